@@ -1,7 +1,9 @@
 #include <atomic>
+#include <chrono>
 #include <future>
 #include <iostream>
 #include <random>
+#include <thread>
 
 #include "integration_test_helper.h"
 #include "log.h"
@@ -13,6 +15,7 @@ using namespace mavsdk;
 
 static std::vector<Mission::MissionItem> create_mission_items();
 static bool should_keep_message(const mavlink_message_t& message);
+static std::chrono::duration<double> time_lossy_transfer(bool over_ftp);
 
 static std::default_random_engine generator;
 static std::uniform_real_distribution<double> distribution(0.0, 1.0);
@@ -58,6 +61,55 @@ TEST(SitlTest, PX4MissionTransferLossy)
     EXPECT_EQ(mission_plan, result.second);
 }
 
+// ArduPilot serves the mission as @MISSION/mission.dat over MAVLink FTP. This compares the
+// file transfer with the item by item transfer on the same lossy link.
+TEST(SitlTest, ArduPilotMissionTransferLossyFtpVsItems)
+{
+    const auto items_duration = time_lossy_transfer(false);
+    const auto ftp_duration = time_lossy_transfer(true);
+
+    LogInfo() << "Mission upload and download item by item took " << items_duration.count()
+              << " s, over FTP " << ftp_duration.count() << " s";
+}
+
+std::chrono::duration<double> time_lossy_transfer(bool over_ftp)
+{
+    Mavsdk::Configuration configuration{ComponentType::GroundStation};
+    configuration.set_mission_transfer_over_ftp(over_ftp);
+    Mavsdk mavsdk{configuration};
+    EXPECT_EQ(mavsdk.add_any_connection("udpin://0.0.0.0:14540"), ConnectionResult::Success);
+
+    auto maybe_system = mavsdk.first_autopilot(10.0);
+    EXPECT_TRUE(maybe_system);
+    if (!maybe_system) {
+        return {};
+    }
+    auto system = maybe_system.value();
+    auto mission = std::make_shared<Mission>(system);
+
+    // Give the autopilot version with the FTP capability time to arrive.
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    mavsdk.intercept_outgoing_messages_async(
+        [](const mavlink_message_t& message) { return should_keep_message(message); });
+
+    mavsdk.intercept_incoming_messages_async(
+        [](const mavlink_message_t& message) { return should_keep_message(message); });
+
+    Mission::MissionPlan mission_plan;
+    mission_plan.mission_items = create_mission_items();
+
+    const auto start = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(mission->upload_mission(mission_plan), Mission::Result::Success);
+
+    auto result = mission->download_mission();
+    EXPECT_EQ(result.first, Mission::Result::Success);
+    EXPECT_EQ(mission_plan, result.second);
+
+    return std::chrono::steady_clock::now() - start;
+}
+
 bool should_keep_message(const mavlink_message_t& message)
 {
     bool should_keep = true;
@@ -66,7 +118,8 @@ bool should_keep_message(const mavlink_message_t& message)
         message.msgid == MAVLINK_MSG_ID_MISSION_REQUEST_INT ||
         // message.msgid == MAVLINK_MSG_ID_MISSION_ACK || FIXME: we rely on ack
         message.msgid == MAVLINK_MSG_ID_MISSION_COUNT ||
-        message.msgid == MAVLINK_MSG_ID_MISSION_ITEM_INT) {
+        message.msgid == MAVLINK_MSG_ID_MISSION_ITEM_INT ||
+        message.msgid == MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL) {
         should_keep = distribution(generator) < 0.95;
     }
     return should_keep;
@@ -1,46 +1,230 @@
 #pragma once
 
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include "log.h"
 #include "callback_list.h"
+#include "delivery_policy.h"
+#include "delivery_timer.h"
 #include "handle_factory.h"
 
 namespace mavsdk {
 
+// Queues the updates of one subscription with DeliveryPolicy::Mode::Latest or RateLimited.
+//
+// At most one call is queued at any time, updates arriving in the meantime replace the
+// value it is going to be called with. With RateLimited, updates arriving within the interval
+// after a delivery are held back as well, and the DeliveryTimer queues the newest one once the
+// interval has passed, so the last update of a burst is not lost.
+//
+// The callback is only ever called where it would be called without a policy: from the queue
+// function for queue(), and on the thread calling call() for exec(). The DeliveryTimer thread
+// never calls it. With exec(), there is no queue to hand a held back update to, so it is
+// replaced by the next update, which is delivered once the interval has passed.
+template<typename... Args>
+class ConflatedDelivery : public std::enable_shared_from_this<ConflatedDelivery<Args...>> {
+public:
+    using QueueFunction = std::function<void(const std::function<void()>&)>;
+
+    ConflatedDelivery(DeliveryPolicy policy, std::function<void(Args...)> callback) :
+        _callback(std::move(callback)),
+        _min_interval(
+            policy.mode == DeliveryPolicy::Mode::RateLimited && policy.rate_hz > 0.0 ?
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(1.0 / policy.rate_hz)) :
+                std::chrono::steady_clock::duration::zero())
+    {}
+
+    void call(Args... args)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_closed) {
+                return;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            if (too_early(now)) {
+                // Superseded by the next call.
+                return;
+            }
+            _last_delivery = now;
+        }
+        _callback(args...);
+    }
+
+    void queue(Args... args, const QueueFunction& queue_func)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_closed) {
+                return;
+            }
+            _latest.emplace(args...);
+
+            // The queued call could have been dropped if the queue was full, so we don't
+            // wait for it forever.
+            const auto now = std::chrono::steady_clock::now();
+            if (_pending_since && now - _pending_since.value() < PENDING_TIMEOUT) {
+                return;
+            }
+            if (_timer_armed || too_early(now)) {
+                arm_timer(queue_func);
+                return;
+            }
+            _pending_since = now;
+            _last_delivery = now;
+        }
+
+        queue_func([self = this->shared_from_this()]() { self->deliver(); });
+    }
+
+    // Called when unsubscribing, nothing is delivered anymore once this returns.
+    void close()
+    {
+        std::lock_guard<std::recursive_mutex> timer_lock(_timer_mutex);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closed = true;
+        _latest.reset();
+        _queue_func = nullptr;
+    }
+
+private:
+    bool too_early(std::chrono::steady_clock::time_point now) const
+    {
+        return _min_interval != std::chrono::steady_clock::duration::zero() && _last_delivery &&
+               now - _last_delivery.value() < _min_interval;
+    }
+
+    // Called with _mutex held. The timer only queues, so the callback is called by whoever
+    // runs the queue and not on the timer thread.
+    void arm_timer(const QueueFunction& queue_func)
+    {
+        if (_timer_armed) {
+            return;
+        }
+        _timer_armed = true;
+        _queue_func = queue_func;
+
+        DeliveryTimer::instance().call_at(
+            _last_delivery.value() + _min_interval, [weak = this->weak_from_this()]() {
+                if (auto self = weak.lock()) {
+                    self->on_timer();
+                }
+            });
+    }
+
+    void on_timer()
+    {
+        // Held while handing over the update, so that close() waits for it.
+        std::lock_guard<std::recursive_mutex> timer_lock(_timer_mutex);
+
+        QueueFunction queue_func;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _timer_armed = false;
+            queue_func = std::move(_queue_func);
+            _queue_func = nullptr;
+            if (_closed || !_latest || !queue_func) {
+                return;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            _last_delivery = now;
+            _pending_since = now;
+        }
+
+        queue_func([self = this->shared_from_this()]() { self->deliver(); });
+    }
+
+    void deliver()
+    {
+        std::optional<std::tuple<std::decay_t<Args>...>> value;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            value.swap(_latest);
+            _pending_since.reset();
+        }
+
+        if (value) {
+            std::apply(_callback, std::move(value.value()));
+        }
+    }
+
+    static constexpr auto PENDING_TIMEOUT = std::chrono::seconds(1);
+
+    const std::function<void(Args...)> _callback;
+    const std::chrono::steady_clock::duration _min_interval;
+
+    // Recursive because the queue function or the callback can unsubscribe.
+    std::recursive_mutex _timer_mutex{};
+    std::mutex _mutex{};
+    std::optional<std::tuple<std::decay_t<Args>...>> _latest{};
+    std::optional<std::chrono::steady_clock::time_point> _pending_since{};
+    std::optional<std::chrono::steady_clock::time_point> _last_delivery{};
+    bool _timer_armed{false};
+    // Only set while the timer is armed.
+    QueueFunction _queue_func{};
+    bool _closed{false};
+};
+
+// The subscribers are kept in an immutable snapshot which is replaced as a whole
+// (copy-on-write) when subscribing or unsubscribing. Calling the callbacks therefore only
+// needs a few atomic operations and no mutex, and callbacks can subscribe and unsubscribe
+// without deadlocking. Changes take effect from the next call on.
+//
+// Replaced snapshots are freed once no call is reading them anymore, which is tracked with
+// a reader count.
+//
+// Subscribers with a DeliveryPolicy other than All get a ConflatedDelivery, so that they
+// occupy at most one entry in the user callback queue.
 template<typename... Args> class CallbackListImpl {
 public:
-    Handle<Args...> subscribe(const std::function<void(Args...)>& callback)
+    CallbackListImpl() : _snapshot(std::make_shared<Snapshot>())
     {
-        check_removals();
-        process_subscriptions();
+        _current.store(_snapshot.get());
+    }
+
+    ~CallbackListImpl()
+    {
+        // The DeliveryTimer must not use the queue function of our owner anymore.
+        for (const auto& subscriber : _snapshot->list) {
+            if (subscriber.conflated) {
+                subscriber.conflated->close();
+            }
+        }
+    }
 
+    Handle<Args...> subscribe(const std::function<void(Args...)>& callback)
+    {
         // We need to return a handle, even if the callback is nullptr to
         // unsubscribe. That's fine, the handle just won't remove anything
         // when/if used later.
         auto handle = _handle_factory.create();
 
         if (callback != nullptr) {
-            if (_mutex.try_lock()) {
-                // We've acquired the lock without blocking, so we can modify the list.
-                _list.emplace_back(handle, callback);
-                _mutex.unlock();
-            } else {
-                // We couldn't acquire the lock because we're likely in a callback.
-                // Defer the subscription.
-                std::lock_guard<std::mutex> lock(_subscribe_later_mutex);
-                _subscribe_later.emplace_back(handle, callback);
+            Subscriber subscriber{handle, callback, nullptr};
+            using PolicyCallback = DeliveryPolicyCallback<Args...>;
+            if (const auto* policy_callback = callback.template target<PolicyCallback>()) {
+                subscriber.callback = policy_callback->callback();
+                if (policy_callback->policy().mode != DeliveryPolicy::Mode::All) {
+                    subscriber.conflated = std::make_shared<ConflatedDelivery<Args...>>(
+                        policy_callback->policy(), policy_callback->callback());
+                }
             }
+            update([&](Snapshot& snapshot) { snapshot.list.push_back(subscriber); });
         } else {
             LogErr() << "Use new unsubscribe methods instead of subscribe(nullptr)\n"
                      << "See: https://mavsdk.mavlink.io/main/en/cpp/api_changes.html#unsubscribe";
-            try_clear();
+            update([](Snapshot& snapshot) { snapshot.list.clear(); });
         }
 
         return handle;
@@ -54,29 +238,14 @@ public:
             return;
         }
 
-        // We want to allow unsubscribing while in a callback. This would
-        // normally lead to a deadlock. Therefore, we just try to grab the
-        // lock here, and if it's already taken, we schedule the removal
-        // for later.
-        std::unique_lock<std::mutex> lock(_mutex, std::try_to_lock);
-        if (lock.owns_lock()) {
-            _list.erase(
+        update([&](Snapshot& snapshot) {
+            snapshot.list.erase(
                 std::remove_if(
-                    _list.begin(), _list.end(), [&](auto& pair) { return pair.first == handle; }),
-                _list.end());
-        } else {
-            std::lock_guard<std::mutex> remove_later_lock(_remove_later_mutex);
-            _remove_later.push_back(handle);
-        }
-
-        // check and remove from deferred lock list if present
-        std::lock_guard<std::mutex> later_lock(_subscribe_later_mutex);
-        _subscribe_later.erase(
-            std::remove_if(
-                _subscribe_later.begin(),
-                _subscribe_later.end(),
-                [&](const auto& pair) { return pair.first == handle; }),
-            _subscribe_later.end());
+                    snapshot.list.begin(),
+                    snapshot.list.end(),
+                    [&](const auto& subscriber) { return subscriber.handle == handle; }),
+                snapshot.list.end());
+        });
     }
 
     /**
@@ -89,143 +258,219 @@ public:
      */
     void subscribe_conditional(const std::function<bool(Args...)>& callback)
     {
-        check_removals();
-        process_subscriptions();
-
         if (callback != nullptr) {
-            if (_mutex.try_lock()) {
-                _cond_cb_list.emplace_back(callback);
-                _mutex.unlock();
-            } else {
-                // We couldn't acquire the lock because we're likely in a callback.
-                // Defer the subscription.
-                std::lock_guard<std::mutex> lock(_subscribe_later_mutex);
-                _subscribe_later_cond.emplace_back(callback);
-            }
+            auto conditional = std::make_shared<Conditional>(callback);
+            update([&](Snapshot& snapshot) { snapshot.conditionals.push_back(conditional); });
         } else {
-            try_clear();
+            update([](Snapshot& snapshot) { snapshot.list.clear(); });
         }
     }
 
     void exec(Args... args)
     {
-        check_removals();
-        process_subscriptions();
-
-        std::lock_guard<std::mutex> lock(_mutex);
-        for (const auto& pair : _list) {
-            pair.second(args...);
+        if (!_has_callbacks.load(std::memory_order_acquire)) {
+            return;
         }
 
-        for (auto it = _cond_cb_list.begin(); it != _cond_cb_list.end();) {
-            if ((*it)(args...)) {
-                // If the callback returns true, remove it based on the iterator
-                it = _cond_cb_list.erase(it);
+        ReadGuard guard(*this);
+        const Snapshot& snapshot = guard.snapshot();
+
+        for (const auto& subscriber : snapshot.list) {
+            if (subscriber.conflated) {
+                subscriber.conflated->call(args...);
             } else {
-                // Otherwise, move to the next element
-                ++it;
+                subscriber.callback(args...);
+            }
+        }
+
+        for (const auto& conditional : snapshot.conditionals) {
+            if (conditional->done.load(std::memory_order_acquire)) {
+                continue;
+            }
+            if (conditional->callback(args...) && !conditional->done.exchange(true)) {
+                // If the callback returns true, it is removed.
+                remove_conditional(conditional.get());
             }
         }
     }
 
     void queue(Args... args, const std::function<void(const std::function<void()>&)>& queue_func)
     {
-        check_removals();
-        process_subscriptions();
-
-        std::lock_guard<std::mutex> lock(_mutex);
-
-        for (const auto& pair : _list) {
-            queue_func([callback = pair.second, args...]() { callback(args...); });
+        if (!_has_callbacks.load(std::memory_order_acquire)) {
+            return;
         }
-    }
 
-    bool empty()
-    {
-        check_removals();
-        process_subscriptions();
+        std::shared_ptr<const Snapshot> snapshot;
+        {
+            ReadGuard guard(*this);
+            bool deliver_all = false;
+            for (const auto& subscriber : guard.snapshot().list) {
+                if (subscriber.conflated) {
+                    subscriber.conflated->queue(args..., queue_func);
+                } else {
+                    deliver_all = true;
+                }
+            }
+            if (!deliver_all) {
+                return;
+            }
+            snapshot = guard.snapshot().shared_from_this();
+        }
 
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _list.empty() && _cond_cb_list.empty();
+        // One queued call for all other subscribers, sharing the snapshot and the arguments.
+        queue_func([snapshot = std::move(snapshot), args...]() {
+            for (const auto& subscriber : snapshot->list) {
+                if (!subscriber.conflated) {
+                    subscriber.callback(args...);
+                }
+            }
+        });
     }
 
+    bool empty() { return !_has_callbacks.load(std::memory_order_acquire); }
+
     void clear()
     {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _list.clear();
-        _cond_cb_list.clear();
+        update([](Snapshot& snapshot) {
+            snapshot.list.clear();
+            snapshot.conditionals.clear();
+        });
     }
 
 private:
-    void check_removals()
-    {
-        std::lock_guard<std::mutex> remove_later_lock(_remove_later_mutex);
+    struct Conditional {
+        explicit Conditional(std::function<bool(Args...)> cb) : callback(std::move(cb)) {}
+
+        std::function<bool(Args...)> callback;
+        // Set once the callback returned true, it's then not called anymore even if it is
+        // still in a snapshot that is being read.
+        std::atomic<bool> done{false};
+    };
+
+    struct Subscriber {
+        Handle<Args...> handle;
+        std::function<void(Args...)> callback;
+        // Only set for policies other than DeliveryPolicy::Mode::All.
+        std::shared_ptr<ConflatedDelivery<Args...>> conflated;
+    };
+
+    struct Snapshot : std::enable_shared_from_this<Snapshot> {
+        Snapshot() = default;
+        // Copy the subscribers only, not the shared_from_this state.
+        Snapshot(const Snapshot& other) :
+            std::enable_shared_from_this<Snapshot>(),
+            list(other.list),
+            conditionals(other.conditionals)
+        {}
+
+        bool contains(const Handle<Args...>& handle) const
+        {
+            return std::any_of(list.begin(), list.end(), [&](const auto& subscriber) {
+                return subscriber.handle == handle;
+            });
+        }
 
-        // We could probably just grab the lock here, but it's safer not to
-        // acquire both locks to avoid deadlocks.
-        if (_mutex.try_lock()) {
-            if (_remove_all_later) {
-                _remove_all_later = false;
-                _list.clear();
-                _cond_cb_list.clear();
-                _remove_later.clear();
-            }
+        std::vector<Subscriber> list{};
+        std::vector<std::shared_ptr<Conditional>> conditionals{};
+    };
+
+    class ReadGuard {
+    public:
+        explicit ReadGuard(CallbackListImpl& parent) : _parent(parent)
+        {
+            // The reader count has to be incremented before loading the snapshot, so that a
+            // writer seeing no readers can be sure nobody is reading a replaced snapshot.
+            _parent._readers.fetch_add(1);
+            _snapshot = _parent._current.load();
+        }
 
-            for (const auto& handle : _remove_later) {
-                _list.erase(
-                    std::remove_if(
-                        _list.begin(),
-                        _list.end(),
-                        [&](auto& pair) { return pair.first == handle; }),
-                    _list.end());
+        ~ReadGuard()
+        {
+            if (_parent._readers.fetch_sub(1) == 1 &&
+                _parent._has_retired.load(std::memory_order_relaxed)) {
+                _parent.try_free_retired();
             }
-            _mutex.unlock();
         }
-    }
 
-    void process_subscriptions()
+        const Snapshot& snapshot() const { return *_snapshot; }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        CallbackListImpl& _parent;
+        const Snapshot* _snapshot;
+    };
+
+    template<typename Modify> void update(Modify&& modify)
     {
-        std::lock_guard<std::mutex> subscribe_later_lock(_subscribe_later_mutex);
+        std::vector<std::shared_ptr<ConflatedDelivery<Args...>>> removed;
+        {
+            std::lock_guard<std::mutex> lock(_write_mutex);
 
-        if (_mutex.try_lock()) {
-            for (const auto& sub : _subscribe_later) {
-                _list.emplace_back(sub);
+            auto next = std::make_shared<Snapshot>(*_snapshot);
+            modify(*next);
+
+            for (const auto& subscriber : _snapshot->list) {
+                if (subscriber.conflated && !next->contains(subscriber.handle)) {
+                    removed.push_back(subscriber.conflated);
+                }
             }
-            _subscribe_later.clear();
 
-            // add conditional callbacks
-            for (const auto& sub : _subscribe_later_cond) {
-                _cond_cb_list.emplace_back(sub);
+            _has_callbacks.store(!next->list.empty() || !next->conditionals.empty());
+            _current.store(next.get());
+
+            _retired.push_back(std::move(_snapshot));
+            _snapshot = std::move(next);
+
+            if (_readers.load() == 0) {
+                _retired.clear();
             }
-            _subscribe_later_cond.clear();
-            _mutex.unlock();
+            _has_retired.store(!_retired.empty(), std::memory_order_relaxed);
+        }
+
+        // Not with the write lock, closing waits for a delivery of the DeliveryTimer which
+        // might subscribe or unsubscribe itself.
+        for (const auto& conflated : removed) {
+            conflated->close();
         }
     }
 
-    void try_clear()
+    void remove_conditional(const Conditional* conditional)
     {
-        std::unique_lock<std::mutex> lock(_mutex, std::try_to_lock);
-        if (lock.owns_lock()) {
-            _list.clear();
-        } else {
-            std::lock_guard<std::mutex> remove_later_lock(_remove_later_mutex);
-            _remove_all_later = true;
+        update([&](Snapshot& snapshot) {
+            snapshot.conditionals.erase(
+                std::remove_if(
+                    snapshot.conditionals.begin(),
+                    snapshot.conditionals.end(),
+                    [&](const auto& other) { return other.get() == conditional; }),
+                snapshot.conditionals.end());
+        });
+    }
+
+    void try_free_retired()
+    {
+        // If a writer is busy, it will free them itself.
+        std::unique_lock<std::mutex> lock(_write_mutex, std::try_to_lock);
+        if (lock.owns_lock() && _readers.load() == 0) {
+            _retired.clear();
+            _has_retired.store(false, std::memory_order_relaxed);
         }
     }
 
-    mutable std::mutex _mutex{};
     HandleFactory<Args...> _handle_factory;
-    std::vector<std::pair<Handle<Args...>, std::function<void(Args...)>>> _list{};
-    std::vector<std::function<bool(Args...)>> _cond_cb_list{};
-
-    mutable std::mutex _remove_later_mutex{};
-    std::vector<Handle<Args...>> _remove_later{};
-
-    std::mutex _subscribe_later_mutex;
-    std::vector<std::pair<Handle<Args...>, std::function<void(Args...)>>> _subscribe_later;
-    std::vector<std::function<bool(Args...)>> _subscribe_later_cond;
 
-    bool _remove_all_later{false};
+    // What readers use, always points to _snapshot.
+    std::atomic<const Snapshot*> _current{nullptr};
+    std::atomic<bool> _has_callbacks{false};
+    std::atomic<unsigned> _readers{0};
+    std::atomic<bool> _has_retired{false};
+
+    // Only accessed with _write_mutex.
+    std::mutex _write_mutex{};
+    std::shared_ptr<Snapshot> _snapshot;
+    // Replaced snapshots which might still be read.
+    std::vector<std::shared_ptr<Snapshot>> _retired{};
 };
 
 } // namespace mavsdk
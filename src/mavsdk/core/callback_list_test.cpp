@@ -1,7 +1,9 @@
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <thread>
 #include <set>
+#include <string>
 #include <optional>
 #include <memory>
 #include <vector>
@@ -16,6 +18,7 @@ namespace mavsdk {
 
 template class CallbackList<int, double>;
 template class CallbackList<>;
+template class CallbackList<int>;
 
 } // namespace mavsdk
 
@@ -283,3 +286,256 @@ TEST(CallbackList, SubscribeAndUnsubscribeWithinCallbacks2)
         thread.join();
     }
 }
+
+TEST(CallbackList, CallWhileSubscribingFromOtherThread)
+{
+    CallbackList<int, double> cl;
+    std::atomic<bool> done{false};
+    std::atomic<unsigned> called{0};
+
+    cl.subscribe([&](int, double) { ++called; });
+
+    std::thread writer([&]() {
+        for (unsigned i = 0; i < 10000; ++i) {
+            auto handle = cl.subscribe([&](int, double) { ++called; });
+            cl.unsubscribe(handle);
+        }
+        done = true;
+    });
+
+    unsigned calls = 0;
+    while (!done) {
+        cl(1, 2.0);
+        ++calls;
+    }
+    writer.join();
+
+    // The first subscriber is called every time, the others sometimes.
+    EXPECT_GE(called, calls);
+    EXPECT_FALSE(cl.empty());
+}
+
+TEST(CallbackList, QueueCallsAllSubscribersOnce)
+{
+    CallbackList<int, double> cl;
+    std::vector<std::function<void()>> queued;
+    auto queue_func = [&](const std::function<void()>& func) { queued.push_back(func); };
+
+    // Nothing subscribed, nothing queued.
+    cl.queue(1, 2.0, queue_func);
+    EXPECT_TRUE(queued.empty());
+
+    unsigned first_called = 0;
+    unsigned second_called = 0;
+    auto handle = cl.subscribe([&](int i, double) { first_called += i; });
+    cl.subscribe([&](int i, double) { second_called += i; });
+
+    cl.queue(3, 2.0, queue_func);
+    ASSERT_EQ(queued.size(), 1u);
+
+    // Unsubscribing doesn't affect what is already queued.
+    cl.unsubscribe(handle);
+    queued.front()();
+    EXPECT_EQ(first_called, 3);
+    EXPECT_EQ(second_called, 3);
+}
+
+TEST(CallbackList, LatestOnlyOccupiesOneQueueEntry)
+{
+    CallbackList<int, double> cl;
+    std::vector<std::function<void()>> queued;
+    auto queue_func = [&](const std::function<void()>& func) { queued.push_back(func); };
+
+    std::vector<int> all_values;
+    std::vector<int> latest_values;
+    cl.subscribe([&](int i, double) { all_values.push_back(i); });
+    cl.subscribe(with_delivery_policy<std::function<void(int, double)>>(
+        DeliveryPolicy::latest(), [&](int i, double) { latest_values.push_back(i); }));
+
+    for (int i = 0; i < 5; ++i) {
+        cl.queue(i, 0.0, queue_func);
+    }
+
+    // One entry per update for the first subscriber, one in total for the second.
+    EXPECT_EQ(queued.size(), 6u);
+    for (const auto& func : queued) {
+        func();
+    }
+    queued.clear();
+
+    EXPECT_EQ(all_values, (std::vector<int>{0, 1, 2, 3, 4}));
+    EXPECT_EQ(latest_values, (std::vector<int>{4}));
+
+    // After delivery, the next update is queued again.
+    cl.queue(5, 0.0, queue_func);
+    ASSERT_EQ(queued.size(), 2u);
+    for (const auto& func : queued) {
+        func();
+    }
+    EXPECT_EQ(latest_values, (std::vector<int>{4, 5}));
+}
+
+TEST(CallbackList, RateLimited)
+{
+    CallbackList<int, double> cl;
+    std::mutex mutex;
+    std::vector<int> values;
+    cl.subscribe(with_delivery_policy<std::function<void(int, double)>>(
+        DeliveryPolicy::rate_limited(10.0), [&](int i, double) {
+            std::lock_guard<std::mutex> lock(mutex);
+            values.push_back(i);
+        }));
+
+    // Direct calls are rate limited as well.
+    cl(0, 0.0);
+    cl(1, 0.0);
+    cl(2, 0.0);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_EQ(values, (std::vector<int>{0}));
+    }
+
+    // Nothing is delivered from another thread in the meantime.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_EQ(values, (std::vector<int>{0}));
+    }
+
+    // The next update after the interval is.
+    cl(3, 0.0);
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(values, (std::vector<int>{0, 3}));
+}
+
+TEST(CallbackList, RateLimitedCallsBackOnCallingThread)
+{
+    CallbackList<int> cl;
+    std::vector<std::thread::id> threads;
+    cl.subscribe(with_delivery_policy<std::function<void(int)>>(
+        DeliveryPolicy::rate_limited(20.0),
+        [&](int) { threads.push_back(std::this_thread::get_id()); }));
+
+    for (int i = 0; i < 10; ++i) {
+        cl(i);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    ASSERT_FALSE(threads.empty());
+    for (const auto& thread : threads) {
+        EXPECT_EQ(thread, std::this_thread::get_id());
+    }
+}
+
+TEST(CallbackList, RateLimitedQueuesLastUpdateOfBurst)
+{
+    CallbackList<int, double> cl;
+    std::mutex mutex;
+    std::vector<std::function<void()>> queued;
+    auto queue_func = [&](const std::function<void()>& func) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.push_back(func);
+    };
+    auto run_queued = [&]() {
+        std::vector<std::function<void()>> funcs;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            funcs.swap(queued);
+        }
+        for (const auto& func : funcs) {
+            func();
+        }
+        return funcs.size();
+    };
+
+    std::vector<int> values;
+    cl.subscribe(with_delivery_policy<std::function<void(int, double)>>(
+        DeliveryPolicy::rate_limited(10.0), [&](int i, double) { values.push_back(i); }));
+
+    cl.queue(0, 0.0, queue_func);
+    EXPECT_EQ(run_queued(), 1u);
+    EXPECT_EQ(values, (std::vector<int>{0}));
+
+    // Within the interval, nothing is queued yet.
+    cl.queue(1, 0.0, queue_func);
+    cl.queue(2, 0.0, queue_func);
+    EXPECT_EQ(run_queued(), 0u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(run_queued(), 1u);
+    EXPECT_EQ(values, (std::vector<int>{0, 2}));
+}
+
+TEST(CallbackList, RateLimitedDeliversNothingAfterUnsubscribe)
+{
+    CallbackList<int, double> cl;
+    std::atomic<int> called{0};
+    auto handle = cl.subscribe(with_delivery_policy<std::function<void(int, double)>>(
+        DeliveryPolicy::rate_limited(10.0), [&](int, double) { ++called; }));
+
+    cl(0, 0.0);
+    cl(1, 0.0);
+    cl.unsubscribe(handle);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(called, 1);
+}
+
+TEST(CallbackList, MismatchingDeliveryPolicyDeliversAll)
+{
+    CallbackList<int> cl;
+    std::vector<int> values;
+
+    // The policy is for a different callback type, so it can't be applied.
+    cl.subscribe(with_delivery_policy<std::function<void(const int&)>>(
+        DeliveryPolicy::latest(), [&](const int& i) { values.push_back(i); }));
+
+    cl(0);
+    cl(1);
+    EXPECT_EQ(values, (std::vector<int>{0, 1}));
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests.
+TEST(CallbackList, DISABLED_Benchmark)
+{
+    constexpr unsigned calls = 1000000;
+
+    for (unsigned subscribers : {0u, 1u, 10u}) {
+        CallbackList<int, double> cl;
+        unsigned called = 0;
+        for (unsigned i = 0; i < subscribers; ++i) {
+            cl.subscribe([&](int, double) { ++called; });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < calls; ++i) {
+            cl(static_cast<int>(i), 1.0);
+        }
+        const double exec_ns =
+            std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+                .count() /
+            calls;
+
+        unsigned queued = 0;
+        std::function<void()> last;
+        start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < calls; ++i) {
+            cl.queue(static_cast<int>(i), 1.0, [&](const std::function<void()>& func) {
+                last = func;
+                ++queued;
+            });
+        }
+        const double queue_ns =
+            std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+                .count() /
+            calls;
+
+        // Time per call.
+        const auto suffix = "_ns_" + std::to_string(subscribers) + "_subscribers";
+        ::testing::Test::RecordProperty("exec" + suffix, static_cast<int>(exec_ns));
+        ::testing::Test::RecordProperty("queue" + suffix, static_cast<int>(queue_ns));
+
+        EXPECT_EQ(called, subscribers * calls);
+        EXPECT_EQ(queued, subscribers > 0 ? calls : 0);
+    }
+}
@@ -1,6 +1,8 @@
 #include "connection.h"
 
+#include <cstring>
 #include <memory>
+#include <sstream>
 #include <utility>
 #include "mavsdk_impl.h"
 #include "log.h"
@@ -74,22 +76,21 @@ void Connection::stop_libmav_receiver()
     }
 }
 
-void Connection::receive_libmav_message(
-    const Mavsdk::MavlinkMessage& message, Connection* connection)
+void Connection::receive_libmav_message(const LibmavMessage& message, Connection* connection)
 {
     // Register system ID when receiving a message from a new system.
-    if (_system_ids.find(message.system_id) == _system_ids.end()) {
-        _system_ids.insert(message.system_id);
+    if (_system_ids.find(message.message.system_id) == _system_ids.end()) {
+        _system_ids.insert(message.message.system_id);
     }
 
     if (_debugging) {
-        LogDebug() << "Connection::receive_libmav_message: " << message.message_name
-                   << " from system " << message.system_id;
+        LogDebug() << "Connection::receive_libmav_message: " << message.message.message_name
+                   << " from system " << message.message.system_id;
     }
 
     if (_libmav_receiver_callback) {
         if (_debugging) {
-            LogDebug() << "Calling libmav receiver callback for: " << message.message_name;
+            LogDebug() << "Calling libmav receiver callback for: " << message.message.message_name;
         }
         _libmav_receiver_callback(message, connection);
     } else {
@@ -99,6 +100,18 @@ void Connection::receive_libmav_message(
 
 void Connection::receive_message(mavlink_message_t& message, Connection* connection)
 {
+    if (_mavlink_receiver && _mavlink_receiver->last_message_unknown_id()) {
+        // We can't check the checksum without knowing the message, but the sequence
+        // number is still valid, so this is not counted as loss.
+        _unknown_message_ids.fetch_add(1, std::memory_order_relaxed);
+        _link_quality.record(message.sysid, message.compid, message.seq);
+    } else if (_mavlink_receiver && _mavlink_receiver->last_message_bad_crc()) {
+        _crc_errors.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        _received_counters.record(message.msgid, mavlink_frame_length(message));
+        _link_quality.record(message.sysid, message.compid, message.seq);
+    }
+
     // Register system ID when receiving a message from a new system.
     if (_system_ids.find(message.sysid) == _system_ids.end()) {
         _system_ids.insert(message.sysid);
@@ -106,6 +119,123 @@ void Connection::receive_message(mavlink_message_t& message, Connection* connect
     _receiver_callback(message, connection);
 }
 
+void Connection::queue_frame(MavlinkFramePtr frame)
+{
+    if (_queued_frames.empty()) {
+        _first_queued_frame_time = std::chrono::steady_clock::now();
+    }
+    _queued_frames.push_back(std::move(frame));
+}
+
+std::pair<bool, std::string> Connection::flush_frames()
+{
+    if (!has_queued_frames()) {
+        return {true, ""};
+    }
+
+    auto result = send_frames(_queued_frames);
+    if (result.first) {
+        for (const auto& frame : _queued_frames) {
+            _sent_counters.record(frame->message_id(), frame->size());
+        }
+    }
+
+    // Keeps the capacity for the next iteration.
+    _queued_frames.clear();
+    return result;
+}
+
+std::pair<bool, std::string> Connection::send_frames(const std::vector<MavlinkFramePtr>& frames)
+{
+    for (const auto& frame : frames) {
+        auto result = send_raw_bytes(frame->data(), frame->size());
+        if (!result.first) {
+            return result;
+        }
+    }
+    return {true, ""};
+}
+
+std::pair<bool, std::string>
+Connection::send_frames_concatenated(const std::vector<MavlinkFramePtr>& frames)
+{
+    if (frames.size() == 1) {
+        return send_raw_bytes(frames.front()->data(), frames.front()->size());
+    }
+
+    _concatenated_frames.clear();
+    for (const auto& frame : frames) {
+        _concatenated_frames.insert(
+            _concatenated_frames.end(), frame->data(), frame->data() + frame->size());
+    }
+    return send_raw_bytes(_concatenated_frames.data(), _concatenated_frames.size());
+}
+
+std::pair<bool, std::string> Connection::send_frames_buffered(
+    const std::vector<MavlinkFramePtr>& frames,
+    const OutboundStream::WriteFunction& write_function)
+{
+    unsigned dropped = 0;
+    for (const auto& frame : frames) {
+        if (!_outbound_stream.push(frame)) {
+            ++dropped;
+        }
+    }
+
+    const int error = _outbound_stream.write(write_function);
+    if (error != 0) {
+        std::stringstream ss;
+        ss << "Send failure: " << strerror(error);
+        LogErr() << ss.str();
+        return {false, ss.str()};
+    }
+
+    if (dropped > 0) {
+        std::stringstream ss;
+        ss << "Send buffer full, dropped " << dropped << " messages";
+        LogWarn() << ss.str();
+        return {false, ss.str()};
+    }
+
+    return {true, ""};
+}
+
+ConnectionStatistics Connection::statistics() const
+{
+    ConnectionStatistics statistics;
+    statistics.messages_received = _received_counters.messages();
+    statistics.bytes_received = _received_counters.bytes();
+    statistics.messages_received_rate_hz = _received_counters.rate_hz();
+    statistics.bytes_received_rate = _received_counters.bytes_rate();
+    statistics.messages_lost = _link_quality.lost();
+    statistics.crc_errors = _crc_errors.load(std::memory_order_relaxed);
+    statistics.unknown_message_ids = _unknown_message_ids.load(std::memory_order_relaxed);
+    statistics.messages_sent = _sent_counters.messages();
+    statistics.bytes_sent = _sent_counters.bytes();
+    statistics.messages_sent_rate_hz = _sent_counters.rate_hz();
+    statistics.received = _received_counters.snapshot();
+    statistics.sent = _sent_counters.snapshot();
+    return statistics;
+}
+
+void Connection::update_statistics_rates(double elapsed_s)
+{
+    _received_counters.update_rates(elapsed_s);
+    _sent_counters.update_rates(elapsed_s);
+    _link_quality.update_rates(elapsed_s);
+}
+
+void Connection::record_round_trip_time(
+    uint8_t system_id, uint8_t component_id, std::chrono::steady_clock::duration rtt)
+{
+    _link_quality.record_round_trip_time(system_id, component_id, rtt);
+}
+
+std::vector<LinkQuality> Connection::link_quality(uint8_t system_id) const
+{
+    return _link_quality.snapshot(system_id);
+}
+
 bool Connection::should_forward_messages() const
 {
     return _forwarding_option == ForwardingOption::ForwardingOn;
@@ -121,6 +251,12 @@ bool Connection::has_system_id(uint8_t system_id)
     return _system_ids.find(system_id) != _system_ids.end();
 }
 
+bool Connection::has_only_system_id(uint8_t system_id)
+{
+    // The system ID 0 is always in there.
+    return has_system_id(system_id) && _system_ids.size() == (system_id != 0 ? 2 : 1);
+}
+
 #ifdef WINDOWS
 std::string get_socket_error_string(int error_code)
 {
@@ -2,12 +2,17 @@
 
 #include "mavsdk.h"
 #include "mavlink_receiver.h"
+#include "mavlink_statistics.h"
 #include "libmav_receiver.h"
+#include "mavlink_frame.h"
+#include "outbound_stream.h"
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 namespace mavsdk {
 
@@ -18,7 +23,7 @@ public:
     using ReceiverCallback =
         std::function<void(mavlink_message_t& message, Connection* connection)>;
     using LibmavReceiverCallback =
-        std::function<void(const Mavsdk::MavlinkMessage& message, Connection* connection)>;
+        std::function<void(const LibmavMessage& message, Connection* connection)>;
 
     explicit Connection(
         ReceiverCallback receiver_callback,
@@ -35,10 +40,42 @@ public:
     // Send raw bytes for forwarding unknown messages
     virtual std::pair<bool, std::string> send_raw_bytes(const char* bytes, size_t length) = 0;
 
+    // Frames are queued during one iteration of the work thread and then sent together by
+    // flush_frames(). Both are only to be called from the work thread.
+    void queue_frame(MavlinkFramePtr frame);
+    [[nodiscard]] bool has_queued_frames() const
+    {
+        return !_queued_frames.empty() || _outbound_stream.has_pending();
+    }
+
+    // When the oldest of the queued frames was queued.
+    [[nodiscard]] std::chrono::steady_clock::time_point first_queued_frame_time() const
+    {
+        return _first_queued_frame_time;
+    }
+
+    // Sends all queued frames and records them in the statistics. The frames are dropped if
+    // sending fails.
+    std::pair<bool, std::string> flush_frames();
+
     bool has_system_id(uint8_t system_id);
+    // True if messages from this system and no other have been received.
+    bool has_only_system_id(uint8_t system_id);
     bool should_forward_messages() const;
     static unsigned forwarding_connections_count();
 
+    // The connection handle is not known here and left empty.
+    ConnectionStatistics statistics() const;
+    void update_statistics_rates(double elapsed_s);
+
+    // To be called from the work thread when a reply to a ping or timesync arrived on this
+    // connection.
+    void record_round_trip_time(
+        uint8_t system_id, uint8_t component_id, std::chrono::steady_clock::duration rtt);
+
+    // The connection handle is not known here and left empty.
+    std::vector<LinkQuality> link_quality(uint8_t system_id) const;
+
     // Access to libmav receiver for message creation
     LibmavReceiver* get_libmav_receiver() { return _libmav_receiver.get(); }
 
@@ -47,13 +84,27 @@ public:
     const Connection& operator=(const Connection&) = delete;
 
 protected:
+    // Sends several frames. By default, every frame is sent on its own, as for datagram
+    // based connections every frame has to be its own datagram.
+    virtual std::pair<bool, std::string> send_frames(const std::vector<MavlinkFramePtr>& frames);
+
+    // For stream based connections, the frames are written with one call.
+    std::pair<bool, std::string>
+    send_frames_concatenated(const std::vector<MavlinkFramePtr>& frames);
+
+    // Same, but written with scatter/gather writes from the frames directly. What can't be
+    // written right away is kept and written first on the next flush.
+    std::pair<bool, std::string> send_frames_buffered(
+        const std::vector<MavlinkFramePtr>& frames,
+        const OutboundStream::WriteFunction& write_function);
+
     bool start_mavlink_receiver();
     void stop_mavlink_receiver();
     void receive_message(mavlink_message_t& message, Connection* connection);
 
     bool start_libmav_receiver();
     void stop_libmav_receiver();
-    void receive_libmav_message(const Mavsdk::MavlinkMessage& message, Connection* connection);
+    void receive_libmav_message(const LibmavMessage& message, Connection* connection);
 
     ReceiverCallback _receiver_callback{};
     LibmavReceiverCallback _libmav_receiver_callback{};
@@ -65,8 +116,19 @@ protected:
 
     bool _debugging = false;
 
+    MessageIdCounters _received_counters{};
+    MessageIdCounters _sent_counters{};
+    LinkQualityTracker _link_quality{};
+    std::atomic<uint64_t> _crc_errors{0};
+    std::atomic<uint64_t> _unknown_message_ids{0};
+
     static std::atomic<unsigned> _forwarding_connections_count;
 
+    std::vector<MavlinkFramePtr> _queued_frames{};
+    std::chrono::steady_clock::time_point _first_queued_frame_time{};
+    std::vector<char> _concatenated_frames{};
+    OutboundStream _outbound_stream{};
+
     // void received_mavlink_message(mavlink_message_t &);
 };
 
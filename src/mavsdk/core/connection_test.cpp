@@ -0,0 +1,160 @@
+#include "connection.h"
+#include "mavsdk_impl.h"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+class FakeConnection : public Connection {
+public:
+    FakeConnection(MavsdkImpl& mavsdk_impl, bool stream) :
+        Connection(
+            [](mavlink_message_t&, Connection*) {},
+            [](const LibmavMessage&, Connection*) {},
+            mavsdk_impl),
+        _stream(stream)
+    {}
+
+    ConnectionResult start() override { return ConnectionResult::Success; }
+    ConnectionResult stop() override { return ConnectionResult::Success; }
+
+    std::pair<bool, std::string> send_message(const mavlink_message_t& message) override
+    {
+        const MavlinkFrame frame{message};
+        return send_raw_bytes(frame.data(), frame.size());
+    }
+
+    std::pair<bool, std::string> send_raw_bytes(const char* bytes, size_t length) override
+    {
+        writes.emplace_back(bytes, length);
+        return {true, ""};
+    }
+
+    void receive(const std::string& bytes)
+    {
+        if (!_mavlink_receiver) {
+            start_mavlink_receiver();
+        }
+        std::string datagram = bytes;
+        _mavlink_receiver->set_new_datagram(
+            datagram.data(), static_cast<unsigned>(datagram.size()));
+        while (_mavlink_receiver->parse_message()) {
+            receive_message(_mavlink_receiver->get_last_message(), this);
+        }
+    }
+
+    std::vector<std::string> writes{};
+
+protected:
+    std::pair<bool, std::string> send_frames(const std::vector<MavlinkFramePtr>& frames) override
+    {
+        return _stream ? send_frames_concatenated(frames) : Connection::send_frames(frames);
+    }
+
+private:
+    bool _stream;
+};
+
+MavlinkFramePtr make_heartbeat(uint8_t sequence)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack_chan(
+        1, 1, MAVLINK_COMM_0, &message, MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID, 0, 0, 0);
+    message.seq = sequence;
+    return make_mavlink_frame(message);
+}
+
+// Encodes a heartbeat with a valid checksum, or, with a different message ID, a message we
+// don't know and therefore can't check the checksum of.
+std::string make_received_frame(uint8_t sequence, uint32_t message_id = MAVLINK_MSG_ID_HEARTBEAT)
+{
+    mavlink_get_channel_status(MAVLINK_COMM_1)->current_tx_seq = sequence;
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack_chan(
+        1, 1, MAVLINK_COMM_1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, 0);
+    message.msgid = message_id;
+    const MavlinkFrame frame{message};
+    return std::string(frame.data(), frame.size());
+}
+
+} // namespace
+
+TEST(Connection, FlushSendsEveryFrameOnDatagramConnections)
+{
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{ComponentType::GroundStation}};
+    FakeConnection connection{mavsdk_impl, false};
+
+    const auto frame = make_heartbeat(0);
+    connection.queue_frame(frame);
+    connection.queue_frame(frame);
+    connection.queue_frame(make_heartbeat(1));
+    EXPECT_TRUE(connection.has_queued_frames());
+
+    EXPECT_TRUE(connection.flush_frames().first);
+    EXPECT_FALSE(connection.has_queued_frames());
+
+    ASSERT_EQ(connection.writes.size(), 3u);
+    EXPECT_EQ(connection.writes[0], std::string(frame->data(), frame->size()));
+
+    const auto statistics = connection.statistics();
+    EXPECT_EQ(statistics.messages_sent, 3u);
+    EXPECT_EQ(statistics.bytes_sent, 3 * frame->size());
+}
+
+TEST(Connection, FlushConcatenatesFramesOnStreamConnections)
+{
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{ComponentType::GroundStation}};
+    FakeConnection connection{mavsdk_impl, true};
+
+    const auto first = make_heartbeat(0);
+    const auto second = make_heartbeat(1);
+    connection.queue_frame(first);
+    connection.queue_frame(second);
+
+    EXPECT_TRUE(connection.flush_frames().first);
+
+    ASSERT_EQ(connection.writes.size(), 1u);
+    EXPECT_EQ(
+        connection.writes[0],
+        std::string(first->data(), first->size()) + std::string(second->data(), second->size()));
+    EXPECT_EQ(connection.statistics().messages_sent, 2u);
+
+    // Nothing queued, nothing written.
+    EXPECT_TRUE(connection.flush_frames().first);
+    EXPECT_EQ(connection.writes.size(), 1u);
+}
+
+TEST(Connection, UnknownMessageIdsAreNotCountedAsLoss)
+{
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{ComponentType::GroundStation}};
+    FakeConnection connection{mavsdk_impl, false};
+
+    constexpr uint32_t unknown_message_id = 16000000;
+
+    connection.receive(make_received_frame(0));
+    connection.receive(make_received_frame(1, unknown_message_id));
+    connection.receive(make_received_frame(2, unknown_message_id));
+    connection.receive(make_received_frame(3));
+
+    auto statistics = connection.statistics();
+    EXPECT_EQ(statistics.messages_received, 2u);
+    EXPECT_EQ(statistics.messages_lost, 0u);
+    EXPECT_EQ(statistics.unknown_message_ids, 2u);
+    EXPECT_EQ(statistics.crc_errors, 0u);
+
+    // A heartbeat with a corrupted checksum is a checksum error.
+    auto corrupted = make_received_frame(4);
+    corrupted.back() ^= 0xff;
+    connection.receive(corrupted);
+    connection.receive(make_received_frame(5));
+
+    statistics = connection.statistics();
+    EXPECT_EQ(statistics.messages_received, 3u);
+    EXPECT_EQ(statistics.messages_lost, 1u);
+    EXPECT_EQ(statistics.unknown_message_ids, 2u);
+    EXPECT_EQ(statistics.crc_errors, 1u);
+}
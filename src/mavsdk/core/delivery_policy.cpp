@@ -0,0 +1,12 @@
+#include "delivery_policy.h"
+#include "log.h"
+
+namespace mavsdk::detail {
+
+void warn_delivery_policy_ignored()
+{
+    LogWarn() << "Delivery policy ignored, every update is delivered. "
+              << "Does the callback type given to with_delivery_policy() match the subscription?";
+}
+
+} // namespace mavsdk::detail
@@ -0,0 +1,54 @@
+#include "delivery_timer.h"
+
+#include <thread>
+
+namespace mavsdk {
+
+DeliveryTimer& DeliveryTimer::instance()
+{
+    // Intentionally leaked, so that subscriptions can still be delivered to during static
+    // destruction.
+    static DeliveryTimer* timer = new DeliveryTimer();
+    return *timer;
+}
+
+DeliveryTimer::DeliveryTimer()
+{
+    // Never joined, the timer lives as long as the process.
+    std::thread(&DeliveryTimer::run, this).detach();
+}
+
+void DeliveryTimer::call_at(std::chrono::steady_clock::time_point time, std::function<void()> func)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _calls.emplace(time, std::move(func));
+    }
+    _cv.notify_one();
+}
+
+void DeliveryTimer::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        if (_calls.empty()) {
+            _cv.wait(lock);
+            continue;
+        }
+
+        const auto next = _calls.begin();
+        if (std::chrono::steady_clock::now() < next->first) {
+            _cv.wait_until(lock, next->first);
+            continue;
+        }
+
+        auto func = std::move(next->second);
+        _calls.erase(next);
+
+        lock.unlock();
+        func();
+        lock.lock();
+    }
+}
+
+} // namespace mavsdk
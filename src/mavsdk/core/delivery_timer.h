@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace mavsdk {
+
+// Calls functions at a given time on its own thread.
+//
+// It's shared by all callback lists to deliver the last update of a rate-limited subscription
+// once the interval has passed, so it must only be used for short functions.
+class DeliveryTimer {
+public:
+    static DeliveryTimer& instance();
+
+    void call_at(std::chrono::steady_clock::time_point time, std::function<void()> func);
+
+    DeliveryTimer(const DeliveryTimer&) = delete;
+    DeliveryTimer& operator=(const DeliveryTimer&) = delete;
+
+private:
+    DeliveryTimer();
+    ~DeliveryTimer() = default;
+
+    void run();
+
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> _calls{};
+};
+
+} // namespace mavsdk
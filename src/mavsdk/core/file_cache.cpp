@@ -2,14 +2,21 @@
 #include "file_cache.h"
 #include "log.h"
 
+#include <picosha2.h>
+
+#include <algorithm>
 #include <cstring>
 #include <fstream>
+#include <iterator>
+#include <set>
+#include <vector>
 
 // For directory locking
 #ifdef WINDOWS
 #include <Windows.h>
 #else
 #include <sys/file.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -64,6 +71,18 @@ FileCache::FileCache(std::filesystem::path path, int max_num_files, bool verbose
             LogErr() << "Failed to create cache directory: " << err.message();
         }
     }
+
+    const std::lock_guard lock(_mutex);
+    const DirectoryLock directory_lock(_path / _lock_file);
+    load_index();
+    remove_old_entries(); // Only needed if the cache size got reduced
+}
+
+FileCache::~FileCache()
+{
+    const std::lock_guard lock(_mutex);
+    const DirectoryLock directory_lock(_path / _lock_file);
+    flush_access_counters();
 }
 
 std::filesystem::path FileCache::meta_filename(const std::string& file_tag) const
@@ -71,31 +90,39 @@ std::filesystem::path FileCache::meta_filename(const std::string& file_tag) cons
     return _path / (file_tag + _meta_extension);
 }
 
-std::filesystem::path FileCache::data_filename(const std::string& file_tag) const
+std::filesystem::path FileCache::data_filename(const std::string& content_hash) const
 {
-    return _path / (file_tag + _cache_extension);
+    return _path / (content_hash + _cache_extension);
 }
 
 std::optional<std::filesystem::path> FileCache::access(const std::string& file_tag)
 {
-    const DirectoryLock directory_lock(_path / _lock_file); // also serves as multi-threadding lock
+    const std::lock_guard lock(_mutex);
 
-    const std::filesystem::path meta(meta_filename(file_tag));
-    std::filesystem::path data(data_filename(file_tag));
-    if (!std::filesystem::exists(meta) || !std::filesystem::exists(data)) {
+    auto it = _entries.find(file_tag);
+    if (it == _entries.end()) {
+        // It might have been inserted by another instance in the meantime.
+        const DirectoryLock directory_lock(_path / _lock_file);
+        auto entry = load_entry(file_tag);
+        if (entry) {
+            it = _entries.emplace(file_tag, std::move(entry.value())).first;
+        }
+    }
+
+    if (it == _entries.end()) {
         if (_verbose_debugging) {
             LogDebug() << "Cache miss for " << file_tag;
         }
         return std::nullopt;
     }
 
-    const auto access_counters = load_access_counters();
-    remove_old_entries(access_counters); // Only needed if the cache size got reduced
-    // Check if entry is still valid (it could have been removed if the metadata is invalid)
+    // Check if entry is still valid (it could have been removed by another instance)
+    const std::filesystem::path data(data_filename(it->second.content_hash));
     if (!std::filesystem::exists(data)) {
         if (_verbose_debugging) {
             LogDebug() << "Cache miss for " << file_tag;
         }
+        _entries.erase(it);
         return std::nullopt;
     }
 
@@ -103,142 +130,330 @@ std::optional<std::filesystem::path> FileCache::access(const std::string& file_t
         LogDebug() << "Cache hit for " << file_tag;
     }
 
-    // Mark access
-    Meta m{};
-    std::fstream meta_file(meta, std::ios::binary | std::ios::in | std::ios::out);
-    if (meta_file.good()) {
-        if (meta_file.read(reinterpret_cast<char*>(&m), sizeof(m)) &&
-            meta_file.gcount() == sizeof(m)) {
-            m.access_counter = access_counters.next_access_counter;
-            meta_file.seekg(0);
-            if (!meta_file.write(reinterpret_cast<const char*>(&m), sizeof(m))) {
-                LogErr() << "Meta write failed " << meta;
-            }
-        } else {
-            LogErr() << "Meta read failed " << meta;
-        }
-    } else {
-        LogErr() << "Failed to open " << meta;
-    }
+    // Mark access, it is written back later
+    it->second.access_counter = _next_access_counter++;
+    it->second.dirty = true;
 
     return data;
 }
 
+std::optional<FileCache::MappedFile> FileCache::read(const std::string& file_tag)
+{
+    const auto data = access(file_tag);
+    if (!data) {
+        return std::nullopt;
+    }
+    return MappedFile::open(data.value());
+}
+
 std::optional<std::filesystem::path>
 FileCache::insert(const std::string& file_tag, const std::filesystem::path& file_name)
 {
-    const DirectoryLock directory_lock(_path / _lock_file); // also serves as multi-threadding lock
+    const auto hash = content_hash(file_name);
+    if (!hash) {
+        LogWarn() << "Failed to read " << file_name;
+        return std::nullopt;
+    }
 
-    const std::filesystem::path meta(meta_filename(file_tag));
-    std::filesystem::path data(data_filename(file_tag));
-    auto access_counters = load_access_counters();
+    const std::lock_guard lock(_mutex);
+    const DirectoryLock directory_lock(_path / _lock_file); // also serves as multi-process lock
 
-    if (std::filesystem::exists(meta) && std::filesystem::exists(data)) {
-        if (_verbose_debugging) {
-            LogDebug() << "Not inserting, entry already exists: " << file_tag;
+    auto it = _entries.find(file_tag);
+    if (it == _entries.end()) {
+        auto entry = load_entry(file_tag);
+        if (entry) {
+            it = _entries.emplace(file_tag, std::move(entry.value())).first;
         }
-        std::filesystem::remove(file_name);
-        return data;
     }
 
-    // Move the file to the cache location
-    std::error_code err;
-    std::filesystem::rename(file_name, data, err);
-    if (err) {
-        if (err.value() == EXDEV) { // different file system
-            std::filesystem::copy_file(file_name, data, err);
-            if (!err) {
-                std::filesystem::remove(file_name, err);
+    if (it != _entries.end()) {
+        const std::filesystem::path existing_data(data_filename(it->second.content_hash));
+        if (std::filesystem::exists(existing_data)) {
+            if (_verbose_debugging) {
+                LogDebug() << "Not inserting, entry already exists: " << file_tag;
             }
+            std::filesystem::remove(file_name);
+            return existing_data;
+        }
+        _entries.erase(it);
+    }
+
+    const std::filesystem::path data(data_filename(hash.value()));
+    std::error_code err;
+    if (std::filesystem::exists(data)) {
+        // Same content is already cached for another tag
+        if (_verbose_debugging) {
+            LogDebug() << "Sharing cached content for " << file_tag;
         }
+        std::filesystem::remove(file_name, err);
+    } else {
+        // Move the file to the cache location
+        std::filesystem::rename(file_name, data, err);
         if (err) {
-            LogWarn() << "File rename failed from " << file_name << " to " << data << ": "
-                      << err.message();
-            return std::nullopt;
+            if (err.value() == EXDEV) { // different file system
+                std::filesystem::copy_file(file_name, data, err);
+                if (!err) {
+                    std::filesystem::remove(file_name, err);
+                }
+            }
+            if (err) {
+                LogWarn() << "File rename failed from " << file_name << " to " << data << ": "
+                          << err.message();
+                return std::nullopt;
+            }
         }
     }
 
-    // Write meta data
+    Entry entry{};
+    entry.access_counter = _next_access_counter++;
+    entry.content_hash = hash.value();
+    write_meta(file_tag, entry);
+    _entries.emplace(file_tag, std::move(entry));
+
+    flush_access_counters();
+
+    if (static_cast<int>(_entries.size()) > _max_num_files) {
+        // Other instances might have added entries, so evict based on what is on disk.
+        load_index();
+        remove_old_entries();
+    }
+    return data;
+}
+
+std::optional<std::string> FileCache::content_hash(const std::filesystem::path& file_name)
+{
+    std::ifstream file(file_name, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    std::vector<unsigned char> hash(picosha2::k_digest_size);
+    picosha2::hash256(
+        std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>(), hash);
+    if (file.bad()) {
+        return std::nullopt;
+    }
+    return picosha2::bytes_to_hex_string(hash);
+}
+
+std::optional<FileCache::Entry> FileCache::load_entry(const std::string& file_tag) const
+{
     Meta m{};
-    m.access_counter = access_counters.next_access_counter++;
+    const uint32_t expected_magic = m.magic;
+    const uint32_t expected_version = m.version;
+    std::ifstream meta_file(meta_filename(file_tag), std::ios::binary);
+    if (!meta_file.read(reinterpret_cast<char*>(&m), sizeof(m)) ||
+        meta_file.gcount() != sizeof(m) || m.magic != expected_magic ||
+        m.version != expected_version) {
+        return std::nullopt;
+    }
+
+    Entry entry{};
+    entry.access_counter = m.access_counter;
+    entry.content_hash = std::string(m.content_hash, _hash_length);
+    if (!std::filesystem::exists(data_filename(entry.content_hash))) {
+        return std::nullopt;
+    }
+    return entry;
+}
+
+void FileCache::write_meta(const std::string& file_tag, const Entry& entry) const
+{
+    const std::filesystem::path meta(meta_filename(file_tag));
+
+    Meta m{};
+    m.access_counter = entry.access_counter;
+    std::memcpy(
+        m.content_hash,
+        entry.content_hash.data(),
+        std::min(entry.content_hash.size(), sizeof(m.content_hash)));
+
     std::fstream meta_file(meta, std::ios::binary | std::ios::out | std::ios::trunc);
     if (meta_file.good()) {
         if (!meta_file.write(reinterpret_cast<const char*>(&m), sizeof(m))) {
             LogWarn() << "Meta write failed " << meta;
         }
-        access_counters.cached_files[m.access_counter] = file_tag;
     } else {
         LogWarn() << "Failed to open " << meta;
     }
+}
 
-    remove_old_entries(access_counters);
-    return data;
+void FileCache::flush_access_counters()
+{
+    for (auto& [file_tag, entry] : _entries) {
+        if (entry.dirty) {
+            write_meta(file_tag, entry);
+            entry.dirty = false;
+        }
+    }
 }
 
-FileCache::AccessCounters FileCache::load_access_counters() const
+void FileCache::load_index()
 {
-    AccessCounters access_counters;
+    // Keep the accesses of this instance which have not been written yet.
+    flush_access_counters();
+    _entries.clear();
 
     for (const auto& path : std::filesystem::directory_iterator(_path)) {
         if (path.path().extension() != _meta_extension) {
             continue;
         }
 
-        bool validation_failed = false;
-        std::filesystem::path data(path);
-        data.replace_extension(_cache_extension);
-        if (!std::filesystem::exists(data)) {
-            validation_failed = true;
-        }
-
-        // Read meta + validate
-        Meta m{};
-        const uint32_t expected_magic = m.magic;
-        const uint32_t expected_version = m.version;
-        std::ifstream meta_file(path.path(), std::ios::binary);
-        if (meta_file.read(reinterpret_cast<char*>(&m), sizeof(m)) &&
-            meta_file.gcount() == sizeof(m)) {
-            if (m.magic != expected_magic || m.version != expected_version) {
-                validation_failed = true;
-            }
-        } else {
-            validation_failed = true;
-        }
+        // Extract the tag
+        const std::string tag = path.path().stem().string();
+        auto entry = load_entry(tag);
 
-        if (validation_failed) {
+        if (!entry) {
             LogWarn() << "Validation failed, removing cache files " << path.path();
             std::filesystem::remove(path.path());
-            std::filesystem::remove(data);
-        } else {
-            // Extract the tag
-            const std::string tag = path.path().stem().string();
-            access_counters.cached_files[m.access_counter] = tag;
+            continue;
+        }
 
-            // LogDebug() << "Found cached file: " << path.path() << " counter: " <<
-            // m.access_counter;
+        // LogDebug() << "Found cached file: " << path.path() << " counter: " <<
+        // entry->access_counter;
 
-            if (m.access_counter >= access_counters.next_access_counter) {
-                access_counters.next_access_counter = m.access_counter + 1;
-            }
+        if (entry->access_counter >= _next_access_counter) {
+            _next_access_counter = entry->access_counter + 1;
         }
+        _entries.emplace(tag, std::move(entry.value()));
     }
-    return access_counters;
+
+    // Data of removed entries, and of entries of the previous format
+    remove_unused_data_files();
 }
 
-void FileCache::remove_old_entries(const AccessCounters& access_counters) const
+void FileCache::remove_old_entries()
 {
-    int num_delete = static_cast<int>(access_counters.cached_files.size()) - _max_num_files;
-    auto iter = access_counters.cached_files.begin();
+    const int num_entries = static_cast<int>(_entries.size());
+    if (num_entries <= _max_num_files) {
+        return;
+    }
+
+    // Make some room, so not every following insert has to evict again.
+    const int num_keep = _max_num_files - _max_num_files / 10;
+    int num_delete = num_entries - num_keep;
+
+    std::vector<std::pair<AccessCounterType, std::string>> by_access;
+    by_access.reserve(_entries.size());
+    for (const auto& [file_tag, entry] : _entries) {
+        by_access.emplace_back(entry.access_counter, file_tag);
+    }
+    std::sort(by_access.begin(), by_access.end());
+
+    auto iter = by_access.begin();
     while (num_delete > 0) {
         if (_verbose_debugging) {
             LogDebug() << "Removing cache entry num:counter:file" << num_delete << iter->first
                        << iter->second;
         }
         std::filesystem::remove(meta_filename(iter->second));
-        std::filesystem::remove(data_filename(iter->second));
+        _entries.erase(iter->second);
         --num_delete;
         ++iter;
     }
+
+    remove_unused_data_files();
+}
+
+void FileCache::remove_unused_data_files() const
+{
+    std::set<std::string> used;
+    for (const auto& [file_tag, entry] : _entries) {
+        used.insert(entry.content_hash);
+    }
+
+    std::vector<std::filesystem::path> unused;
+    for (const auto& path : std::filesystem::directory_iterator(_path)) {
+        if (path.path().extension() == _cache_extension &&
+            used.find(path.path().stem().string()) == used.end()) {
+            unused.push_back(path.path());
+        }
+    }
+
+    for (const auto& path : unused) {
+        std::error_code err;
+        std::filesystem::remove(path, err);
+    }
+}
+
+std::optional<FileCache::MappedFile> FileCache::MappedFile::open(const std::filesystem::path& path)
+{
+    MappedFile mapped_file;
+
+    std::error_code err;
+    const auto size = std::filesystem::file_size(path, err);
+    if (err) {
+        LogErr() << "Failed to get size of " << path << ": " << err.message();
+        return std::nullopt;
+    }
+    if (size == 0) {
+        // Nothing to map
+        return mapped_file;
+    }
+
+#ifdef WINDOWS
+    HANDLE file = CreateFileA(
+        path.string().c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        0,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        0);
+    if (file == INVALID_HANDLE_VALUE) {
+        LogErr() << "Cannot open file " << path << ": " << GetLastError();
+        return std::nullopt;
+    }
+    HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        LogErr() << "Cannot map file " << path << ": " << GetLastError();
+        return std::nullopt;
+    }
+    // The view keeps the mapping alive.
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (data == NULL) {
+        LogErr() << "Cannot map file " << path << ": " << GetLastError();
+        return std::nullopt;
+    }
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LogErr() << "Cannot open file " << path << ": " << strerror(errno);
+        return std::nullopt;
+    }
+    // The mapping stays valid after closing the file.
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        LogErr() << "Cannot map file " << path << ": " << strerror(errno);
+        return std::nullopt;
+    }
+#endif
+
+    mapped_file._data = static_cast<const char*>(data);
+    mapped_file._size = static_cast<size_t>(size);
+    return mapped_file;
+}
+
+FileCache::MappedFile::MappedFile(MappedFile&& other) noexcept :
+    _data(other._data),
+    _size(other._size)
+{
+    other._data = nullptr;
+    other._size = 0;
+}
+
+FileCache::MappedFile::~MappedFile()
+{
+    if (_data == nullptr) {
+        return;
+    }
+#ifdef WINDOWS
+    UnmapViewOfFile(_data);
+#else
+    munmap(const_cast<char*>(_data), _size);
+#endif
 }
 
 } // namespace mavsdk
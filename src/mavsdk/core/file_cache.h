@@ -6,8 +6,10 @@
 
 #include <filesystem>
 #include <cstdint>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <map>
 
 namespace mavsdk {
@@ -20,10 +22,45 @@ namespace mavsdk {
  * - multiple instances (or processes) can work on the same directory.
  *   (however there is no lock held when returning a file from a cache, so the assumption is that
  *   the cache is large enough so no other process evicts the file until it is used).
+ * - the index of the cached files is loaded once and then kept in memory, accesses are written
+ *   back together on the next insert, or on destruction.
+ * - files are stored by the SHA-256 of their content, so tags with identical content, e.g. the
+ *   same definitions from several vehicles, share one file.
+ * - when there are too many files, the least recently used ones are removed in one go, down to
+ *   90% of the maximum.
  */
 class FileCache {
 public:
     FileCache(std::filesystem::path path, int max_num_files, bool verbose_debugging = false);
+    ~FileCache();
+
+    FileCache(const FileCache&) = delete;
+    FileCache& operator=(const FileCache&) = delete;
+
+    /**
+     * Read-only memory mapping of a cached file.
+     */
+    class MappedFile {
+    public:
+        static std::optional<MappedFile> open(const std::filesystem::path& path);
+
+        ~MappedFile();
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile& operator=(MappedFile&&) = delete;
+
+        /**
+         * @return the file content, valid as long as the MappedFile exists
+         */
+        std::string_view data() const { return {_data, _size}; }
+
+    private:
+        MappedFile() = default;
+
+        const char* _data{nullptr};
+        size_t _size{0};
+    };
 
     /**
      * Try to access a file and set the access counter
@@ -32,6 +69,13 @@ public:
      */
     std::optional<std::filesystem::path> access(const std::string& file_tag);
 
+    /**
+     * Try to access a file, set the access counter and map its content into memory
+     * @param fileTag
+     * @return mapped file or nullopt if not found
+     */
+    std::optional<MappedFile> read(const std::string& file_tag);
+
     /**
      * Insert a file into the cache & remove old files if there's too many.
      * @param fileTag
@@ -61,29 +105,43 @@ private:
     static constexpr const char* _meta_extension = ".meta";
     static constexpr const char* _cache_extension = ".cache";
     static constexpr const char* _lock_file = "lock";
+    static constexpr size_t _hash_length = 64; ///< SHA-256 as hex string
 
     using AccessCounterType = uint64_t;
 
     struct Meta {
         uint32_t magic{0x9a9cad0e};
-        uint32_t version{0};
+        uint32_t version{1};
         AccessCounterType access_counter{0};
+        char content_hash[_hash_length]{};
     };
 
-    struct AccessCounters {
-        AccessCounterType next_access_counter{0};
-        std::map<AccessCounterType, std::string> cached_files;
+    struct Entry {
+        AccessCounterType access_counter{0};
+        std::string content_hash;
+        bool dirty{false}; ///< accessed since the meta file was written
     };
 
-    AccessCounters load_access_counters() const;
-    void remove_old_entries(const AccessCounters& access_counters) const;
+    // All of these need _mutex and the directory lock to be held.
+    void load_index();
+    std::optional<Entry> load_entry(const std::string& file_tag) const;
+    void write_meta(const std::string& file_tag, const Entry& entry) const;
+    void flush_access_counters();
+    void remove_old_entries();
+    void remove_unused_data_files() const;
+
+    static std::optional<std::string> content_hash(const std::filesystem::path& file_name);
 
     std::filesystem::path meta_filename(const std::string& file_tag) const;
-    std::filesystem::path data_filename(const std::string& file_tag) const;
+    std::filesystem::path data_filename(const std::string& content_hash) const;
 
     const std::filesystem::path _path;
     const int _max_num_files;
     const bool _verbose_debugging;
+
+    std::mutex _mutex{}; ///< Protects access to _entries and _next_access_counter
+    std::map<std::string, Entry> _entries{};
+    AccessCounterType _next_access_counter{0};
 };
 
 } // namespace mavsdk
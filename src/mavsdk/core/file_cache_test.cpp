@@ -1,8 +1,10 @@
 
 #include <gtest/gtest.h>
+#include <chrono>
 #include <fstream>
 #include "file_cache.h"
 #include "fs_utils.h"
+#include "log.h"
 
 using namespace mavsdk;
 
@@ -149,3 +151,119 @@ TEST_F(FileCacheTest, multi_test)
         EXPECT_EQ(cache.access(_tmp_files[10].cache_tag).value(), _tmp_files[10].cached_path);
     }
 }
+
+TEST_F(FileCacheTest, same_content_test)
+{
+    FileCache cache(_cache_dir, 10, true);
+
+    // Same content as _tmp_files[0], with a different tag
+    const auto same_path = _tmp_files_dir / "same.txt";
+    {
+        std::ofstream f(same_path, std::ios::out | std::ios::binary);
+        f << _tmp_files[0].content;
+    }
+
+    const auto cached_path = cache.insert(_tmp_files[0].cache_tag, _tmp_files[0].path).value();
+    EXPECT_EQ(cache.insert("_tag_same_xy", same_path).value(), cached_path);
+    EXPECT_FALSE(std::filesystem::exists(same_path));
+
+    EXPECT_EQ(cache.access(_tmp_files[0].cache_tag).value(), cached_path);
+    EXPECT_EQ(cache.access("_tag_same_xy").value(), cached_path);
+}
+
+TEST_F(FileCacheTest, same_content_eviction_test)
+{
+    FileCache cache(_cache_dir, 2, true);
+
+    const auto same_path = _tmp_files_dir / "same.txt";
+    {
+        std::ofstream f(same_path, std::ios::out | std::ios::binary);
+        f << _tmp_files[0].content;
+    }
+
+    const auto cached_path = cache.insert(_tmp_files[0].cache_tag, _tmp_files[0].path).value();
+    cache.insert("_tag_same_xy", same_path);
+    cache.insert(_tmp_files[1].cache_tag, _tmp_files[1].path);
+
+    // The content is still used by the second tag.
+    EXPECT_FALSE(cache.access(_tmp_files[0].cache_tag));
+    EXPECT_EQ(cache.access("_tag_same_xy").value(), cached_path);
+    EXPECT_TRUE(std::filesystem::exists(cached_path));
+
+    cache.insert(_tmp_files[2].cache_tag, _tmp_files[2].path);
+
+    EXPECT_FALSE(cache.access(_tmp_files[1].cache_tag));
+    EXPECT_TRUE(cache.access("_tag_same_xy"));
+    cache.insert(_tmp_files[3].cache_tag, _tmp_files[3].path);
+    cache.insert(_tmp_files[4].cache_tag, _tmp_files[4].path);
+
+    EXPECT_FALSE(cache.access("_tag_same_xy"));
+    EXPECT_FALSE(std::filesystem::exists(cached_path));
+}
+
+TEST_F(FileCacheTest, read_test)
+{
+    FileCache cache(_cache_dir, 10, true);
+
+    EXPECT_FALSE(cache.read(_tmp_files[12].cache_tag));
+
+    cache.insert(_tmp_files[12].cache_tag, _tmp_files[12].path);
+
+    auto mapped_file = cache.read(_tmp_files[12].cache_tag);
+    ASSERT_TRUE(mapped_file);
+    EXPECT_EQ(mapped_file->data(), _tmp_files[12].content);
+}
+
+TEST_F(FileCacheTest, batch_eviction_test)
+{
+    FileCache cache(_cache_dir, 20, true);
+
+    for (int i = 0; i < 20; ++i) {
+        cache.insert(_tmp_files[i].cache_tag, _tmp_files[i].path);
+    }
+    EXPECT_TRUE(cache.access(_tmp_files[0].cache_tag));
+
+    // Going over the limit makes room for a few more at once.
+    cache.insert(_tmp_files[20].cache_tag, _tmp_files[20].path);
+
+    EXPECT_TRUE(cache.access(_tmp_files[0].cache_tag));
+    EXPECT_FALSE(cache.access(_tmp_files[1].cache_tag));
+    EXPECT_FALSE(cache.access(_tmp_files[2].cache_tag));
+    EXPECT_FALSE(cache.access(_tmp_files[3].cache_tag));
+    EXPECT_TRUE(cache.access(_tmp_files[4].cache_tag));
+    EXPECT_TRUE(cache.access(_tmp_files[20].cache_tag));
+}
+
+TEST_F(FileCacheTest, cold_start_test)
+{
+    constexpr int num_files = 1000;
+
+    {
+        FileCache cache(_cache_dir, num_files, false);
+        for (int i = 0; i < num_files; ++i) {
+            const auto path = _tmp_files_dir / "file.txt";
+            {
+                std::ofstream f(path, std::ios::out | std::ios::binary);
+                f << "content " << i;
+            }
+            ASSERT_TRUE(cache.insert("_tag_" + std::to_string(i), path));
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    FileCache cache(_cache_dir, num_files, false);
+    const auto loaded = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < num_files; ++i) {
+        auto mapped_file = cache.read("_tag_" + std::to_string(i));
+        ASSERT_TRUE(mapped_file);
+        EXPECT_EQ(mapped_file->data(), "content " + std::to_string(i));
+    }
+    const auto read = std::chrono::steady_clock::now();
+
+    LogInfo() << "Loading index of " << num_files << " files took "
+              << std::chrono::duration_cast<std::chrono::microseconds>(loaded - start).count()
+              << " us, reading all of them "
+              << std::chrono::duration_cast<std::chrono::microseconds>(read - loaded).count()
+              << " us";
+}
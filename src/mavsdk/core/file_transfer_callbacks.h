@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+// Downloads a file from the target component, e.g. using MAVLink FTP. Returns false if
+// that's not possible, otherwise the callback is called once the download is done.
+using FileDownloader = std::function<bool(
+    const std::string& remote_path,
+    std::function<void(bool success, std::vector<uint8_t> data)> callback)>;
+
+// Cancels a file transfer, the callback is not called anymore afterwards.
+using FileTransferCancel = std::function<void()>;
+
+// Uploads data as a file to the target component, e.g. using MAVLink FTP. Returns nothing if
+// that's not possible, otherwise the callback is called once the upload is done, unless it is
+// cancelled with the returned function.
+using FileUploader = std::function<FileTransferCancel(
+    const std::string& remote_path,
+    std::vector<uint8_t> data,
+    std::function<void(bool success)> callback)>;
+
+} // namespace mavsdk
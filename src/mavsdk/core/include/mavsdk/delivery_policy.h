@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace mavsdk {
+
+/**
+ * @brief Policy how updates of a subscription are delivered to its callback.
+ *
+ * Callbacks are called from one thread for all subscriptions. If a callback is
+ * slower than the rate of its updates, updates pile up and can eventually be
+ * dropped for any subscription. For state-like data (e.g. attitude, position,
+ * battery) where only the newest value matters, the updates can be conflated
+ * or rate-limited instead.
+ *
+ * The policy is set by wrapping the callback passed to subscribe using
+ * with_delivery_policy().
+ *
+ * The callback is called on the same thread as without a policy. For the few
+ * subscriptions which are called directly from the thread producing the updates
+ * rather than from the callback thread, a held back update can't be delivered
+ * on its own, so with RateLimited it is replaced by the next update instead.
+ */
+struct DeliveryPolicy {
+    /**
+     * @brief Delivery mode.
+     */
+    enum class Mode {
+        All, /**< @brief Every update is delivered (default). */
+        Latest, /**< @brief Only the newest update is delivered, updates arriving while
+                   the callback is still pending replace the pending one. */
+        RateLimited, /**< @brief Like Latest, but at most rate_hz updates per second. The
+                        newest update is delivered once the interval has passed. */
+    };
+
+    Mode mode{Mode::All}; /**< @brief Delivery mode */
+    double rate_hz{0.0}; /**< @brief Maximum rate for Mode::RateLimited */
+
+    /**
+     * @brief Deliver every update.
+     */
+    static DeliveryPolicy all() { return DeliveryPolicy{Mode::All, 0.0}; }
+
+    /**
+     * @brief Deliver only the newest update.
+     */
+    static DeliveryPolicy latest() { return DeliveryPolicy{Mode::Latest, 0.0}; }
+
+    /**
+     * @brief Deliver the newest update, at most rate_hz times per second.
+     */
+    static DeliveryPolicy rate_limited(double rate_hz)
+    {
+        return DeliveryPolicy{Mode::RateLimited, rate_hz};
+    }
+};
+
+namespace detail {
+/**
+ * @brief Logs that a delivery policy is ignored (internal use only).
+ */
+void warn_delivery_policy_ignored();
+} // namespace detail
+
+/**
+ * @brief A callback together with its delivery policy (internal use only).
+ *
+ * Use with_delivery_policy() to create it.
+ */
+template<typename... Args> class DeliveryPolicyCallback {
+public:
+    /**
+     * @brief Constructor (internal use only).
+     */
+    DeliveryPolicyCallback(DeliveryPolicy policy, std::function<void(Args...)> callback) :
+        _policy(policy),
+        _callback(std::move(callback))
+    {}
+
+    /**
+     * @brief Call the callback.
+     *
+     * Subscriptions call the wrapped callback directly, so this is only called if the
+     * subscription didn't recognize the policy, e.g. because the callback type given to
+     * with_delivery_policy() doesn't match. Every update is delivered then.
+     */
+    void operator()(Args... args) const
+    {
+        if (_policy.mode != DeliveryPolicy::Mode::All && !_warned->exchange(true)) {
+            detail::warn_delivery_policy_ignored();
+        }
+        _callback(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief The delivery policy.
+     */
+    const DeliveryPolicy& policy() const { return _policy; }
+
+    /**
+     * @brief The wrapped callback.
+     */
+    const std::function<void(Args...)>& callback() const { return _callback; }
+
+private:
+    DeliveryPolicy _policy;
+    std::function<void(Args...)> _callback;
+    // Shared by copies, so that we only warn once per subscription.
+    std::shared_ptr<std::atomic<bool>> _warned{std::make_shared<std::atomic<bool>>(false)};
+};
+
+namespace detail {
+template<typename Callback> struct DeliveryPolicyCallbackFor;
+
+template<typename... Args> struct DeliveryPolicyCallbackFor<std::function<void(Args...)>> {
+    using Type = DeliveryPolicyCallback<Args...>;
+};
+} // namespace detail
+
+/**
+ * @brief Set the delivery policy of a subscription.
+ *
+ * The callback type of the subscription has to be given, e.g.:
+ *
+ *     ```cpp
+ *     telemetry.subscribe_attitude_euler(
+ *         with_delivery_policy<Telemetry::AttitudeEulerCallback>(
+ *             DeliveryPolicy::latest(),
+ *             [](Telemetry::EulerAngle euler_angle) { ... }));
+ *     ```
+ *
+ * @param policy The delivery policy.
+ * @param callback The callback to call.
+ *
+ * @return The callback to pass to subscribe.
+ */
+template<typename Callback>
+Callback with_delivery_policy(const DeliveryPolicy& policy, Callback callback)
+{
+    return typename detail::DeliveryPolicyCallbackFor<Callback>::Type{policy, std::move(callback)};
+}
+
+} // namespace mavsdk
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "handle.h"
+
+namespace mavsdk {
+
+/**
+ * @brief Policy how outgoing messages to a system are spread over connections.
+ *
+ * This only matters if a system is reachable over more than one connection.
+ * Messages which are not targeted at a specific system as well as heartbeats
+ * and commands are always sent on all connections.
+ */
+struct LinkPolicy {
+    /**
+     * @brief Link selection mode.
+     */
+    enum class Mode {
+        BroadcastAll, /**< @brief Send on all connections (default). */
+        PrimaryWithFailover, /**< @brief Send on the primary connection while it is
+                                healthy, otherwise on the best other one. */
+        LowestLatency, /**< @brief Send on the healthy connection with the lowest round
+                          trip time. */
+    };
+
+    Mode mode{Mode::BroadcastAll}; /**< @brief Link selection mode */
+    Handle<> primary_connection{}; /**< @brief Primary connection, first connection if not
+                                      set */
+    double failover_timeout_s{2.0}; /**< @brief A connection is considered unhealthy if
+                                       nothing was received from the system for this long */
+};
+
+} // namespace mavsdk
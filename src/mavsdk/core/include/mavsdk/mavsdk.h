@@ -12,6 +12,8 @@
 #include "component_type.h"
 #include "server_component.h"
 #include "connection_result.h"
+#include "delivery_policy.h"
+#include "statistics.h"
 #include "mavlink_include.h"
 
 namespace mavsdk {
@@ -163,6 +165,22 @@ public:
      */
     void unsubscribe_connection_errors(ConnectionErrorHandle handle);
 
+    /**
+     * @brief Get message and link statistics.
+     *
+     * This includes per connection message and byte counters (in total and per
+     * message ID), lost messages based on sequence numbers, checksum errors,
+     * the fill level of the internal queues, as well as histograms of the time
+     * spent in internal message handlers and user callbacks.
+     *
+     * Rates are updated once per second.
+     *
+     * @note This is part of the C++ API only and not available through mavsdk_server.
+     *
+     * @return Statistics snapshot.
+     */
+    MavsdkStatistics statistics() const;
+
     /**
      * @brief Get a vector of systems which have been discovered or set-up.
      *
@@ -260,12 +278,119 @@ public:
          */
         void set_mav_type(uint8_t mav_type);
 
+        /**
+         * @brief Get the outbound bandwidth limit per connection.
+         * @return limit in bytes per second, 0 means unlimited.
+         */
+        double get_outbound_bandwidth_limit() const;
+
+        /**
+         * @brief Set the outbound bandwidth limit per connection.
+         *
+         * When set, outgoing messages are queued per connection and sent in
+         * order of their traffic class (control, command, telemetry, bulk
+         * transfer) without exceeding the limit. This keeps e.g. setpoints
+         * flowing on a slow telemetry radio while a mission or file is
+         * transferred.
+         *
+         * @param bytes_per_second limit in bytes per second, 0 means unlimited (default).
+         */
+        void set_outbound_bandwidth_limit(double bytes_per_second);
+
+        /**
+         * @brief Get whether serial ports are set to low latency mode.
+         * @return true if low latency mode is requested.
+         */
+        bool get_serial_low_latency() const;
+
+        /**
+         * @brief Set whether serial ports are set to low latency mode.
+         *
+         * On Linux, this sets ASYNC_LOW_LATENCY for serial connections added
+         * afterwards, so that USB serial adapters (e.g. FTDI) pass on received
+         * data right away instead of after their latency timer of up to 16 ms.
+         * This is ignored by drivers and platforms not supporting it.
+         *
+         * @param low_latency true to request low latency mode (default false).
+         */
+        void set_serial_low_latency(bool low_latency);
+
+        /**
+         * @brief Get whether missions are transferred as files using MAVLink FTP.
+         * @return true if missions are transferred as files, where supported.
+         */
+        bool get_mission_transfer_over_ftp() const;
+
+        /**
+         * @brief Set whether missions are transferred as files using MAVLink FTP.
+         *
+         * ArduPilot provides the mission, fence and rally points as files,
+         * which are transferred several times faster than item by item,
+         * especially on slow or lossy links. They are used if the autopilot
+         * advertises MAVLink FTP support, otherwise, or if the file transfer
+         * fails, the items are transferred one by one.
+         *
+         * @param over_ftp true to use file transfers where supported (default false).
+         */
+        void set_mission_transfer_over_ftp(bool over_ftp);
+
+        /**
+         * @brief Get whether only changed mission items are uploaded.
+         * @return true if only changed items are uploaded, where supported.
+         */
+        bool get_mission_partial_upload() const;
+
+        /**
+         * @brief Set whether only changed mission items are uploaded.
+         *
+         * The items of the last mission, fence or rally point transfer are
+         * kept. If a new upload has the same number of items, only the range
+         * from the first to the last changed item is written using
+         * MISSION_WRITE_PARTIAL_LIST, which is much faster for small edits
+         * of large missions. If the autopilot doesn't support this, all
+         * items are uploaded instead.
+         *
+         * This is only done once the autopilot has reported the id of the
+         * items in MISSION_CURRENT after our transfer, so that changes made
+         * by other ground stations are detected. Without an id, all items are
+         * uploaded.
+         *
+         * @param partial_upload true to upload only changed items (default false).
+         */
+        void set_mission_partial_upload(bool partial_upload);
+
+        /**
+         * @brief Get the number of mission items requested at the same time when receiving.
+         * @return number of outstanding mission item requests.
+         */
+        unsigned get_mission_server_request_window() const;
+
+        /**
+         * @brief Set the number of mission items requested at the same time when receiving.
+         *
+         * When a mission is uploaded to a server component, e.g. by a ground
+         * station, the items are by default requested one by one, each after
+         * the previous one has arrived. With a larger window, several items
+         * are requested ahead, so large missions are not limited by the round
+         * trip time of the link. Items are accepted in any order, and missing
+         * ones are requested again, in order. The uploading side needs to
+         * answer each request as it arrives.
+         *
+         * @param window number of outstanding requests, 1 to request one by one (default 1).
+         */
+        void set_mission_server_request_window(unsigned window);
+
     private:
         uint8_t _system_id;
         uint8_t _component_id;
         bool _always_send_heartbeats;
         ComponentType _component_type;
         MAV_TYPE _mav_type;
+        double _outbound_bandwidth_limit{0.0};
+        bool _serial_low_latency{false};
+        bool _mission_transfer_over_ftp{false};
+        bool _mission_partial_upload{false};
+        unsigned _mission_server_request_window{1};
 
         static ComponentType component_type_for_component_id(uint8_t component_id);
         static MAV_TYPE mav_type_for_component_type(ComponentType component_type);
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "handle.h"
+
+namespace mavsdk {
+
+/**
+ * @brief Histogram of durations with power-of-two buckets in microseconds.
+ */
+struct DurationHistogram {
+    /**
+     * @brief Number of buckets.
+     */
+    static constexpr size_t NUM_BUCKETS = 21;
+
+    /**
+     * @brief Counts per bucket.
+     *
+     * Bucket 0 counts durations below 1 us, bucket i durations below 2^i us,
+     * and the last bucket everything else (more than ~0.5 s).
+     */
+    std::array<uint64_t, NUM_BUCKETS> buckets{};
+    uint64_t count{}; /**< @brief Number of durations recorded */
+    uint64_t total_us{}; /**< @brief Sum of all durations recorded */
+    uint64_t max_us{}; /**< @brief Longest duration recorded */
+};
+
+/**
+ * @brief Statistics for one MAVLink message ID.
+ */
+struct MessageIdStatistics {
+    uint32_t message_id{}; /**< @brief MAVLink message ID */
+    uint64_t messages{}; /**< @brief Number of messages */
+    uint64_t bytes{}; /**< @brief Number of bytes including header and checksum */
+    double rate_hz{}; /**< @brief Message rate during the last second */
+};
+
+/**
+ * @brief Statistics for one connection.
+ */
+struct ConnectionStatistics {
+    Handle<> connection_handle{}; /**< @brief Handle of the connection */
+    uint64_t messages_received{}; /**< @brief Messages received */
+    uint64_t bytes_received{}; /**< @brief Bytes of messages received */
+    double messages_received_rate_hz{}; /**< @brief Receive rate during the last second */
+    double bytes_received_rate{}; /**< @brief Bytes/s received during the last second */
+    uint64_t messages_lost{}; /**< @brief Messages lost based on sequence number gaps */
+    uint64_t crc_errors{}; /**< @brief Messages with bad checksum */
+    uint64_t unknown_message_ids{}; /**< @brief Messages with unknown message ID */
+    uint64_t messages_sent{}; /**< @brief Messages sent */
+    uint64_t bytes_sent{}; /**< @brief Bytes of messages sent */
+    double messages_sent_rate_hz{}; /**< @brief Send rate during the last second */
+    std::vector<MessageIdStatistics> received{}; /**< @brief Received messages by ID */
+    std::vector<MessageIdStatistics> sent{}; /**< @brief Sent messages by ID */
+};
+
+/**
+ * @brief Quality of the link to one component over one connection.
+ */
+struct LinkQuality {
+    Handle<> connection_handle{}; /**< @brief Handle of the connection */
+    uint8_t component_id{}; /**< @brief MAVLink component ID */
+    uint64_t messages_received{}; /**< @brief Messages received */
+    uint64_t messages_lost{}; /**< @brief Messages lost based on sequence number gaps */
+    double loss_ratio{}; /**< @brief Ratio of messages lost during the last second (0..1) */
+    double rtt_s{}; /**< @brief Last round trip time measured, NaN if unknown */
+    double rtt_jitter_s{}; /**< @brief Smoothed variation of the round trip time */
+    double idle_s{}; /**< @brief Time since messages were last received (1 s resolution) */
+};
+
+/**
+ * @brief Fill level of an internal queue.
+ */
+struct QueueStatistics {
+    size_t depth{}; /**< @brief Current number of entries */
+    size_t peak_depth{}; /**< @brief Highest number of entries seen */
+};
+
+/**
+ * @brief Execution time of the internal handlers of one MAVLink message ID.
+ */
+struct HandlerStatistics {
+    uint32_t message_id{}; /**< @brief MAVLink message ID */
+    DurationHistogram duration{}; /**< @brief Time spent in handlers for this message */
+};
+
+/**
+ * @brief Statistics of a Mavsdk instance.
+ */
+struct MavsdkStatistics {
+    std::vector<ConnectionStatistics> connections{}; /**< @brief Per connection */
+    QueueStatistics received_queue{}; /**< @brief Messages received, not processed yet */
+    QueueStatistics send_queue{}; /**< @brief Messages queued, not sent yet */
+    QueueStatistics user_callback_queue{}; /**< @brief User callbacks queued, not called yet */
+    std::vector<HandlerStatistics> handlers{}; /**< @brief Message handler execution times */
+    DurationHistogram user_callbacks{}; /**< @brief User callback execution times */
+};
+
+} // namespace mavsdk
@@ -9,6 +9,8 @@
 #include "component_type.h"
 #include "deprecated.h"
 #include "handle.h"
+#include "link_policy.h"
+#include "statistics.h"
 #include "vehicle.h"
 
 namespace mavsdk {
@@ -193,6 +195,68 @@ public:
      */
     Vehicle vehicle_type() const;
 
+    /**
+     * @brief Get statistics of the messages received from this system.
+     *
+     * The counters are kept per MAVLink message ID and include all components
+     * of the system.
+     *
+     * @return statistics per message ID, for each ID received at least once.
+     */
+    std::vector<MessageIdStatistics> message_statistics() const;
+
+    /**
+     * @brief Get the quality of the links to this system.
+     *
+     * There is one entry per connection and component. Lost messages are detected
+     * using gaps in the MAVLink sequence numbers, the round trip time is measured
+     * using PING and TIMESYNC replies.
+     *
+     * @return link quality per connection and component.
+     */
+    std::vector<LinkQuality> link_quality() const;
+
+    /**
+     * @brief Type for link quality callback.
+     */
+    using LinkQualityCallback = std::function<void(std::vector<LinkQuality>)>;
+
+    /**
+     * @brief Handle type to unsubscribe from subscribe_link_quality.
+     */
+    using LinkQualityHandle = Handle<std::vector<LinkQuality>>;
+
+    /**
+     * @brief Subscribe to link quality updates, called once per second.
+     *
+     * @param callback Callback which will be called.
+     * @return Handle to unsubscribe again.
+     */
+    LinkQualityHandle subscribe_link_quality(const LinkQualityCallback& callback);
+
+    /**
+     * @brief Unsubscribe from subscribe_link_quality.
+     *
+     * @param handle Handle from subscribe_link_quality.
+     */
+    void unsubscribe_link_quality(LinkQualityHandle handle);
+
+    /**
+     * @brief Set how outgoing messages to this system are spread over connections.
+     *
+     * The link used is re-evaluated once per second based on link_quality().
+     *
+     * @param link_policy Policy to use.
+     */
+    void set_link_policy(const LinkPolicy& link_policy);
+
+    /**
+     * @brief Get the link policy currently used for this system.
+     *
+     * @return current link policy.
+     */
+    LinkPolicy link_policy() const;
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
@@ -1,9 +1,11 @@
 
 #include "inflate_lzma.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <cerrno>
+#include <functional>
 #ifndef LZMA_API_STATIC
 #define LZMA_API_STATIC
 #endif
@@ -85,7 +87,13 @@ static bool init_decoder(lzma_stream* strm)
     return false;
 }
 
-static bool decompress(lzma_stream* strm, const char* inname, FILE* infile, FILE* outfile)
+// Reads the next input into the buffer and returns the size, or sets the error flag.
+using ReadFunction = std::function<size_t(uint8_t* buf, size_t size, bool& error)>;
+// Writes the output and returns false on error.
+using WriteFunction = std::function<bool(const uint8_t* buf, size_t size)>;
+
+static bool decompress(
+    lzma_stream* strm, const char* inname, const ReadFunction& read, const WriteFunction& write)
 {
     // When LZMA_CONCATENATED flag was used when initializing the decoder,
     // we need to tell lzma_code() when there will be no more input.
@@ -107,12 +115,15 @@ static bool decompress(lzma_stream* strm, const char* inname, FILE* infile, FILE
     strm->next_out = outbuf;
     strm->avail_out = sizeof(outbuf);
 
+    bool end_of_input = false;
+
     while (true) {
-        if (strm->avail_in == 0 && !feof(infile)) {
+        if (strm->avail_in == 0 && !end_of_input) {
+            bool read_error = false;
             strm->next_in = inbuf;
-            strm->avail_in = fread(inbuf, 1, sizeof(inbuf), infile);
+            strm->avail_in = read(inbuf, sizeof(inbuf), read_error);
 
-            if (ferror(infile)) {
+            if (read_error) {
                 fprintf(stderr, "%s: Read error: %s\n", inname, strerror(errno));
                 // SonarCloud: Address of stack memory associated with local
                 // variable 'inbuf' is still referred to by the stack variable
@@ -131,8 +142,10 @@ static bool decompress(lzma_stream* strm, const char* inname, FILE* infile, FILE
             // will be coming. As said before, this isn't required
             // if the LZMA_CONCATENATED flag isn't used when
             // initializing the decoder.
-            if (feof(infile))
+            if (strm->avail_in == 0) {
+                end_of_input = true;
                 action = LZMA_FINISH;
+            }
         }
 
         lzma_ret ret = lzma_code(strm, action);
@@ -140,7 +153,7 @@ static bool decompress(lzma_stream* strm, const char* inname, FILE* infile, FILE
         if (strm->avail_out == 0 || ret == LZMA_STREAM_END) {
             size_t write_size = sizeof(outbuf) - strm->avail_out;
 
-            if (fwrite(outbuf, 1, write_size, outfile) != write_size) {
+            if (!write(outbuf, write_size)) {
                 fprintf(stderr, "Write error: %s\n", strerror(errno));
                 strm->next_in = nullptr;
                 strm->avail_in = 0;
@@ -282,7 +295,17 @@ bool InflateLZMA::inflateLZMAFile(
         return false;
     }
 
-    const bool success = decompress(&strm, lzma_filename.string().c_str(), infile, outfile);
+    const bool success = decompress(
+        &strm,
+        lzma_filename.string().c_str(),
+        [infile](uint8_t* buf, size_t size, bool& error) {
+            const size_t read_size = fread(buf, 1, size, infile);
+            error = ferror(infile) != 0;
+            return read_size;
+        },
+        [outfile](const uint8_t* buf, size_t size) {
+            return fwrite(buf, 1, size, outfile) == size;
+        });
     fclose(infile);
     fclose(outfile);
 
@@ -290,3 +313,37 @@ bool InflateLZMA::inflateLZMAFile(
 
     return success;
 }
+
+bool InflateLZMA::inflateLZMA(const std::string& lzma_data, std::string& decompressed_data)
+{
+    decompressed_data.clear();
+
+    lzma_stream strm = LZMA_STREAM_INIT;
+
+    if (!init_decoder(&strm)) {
+        return false;
+    }
+
+    size_t offset = 0;
+    const bool success = decompress(
+        &strm,
+        "data",
+        [&](uint8_t* buf, size_t size, bool& error) {
+            error = false;
+            const size_t read_size = std::min(size, lzma_data.size() - offset);
+            std::memcpy(buf, lzma_data.data() + offset, read_size);
+            offset += read_size;
+            return read_size;
+        },
+        [&](const uint8_t* buf, size_t size) {
+            decompressed_data.append(reinterpret_cast<const char*>(buf), size);
+            return true;
+        });
+
+    lzma_end(&strm);
+
+    if (!success) {
+        decompressed_data.clear();
+    }
+    return success;
+}
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <filesystem>
+#include <string>
 
 class InflateLZMA {
 public:
@@ -11,4 +12,9 @@ public:
     static bool inflateLZMAFile(
         const std::filesystem::path& lzma_filename,
         const std::filesystem::path& decompressed_filename);
+
+    /// Decompresses the specified data in memory
+    ///     @param lzma_data         The compressed data
+    ///     @param decompressed_data The decompressed data
+    static bool inflateLZMA(const std::string& lzma_data, std::string& decompressed_data);
 };
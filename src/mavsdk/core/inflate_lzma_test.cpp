@@ -0,0 +1,38 @@
+#include "inflate_lzma.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// '{"version": 1, "parameters": []}\n' compressed with xz.
+static const std::vector<uint8_t> compressed_json{
+    0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00, 0x00, 0x01, 0x69, 0x22, 0xde, 0x36, 0x04, 0xc0,
+    0x25, 0x21, 0x21, 0x01, 0x16, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x29, 0xb1, 0x73, 0xf3, 0x01, 0x00, 0x20, 0x7b, 0x22, 0x76, 0x65, 0x72, 0x73, 0x69,
+    0x6f, 0x6e, 0x22, 0x3a, 0x20, 0x31, 0x2c, 0x20, 0x22, 0x70, 0x61, 0x72, 0x61, 0x6d,
+    0x65, 0x74, 0x65, 0x72, 0x73, 0x22, 0x3a, 0x20, 0x5b, 0x5d, 0x7d, 0x0a, 0x00, 0x00,
+    0x00, 0x00, 0x60, 0x8f, 0x34, 0xfa, 0x00, 0x01, 0x3d, 0x21, 0xcb, 0xed, 0x07, 0x06,
+    0x90, 0x42, 0x99, 0x0d, 0x01, 0x00, 0x00, 0x00, 0x00, 0x01, 0x59, 0x5a,
+};
+
+TEST(InflateLZMA, InMemory)
+{
+    const std::string data(compressed_json.begin(), compressed_json.end());
+    std::string decompressed;
+    EXPECT_TRUE(InflateLZMA::inflateLZMA(data, decompressed));
+    EXPECT_EQ(decompressed, "{\"version\": 1, \"parameters\": []}\n");
+}
+
+TEST(InflateLZMA, InMemoryTruncated)
+{
+    const std::string data(compressed_json.begin(), compressed_json.end() - 10);
+    std::string decompressed;
+    EXPECT_FALSE(InflateLZMA::inflateLZMA(data, decompressed));
+    EXPECT_TRUE(decompressed.empty());
+}
+
+TEST(InflateLZMA, InMemoryNotCompressed)
+{
+    std::string decompressed;
+    EXPECT_FALSE(InflateLZMA::inflateLZMA("{\"version\": 1}", decompressed));
+}
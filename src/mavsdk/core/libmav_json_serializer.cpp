@@ -0,0 +1,230 @@
+#include "libmav_json_serializer.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include "mavlink_include.h"
+
+namespace mavsdk {
+
+namespace {
+
+template<typename T> T read_value(const uint8_t* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+template<typename T> void append_integer(std::string& json, T value)
+{
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    json.append(buffer, result.ptr);
+}
+
+template<typename T> void append_floating(std::string& json, T value)
+{
+    // JSON has no representation for NaN or infinity.
+    if (!std::isfinite(value)) {
+        json.append("null");
+        return;
+    }
+
+    char buffer[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    // Shortest representation which reads back to the same value.
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    json.append(buffer, result.ptr);
+#else
+    const int length = std::snprintf(
+        buffer,
+        sizeof(buffer),
+        std::is_same_v<T, float> ? "%.9g" : "%.17g",
+        static_cast<double>(value));
+    json.append(buffer, static_cast<size_t>(length));
+#endif
+}
+
+void append_value(std::string& json, mav::FieldType::BaseType type, const uint8_t* data)
+{
+    switch (type) {
+        case mav::FieldType::BaseType::UINT8:
+            append_integer(json, read_value<uint8_t>(data));
+            break;
+        case mav::FieldType::BaseType::INT8:
+            append_integer(json, read_value<int8_t>(data));
+            break;
+        case mav::FieldType::BaseType::UINT16:
+            append_integer(json, read_value<uint16_t>(data));
+            break;
+        case mav::FieldType::BaseType::INT16:
+            append_integer(json, read_value<int16_t>(data));
+            break;
+        case mav::FieldType::BaseType::UINT32:
+            append_integer(json, read_value<uint32_t>(data));
+            break;
+        case mav::FieldType::BaseType::INT32:
+            append_integer(json, read_value<int32_t>(data));
+            break;
+        case mav::FieldType::BaseType::UINT64:
+            append_integer(json, read_value<uint64_t>(data));
+            break;
+        case mav::FieldType::BaseType::INT64:
+            append_integer(json, read_value<int64_t>(data));
+            break;
+        case mav::FieldType::BaseType::FLOAT:
+            append_floating(json, read_value<float>(data));
+            break;
+        case mav::FieldType::BaseType::DOUBLE:
+            append_floating(json, read_value<double>(data));
+            break;
+        default:
+            json.append("null");
+            break;
+    }
+}
+
+void append_string(std::string& json, const char* data, unsigned max_length)
+{
+    json.push_back('"');
+    for (unsigned i = 0; i < max_length && data[i] != '\0'; ++i) {
+        const char c = data[i];
+        if (c == '"' || c == '\\') {
+            json.push_back('\\');
+            json.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+            json.append(buffer);
+        } else {
+            json.push_back(c);
+        }
+    }
+    json.push_back('"');
+}
+
+unsigned type_size(mav::FieldType::BaseType type)
+{
+    switch (type) {
+        case mav::FieldType::BaseType::UINT8:
+        case mav::FieldType::BaseType::INT8:
+        case mav::FieldType::BaseType::CHAR:
+            return 1;
+        case mav::FieldType::BaseType::UINT16:
+        case mav::FieldType::BaseType::INT16:
+            return 2;
+        case mav::FieldType::BaseType::UINT32:
+        case mav::FieldType::BaseType::INT32:
+        case mav::FieldType::BaseType::FLOAT:
+            return 4;
+        case mav::FieldType::BaseType::UINT64:
+        case mav::FieldType::BaseType::INT64:
+        case mav::FieldType::BaseType::DOUBLE:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+} // namespace
+
+void LibmavJsonSerializer::set_message_set(std::shared_ptr<const mav::MessageSet> message_set)
+{
+    if (message_set == _message_set) {
+        return;
+    }
+
+    _plans.clear();
+    _message_set = std::move(message_set);
+}
+
+const LibmavJsonSerializer::Plan&
+LibmavJsonSerializer::plan_for(const mav::MessageDefinition& definition)
+{
+    const auto it = _plans.find(&definition);
+    if (it != _plans.end()) {
+        return it->second;
+    }
+
+    Plan plan;
+    plan.prefix = "{\"message_id\":" + std::to_string(definition.id()) + ",\"message_name\":\"" +
+                  definition.name() + "\"";
+    plan.expected_length = plan.prefix.size() + 1;
+
+    for (const auto& field_name : definition.fieldNames()) {
+        FieldPlan field_plan;
+        field_plan.key = ",\"" + field_name + "\":";
+
+        const auto field = definition.getField(field_name);
+        if (field && type_size(field.value().type.base_type) > 0) {
+            field_plan.type = field.value().type.base_type;
+            field_plan.offset = static_cast<unsigned>(field.value().offset);
+            field_plan.count = static_cast<unsigned>(std::max(field.value().type.size, 1));
+            field_plan.valid = true;
+        }
+
+        // Rough guess of the formatted length, to reserve the buffer once.
+        plan.expected_length += field_plan.key.size() + 2 + field_plan.count * 12;
+        plan.fields.push_back(std::move(field_plan));
+    }
+
+    return _plans.emplace(&definition, std::move(plan)).first->second;
+}
+
+void LibmavJsonSerializer::serialize(
+    const mav::MessageDefinition& definition, const uint8_t* payload, std::string& json)
+{
+    const auto& plan = plan_for(definition);
+
+    json.clear();
+    json.reserve(plan.expected_length);
+    json.append(plan.prefix);
+
+    for (const auto& field : plan.fields) {
+        json.append(field.key);
+
+        if (!field.valid) {
+            json.append("null");
+            continue;
+        }
+
+        const uint8_t* data = payload + field.offset;
+
+        if (field.type == mav::FieldType::BaseType::CHAR) {
+            append_string(json, reinterpret_cast<const char*>(data), field.count);
+        } else if (field.count == 1) {
+            append_value(json, field.type, data);
+        } else {
+            const unsigned size = type_size(field.type);
+            json.push_back('[');
+            for (unsigned i = 0; i < field.count; ++i) {
+                if (i > 0) {
+                    json.push_back(',');
+                }
+                append_value(json, field.type, data + i * size);
+            }
+            json.push_back(']');
+        }
+    }
+
+    json.push_back('}');
+}
+
+std::string LibmavJsonSerializer::to_json(const mav::Message& message)
+{
+    // MAVLink 2 truncates trailing zeros, so the payload can be shorter than the definition.
+    std::array<uint8_t, MAVLINK_MAX_PAYLOAD_LEN> payload{};
+    const auto payload_view = message.getPayloadView();
+    std::memcpy(payload.data(), payload_view.first, message.getPayloadLength());
+
+    std::string json;
+    serialize(message.type(), payload.data(), json);
+    return json;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <mav/Message.h>
+#include <mav/MessageSet.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mavsdk {
+
+// Converts libmav messages to JSON.
+//
+// For every message definition, the field names, offsets and types are looked up once and
+// kept as a plan, so serializing a message only reads the payload and formats numbers.
+//
+// Not thread-safe, every thread should use its own serializer.
+class LibmavJsonSerializer {
+public:
+    LibmavJsonSerializer() = default;
+
+    // The plans are keyed by the address of the definition, so they are only valid as long as
+    // the definitions are. Passing the set the messages come from keeps it alive, and if it
+    // changes, the plans are dropped, so the definitions of a later set can't pick up a stale
+    // plan at a reused address.
+    void set_message_set(std::shared_ptr<const mav::MessageSet> message_set);
+
+    // Replaces the content of json, so its capacity can be reused for the next message.
+    // The payload needs to be zero padded up to the maximum payload size of the definition.
+    void serialize(
+        const mav::MessageDefinition& definition, const uint8_t* payload, std::string& json);
+
+    std::string to_json(const mav::Message& message);
+
+private:
+    struct FieldPlan {
+        // ,"name":
+        std::string key{};
+        mav::FieldType::BaseType type{mav::FieldType::BaseType::UINT8};
+        unsigned offset{0};
+        unsigned count{1};
+        bool valid{false};
+    };
+
+    struct Plan {
+        // {"message_id":0,"message_name":"HEARTBEAT"
+        std::string prefix{};
+        std::vector<FieldPlan> fields{};
+        size_t expected_length{0};
+    };
+
+    const Plan& plan_for(const mav::MessageDefinition& definition);
+
+    std::shared_ptr<const mav::MessageSet> _message_set{};
+    // Only valid for the definitions of _message_set, see set_message_set().
+    std::unordered_map<const mav::MessageDefinition*, Plan> _plans{};
+};
+
+} // namespace mavsdk
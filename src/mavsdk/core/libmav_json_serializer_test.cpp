@@ -0,0 +1,341 @@
+#include "libmav_json_serializer.h"
+#include "mavsdk_impl.h"
+
+#include <gtest/gtest.h>
+#include <json/json.h>
+#include <mav/MessageSet.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <variant>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+// How messages were converted before, field by field by name.
+std::string reference_to_json(const mav::Message& msg)
+{
+    std::ostringstream json_stream;
+    json_stream << "{";
+    json_stream << "\"message_id\":" << msg.id();
+    json_stream << ",\"message_name\":\"" << msg.name() << "\"";
+
+    for (const auto& field_name : msg.type().fieldNames()) {
+        json_stream << ",\"" << field_name << "\":";
+
+        auto variant_opt = msg.getAsNativeTypeInVariant(field_name);
+        if (!variant_opt) {
+            json_stream << "null";
+            continue;
+        }
+
+        std::visit(
+            [&json_stream](const auto& value) {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, std::string>) {
+                    json_stream << "\"" << value << "\"";
+                } else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+                    if (!std::isfinite(value)) {
+                        json_stream << "null";
+                    } else {
+                        json_stream << value;
+                    }
+                } else if constexpr (std::is_arithmetic_v<T>) {
+                    json_stream << static_cast<int64_t>(value);
+                } else {
+                    json_stream << "[";
+                    bool first = true;
+                    for (const auto& elem : value) {
+                        if (!first) {
+                            json_stream << ",";
+                        }
+                        first = false;
+                        if constexpr (std::is_floating_point_v<std::decay_t<decltype(elem)>>) {
+                            if (!std::isfinite(elem)) {
+                                json_stream << "null";
+                                continue;
+                            }
+                        }
+                        json_stream << +elem;
+                    }
+                    json_stream << "]";
+                }
+            },
+            variant_opt.value());
+    }
+
+    json_stream << "}";
+    return json_stream.str();
+}
+
+void expect_same_json(
+    const Json::Value& expected, const Json::Value& actual, const std::string& path)
+{
+    if (expected.isNumeric() && actual.isNumeric()) {
+        const double tolerance = std::max(1e-5 * std::abs(expected.asDouble()), 1e-5);
+        EXPECT_NEAR(expected.asDouble(), actual.asDouble(), tolerance) << path;
+    } else if (expected.isArray() && actual.isArray()) {
+        ASSERT_EQ(expected.size(), actual.size()) << path;
+        for (Json::ArrayIndex i = 0; i < expected.size(); ++i) {
+            expect_same_json(expected[i], actual[i], path + "[" + std::to_string(i) + "]");
+        }
+    } else if (expected.isObject() && actual.isObject()) {
+        ASSERT_EQ(expected.getMemberNames(), actual.getMemberNames()) << path;
+        for (const auto& name : expected.getMemberNames()) {
+            expect_same_json(expected[name], actual[name], path + "." + name);
+        }
+    } else {
+        EXPECT_EQ(expected, actual) << path;
+    }
+}
+
+// One message with some values set for every definition of the message set.
+std::vector<mav::Message> all_messages(MavsdkImpl& mavsdk_impl)
+{
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> integer_distribution{0, 100};
+    std::uniform_real_distribution<double> real_distribution{-1000.0, 1000.0};
+
+    std::vector<mav::Message> messages;
+    for (int id = 0; id < 65536; ++id) {
+        auto definition = mavsdk_impl.get_message_definition_safe(id);
+        if (!definition) {
+            continue;
+        }
+        const auto& message_definition = definition.get();
+
+        std::array<uint8_t, MAVLINK_MAX_PAYLOAD_LEN> payload{};
+        for (const auto& field_name : message_definition.fieldNames()) {
+            const auto field = message_definition.getField(field_name);
+            if (!field) {
+                continue;
+            }
+            const int count = std::max(field.value().type.size, 1);
+            for (int i = 0; i < count; ++i) {
+                auto write = [&](auto value) {
+                    std::memcpy(
+                        payload.data() + field.value().offset + i * sizeof(value),
+                        &value,
+                        sizeof(value));
+                };
+                switch (field.value().type.base_type) {
+                    case mav::FieldType::BaseType::CHAR:
+                        write(static_cast<char>(i + 1 < count ? 'a' + i % 26 : '\0'));
+                        break;
+                    case mav::FieldType::BaseType::FLOAT:
+                        write(static_cast<float>(real_distribution(generator)));
+                        break;
+                    case mav::FieldType::BaseType::DOUBLE:
+                        write(real_distribution(generator));
+                        break;
+                    case mav::FieldType::BaseType::INT8:
+                        write(static_cast<int8_t>(-integer_distribution(generator)));
+                        break;
+                    case mav::FieldType::BaseType::INT16:
+                        write(static_cast<int16_t>(-integer_distribution(generator)));
+                        break;
+                    case mav::FieldType::BaseType::INT32:
+                        write(static_cast<int32_t>(-integer_distribution(generator)));
+                        break;
+                    case mav::FieldType::BaseType::INT64:
+                        write(static_cast<int64_t>(-integer_distribution(generator)));
+                        break;
+                    case mav::FieldType::BaseType::UINT8:
+                        write(static_cast<uint8_t>(integer_distribution(generator)));
+                        break;
+                    case mav::FieldType::BaseType::UINT16:
+                        write(static_cast<uint16_t>(integer_distribution(generator)));
+                        break;
+                    case mav::FieldType::BaseType::UINT32:
+                        write(static_cast<uint32_t>(integer_distribution(generator)));
+                        break;
+                    case mav::FieldType::BaseType::UINT64:
+                        write(static_cast<uint64_t>(integer_distribution(generator)));
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+
+        const auto max_payload_size = static_cast<uint8_t>(message_definition.maxPayloadSize());
+        mavlink_message_t message{};
+        message.msgid = static_cast<uint32_t>(id);
+        std::memcpy(message.payload64, payload.data(), max_payload_size);
+        mavlink_finalize_message_chan(
+            &message,
+            1,
+            1,
+            mavsdk_impl.channel(),
+            max_payload_size,
+            max_payload_size,
+            static_cast<uint8_t>(message_definition.crcExtra()));
+
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+        size_t bytes_consumed = 0;
+        auto parsed = mavsdk_impl.parse_message_safe(buffer, buffer_len, bytes_consumed);
+        if (parsed) {
+            messages.push_back(parsed.value());
+        }
+    }
+    return messages;
+}
+
+} // namespace
+
+TEST(LibmavJsonSerializer, SameAsReference)
+{
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{ComponentType::GroundStation}};
+    const auto messages = all_messages(mavsdk_impl);
+    ASSERT_GT(messages.size(), 200u);
+
+    LibmavJsonSerializer serializer;
+    Json::Reader reader;
+
+    for (const auto& message : messages) {
+        Json::Value expected;
+        Json::Value actual;
+        ASSERT_TRUE(reader.parse(reference_to_json(message), expected)) << message.name();
+        const auto json = serializer.to_json(message);
+        ASSERT_TRUE(reader.parse(json, actual)) << json;
+        expect_same_json(expected, actual, message.name());
+    }
+}
+
+TEST(LibmavJsonSerializer, EscapesStringsAndNan)
+{
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{ComponentType::GroundStation}};
+
+    mavlink_message_t message;
+    mavlink_msg_param_value_pack_chan(
+        1,
+        1,
+        mavsdk_impl.channel(),
+        &message,
+        "A\"B\\C",
+        std::numeric_limits<float>::quiet_NaN(),
+        MAV_PARAM_TYPE_REAL32,
+        1,
+        0);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+    size_t bytes_consumed = 0;
+    auto parsed = mavsdk_impl.parse_message_safe(buffer, buffer_len, bytes_consumed);
+    ASSERT_TRUE(parsed);
+
+    LibmavJsonSerializer serializer;
+    Json::Value json;
+    Json::Reader reader;
+    ASSERT_TRUE(reader.parse(serializer.to_json(parsed.value()), json));
+
+    EXPECT_EQ(json["message_name"].asString(), "PARAM_VALUE");
+    EXPECT_EQ(json["param_id"].asString(), "A\"B\\C");
+    EXPECT_TRUE(json["param_value"].isNull());
+    EXPECT_EQ(json["param_count"].asUInt(), 1u);
+}
+
+TEST(LibmavJsonSerializer, ReloadedMessageSet)
+{
+    const auto make_message_set = [](const std::string& field_name) {
+        auto message_set = std::make_shared<mav::MessageSet>();
+        message_set->addFromXMLString(
+            R"(<?xml version="1.0"?>
+<mavlink>
+  <messages>
+    <message id="42999" name="TEST_MESSAGE">
+      <description>Test message.</description>
+      <field type="uint32_t" name=")" +
+            field_name + R"(">Value.</field>
+    </message>
+  </messages>
+</mavlink>
+)");
+        return message_set;
+    };
+
+    LibmavJsonSerializer serializer;
+    Json::Reader reader;
+    std::array<uint8_t, MAVLINK_MAX_PAYLOAD_LEN> payload{};
+    payload[0] = 42;
+    std::string json;
+
+    auto message_set = make_message_set("first");
+    std::weak_ptr<mav::MessageSet> first_message_set = message_set;
+    serializer.set_message_set(message_set);
+    const auto first_definition = message_set->getMessageDefinition(42999);
+    ASSERT_TRUE(first_definition);
+    serializer.serialize(first_definition.get(), payload.data(), json);
+    Json::Value first;
+    ASSERT_TRUE(reader.parse(json, first)) << json;
+    EXPECT_EQ(first["first"].asUInt(), 42u);
+
+    // The serializer keeps the set it was given alive.
+    message_set.reset();
+    EXPECT_FALSE(first_message_set.expired());
+
+    // Same message, but a different definition.
+    message_set = make_message_set("second");
+    serializer.set_message_set(message_set);
+    EXPECT_TRUE(first_message_set.expired());
+
+    const auto second_definition = message_set->getMessageDefinition(42999);
+    ASSERT_TRUE(second_definition);
+    serializer.serialize(second_definition.get(), payload.data(), json);
+    Json::Value second;
+    ASSERT_TRUE(reader.parse(json, second)) << json;
+    EXPECT_FALSE(second.isMember("first"));
+    EXPECT_EQ(second["second"].asUInt(), 42u);
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests.
+TEST(LibmavJsonSerializer, DISABLED_Benchmark)
+{
+    constexpr unsigned rounds = 20;
+
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{ComponentType::GroundStation}};
+    const auto messages = all_messages(mavsdk_impl);
+    ASSERT_FALSE(messages.empty());
+
+    size_t total_length = 0;
+
+    auto measure = [&](auto&& convert) {
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned round = 0; round < rounds; ++round) {
+            for (const auto& message : messages) {
+                total_length += convert(message);
+            }
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() /
+               (rounds * messages.size());
+    };
+
+    const double reference_s =
+        measure([](const mav::Message& message) { return reference_to_json(message).size(); });
+
+    LibmavJsonSerializer serializer;
+    std::string json;
+    std::array<uint8_t, MAVLINK_MAX_PAYLOAD_LEN> payload{};
+    const double serializer_s = measure([&](const mav::Message& message) {
+        // Like the receiver, which already has the zero padded payload.
+        payload.fill(0);
+        std::memcpy(
+            payload.data(), message.getPayloadView().first, message.getPayloadLength());
+        serializer.serialize(message.type(), payload.data(), json);
+        return json.size();
+    });
+
+    // Time per message, averaged over all message types.
+    ::testing::Test::RecordProperty("message_types", static_cast<int>(messages.size()));
+    ::testing::Test::RecordProperty("reference_ns", static_cast<int>(reference_s * 1e9));
+    ::testing::Test::RecordProperty("serializer_ns", static_cast<int>(serializer_s * 1e9));
+
+    EXPECT_GT(total_length, 0u);
+}
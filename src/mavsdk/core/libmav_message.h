@@ -0,0 +1,21 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "mavlink_include.h"
+#include "mavsdk.h"
+
+namespace mavsdk {
+
+// A message parsed by libmav, as it is passed from the receive threads to the handlers.
+struct LibmavMessage {
+    // The fields_json is only filled in if a handler or an interception wants JSON.
+    Mavsdk::MavlinkMessage message{};
+    uint32_t message_id{0};
+    // Zero padded up to the maximum length, so fields truncated by MAVLink 2 read as 0.
+    std::array<uint8_t, MAVLINK_MAX_PAYLOAD_LEN> payload{};
+    uint8_t payload_length{0};
+};
+
+} // namespace mavsdk
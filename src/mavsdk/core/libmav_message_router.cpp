@@ -0,0 +1,173 @@
+#include "libmav_message_router.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+void MessageIdInterest::add(std::optional<uint32_t> message_id)
+{
+    if (!message_id) {
+        _all.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (auto* count = _table.get(message_id.value())) {
+        count->fetch_add(1, std::memory_order_relaxed);
+    } else {
+        // The table is full, we can't tell this message apart anymore.
+        _all.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void MessageIdInterest::remove(std::optional<uint32_t> message_id)
+{
+    if (!message_id) {
+        _all.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (auto* count = _table.get(message_id.value())) {
+        count->fetch_sub(1, std::memory_order_relaxed);
+    } else {
+        _all.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+bool MessageIdInterest::wanted(uint32_t message_id) const
+{
+    if (_all.load(std::memory_order_relaxed) > 0) {
+        return true;
+    }
+
+    const auto* count = _table.find(message_id);
+    return count != nullptr && count->load(std::memory_order_relaxed) > 0;
+}
+
+bool LibmavMessageRouter::Subscription::matches(const LibmavMessage& message) const
+{
+    if (!filter.message_id && !filter.message_name.empty() &&
+        filter.message_name != message.message.message_name) {
+        return false;
+    }
+
+    if (filter.component_id && filter.component_id.value() != message.message.component_id) {
+        return false;
+    }
+
+    return true;
+}
+
+LibmavMessageRouter::SubscriptionHandle
+LibmavMessageRouter::subscribe(Filter filter, Callback callback)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const auto handle = _handle_factory.create();
+
+    auto table = std::make_shared<Table>(*_table);
+    Subscription subscription{handle, std::move(filter), std::move(callback)};
+    if (subscription.filter.message_id) {
+        table->by_message_id[subscription.filter.message_id.value()].push_back(
+            std::move(subscription));
+    } else {
+        table->others.push_back(std::move(subscription));
+    }
+    _table = std::move(table);
+
+    return handle;
+}
+
+std::optional<LibmavMessageRouter::Filter>
+LibmavMessageRouter::unsubscribe(SubscriptionHandle handle)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto table = std::make_shared<Table>(*_table);
+
+    auto remove_from = [&](std::vector<Subscription>& subscriptions) -> std::optional<Filter> {
+        auto it = std::find_if(
+            subscriptions.begin(), subscriptions.end(), [&](const Subscription& subscription) {
+                return subscription.handle == handle;
+            });
+        if (it == subscriptions.end()) {
+            return std::nullopt;
+        }
+        auto filter = it->filter;
+        subscriptions.erase(it);
+        return filter;
+    };
+
+    std::optional<Filter> removed = remove_from(table->others);
+    for (auto it = table->by_message_id.begin(); !removed && it != table->by_message_id.end();
+         ++it) {
+        removed = remove_from(it->second);
+        if (removed && it->second.empty()) {
+            table->by_message_id.erase(it);
+            break;
+        }
+    }
+
+    if (removed) {
+        _table = std::move(table);
+    }
+    return removed;
+}
+
+std::vector<LibmavMessageRouter::Filter> LibmavMessageRouter::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<Filter> removed;
+    for (const auto& subscription : _table->others) {
+        removed.push_back(subscription.filter);
+    }
+    for (const auto& entry : _table->by_message_id) {
+        for (const auto& subscription : entry.second) {
+            removed.push_back(subscription.filter);
+        }
+    }
+
+    _table = std::make_shared<Table>();
+    return removed;
+}
+
+std::shared_ptr<const LibmavMessageRouter::Table> LibmavMessageRouter::table() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _table;
+}
+
+unsigned LibmavMessageRouter::route(const LibmavMessage& message) const
+{
+    const auto current_table = table();
+
+    // All subscribers share one copy of the message.
+    std::shared_ptr<const LibmavMessage> payload;
+    unsigned called = 0;
+
+    auto call = [&](const Subscription& subscription) {
+        if (!subscription.matches(message)) {
+            return;
+        }
+        if (!payload) {
+            payload = std::make_shared<const LibmavMessage>(message);
+        }
+        subscription.callback(payload);
+        ++called;
+    };
+
+    const auto it = current_table->by_message_id.find(message.message_id);
+    if (it != current_table->by_message_id.end()) {
+        for (const auto& subscription : it->second) {
+            call(subscription);
+        }
+    }
+
+    for (const auto& subscription : current_table->others) {
+        call(subscription);
+    }
+
+    return called;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "handle.h"
+#include "handle_factory.h"
+#include "libmav_message.h"
+#include "mavlink_statistics.h"
+#include "mavsdk.h"
+
+namespace mavsdk {
+
+// Counts the subscriptions per message ID, so the receive threads can check without taking a
+// lock whether a message needs to be parsed at all.
+class MessageIdInterest {
+public:
+    MessageIdInterest() = default;
+
+    // An empty message ID means all messages.
+    void add(std::optional<uint32_t> message_id);
+    void remove(std::optional<uint32_t> message_id);
+
+    bool wanted(uint32_t message_id) const;
+
+private:
+    std::atomic<uint32_t> _all{0};
+    MessageIdTable<std::atomic<uint32_t>> _table{};
+};
+
+// Routes messages parsed by libmav to the subscribers of their message ID.
+//
+// The subscriptions are kept in an immutable table which is replaced on every change. Routing
+// only takes the lock to get the current table, and callbacks can unsubscribe themselves.
+class LibmavMessageRouter {
+public:
+    using Callback = std::function<void(const std::shared_ptr<const LibmavMessage>&)>;
+    using SubscriptionHandle = Handle<Mavsdk::MavlinkMessage>;
+
+    struct Filter {
+        // Empty for all messages.
+        std::optional<uint32_t> message_id{};
+        // Only used if the message ID is not known (yet), e.g. before custom XML is loaded.
+        std::string message_name{};
+        std::optional<uint8_t> component_id{};
+        // Whether the fields need to be converted to JSON, or only the payload is used.
+        bool json{true};
+    };
+
+    LibmavMessageRouter() = default;
+
+    SubscriptionHandle subscribe(Filter filter, Callback callback);
+
+    // Returns the filter of the subscription removed.
+    std::optional<Filter> unsubscribe(SubscriptionHandle handle);
+
+    // Returns the filters of all subscriptions removed.
+    std::vector<Filter> clear();
+
+    // The message is only copied into the shared payload if there is a subscriber for it.
+    // Returns the number of subscribers called.
+    unsigned route(const LibmavMessage& message) const;
+
+private:
+    struct Subscription {
+        SubscriptionHandle handle;
+        Filter filter;
+        Callback callback;
+
+        bool matches(const LibmavMessage& message) const;
+    };
+
+    struct Table {
+        std::unordered_map<uint32_t, std::vector<Subscription>> by_message_id{};
+        std::vector<Subscription> others{};
+    };
+
+    std::shared_ptr<const Table> table() const;
+
+    mutable std::mutex _mutex{};
+    std::shared_ptr<const Table> _table{std::make_shared<Table>()};
+    HandleFactory<Mavsdk::MavlinkMessage> _handle_factory{};
+};
+
+} // namespace mavsdk
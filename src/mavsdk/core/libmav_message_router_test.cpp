@@ -0,0 +1,148 @@
+#include "libmav_message_router.h"
+
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+LibmavMessage
+make_message(uint32_t message_id, const std::string& name, uint8_t component_id = 1)
+{
+    LibmavMessage message;
+    message.message_id = message_id;
+    message.message.message_name = name;
+    message.message.system_id = 1;
+    message.message.component_id = component_id;
+    message.message.fields_json = "{\"message_name\":\"" + name + "\"}";
+    return message;
+}
+
+} // namespace
+
+TEST(LibmavMessageRouter, RoutesByMessageId)
+{
+    LibmavMessageRouter router;
+
+    unsigned attitude_called = 0;
+    unsigned heartbeat_called = 0;
+    unsigned all_called = 0;
+
+    LibmavMessageRouter::Filter attitude_filter;
+    attitude_filter.message_id = 30;
+    router.subscribe(attitude_filter, [&](const auto& message) {
+        EXPECT_EQ(message->message.message_name, "ATTITUDE");
+        ++attitude_called;
+    });
+
+    LibmavMessageRouter::Filter heartbeat_filter;
+    heartbeat_filter.message_id = 0;
+    router.subscribe(heartbeat_filter, [&](const auto&) { ++heartbeat_called; });
+
+    router.subscribe(LibmavMessageRouter::Filter{}, [&](const auto&) { ++all_called; });
+
+    EXPECT_EQ(router.route(make_message(30, "ATTITUDE")), 2);
+    EXPECT_EQ(router.route(make_message(30, "ATTITUDE")), 2);
+    EXPECT_EQ(router.route(make_message(0, "HEARTBEAT")), 2);
+    EXPECT_EQ(router.route(make_message(33, "GLOBAL_POSITION_INT")), 1);
+
+    EXPECT_EQ(attitude_called, 2);
+    EXPECT_EQ(heartbeat_called, 1);
+    EXPECT_EQ(all_called, 4);
+}
+
+TEST(LibmavMessageRouter, SharesPayload)
+{
+    LibmavMessageRouter router;
+
+    LibmavMessageRouter::Filter filter;
+    filter.message_id = 30;
+
+    std::vector<std::shared_ptr<const LibmavMessage>> received;
+    for (int i = 0; i < 3; ++i) {
+        router.subscribe(filter, [&](const auto& message) { received.push_back(message); });
+    }
+
+    router.route(make_message(30, "ATTITUDE"));
+
+    ASSERT_EQ(received.size(), 3);
+    EXPECT_EQ(received[0].get(), received[1].get());
+    EXPECT_EQ(received[0].get(), received[2].get());
+    EXPECT_EQ(received[0]->message.message_name, "ATTITUDE");
+}
+
+TEST(LibmavMessageRouter, FiltersByNameAndComponent)
+{
+    LibmavMessageRouter router;
+
+    unsigned by_name_called = 0;
+    LibmavMessageRouter::Filter by_name;
+    by_name.message_name = "CUSTOM";
+    router.subscribe(by_name, [&](const auto&) { ++by_name_called; });
+
+    unsigned by_component_called = 0;
+    LibmavMessageRouter::Filter by_component;
+    by_component.message_id = 30;
+    by_component.component_id = 2;
+    router.subscribe(by_component, [&](const auto&) { ++by_component_called; });
+
+    router.route(make_message(42000, "CUSTOM"));
+    router.route(make_message(42001, "OTHER"));
+    router.route(make_message(30, "ATTITUDE", 1));
+    router.route(make_message(30, "ATTITUDE", 2));
+
+    EXPECT_EQ(by_name_called, 1);
+    EXPECT_EQ(by_component_called, 1);
+}
+
+TEST(LibmavMessageRouter, Unsubscribe)
+{
+    LibmavMessageRouter router;
+
+    LibmavMessageRouter::Filter filter;
+    filter.message_id = 30;
+
+    unsigned called = 0;
+    LibmavMessageRouter::SubscriptionHandle handle;
+    handle = router.subscribe(filter, [&](const auto&) {
+        ++called;
+        // Unsubscribing from within the callback is allowed.
+        router.unsubscribe(handle);
+    });
+
+    router.route(make_message(30, "ATTITUDE"));
+    router.route(make_message(30, "ATTITUDE"));
+    EXPECT_EQ(called, 1);
+
+    const auto removed = router.unsubscribe(handle);
+    EXPECT_FALSE(removed.has_value());
+
+    router.subscribe(filter, [](const auto&) {});
+    router.subscribe(LibmavMessageRouter::Filter{}, [](const auto&) {});
+    EXPECT_EQ(router.clear().size(), 2);
+    EXPECT_EQ(router.route(make_message(30, "ATTITUDE")), 0);
+}
+
+TEST(MessageIdInterest, Wanted)
+{
+    MessageIdInterest interest;
+
+    EXPECT_FALSE(interest.wanted(30));
+
+    interest.add(30);
+    interest.add(42000);
+    EXPECT_TRUE(interest.wanted(30));
+    EXPECT_TRUE(interest.wanted(42000));
+    EXPECT_FALSE(interest.wanted(0));
+    EXPECT_FALSE(interest.wanted(42001));
+
+    interest.add(std::nullopt);
+    EXPECT_TRUE(interest.wanted(0));
+    interest.remove(std::nullopt);
+    EXPECT_FALSE(interest.wanted(0));
+
+    interest.remove(30);
+    interest.remove(42000);
+    EXPECT_FALSE(interest.wanted(30));
+    EXPECT_FALSE(interest.wanted(42000));
+}
@@ -2,11 +2,7 @@
 #include "mavsdk_impl.h"
 #include <mav/MessageSet.h>
 #include <mav/BufferParser.h>
-#include <json/json.h>
-#include <variant>
 #include <cstring>
-#include <sstream>
-#include <cmath>
 #include "log.h"
 
 namespace mavsdk {
@@ -43,6 +39,14 @@ bool LibmavReceiver::parse_message()
 
 bool LibmavReceiver::parse_libmav_message_from_buffer(const uint8_t* buffer, size_t buffer_len)
 {
+    // Parsing and converting to JSON is expensive, so we skip messages nobody is interested in.
+    const auto message_id = peek_message_id(buffer, buffer_len);
+    if (message_id && !_mavsdk_impl.libmav_message_wanted(message_id.value())) {
+        _datagram = nullptr;
+        _datagram_len = 0;
+        return false;
+    }
+
     size_t bytes_consumed = 0;
 
     // Use thread-safe parsing from MavsdkImpl (handles MessageSet synchronization internally)
@@ -61,30 +65,43 @@ bool LibmavReceiver::parse_libmav_message_from_buffer(const uint8_t* buffer, siz
     // Extract system and component IDs from header
     auto header = message.header();
 
-    // Generate complete JSON with all field values
-    std::string json = libmav_message_to_json(message);
-
     // Fill our message structures
     _last_libmav_message = message;
-    _last_message.message_name = message.name();
-    _last_message.system_id = header.systemId();
-    _last_message.component_id = header.componentId();
+    _last_message.message_id = message.id();
+    _last_message.message.message_name = message.name();
+    _last_message.message.system_id = header.systemId();
+    _last_message.message.component_id = header.componentId();
 
     // Extract target_system and target_component if present in message fields
     uint8_t target_system_id = 0;
     uint8_t target_component_id = 0;
     if (message.get("target_system", target_system_id) == mav::MessageResult::Success) {
-        _last_message.target_system_id = target_system_id;
+        _last_message.message.target_system_id = target_system_id;
     } else {
-        _last_message.target_system_id = 0;
+        _last_message.message.target_system_id = 0;
     }
     if (message.get("target_component", target_component_id) == mav::MessageResult::Success) {
-        _last_message.target_component_id = target_component_id;
+        _last_message.message.target_component_id = target_component_id;
     } else {
-        _last_message.target_component_id = 0;
+        _last_message.message.target_component_id = 0;
     }
 
-    _last_message.fields_json = json;
+    // The raw payload is used for typed field access.
+    const auto payload_view = message.getPayloadView();
+    const uint8_t payload_length = message.getPayloadLength();
+    _last_message.payload.fill(0);
+    std::memcpy(_last_message.payload.data(), payload_view.first, payload_length);
+    _last_message.payload_length = payload_length;
+
+    // Generate complete JSON with all field values, unless only the raw payload is used.
+    if (_mavsdk_impl.libmav_json_wanted(_last_message.message_id)) {
+        // The message was parsed with this set or an older one which this thread still holds.
+        _json_serializer.set_message_set(_mavsdk_impl.get_message_set());
+        _json_serializer.serialize(
+            message.type(), _last_message.payload.data(), _last_message.message.fields_json);
+    } else {
+        _last_message.message.fields_json.clear();
+    }
 
     // Clear the original datagram since we processed it
     _datagram = nullptr;
@@ -93,113 +110,25 @@ bool LibmavReceiver::parse_libmav_message_from_buffer(const uint8_t* buffer, siz
     return true;
 }
 
-std::string LibmavReceiver::libmav_message_to_json(const mav::Message& msg) const
+std::optional<uint32_t> LibmavReceiver::peek_message_id(const uint8_t* buffer, size_t buffer_len)
 {
-    std::ostringstream json_stream;
-    json_stream << "{";
-    json_stream << "\"message_id\":" << msg.id();
-    json_stream << ",\"message_name\":\"" << msg.name() << "\"";
-
-    // Get message definition to iterate through all fields (using thread-safe method)
-    auto message_def_opt = _mavsdk_impl.get_message_definition_safe(static_cast<int>(msg.id()));
-
-    if (message_def_opt) {
-        auto& message_def = message_def_opt.get();
-
-        // Get field names and iterate through them
-        auto field_names = message_def.fieldNames();
-        for (const auto& field_name : field_names) {
-            json_stream << ",\"" << field_name << "\":";
-
-            // Extract field value based on type and convert to JSON
-            auto variant_opt = msg.getAsNativeTypeInVariant(field_name);
-            if (variant_opt) {
-                const auto& variant = variant_opt.value();
-
-                // Convert variant to JSON string based on the field type
-                std::visit(
-                    [&json_stream](const auto& value) {
-                        using T = std::decay_t<decltype(value)>;
-
-                        if constexpr (
-                            std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t> ||
-                            std::is_same_v<T, uint32_t> || std::is_same_v<T, uint64_t> ||
-                            std::is_same_v<T, int8_t> || std::is_same_v<T, int16_t> ||
-                            std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t>) {
-                            json_stream << static_cast<int64_t>(value);
-                        } else if constexpr (std::is_same_v<T, char>) {
-                            json_stream << static_cast<int>(value);
-                        } else if constexpr (
-                            std::is_same_v<T, float> || std::is_same_v<T, double>) {
-                            if (!std::isfinite(value)) {
-                                json_stream << "null";
-                            } else {
-                                json_stream << value;
-                            }
-                        } else if constexpr (std::is_same_v<T, std::string>) {
-                            json_stream << "\"" << value << "\"";
-                        } else if constexpr (
-                            std::is_same_v<T, std::vector<uint8_t>> ||
-                            std::is_same_v<T, std::vector<int8_t>>) {
-                            // Handle uint8_t/int8_t vectors specially to avoid character output
-                            json_stream << "[";
-                            bool first = true;
-                            for (const auto& elem : value) {
-                                if (!first)
-                                    json_stream << ",";
-                                first = false;
-                                json_stream << static_cast<int>(elem);
-                            }
-                            json_stream << "]";
-                        } else if constexpr (
-                            std::is_same_v<T, std::vector<uint16_t>> ||
-                            std::is_same_v<T, std::vector<uint32_t>> ||
-                            std::is_same_v<T, std::vector<uint64_t>> ||
-                            std::is_same_v<T, std::vector<int16_t>> ||
-                            std::is_same_v<T, std::vector<int32_t>> ||
-                            std::is_same_v<T, std::vector<int64_t>>) {
-                            // Handle integer vector types
-                            json_stream << "[";
-                            bool first = true;
-                            for (const auto& elem : value) {
-                                if (!first)
-                                    json_stream << ",";
-                                first = false;
-                                json_stream << elem;
-                            }
-                            json_stream << "]";
-                        } else if constexpr (
-                            std::is_same_v<T, std::vector<float>> ||
-                            std::is_same_v<T, std::vector<double>>) {
-                            // Handle float/double vector types with NaN check
-                            json_stream << "[";
-                            bool first = true;
-                            for (const auto& elem : value) {
-                                if (!first)
-                                    json_stream << ",";
-                                first = false;
-                                if (!std::isfinite(elem)) {
-                                    json_stream << "null";
-                                } else {
-                                    json_stream << elem;
-                                }
-                            }
-                            json_stream << "]";
-                        } else {
-                            // Fallback for unknown types
-                            json_stream << "null";
-                        }
-                    },
-                    variant);
-            } else {
-                // Field not present or failed to extract
-                json_stream << "null";
+    for (size_t i = 0; i < buffer_len; ++i) {
+        if (buffer[i] == MAVLINK_STX) {
+            if (buffer_len - i < MAVLINK_CORE_HEADER_LEN + 1) {
+                return std::nullopt;
+            }
+            return static_cast<uint32_t>(buffer[i + 7]) |
+                   (static_cast<uint32_t>(buffer[i + 8]) << 8) |
+                   (static_cast<uint32_t>(buffer[i + 9]) << 16);
+        }
+        if (buffer[i] == MAVLINK_STX_MAVLINK1) {
+            if (buffer_len - i < MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1) {
+                return std::nullopt;
             }
+            return buffer[i + 5];
         }
     }
-
-    json_stream << "}";
-    return json_stream.str();
+    return std::nullopt;
 }
 
 std::optional<std::string> LibmavReceiver::message_id_to_name(uint32_t id) const
@@ -5,6 +5,8 @@
 #include <cstdint>
 #include <optional>
 #include <memory>
+#include "libmav_json_serializer.h"
+#include "libmav_message.h"
 #include "mavlink_include.h"
 #include "mavsdk.h"
 
@@ -28,7 +30,7 @@ public:
     explicit LibmavReceiver(MavsdkImpl& mavsdk_impl);
     ~LibmavReceiver(); // Need explicit destructor for unique_ptr with incomplete type
 
-    const Mavsdk::MavlinkMessage& get_last_message() const { return _last_message; }
+    const LibmavMessage& get_last_message() const { return _last_message; }
     const std::optional<mav::Message>& get_last_libmav_message() const
     {
         return _last_libmav_message;
@@ -48,13 +50,11 @@ public:
     // Load custom XML message definitions
     bool load_custom_xml(const std::string& xml_content);
 
-    // JSON conversion (made public for use in message interception)
-    std::string libmav_message_to_json(const mav::Message& msg) const;
-
 private:
     MavsdkImpl& _mavsdk_impl; // For thread-safe MessageSet access
     std::unique_ptr<mav::BufferParser> _buffer_parser;
-    Mavsdk::MavlinkMessage _last_message;
+    LibmavMessage _last_message;
+    LibmavJsonSerializer _json_serializer{};
     std::optional<mav::Message> _last_libmav_message; // Separate libmav message for integration
 
     char* _datagram = nullptr;
@@ -64,6 +64,9 @@ private:
 
     // Helper methods
     bool parse_libmav_message_from_buffer(const uint8_t* buffer, size_t buffer_len);
+
+    // Message ID of the first message in the buffer, if the header is complete.
+    static std::optional<uint32_t> peek_message_id(const uint8_t* buffer, size_t buffer_len);
 };
 
 } // namespace mavsdk
@@ -0,0 +1,175 @@
+#include "link_selector.h"
+
+#include <cmath>
+#include <limits>
+
+#include "mavlink_include.h"
+
+namespace mavsdk {
+
+namespace {
+
+// A lower latency link needs to be this much better before we switch to avoid flapping.
+constexpr double LOWEST_LATENCY_HYSTERESIS = 0.8;
+
+double rtt_or_infinity(const LinkCandidate& candidate)
+{
+    return std::isnan(candidate.rtt_s) ? std::numeric_limits<double>::infinity() :
+                                         candidate.rtt_s;
+}
+
+std::optional<size_t> lowest_loss(const std::vector<LinkCandidate>& candidates)
+{
+    std::optional<size_t> best;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (!candidates[i].healthy) {
+            continue;
+        }
+        if (!best || candidates[i].loss_ratio < candidates[*best].loss_ratio) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+std::optional<size_t> lowest_latency(const std::vector<LinkCandidate>& candidates)
+{
+    std::optional<size_t> best;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (!candidates[i].healthy) {
+            continue;
+        }
+        if (!best) {
+            best = i;
+            continue;
+        }
+        const double rtt = rtt_or_infinity(candidates[i]);
+        const double best_rtt = rtt_or_infinity(candidates[*best]);
+        if (rtt < best_rtt ||
+            (rtt == best_rtt && candidates[i].loss_ratio < candidates[*best].loss_ratio)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+LinkCandidate
+make_link_candidate(const std::vector<LinkQuality>& link_qualities, double failover_timeout_s)
+{
+    LinkCandidate candidate;
+    candidate.rtt_s = std::numeric_limits<double>::quiet_NaN();
+
+    double loss_ratio_sum = 0.0;
+    unsigned num_active = 0;
+
+    for (const auto& link_quality : link_qualities) {
+        if (link_quality.idle_s >= failover_timeout_s) {
+            continue;
+        }
+
+        candidate.healthy = true;
+        loss_ratio_sum += link_quality.loss_ratio;
+        ++num_active;
+
+        if (!std::isnan(link_quality.rtt_s) &&
+            (std::isnan(candidate.rtt_s) || link_quality.rtt_s < candidate.rtt_s)) {
+            candidate.rtt_s = link_quality.rtt_s;
+        }
+    }
+
+    if (num_active > 0) {
+        candidate.loss_ratio = loss_ratio_sum / num_active;
+    }
+
+    return candidate;
+}
+
+std::optional<size_t> select_link(
+    const LinkPolicy& policy,
+    const std::vector<LinkCandidate>& candidates,
+    std::optional<size_t> current)
+{
+    if (candidates.empty()) {
+        return {};
+    }
+
+    switch (policy.mode) {
+        case LinkPolicy::Mode::BroadcastAll:
+            return {};
+
+        case LinkPolicy::Mode::PrimaryWithFailover: {
+            size_t primary = 0;
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                if (candidates[i].is_primary) {
+                    primary = i;
+                    break;
+                }
+            }
+
+            if (candidates[primary].healthy) {
+                return primary;
+            }
+
+            // Stay on the failover link as long as it is fine.
+            if (current && *current < candidates.size() && candidates[*current].healthy) {
+                return current;
+            }
+
+            // If nothing is healthy, we rather send on all links.
+            return lowest_loss(candidates);
+        }
+
+        case LinkPolicy::Mode::LowestLatency: {
+            const auto best = lowest_latency(candidates);
+            if (!best) {
+                return {};
+            }
+
+            if (current && *current < candidates.size() && candidates[*current].healthy &&
+                !(rtt_or_infinity(candidates[*best]) <
+                  rtt_or_infinity(candidates[*current]) * LOWEST_LATENCY_HYSTERESIS)) {
+                return current;
+            }
+
+            return best;
+        }
+    }
+
+    return {};
+}
+
+bool is_redundant_message(uint32_t message_id)
+{
+    switch (message_id) {
+        case MAVLINK_MSG_ID_HEARTBEAT:
+        case MAVLINK_MSG_ID_COMMAND_LONG:
+        case MAVLINK_MSG_ID_COMMAND_INT:
+        case MAVLINK_MSG_ID_COMMAND_CANCEL:
+        // Used to measure the round trip time of each link.
+        case MAVLINK_MSG_ID_PING:
+        case MAVLINK_MSG_ID_TIMESYNC:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint8_t link_selection_system_id(
+    uint32_t message_id,
+    uint8_t target_system_id,
+    std::optional<uint8_t> only_system_id_with_policy)
+{
+    if (is_redundant_message(message_id)) {
+        return 0;
+    }
+
+    if (target_system_id != 0) {
+        return target_system_id;
+    }
+
+    return only_system_id_with_policy.value_or(0);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "link_policy.h"
+#include "statistics.h"
+
+namespace mavsdk {
+
+// Health of one connection to a system as used for the link selection.
+struct LinkCandidate {
+    bool is_primary{false};
+    bool healthy{false};
+    double rtt_s{0.0}; // NaN if unknown
+    double loss_ratio{0.0};
+};
+
+// Summarizes the link quality of all components of a system on one connection.
+LinkCandidate make_link_candidate(
+    const std::vector<LinkQuality>& link_qualities, double failover_timeout_s);
+
+// Returns the index of the candidate to use, or nothing to send on all of them.
+// The current selection is only replaced by a lower latency link if it is clearly better.
+std::optional<size_t> select_link(
+    const LinkPolicy& policy,
+    const std::vector<LinkCandidate>& candidates,
+    std::optional<size_t> current);
+
+// Messages which are always sent on all links, including PING and TIMESYNC, so that the
+// round trip time is known for every link and not only the selected one.
+bool is_redundant_message(uint32_t message_id);
+
+// Returns the system whose link selection applies to a message, or 0 to send it on all links.
+// Messages without target system, e.g. offboard setpoints, ODOMETRY or ATT_POS_MOCAP, are
+// meant for the vehicle, so they follow its link policy if it is the only system with one.
+uint8_t link_selection_system_id(
+    uint32_t message_id,
+    uint8_t target_system_id,
+    std::optional<uint8_t> only_system_id_with_policy);
+
+} // namespace mavsdk
@@ -0,0 +1,156 @@
+#include "link_selector.h"
+#include "mavlink_include.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+
+using namespace mavsdk;
+
+namespace {
+
+LinkCandidate candidate(bool healthy, double rtt_s, double loss_ratio = 0.0, bool primary = false)
+{
+    LinkCandidate result;
+    result.healthy = healthy;
+    result.rtt_s = rtt_s;
+    result.loss_ratio = loss_ratio;
+    result.is_primary = primary;
+    return result;
+}
+
+constexpr double unknown = std::numeric_limits<double>::quiet_NaN();
+
+} // namespace
+
+TEST(LinkSelector, BroadcastAll)
+{
+    LinkPolicy policy;
+    EXPECT_FALSE(select_link(policy, {candidate(true, 0.1), candidate(true, 0.2)}, {}));
+}
+
+TEST(LinkSelector, PrimaryWithFailover)
+{
+    LinkPolicy policy;
+    policy.mode = LinkPolicy::Mode::PrimaryWithFailover;
+
+    // Without primary set, the first one is used.
+    EXPECT_EQ(select_link(policy, {candidate(true, 0.5), candidate(true, 0.1)}, {}), 0u);
+
+    EXPECT_EQ(
+        select_link(policy, {candidate(true, 0.5), candidate(true, 0.1, 0.0, true)}, {}), 1u);
+
+    // Primary is down, pick the one with least loss.
+    EXPECT_EQ(
+        select_link(
+            policy,
+            {candidate(false, 0.5, 0.0, true), candidate(true, 0.1, 0.3), candidate(true, 0.1, 0.1)},
+            0u),
+        2u);
+
+    // Stay on failover link while it is healthy.
+    EXPECT_EQ(
+        select_link(
+            policy,
+            {candidate(false, 0.5, 0.0, true), candidate(true, 0.1, 0.3), candidate(true, 0.1, 0.1)},
+            1u),
+        1u);
+
+    // Go back to primary.
+    EXPECT_EQ(
+        select_link(
+            policy,
+            {candidate(true, 0.5, 0.0, true), candidate(true, 0.1, 0.3), candidate(true, 0.1, 0.1)},
+            1u),
+        0u);
+
+    // Nothing healthy.
+    EXPECT_FALSE(select_link(policy, {candidate(false, 0.5), candidate(false, 0.1)}, 0u));
+}
+
+TEST(LinkSelector, LowestLatency)
+{
+    LinkPolicy policy;
+    policy.mode = LinkPolicy::Mode::LowestLatency;
+
+    EXPECT_EQ(select_link(policy, {candidate(true, 0.5), candidate(true, 0.1)}, {}), 1u);
+    EXPECT_EQ(select_link(policy, {candidate(true, unknown), candidate(true, 0.1)}, {}), 1u);
+    EXPECT_EQ(select_link(policy, {candidate(true, 0.5), candidate(false, 0.1)}, {}), 0u);
+
+    // Only slightly better, keep the current one.
+    EXPECT_EQ(select_link(policy, {candidate(true, 0.10), candidate(true, 0.09)}, 0u), 0u);
+    // Clearly better, switch.
+    EXPECT_EQ(select_link(policy, {candidate(true, 0.10), candidate(true, 0.05)}, 0u), 1u);
+    // Current one is gone.
+    EXPECT_EQ(select_link(policy, {candidate(false, 0.10), candidate(true, 0.2)}, 0u), 1u);
+
+    EXPECT_FALSE(select_link(policy, {candidate(false, 0.10), candidate(false, 0.2)}, 0u));
+}
+
+TEST(LinkSelector, MakeCandidate)
+{
+    LinkQuality autopilot;
+    autopilot.component_id = 1;
+    autopilot.rtt_s = 0.2;
+    autopilot.loss_ratio = 0.1;
+
+    LinkQuality camera;
+    camera.component_id = 100;
+    camera.rtt_s = unknown;
+    camera.loss_ratio = 0.3;
+
+    auto result = make_link_candidate({autopilot, camera}, 2.0);
+    EXPECT_TRUE(result.healthy);
+    EXPECT_DOUBLE_EQ(result.rtt_s, 0.2);
+    EXPECT_DOUBLE_EQ(result.loss_ratio, 0.2);
+
+    autopilot.idle_s = 3.0;
+    camera.idle_s = 2.0;
+    result = make_link_candidate({autopilot, camera}, 2.0);
+    EXPECT_FALSE(result.healthy);
+    EXPECT_TRUE(std::isnan(result.rtt_s));
+
+    EXPECT_FALSE(make_link_candidate({}, 2.0).healthy);
+}
+
+TEST(LinkSelector, RedundantMessages)
+{
+    EXPECT_TRUE(is_redundant_message(MAVLINK_MSG_ID_HEARTBEAT));
+    EXPECT_TRUE(is_redundant_message(MAVLINK_MSG_ID_COMMAND_LONG));
+    EXPECT_TRUE(is_redundant_message(MAVLINK_MSG_ID_PING));
+    EXPECT_TRUE(is_redundant_message(MAVLINK_MSG_ID_TIMESYNC));
+    EXPECT_FALSE(is_redundant_message(MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED));
+}
+
+TEST(LinkSelector, UntargetedStreams)
+{
+    // Motion capture and odometry for the only vehicle with a policy.
+    EXPECT_EQ(link_selection_system_id(MAVLINK_MSG_ID_ODOMETRY, 0, 1), 1);
+    EXPECT_EQ(link_selection_system_id(MAVLINK_MSG_ID_ATT_POS_MOCAP, 0, 1), 1);
+    EXPECT_EQ(link_selection_system_id(MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE, 0, 1), 1);
+
+    // Without target, we can't tell which vehicle it is for if there are several.
+    EXPECT_EQ(link_selection_system_id(MAVLINK_MSG_ID_ODOMETRY, 0, std::nullopt), 0);
+
+    // Targeted messages follow the policy of their target.
+    EXPECT_EQ(link_selection_system_id(MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED, 2, 1), 2);
+
+    // Redundant ones go everywhere.
+    EXPECT_EQ(link_selection_system_id(MAVLINK_MSG_ID_HEARTBEAT, 0, 1), 0);
+    EXPECT_EQ(link_selection_system_id(MAVLINK_MSG_ID_COMMAND_LONG, 1, 1), 0);
+}
+
+TEST(LinkSelector, RoundTripTimeMeasuredOnAllLinks)
+{
+    // Even with a policy selecting one link for the vehicle, pings and timesync go out on all
+    // links, so that the replies give the round trip time of each of them.
+    EXPECT_EQ(link_selection_system_id(MAVLINK_MSG_ID_PING, 0, 1), 0);
+    EXPECT_EQ(link_selection_system_id(MAVLINK_MSG_ID_PING, 1, 1), 0);
+    EXPECT_EQ(link_selection_system_id(MAVLINK_MSG_ID_TIMESYNC, 0, 1), 0);
+    EXPECT_EQ(link_selection_system_id(MAVLINK_MSG_ID_TIMESYNC, 1, 1), 0);
+
+    // So the link with lower latency can be found, even if it is not selected yet.
+    LinkPolicy policy;
+    policy.mode = LinkPolicy::Mode::LowestLatency;
+    EXPECT_EQ(select_link(policy, {candidate(true, 0.3), candidate(true, 0.05)}, 0u), 1u);
+}
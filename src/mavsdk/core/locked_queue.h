@@ -19,7 +19,7 @@ public:
         _condition_var.notify_one();
     }
 
-    size_t size()
+    size_t size() const
     {
         std::lock_guard<std::mutex> lock(_mutex);
         return _queue.size();
@@ -91,7 +91,7 @@ public:
 
 private:
     std::deque<std::shared_ptr<T>> _queue{};
-    std::mutex _mutex{};
+    mutable std::mutex _mutex{};
     std::condition_variable _condition_var{};
     bool _should_exit{false};
 };
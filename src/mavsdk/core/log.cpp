@@ -1,4 +1,5 @@
 #include "log.h"
+#include "log_sink.h"
 #include "unused.h"
 
 #include <mutex>
@@ -50,6 +51,93 @@ void log::subscribe(const log::Callback& callback)
     callback_ = callback;
 }
 
+LogDetailed::~LogDetailed()
+{
+    std::string message = _s.str();
+
+    if (log::get_callback()) {
+        std::lock_guard<std::mutex> lock(get_log_mutex());
+        if (log::get_callback()(_log_level, message, _caller_filename, _caller_filenumber)) {
+            return;
+        }
+    }
+
+#if ANDROID
+    switch (_log_level) {
+        case log::Level::Debug:
+            __android_log_print(ANDROID_LOG_DEBUG, "Mavsdk", "%s", message.c_str());
+            break;
+        case log::Level::Info:
+            __android_log_print(ANDROID_LOG_INFO, "Mavsdk", "%s", message.c_str());
+            break;
+        case log::Level::Warn:
+            __android_log_print(ANDROID_LOG_WARN, "Mavsdk", "%s", message.c_str());
+            break;
+        case log::Level::Err:
+            __android_log_print(ANDROID_LOG_ERROR, "Mavsdk", "%s", message.c_str());
+            break;
+    }
+    // Unused:
+    (void)_caller_filename;
+    (void)_caller_filenumber;
+#else
+    // With MAVSDK_ASYNC_LOGGING set, the line is handed to the background writer
+    // instead of blocking the calling thread on stdout.
+    if (auto* sink = AsyncLogSink::instance()) {
+        sink->push(_log_level, _caller_filename, _caller_filenumber, std::move(message));
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(get_log_mutex());
+
+    switch (_log_level) {
+        case log::Level::Debug:
+            set_color(Color::Green);
+            break;
+        case log::Level::Info:
+            set_color(Color::Blue);
+            break;
+        case log::Level::Warn:
+            set_color(Color::Yellow);
+            break;
+        case log::Level::Err:
+            set_color(Color::Red);
+            break;
+    }
+
+    // Time output taken from:
+    // https://stackoverflow.com/questions/16357999#answer-16358264
+    time_t rawtime;
+    time(&rawtime);
+    struct tm* timeinfo = localtime(&rawtime);
+    char time_buffer[10]{}; // We need 8 characters + \0
+    strftime(time_buffer, sizeof(time_buffer), "%I:%M:%S", timeinfo);
+    std::cout << "[" << time_buffer;
+
+    switch (_log_level) {
+        case log::Level::Debug:
+            std::cout << "|Debug] ";
+            break;
+        case log::Level::Info:
+            std::cout << "|Info ] ";
+            break;
+        case log::Level::Warn:
+            std::cout << "|Warn ] ";
+            break;
+        case log::Level::Err:
+            std::cout << "|Error] ";
+            break;
+    }
+
+    set_color(Color::Reset);
+
+    std::cout << message;
+    std::cout << " (" << _caller_filename << ":" << std::dec << _caller_filenumber << ")";
+
+    std::cout << std::endl;
+#endif
+}
+
 void set_color(Color color)
 {
 #if defined(WINDOWS)
@@ -31,6 +31,8 @@
 namespace mavsdk {
 
 // Mutex moved to log.cpp to avoid inlining issues
+// It is only held while a finished line is handed to the user callback or stdout,
+// not while the line is being formatted.
 std::mutex& get_log_mutex();
 
 std::ostream& operator<<(std::ostream& os, std::byte b);
@@ -42,7 +44,6 @@ void set_color(Color color);
 class LogDetailed {
 public:
     LogDetailed(const char* filename, int filenumber) :
-        _lock_guard(get_log_mutex()),
         _s(),
         _caller_filename(filename),
         _caller_filenumber(filenumber)
@@ -54,80 +55,7 @@ public:
         return *this;
     }
 
-    virtual ~LogDetailed()
-    {
-        if (log::get_callback() &&
-            log::get_callback()(_log_level, _s.str(), _caller_filename, _caller_filenumber)) {
-            return;
-        }
-
-#if ANDROID
-        switch (_log_level) {
-            case log::Level::Debug:
-                __android_log_print(ANDROID_LOG_DEBUG, "Mavsdk", "%s", _s.str().c_str());
-                break;
-            case log::Level::Info:
-                __android_log_print(ANDROID_LOG_INFO, "Mavsdk", "%s", _s.str().c_str());
-                break;
-            case log::Level::Warn:
-                __android_log_print(ANDROID_LOG_WARN, "Mavsdk", "%s", _s.str().c_str());
-                break;
-            case log::Level::Err:
-                __android_log_print(ANDROID_LOG_ERROR, "Mavsdk", "%s", _s.str().c_str());
-                break;
-        }
-        // Unused:
-        (void)_caller_filename;
-        (void)_caller_filenumber;
-#else
-
-        switch (_log_level) {
-            case log::Level::Debug:
-                set_color(Color::Green);
-                break;
-            case log::Level::Info:
-                set_color(Color::Blue);
-                break;
-            case log::Level::Warn:
-                set_color(Color::Yellow);
-                break;
-            case log::Level::Err:
-                set_color(Color::Red);
-                break;
-        }
-
-        // Time output taken from:
-        // https://stackoverflow.com/questions/16357999#answer-16358264
-        time_t rawtime;
-        time(&rawtime);
-        struct tm* timeinfo = localtime(&rawtime);
-        char time_buffer[10]{}; // We need 8 characters + \0
-        strftime(time_buffer, sizeof(time_buffer), "%I:%M:%S", timeinfo);
-        std::cout << "[" << time_buffer;
-
-        switch (_log_level) {
-            case log::Level::Debug:
-                std::cout << "|Debug] ";
-                break;
-            case log::Level::Info:
-                std::cout << "|Info ] ";
-                break;
-            case log::Level::Warn:
-                std::cout << "|Warn ] ";
-                break;
-            case log::Level::Err:
-                std::cout << "|Error] ";
-                break;
-        }
-
-        set_color(Color::Reset);
-
-        std::cout << _s.str();
-        std::cout << " (" << _caller_filename << ":" << std::dec << _caller_filenumber << ")";
-
-        std::cout << std::endl;
-#endif
-    }
+    virtual ~LogDetailed();
 
     LogDetailed(const mavsdk::LogDetailed&) = delete;
     void operator=(const mavsdk::LogDetailed&) = delete;
@@ -136,8 +64,6 @@ protected:
     log::Level _log_level = log::Level::Debug;
 
 private:
-    std::lock_guard<std::mutex> _lock_guard;
-
     std::stringstream _s;
     const char* _caller_filename;
     int _caller_filenumber;
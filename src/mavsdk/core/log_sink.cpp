@@ -0,0 +1,433 @@
+#include "log_sink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace mavsdk {
+
+namespace {
+
+std::atomic<uint64_t> next_sink_id{1};
+
+AsyncLogSink* create_sink_from_env()
+{
+#if ANDROID
+    // Android logging goes through __android_log_print which does not block on stdout. Same
+    // test as in LogDetailed::~LogDetailed, so that the sink is off exactly then.
+    return nullptr;
+#else
+    const char* env_p = std::getenv("MAVSDK_ASYNC_LOGGING");
+    if (env_p == nullptr) {
+        return nullptr;
+    }
+
+    const std::string mode_str(env_p);
+
+    if (mode_str == "1") {
+        return new AsyncLogSink(AsyncLogSink::Mode::Text, [](const char* data, size_t len) {
+            fwrite(data, 1, len, stdout);
+            fflush(stdout);
+        });
+    }
+
+    if (mode_str == "binary") {
+        const char* path_p = std::getenv("MAVSDK_ASYNC_LOG_FILE");
+        // The file is closed once the sink, and with it the writer, is destroyed.
+        std::shared_ptr<FILE> file(
+            fopen(path_p != nullptr ? path_p : "mavsdk_log.bin", "wb"),
+            [](FILE* f) {
+                if (f != nullptr) {
+                    fclose(f);
+                }
+            });
+        if (file == nullptr) {
+            fprintf(stderr, "Could not open binary log file: %s\n", strerror(errno));
+            return nullptr;
+        }
+        return new AsyncLogSink(AsyncLogSink::Mode::Binary, [file](const char* data, size_t len) {
+            fwrite(data, 1, len, file.get());
+            fflush(file.get());
+        });
+    }
+
+    return nullptr;
+#endif
+}
+
+void write_le(char*& data, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        *data++ = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+uint64_t read_le(const char*& data, size_t size)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(*data++)) << (8 * i);
+    }
+    return value;
+}
+
+void flush_instance_at_exit()
+{
+    if (auto* sink = AsyncLogSink::instance()) {
+        sink->flush();
+    }
+}
+
+} // namespace
+
+void AsyncLogSink::BinaryRecordHeader::serialize(char* data) const
+{
+    write_le(data, timestamp_ns, sizeof(timestamp_ns));
+    write_le(data, line, sizeof(line));
+    write_le(data, filename_len, sizeof(filename_len));
+    write_le(data, level, sizeof(level));
+    write_le(data, reserved, sizeof(reserved));
+    write_le(data, message_len, sizeof(message_len));
+}
+
+AsyncLogSink::BinaryRecordHeader AsyncLogSink::BinaryRecordHeader::deserialize(const char* data)
+{
+    BinaryRecordHeader header{};
+    header.timestamp_ns = read_le(data, sizeof(header.timestamp_ns));
+    header.line = static_cast<uint32_t>(read_le(data, sizeof(header.line)));
+    header.filename_len = static_cast<uint16_t>(read_le(data, sizeof(header.filename_len)));
+    header.level = static_cast<uint8_t>(read_le(data, sizeof(header.level)));
+    header.reserved = static_cast<uint8_t>(read_le(data, sizeof(header.reserved)));
+    header.message_len = static_cast<uint32_t>(read_le(data, sizeof(header.message_len)));
+    return header;
+}
+
+AsyncLogSink::AsyncLogSink(Mode mode, Writer writer, size_t capacity_per_thread) :
+    _mode(mode),
+    _writer(std::move(writer)),
+    _capacity(std::max<size_t>(capacity_per_thread, 1)),
+    _id(next_sink_id++),
+    _steady_start(std::chrono::steady_clock::now()),
+    _system_start(std::chrono::system_clock::now())
+{
+    if (_mode == Mode::Binary) {
+        _writer(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    }
+
+    _thread = std::thread(&AsyncLogSink::writer_thread, this);
+}
+
+AsyncLogSink::~AsyncLogSink()
+{
+    _should_exit = true;
+    _wake_cv.notify_all();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+
+    flush();
+}
+
+AsyncLogSink* AsyncLogSink::instance()
+{
+    // Intentionally leaked, so that logging keeps working during static destruction.
+    static AsyncLogSink* sink = []() {
+        auto* new_sink = create_sink_from_env();
+        if (new_sink != nullptr) {
+            std::atexit(flush_instance_at_exit);
+        }
+        return new_sink;
+    }();
+
+    return sink;
+}
+
+AsyncLogSink::ThreadBuffer& AsyncLogSink::buffer_for_this_thread()
+{
+    struct Registration {
+        uint64_t sink_id;
+        std::shared_ptr<ThreadBuffer> buffer;
+    };
+
+    struct Registrations {
+        ~Registrations()
+        {
+            // The thread is going away, the writer can remove the buffer once it is drained.
+            for (auto& registration : list) {
+                registration.buffer->retired = true;
+            }
+        }
+
+        std::vector<Registration> list{};
+    };
+
+    thread_local Registrations registrations;
+
+    for (auto& registration : registrations.list) {
+        if (registration.sink_id == _id) {
+            return *registration.buffer;
+        }
+    }
+
+    // Forget about buffers of sinks that have been destroyed in the meantime.
+    registrations.list.erase(
+        std::remove_if(
+            registrations.list.begin(),
+            registrations.list.end(),
+            [](const Registration& registration) { return registration.buffer.use_count() == 1; }),
+        registrations.list.end());
+
+    auto buffer = std::make_shared<ThreadBuffer>(_capacity);
+    {
+        std::lock_guard<std::mutex> lock(_buffers_mutex);
+        _buffers.push_back(buffer);
+    }
+    registrations.list.push_back(Registration{_id, buffer});
+
+    return *buffer;
+}
+
+bool AsyncLogSink::push(
+    log::Level level, const char* filename, int linenumber, std::string&& message)
+{
+    auto& buffer = buffer_for_this_thread();
+
+    const size_t head = buffer.head.load(std::memory_order_relaxed);
+    const size_t tail = buffer.tail.load(std::memory_order_acquire);
+
+    if (head - tail >= _capacity) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto& entry = buffer.entries[head % _capacity];
+    entry.time = std::chrono::steady_clock::now();
+    entry.level = level;
+    entry.filename = filename;
+    entry.linenumber = linenumber;
+    entry.message = std::move(message);
+
+    buffer.head.store(head + 1, std::memory_order_release);
+
+    // Wake the writer early if we are filling up, otherwise it picks it up on its next round.
+    if (head - tail + 1 >= _capacity / 2) {
+        _wake_cv.notify_one();
+    }
+
+    return true;
+}
+
+void AsyncLogSink::flush()
+{
+    std::lock_guard<std::mutex> lock(_drain_mutex);
+    drain();
+}
+
+AsyncLogSink::Stats AsyncLogSink::stats() const
+{
+    Stats stats;
+    stats.written = _written.load();
+    stats.dropped = _dropped.load();
+    return stats;
+}
+
+void AsyncLogSink::writer_thread()
+{
+    while (!_should_exit) {
+        {
+            std::lock_guard<std::mutex> lock(_drain_mutex);
+            drain();
+        }
+
+        std::unique_lock<std::mutex> lock(_wake_mutex);
+        _wake_cv.wait_for(lock, WRITER_INTERVAL);
+    }
+}
+
+size_t AsyncLogSink::drain()
+{
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(_buffers_mutex);
+        buffers = _buffers;
+    }
+
+    bool any_retired = false;
+    std::vector<std::pair<ThreadBuffer*, size_t>> new_tails;
+    new_tails.reserve(buffers.size());
+
+    for (auto& buffer : buffers) {
+        // Check retired before reading head, so a retired buffer is guaranteed to be empty
+        // once we have drained it.
+        const bool retired = buffer->retired.load(std::memory_order_acquire);
+        const size_t tail = buffer->tail.load(std::memory_order_relaxed);
+        const size_t head = buffer->head.load(std::memory_order_acquire);
+
+        for (size_t i = tail; i != head; ++i) {
+            _pending.push_back(&buffer->entries[i % _capacity]);
+        }
+
+        new_tails.emplace_back(buffer.get(), head);
+        any_retired |= retired;
+    }
+
+    // Lines from different threads are merged by their timestamp.
+    std::stable_sort(_pending.begin(), _pending.end(), [](const Entry* lhs, const Entry* rhs) {
+        return lhs->time < rhs->time;
+    });
+
+    for (auto* entry : _pending) {
+        if (_mode == Mode::Text) {
+            append_text(*entry);
+        } else {
+            append_binary(*entry);
+        }
+        entry->message.clear();
+    }
+
+    const size_t count = _pending.size();
+    _pending.clear();
+
+    // Only now the producers are allowed to reuse the slots.
+    for (auto& new_tail : new_tails) {
+        new_tail.first->tail.store(new_tail.second, std::memory_order_release);
+    }
+
+    const uint64_t dropped = _dropped.load(std::memory_order_relaxed);
+    if (dropped != _dropped_reported) {
+        append_drop_notice(dropped - _dropped_reported);
+        _dropped_reported = dropped;
+    }
+
+    if (!_batch.empty()) {
+        _writer(_batch.data(), _batch.size());
+        _batch.clear();
+    }
+
+    _written.fetch_add(count, std::memory_order_relaxed);
+
+    if (any_retired) {
+        std::lock_guard<std::mutex> lock(_buffers_mutex);
+        _buffers.erase(
+            std::remove_if(
+                _buffers.begin(),
+                _buffers.end(),
+                [](const std::shared_ptr<ThreadBuffer>& buffer) {
+                    return buffer->retired &&
+                           buffer->head.load(std::memory_order_acquire) ==
+                               buffer->tail.load(std::memory_order_relaxed);
+                }),
+            _buffers.end());
+    }
+
+    return count;
+}
+
+void AsyncLogSink::append_text(const Entry& entry)
+{
+    // We only take the wall clock time once at startup and derive it from the monotonic
+    // timestamp taken at the call site.
+    const auto wall_time =
+        _system_start +
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(entry.time - _steady_start);
+    const time_t seconds = std::chrono::system_clock::to_time_t(wall_time);
+
+    if (static_cast<int64_t>(seconds) != _cached_second) {
+        struct tm timeinfo {};
+#if defined(WINDOWS)
+        localtime_s(&timeinfo, &seconds);
+#else
+        localtime_r(&seconds, &timeinfo);
+#endif
+        strftime(_cached_time, sizeof(_cached_time), "%I:%M:%S", &timeinfo);
+        _cached_second = static_cast<int64_t>(seconds);
+    }
+
+#if defined(WINDOWS)
+    const char* color = "";
+    const char* reset = "";
+#else
+    const char* color = "";
+    const char* reset = "\x1b[0m";
+#endif
+    const char* level_str = "";
+
+    switch (entry.level) {
+        case log::Level::Debug:
+            level_str = "|Debug] ";
+#if !defined(WINDOWS)
+            color = "\x1b[32m";
+#endif
+            break;
+        case log::Level::Info:
+            level_str = "|Info ] ";
+#if !defined(WINDOWS)
+            color = "\x1b[34m";
+#endif
+            break;
+        case log::Level::Warn:
+            level_str = "|Warn ] ";
+#if !defined(WINDOWS)
+            color = "\x1b[33m";
+#endif
+            break;
+        case log::Level::Err:
+            level_str = "|Error] ";
+#if !defined(WINDOWS)
+            color = "\x1b[31m";
+#endif
+            break;
+    }
+
+    _batch += color;
+    _batch += '[';
+    _batch += _cached_time;
+    _batch += level_str;
+    _batch += reset;
+    _batch += entry.message;
+    _batch += " (";
+    _batch += entry.filename != nullptr ? entry.filename : "";
+    _batch += ':';
+    _batch += std::to_string(entry.linenumber);
+    _batch += ")\n";
+}
+
+void AsyncLogSink::append_binary(const Entry& entry)
+{
+    const size_t filename_len = entry.filename != nullptr ? strlen(entry.filename) : 0;
+
+    BinaryRecordHeader header{};
+    header.timestamp_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(entry.time - _steady_start).count());
+    header.line = static_cast<uint32_t>(entry.linenumber);
+    header.filename_len = static_cast<uint16_t>(std::min<size_t>(filename_len, UINT16_MAX));
+    header.level = static_cast<uint8_t>(entry.level);
+    header.message_len = static_cast<uint32_t>(entry.message.size());
+
+    char serialized[BinaryRecordHeader::SERIALIZED_SIZE];
+    header.serialize(serialized);
+    _batch.append(serialized, sizeof(serialized));
+    _batch.append(entry.filename != nullptr ? entry.filename : "", header.filename_len);
+    _batch.append(entry.message);
+}
+
+void AsyncLogSink::append_drop_notice(uint64_t dropped)
+{
+    Entry entry;
+    entry.time = std::chrono::steady_clock::now();
+    entry.level = log::Level::Warn;
+    entry.filename = "log_sink.cpp";
+    entry.linenumber = __LINE__;
+    entry.message = "Dropped " + std::to_string(dropped) + " log messages";
+
+    if (_mode == Mode::Text) {
+        append_text(entry);
+    } else {
+        append_binary(entry);
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "log_callback.h"
+
+namespace mavsdk {
+
+// Asynchronous sink for log lines.
+//
+// Every logging thread gets its own single-producer/single-consumer ring, so
+// pushing a line is lock-free and never waits for stdout. A background writer
+// thread drains all rings, formats the lines and hands them to the writer in
+// batches. If a ring is full, the line is dropped and counted instead of
+// blocking the caller (which is often a receive thread or the work thread).
+//
+// The sink is enabled by setting the environment variable
+// MAVSDK_ASYNC_LOGGING to "1" (text) or "binary". In binary mode, records are
+// written to the file set in MAVSDK_ASYNC_LOG_FILE (default: mavsdk_log.bin).
+class AsyncLogSink {
+public:
+    enum class Mode { Text, Binary };
+
+    using Writer = std::function<void(const char* data, size_t len)>;
+
+    struct Stats {
+        uint64_t written{0};
+        uint64_t dropped{0};
+    };
+
+    // Binary record header, followed by filename and message bytes. It is serialized field by
+    // field in little-endian order without padding, so the file format doesn't depend on the
+    // platform.
+    struct BinaryRecordHeader {
+        uint64_t timestamp_ns; // Monotonic, relative to sink start.
+        uint32_t line;
+        uint16_t filename_len;
+        uint8_t level;
+        uint8_t reserved;
+        uint32_t message_len;
+
+        static constexpr size_t SERIALIZED_SIZE = 20;
+
+        void serialize(char* data) const;
+        static BinaryRecordHeader deserialize(const char* data);
+    };
+    static constexpr char BINARY_MAGIC[8] = {'M', 'A', 'V', 'S', 'D', 'K', 'L', '1'};
+
+    static constexpr size_t DEFAULT_CAPACITY_PER_THREAD = 1024;
+
+    AsyncLogSink(
+        Mode mode, Writer writer, size_t capacity_per_thread = DEFAULT_CAPACITY_PER_THREAD);
+    ~AsyncLogSink();
+
+    // Returns false if the line had to be dropped.
+    bool push(log::Level level, const char* filename, int linenumber, std::string&& message);
+
+    // Blocks until everything pushed before this call has been written.
+    void flush();
+
+    Stats stats() const;
+
+    // Process wide sink, nullptr unless enabled using the environment.
+    static AsyncLogSink* instance();
+
+    AsyncLogSink(const AsyncLogSink&) = delete;
+    AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+private:
+    struct Entry {
+        std::chrono::steady_clock::time_point time{};
+        log::Level level{log::Level::Debug};
+        const char* filename{nullptr};
+        int linenumber{0};
+        std::string message{};
+    };
+
+    struct ThreadBuffer {
+        explicit ThreadBuffer(size_t capacity) : entries(capacity) {}
+
+        std::vector<Entry> entries;
+        // Written by producer only.
+        std::atomic<size_t> head{0};
+        // Written by consumer only.
+        std::atomic<size_t> tail{0};
+        std::atomic<bool> retired{false};
+    };
+
+    ThreadBuffer& buffer_for_this_thread();
+    void writer_thread();
+    // Needs _drain_mutex.
+    size_t drain();
+    void append_text(const Entry& entry);
+    void append_binary(const Entry& entry);
+    void append_drop_notice(uint64_t dropped);
+
+    const Mode _mode;
+    const Writer _writer;
+    const size_t _capacity;
+    const uint64_t _id;
+
+    const std::chrono::steady_clock::time_point _steady_start;
+    const std::chrono::system_clock::time_point _system_start;
+
+    std::mutex _buffers_mutex{};
+    std::vector<std::shared_ptr<ThreadBuffer>> _buffers{};
+
+    std::mutex _drain_mutex{};
+    std::string _batch{};
+    std::vector<Entry*> _pending{};
+    // Cache of the formatted wall clock second, so localtime is only called once per second.
+    int64_t _cached_second{-1};
+    char _cached_time[10]{};
+
+    std::atomic<uint64_t> _written{0};
+    std::atomic<uint64_t> _dropped{0};
+    uint64_t _dropped_reported{0};
+
+    std::mutex _wake_mutex{};
+    std::condition_variable _wake_cv{};
+    std::atomic<bool> _should_exit{false};
+    std::thread _thread{};
+
+    static constexpr std::chrono::milliseconds WRITER_INTERVAL{5};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,247 @@
+#include "log_sink.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+TEST(AsyncLogSink, WritesLinesInOrder)
+{
+    std::string output;
+    {
+        AsyncLogSink sink(
+            AsyncLogSink::Mode::Text, [&](const char* data, size_t len) { output.append(data, len); });
+
+        for (int i = 0; i < 10; ++i) {
+            EXPECT_TRUE(sink.push(log::Level::Info, "file.cpp", i, "line " + std::to_string(i)));
+        }
+        sink.flush();
+
+        EXPECT_EQ(sink.stats().written, 10);
+        EXPECT_EQ(sink.stats().dropped, 0);
+    }
+
+    size_t pos = 0;
+    for (int i = 0; i < 10; ++i) {
+        const auto expected = "line " + std::to_string(i) + " (file.cpp:" + std::to_string(i) + ")";
+        const auto found = output.find(expected, pos);
+        ASSERT_NE(found, std::string::npos);
+        pos = found;
+    }
+    EXPECT_NE(output.find("|Info ] "), std::string::npos);
+}
+
+TEST(AsyncLogSink, DropsOnOverflowInsteadOfBlocking)
+{
+    std::promise<void> release_prom;
+    auto release_fut = release_prom.get_future().share();
+
+    std::mutex output_mutex;
+    std::string output;
+
+    AsyncLogSink sink(
+        AsyncLogSink::Mode::Text,
+        [&](const char* data, size_t len) {
+            // Stall the writer to simulate a slow stdout.
+            release_fut.wait();
+            std::lock_guard<std::mutex> lock(output_mutex);
+            output.append(data, len);
+        },
+        4);
+
+    const auto before = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i) {
+        sink.push(log::Level::Debug, "file.cpp", i, "spam");
+    }
+    const auto after = std::chrono::steady_clock::now();
+
+    // Pushing must not have waited for the stalled writer.
+    EXPECT_LT(after - before, std::chrono::milliseconds(500));
+    EXPECT_GT(sink.stats().dropped, 0);
+
+    release_prom.set_value();
+    sink.flush();
+
+    const auto stats = sink.stats();
+    EXPECT_EQ(stats.written + stats.dropped, 100);
+
+    std::lock_guard<std::mutex> lock(output_mutex);
+    EXPECT_NE(output.find("log messages"), std::string::npos);
+}
+
+TEST(AsyncLogSink, BinaryRecords)
+{
+    std::string output;
+    {
+        AsyncLogSink sink(AsyncLogSink::Mode::Binary, [&](const char* data, size_t len) {
+            output.append(data, len);
+        });
+        sink.push(log::Level::Warn, "some_file.cpp", 42, "hello");
+        sink.flush();
+    }
+
+    ASSERT_GE(output.size(), sizeof(AsyncLogSink::BINARY_MAGIC));
+    EXPECT_EQ(
+        std::memcmp(
+            output.data(), AsyncLogSink::BINARY_MAGIC, sizeof(AsyncLogSink::BINARY_MAGIC)),
+        0);
+
+    size_t offset = sizeof(AsyncLogSink::BINARY_MAGIC);
+    ASSERT_GE(output.size(), offset + AsyncLogSink::BinaryRecordHeader::SERIALIZED_SIZE);
+
+    // The line number is little-endian right after the timestamp, regardless of the platform.
+    EXPECT_EQ(output[offset + 8], 42);
+    EXPECT_EQ(output[offset + 9], 0);
+
+    const auto header = AsyncLogSink::BinaryRecordHeader::deserialize(output.data() + offset);
+    offset += AsyncLogSink::BinaryRecordHeader::SERIALIZED_SIZE;
+
+    EXPECT_EQ(header.level, static_cast<uint8_t>(log::Level::Warn));
+    EXPECT_EQ(header.line, 42);
+    ASSERT_EQ(output.size(), offset + header.filename_len + header.message_len);
+    EXPECT_EQ(output.substr(offset, header.filename_len), "some_file.cpp");
+    EXPECT_EQ(output.substr(offset + header.filename_len, header.message_len), "hello");
+}
+
+TEST(AsyncLogSink, ManyThreads)
+{
+    std::atomic<size_t> bytes_written{0};
+    AsyncLogSink sink(AsyncLogSink::Mode::Text, [&](const char*, size_t len) {
+        bytes_written += len;
+    });
+
+    constexpr int num_threads = 4;
+    constexpr int lines_per_thread = 200;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&sink]() {
+            for (int i = 0; i < lines_per_thread; ++i) {
+                sink.push(log::Level::Debug, "file.cpp", i, "message");
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    sink.flush();
+
+    const auto stats = sink.stats();
+    EXPECT_EQ(stats.written + stats.dropped, num_threads * lines_per_thread);
+    EXPECT_GT(bytes_written, 0);
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests.
+//
+// Compares the synchronous path (mutex held, formatting and writing on the caller) with pushing
+// into the sink: first the cost on the calling threads, then the receive throughput of a thread
+// logging every message it processes, e.g. with MAVSDK_MESSAGE_DEBUGGING, while the output is as
+// slow as a terminal.
+TEST(AsyncLogSink, DISABLED_Throughput)
+{
+    constexpr int num_threads = 4;
+    constexpr int lines_per_thread = 20000;
+
+    std::mutex sync_mutex;
+    std::ostringstream sync_out;
+
+    auto run = [&](const std::function<void(int)>& log_line) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < lines_per_thread; ++i) {
+                    log_line(i);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+        return (num_threads * lines_per_thread) / elapsed.count();
+    };
+
+    const double sync_rate = run([&](int i) {
+        std::stringstream ss;
+        ss << "Processing message " << i << " from 1/1";
+        std::lock_guard<std::mutex> lock(sync_mutex);
+        sync_out << "[00:00:00|Debug] " << ss.str() << " (file.cpp:1)" << std::endl;
+    });
+
+    {
+        size_t async_bytes = 0;
+        AsyncLogSink sink(
+            AsyncLogSink::Mode::Text,
+            [&](const char*, size_t len) { async_bytes += len; },
+            lines_per_thread);
+
+        const double async_rate = run([&](int i) {
+            std::stringstream ss;
+            ss << "Processing message " << i << " from 1/1";
+            sink.push(log::Level::Debug, "file.cpp", 1, ss.str());
+        });
+        sink.flush();
+
+        EXPECT_EQ(sink.stats().written + sink.stats().dropped, num_threads * lines_per_thread);
+
+        ::testing::Test::RecordProperty("sync_calls_per_s", static_cast<int>(sync_rate));
+        ::testing::Test::RecordProperty("async_calls_per_s", static_cast<int>(async_rate));
+    }
+
+    // A terminal taking about 20 us per write.
+    auto slow_write = [](size_t len) {
+        std::this_thread::sleep_for(std::chrono::microseconds(20 + len / 1000));
+    };
+
+    // Receives messages for a while, logging each one, and returns the messages per second.
+    constexpr auto receive_duration = std::chrono::milliseconds(500);
+    auto receive = [&](const std::function<void(int)>& log_line) {
+        int num_received = 0;
+        const auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < receive_duration) {
+            log_line(num_received++);
+        }
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+        return num_received / elapsed.count();
+    };
+
+    const double sync_receive_rate = receive([&](int i) {
+        std::stringstream ss;
+        ss << "[00:00:00|Debug] Processing message " << i << " from 1/1 (file.cpp:1)\n";
+        std::lock_guard<std::mutex> lock(sync_mutex);
+        slow_write(ss.str().size());
+    });
+
+    uint64_t async_dropped = 0;
+    const double async_receive_rate = [&]() {
+        AsyncLogSink sink(AsyncLogSink::Mode::Text, [&](const char*, size_t len) {
+            slow_write(len);
+        });
+        const double rate = receive([&](int i) {
+            std::stringstream ss;
+            ss << "Processing message " << i << " from 1/1";
+            sink.push(log::Level::Debug, "file.cpp", 1, ss.str());
+        });
+        sink.flush();
+        async_dropped = sink.stats().dropped;
+        return rate;
+    }();
+
+    // Without a writer to wait for, receiving is not limited by the output.
+    EXPECT_GT(async_receive_rate, sync_receive_rate);
+
+    ::testing::Test::RecordProperty(
+        "sync_received_per_s", static_cast<int>(sync_receive_rate));
+    ::testing::Test::RecordProperty(
+        "async_received_per_s", static_cast<int>(async_receive_rate));
+    ::testing::Test::RecordProperty("async_dropped", static_cast<int>(async_dropped));
+}
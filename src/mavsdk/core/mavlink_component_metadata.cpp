@@ -45,10 +45,18 @@ MavlinkComponentMetadata::MavlinkComponentMetadata(SystemImpl& system_impl) :
         std::error_code err;
         std::filesystem::create_directory(_tmp_download_path, err);
     }
+
+    _work_thread = std::thread{&MavlinkComponentMetadata::work_thread, this};
 }
 
 MavlinkComponentMetadata::~MavlinkComponentMetadata()
 {
+    _should_exit = true;
+    _work_queue.stop();
+    if (_work_thread.joinable()) {
+        _work_thread.join();
+    }
+
     std::error_code ec;
     std::filesystem::remove_all(_tmp_download_path, ec);
     if (ec) {
@@ -109,7 +117,75 @@ void MavlinkComponentMetadata::receive_component_metadata(
         COMP_METADATA_TYPE_GENERAL,
         MetadataComponent{{component_metadata.uri, component_metadata.file_crc}}));
 
-    retrieve_metadata(message.compid, COMP_METADATA_TYPE_GENERAL);
+    queue_retrieval(message.compid, COMP_METADATA_TYPE_GENERAL);
+    start_queued_retrievals();
+}
+
+void MavlinkComponentMetadata::post(std::function<void()> job)
+{
+    _work_queue.push_back(std::make_shared<std::function<void()>>(std::move(job)));
+}
+
+void MavlinkComponentMetadata::work_thread()
+{
+    while (!_should_exit) {
+        std::shared_ptr<std::function<void()>> job;
+        {
+            // Don't hold the queue while working, jobs post further jobs.
+            LockedQueue<std::function<void()>>::Guard work_queue_guard(_work_queue);
+            job = work_queue_guard.wait_and_pop_front();
+        }
+
+        if (!job) {
+            // Queue was stopped or should exit
+            break;
+        }
+
+        (*job)();
+    }
+}
+
+int MavlinkComponentMetadata::retrieval_priority(uint8_t compid, COMP_METADATA_TYPE type)
+{
+    // The general metadata is needed to know about the other types, then parameters are
+    // needed first by most users, events next.
+    int priority;
+    switch (type) {
+        case COMP_METADATA_TYPE_GENERAL:
+            priority = 0;
+            break;
+        case COMP_METADATA_TYPE_PARAMETER:
+            priority = 1;
+            break;
+        case COMP_METADATA_TYPE_EVENTS:
+            priority = 2;
+            break;
+        default:
+            priority = 3;
+            break;
+    }
+    // Within a type, the autopilot goes first.
+    return priority * 2 + (compid == MAV_COMP_ID_AUTOPILOT1 ? 0 : 1);
+}
+
+void MavlinkComponentMetadata::queue_retrieval(uint8_t compid, COMP_METADATA_TYPE type)
+{
+    const std::lock_guard lg{_mavlink_components_mutex};
+    if (_mavlink_components[compid].started_types.insert(type).second) {
+        _queued_retrievals.emplace(retrieval_priority(compid, type), compid, type);
+    }
+}
+
+void MavlinkComponentMetadata::start_queued_retrievals()
+{
+    const std::lock_guard lg{_mavlink_components_mutex};
+    while (_active_retrievals < MAX_PARALLEL_RETRIEVALS && !_queued_retrievals.empty()) {
+        const auto [priority, compid, type] = *_queued_retrievals.begin();
+        UNUSED(priority);
+        _queued_retrievals.erase(_queued_retrievals.begin());
+        ++_active_retrievals;
+        post([this, compid = compid, type = type]() { retrieve_metadata(compid, type); });
+    }
 }
 
 std::string MavlinkComponentMetadata::get_file_cache_tag(
@@ -186,89 +262,61 @@ void MavlinkComponentMetadata::retrieve_metadata(uint8_t compid, COMP_METADATA_T
             uint8_t target_compid = compid;
 
             if (uri_is_mavlinkftp(uri, download_path, target_compid)) {
-                // Create compid-specific tmp subdir, to ensure multiple components don't overwrite
-                // files from each other
-                const std::filesystem::path tmp_download_path =
-                    _tmp_download_path / std::to_string(compid);
-                if (!std::filesystem::exists(tmp_download_path)) {
-                    std::error_code err;
-                    std::filesystem::create_directory(tmp_download_path, err);
+                const std::filesystem::path local_path = tmp_file_path(
+                    compid, type, std::filesystem::path(download_path).filename().string());
+
+                const bool started = _system_impl.mavlink_ftp_client().download_to_memory_async(
+                    download_path,
+                    [this, local_path, compid, type, file_cache_tag](
+                        MavlinkFtpClient::ClientResult download_result,
+                        std::vector<uint8_t> data) {
+                        if (_verbose_debugging) {
+                            LogDebug() << "File download ended with result " << download_result;
+                        }
+                        // TODO: detect slow link (e.g. telemetry), and cancel download
+                        // (fallback to http) e.g. by estimating the remaining download
+                        // time, and cancel if >40s
+                        std::optional<std::string> content;
+                        if (download_result == MavlinkFtpClient::ClientResult::Success) {
+                            content.emplace(data.begin(), data.end());
+                        }
+                        post([this, compid, type, content, local_path, file_cache_tag]() {
+                            on_download_finished(compid, type, content, local_path, file_cache_tag);
+                        });
+                    },
+                    target_compid);
+
+                if (!started) {
+                    LogWarn() << "Could not start download of " << uri;
+                    // Move on to the next uri or type
+                    retrieve_metadata(compid, type);
                 }
 
-                const std::filesystem::path local_path =
-                    tmp_download_path / std::filesystem::path(download_path).filename();
-
-                _system_impl.call_user_callback([this,
-                                                 download_path,
-                                                 tmp_download_path,
-                                                 &component,
-                                                 target_compid,
-                                                 local_path,
-                                                 compid,
-                                                 type,
-                                                 file_cache_tag]() {
-                    _system_impl.mavlink_ftp_client().download_async(
-                        download_path,
-                        tmp_download_path.string(),
-                        true,
-                        [this, &component, local_path, compid, type, file_cache_tag](
-                            MavlinkFtpClient::ClientResult download_result,
-                            MavlinkFtpClient::ProgressData progress_data) {
-                            if (download_result == MavlinkFtpClient::ClientResult::Next) {
-                                if (_verbose_debugging) {
-                                    LogDebug() << "File download progress: "
-                                               << progress_data.bytes_transferred << '/'
-                                               << progress_data.total_bytes;
-                                }
-                                // TODO: detect slow link (e.g. telemetry), and cancel download
-                                // (fallback to http) e.g. by estimating the remaining download
-                                // time, and cancel if >40s
-                            } else {
-                                if (_verbose_debugging) {
-                                    LogDebug()
-                                        << "File download ended with result " << download_result;
-                                }
-                                if (download_result == MavlinkFtpClient::ClientResult::Success) {
-                                    component.current_metadata_path() =
-                                        extract_and_cache_file(local_path, file_cache_tag);
-                                }
-                                // Move on to the next uri or type
-                                retrieve_metadata(compid, type);
-                            }
-                        },
-                        target_compid);
-                });
-
             } else {
                 // http(s) download
 #if BUILD_WITHOUT_CURL == 1
                 LogErr() << "HTTP disabled at build time, skipping download of " << uri;
                 retrieve_metadata(compid, type);
 #else
-                const std::string base_filename = filename_from_uri(uri);
-                const std::filesystem::path tmp_download_path =
-                    _tmp_download_path / ("http-" + std::to_string(compid) + "-" +
-                                          std::to_string(type) + "-" + base_filename);
-                _http_loader.download_async(
+                const std::filesystem::path local_path =
+                    tmp_file_path(compid, type, "http-" + filename_from_uri(uri));
+                _http_loader.download_text_async(
                     uri,
-                    tmp_download_path.string(),
-                    [this, &component, tmp_download_path, compid, type, file_cache_tag](
-                        int progress, HttpStatus status, CURLcode curl_code) -> int {
-                        UNUSED(progress);
-                        if (status == HttpStatus::Error) {
-                            LogErr() << "File download failed with result " << curl_code;
-                            // Move on to the next uri or type
-                            retrieve_metadata(compid, type);
-                        } else if (status == HttpStatus::Finished) {
-                            if (_verbose_debugging) {
-                                LogDebug() << "File download finished " << tmp_download_path;
-                            }
-                            component.current_metadata_path() =
-                                extract_and_cache_file(tmp_download_path, file_cache_tag);
-                            // Move on to the next uri or type
-                            retrieve_metadata(compid, type);
+                    [this, local_path, compid, type, file_cache_tag](
+                        bool success, const std::string& content) {
+                        if (!success) {
+                            LogErr() << "File download failed " << local_path.filename();
+                        } else if (_verbose_debugging) {
+                            LogDebug() << "File download finished " << local_path.filename();
                         }
-                        return 0;
+                        std::optional<std::string> maybe_content;
+                        if (success) {
+                            maybe_content = content;
+                        }
+                        post([this, compid, type, maybe_content, local_path, file_cache_tag]() {
+                            on_download_finished(
+                                compid, type, maybe_content, local_path, file_cache_tag);
+                        });
                     });
 #endif
             }
@@ -279,6 +327,36 @@ void MavlinkComponentMetadata::retrieve_metadata(uint8_t compid, COMP_METADATA_T
     }
 }
 
+void MavlinkComponentMetadata::on_download_finished(
+    uint8_t compid,
+    COMP_METADATA_TYPE type,
+    const std::optional<std::string>& data,
+    const std::filesystem::path& path,
+    const std::string& file_cache_tag)
+{
+    // Extract without holding the lock, so metadata can be queried meanwhile.
+    std::optional<std::filesystem::path> extracted_path;
+    if (data) {
+        extracted_path = extract_and_cache_file(data.value(), path, file_cache_tag);
+    }
+
+    const std::lock_guard lg{_mavlink_components_mutex};
+    if (data) {
+        _mavlink_components[compid].components[type].current_metadata_path() = extracted_path;
+    }
+    // Move on to the next uri or type
+    retrieve_metadata(compid, type);
+}
+
+std::filesystem::path MavlinkComponentMetadata::tmp_file_path(
+    uint8_t compid, COMP_METADATA_TYPE type, const std::string& filename) const
+{
+    // Include compid and type, to ensure downloads running at the same time don't overwrite
+    // files from each other
+    return _tmp_download_path /
+           (std::to_string(compid) + "-" + std::to_string(type) + "-" + filename);
+}
+
 void MavlinkComponentMetadata::handle_metadata_type_completed(
     uint8_t compid, COMP_METADATA_TYPE type)
 {
@@ -306,16 +384,20 @@ void MavlinkComponentMetadata::handle_metadata_type_completed(
         }
     }
 
-    // Retrieve next remaining metadata type
+    assert(_active_retrievals > 0);
+    --_active_retrievals;
+
+    // Retrieve the remaining metadata types, the general metadata might just have added them
     bool all_completed = true;
     for (const auto& [next_type, next_component] : _mavlink_components[compid].components) {
         if (!next_component.is_completed()) {
-            retrieve_metadata(compid, next_type);
+            queue_retrieval(compid, next_type);
             all_completed = false;
-            break;
         }
     }
-    if (all_completed) {
+    start_queued_retrievals();
+
+    if (all_completed && !_mavlink_components[compid].result) {
         LogDebug() << "All metadata types completed for compid " << static_cast<int>(compid);
         _mavlink_components[compid].result = Result::Success;
         on_all_types_completed(compid);
@@ -323,18 +405,28 @@ void MavlinkComponentMetadata::handle_metadata_type_completed(
 }
 
 std::optional<std::filesystem::path> MavlinkComponentMetadata::extract_and_cache_file(
-    const std::filesystem::path& path, const std::string& file_cache_tag)
+    const std::string& data, const std::filesystem::path& path, const std::string& file_cache_tag)
 {
     std::filesystem::path returned_path = path;
-    // Decompress if needed
+    // Decompress if needed, in memory, so only the extracted file is written
+    std::string extracted;
+    const std::string* content = &data;
     if (path.extension() == ".lzma" || path.extension() == ".xz") {
         returned_path.replace_extension(".extracted");
-        if (InflateLZMA::inflateLZMAFile(path, returned_path)) {
-            std::filesystem::remove(path);
-        } else {
+        if (!InflateLZMA::inflateLZMA(data, extracted)) {
             LogErr() << "Inflate of compressed json failed " << path;
             return std::nullopt;
         }
+        content = &extracted;
+    }
+
+    {
+        std::ofstream file(returned_path, std::ios::binary | std::ios::trunc);
+        file.write(content->data(), static_cast<std::streamsize>(content->size()));
+        if (!file) {
+            LogErr() << "Writing json failed " << returned_path;
+            return std::nullopt;
+        }
     }
 
     if (_file_cache && !file_cache_tag.empty()) {
@@ -570,19 +662,15 @@ bool MetadataComponent::get_next_uri(
             case State::TranslationFallback:
                 // Read files if available
                 if (_metadata) {
-                    std::ifstream file(*_metadata);
+                    const auto file = FileCache::MappedFile::open(*_metadata);
                     if (file) {
-                        std::stringstream buffer;
-                        buffer << file.rdbuf();
-                        _json_metadata.emplace(buffer.str());
+                        _json_metadata.emplace(file->data());
                     }
                 }
                 if (_translation) {
-                    std::ifstream file(*_translation);
+                    const auto file = FileCache::MappedFile::open(*_translation);
                     if (file) {
-                        std::stringstream buffer;
-                        buffer << file.rdbuf();
-                        _json_translation.emplace(buffer.str());
+                        _json_translation.emplace(file->data());
                     }
                 }
                 _state = State::Done;
@@ -2,6 +2,7 @@
 
 #include "callback_list.h"
 #include "file_cache.h"
+#include "locked_queue.h"
 #include "mavlink_command_sender.h"
 #include <json/json.h>
 
@@ -9,9 +10,14 @@
 #include "http_loader.h"
 #endif
 
+#include <atomic>
+#include <functional>
 #include <optional>
 #include <set>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 namespace mavsdk {
 
@@ -133,19 +139,39 @@ public:
     uri_is_mavlinkftp(const std::string& uri, std::string& download_path, uint8_t& target_compid);
     static std::string filename_from_uri(const std::string& uri);
 
+    // Number of metadata types which are downloaded at the same time, across all components.
+    static constexpr size_t MAX_PARALLEL_RETRIEVALS = 3;
+
 private:
     struct MavlinkComponent {
         std::map<COMP_METADATA_TYPE, MetadataComponent> components;
+        std::set<COMP_METADATA_TYPE> started_types; ///< queued or being retrieved
         std::optional<Result> result{}; ///< set once all types completed
     };
 
+    // Ordered by priority, then component ID and type.
+    using QueuedRetrieval = std::tuple<int, uint8_t, COMP_METADATA_TYPE>;
+
     void receive_component_metadata(
         MavlinkCommandSender::Result result, const mavlink_message_t& message);
+    void queue_retrieval(uint8_t compid, COMP_METADATA_TYPE type);
+    void start_queued_retrievals();
+    static int retrieval_priority(uint8_t compid, COMP_METADATA_TYPE type);
     void retrieve_metadata(uint8_t compid, COMP_METADATA_TYPE type);
+    void on_download_finished(
+        uint8_t compid,
+        COMP_METADATA_TYPE type,
+        const std::optional<std::string>& data,
+        const std::filesystem::path& path,
+        const std::string& file_cache_tag);
+    std::filesystem::path
+    tmp_file_path(uint8_t compid, COMP_METADATA_TYPE type, const std::string& filename) const;
     static std::string
     get_file_cache_tag(uint8_t compid, int comp_info_type, uint32_t crc, bool is_translation);
-    std::optional<std::filesystem::path>
-    extract_and_cache_file(const std::filesystem::path& path, const std::string& file_cache_tag);
+    std::optional<std::filesystem::path> extract_and_cache_file(
+        const std::string& data,
+        const std::filesystem::path& path,
+        const std::string& file_cache_tag);
     void on_all_types_completed(uint8_t compid);
 
     void handle_metadata_type_completed(uint8_t compid, COMP_METADATA_TYPE type);
@@ -153,6 +179,9 @@ private:
 
     static std::optional<MetadataType> get_metadata_type(COMP_METADATA_TYPE type);
 
+    void post(std::function<void()> job);
+    void work_thread();
+
     SystemImpl& _system_impl;
 
     std::mutex _notification_callbacks_mutex{}; ///< Protects access to _notification_callbacks
@@ -162,10 +191,18 @@ private:
         _translation_locale{}; ///< optional locale in the form of "language_country", e.g. de_DE
     std::recursive_mutex _mavlink_components_mutex{}; ///< Protects access to _mavlink_components
     std::map<uint8_t, MavlinkComponent> _mavlink_components{};
+    std::set<QueuedRetrieval> _queued_retrievals{};
+    size_t _active_retrievals{0};
     std::optional<FileCache> _file_cache{};
     std::filesystem::path _tmp_download_path{};
     bool _verbose_debugging{false};
 
+    // Decompression, caching and parsing is done here, rather than on the thread of the
+    // download, so that the next download isn't held up.
+    LockedQueue<std::function<void()>> _work_queue{};
+    std::thread _work_thread{};
+    std::atomic<bool> _should_exit{false};
+
 #if BUILD_WITHOUT_CURL != 1
     HttpLoader _http_loader;
 #endif
@@ -0,0 +1,10 @@
+#include "mavlink_frame.h"
+
+namespace mavsdk {
+
+MavlinkFrame::MavlinkFrame(const mavlink_message_t& message) :
+    _size(mavlink_msg_to_send_buffer(_bytes.data(), &message)),
+    _message_id(message.msgid)
+{}
+
+} // namespace mavsdk
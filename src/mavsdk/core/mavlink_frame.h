@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "mavlink_include.h"
+
+namespace mavsdk {
+
+// A message encoded for sending.
+//
+// The frame is immutable, so it can be shared by all connections the message is sent or
+// forwarded on, and the message only needs to be encoded once.
+class MavlinkFrame {
+public:
+    explicit MavlinkFrame(const mavlink_message_t& message);
+
+    [[nodiscard]] const char* data() const { return reinterpret_cast<const char*>(_bytes.data()); }
+    [[nodiscard]] size_t size() const { return _size; }
+    [[nodiscard]] uint32_t message_id() const { return _message_id; }
+
+private:
+    std::array<uint8_t, MAVLINK_MAX_PACKET_LEN> _bytes{};
+    uint16_t _size{0};
+    uint32_t _message_id{0};
+};
+
+using MavlinkFramePtr = std::shared_ptr<const MavlinkFrame>;
+
+inline MavlinkFramePtr make_mavlink_frame(const mavlink_message_t& message)
+{
+    return std::make_shared<const MavlinkFrame>(message);
+}
+
+} // namespace mavsdk
@@ -3,10 +3,14 @@
 #include "overloaded.h"
 #include "unused.h"
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <filesystem>
 #include <algorithm>
+#include <iterator>
 #include <numeric>
+#include <random>
+#include <system_error>
 
 #include "crc32.h"
 
@@ -1123,14 +1127,133 @@ void MavlinkFtpClient::download_async(
     }
 }
 
+static std::optional<fs::path> make_temp_folder_path()
+{
+    // Transfers are done from and to files, so in-memory transfers go through a temporary
+    // folder of their own, unique per process and transfer.
+    static const auto process_id = std::random_device{}();
+    static std::atomic<unsigned> transfer_count{0};
+    std::error_code ec;
+    const auto temp_folder =
+        fs::temp_directory_path(ec) / ("mavsdk-ftp-" + std::to_string(process_id) + "-" +
+                                       std::to_string(transfer_count++));
+    if (ec) {
+        LogErr() << "No temporary directory for transfer: " << ec.message();
+        return {};
+    }
+    return temp_folder;
+}
+
+bool MavlinkFtpClient::download_to_memory_async(
+    const std::string& remote_path,
+    DownloadToMemoryCallback callback,
+    std::optional<uint8_t> maybe_target_compid)
+{
+    const auto maybe_temp_folder = make_temp_folder_path();
+    if (!maybe_temp_folder) {
+        return false;
+    }
+    const auto temp_folder = maybe_temp_folder.value();
+
+    const auto local_path = temp_folder / fs::path(remote_path).filename();
+
+    download_async(
+        remote_path,
+        temp_folder.string(),
+        true,
+        [temp_folder, local_path, callback](ClientResult result, ProgressData) {
+            if (result == ClientResult::Next) {
+                return;
+            }
+
+            std::vector<uint8_t> data;
+            if (result == ClientResult::Success) {
+                std::ifstream file(local_path, std::ios::binary);
+                data.assign(
+                    std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                if (file.bad()) {
+                    result = ClientResult::FileIoError;
+                    data.clear();
+                }
+            }
+
+            std::error_code remove_ec;
+            fs::remove_all(temp_folder, remove_ec);
+
+            if (callback) {
+                callback(result, std::move(data));
+            }
+        },
+        maybe_target_compid);
+    return true;
+}
+
+std::function<void()> MavlinkFtpClient::upload_from_memory_async(
+    const std::string& remote_path,
+    const std::vector<uint8_t>& data,
+    UploadFromMemoryCallback callback,
+    std::optional<uint8_t> maybe_target_compid)
+{
+    const auto maybe_temp_folder = make_temp_folder_path();
+    if (!maybe_temp_folder) {
+        return {};
+    }
+    const auto temp_folder = maybe_temp_folder.value();
+
+    // The remote file gets the name of the local one.
+    const auto local_path = temp_folder / fs::path(remote_path).filename();
+
+    std::error_code ec;
+    fs::create_directories(temp_folder, ec);
+    {
+        std::ofstream file(local_path, std::ios::binary);
+        file.write(
+            reinterpret_cast<const char*>(data.data()),
+            static_cast<std::streamsize>(data.size()));
+        if (ec || !file) {
+            LogErr() << "Could not write " << local_path << " for upload";
+            fs::remove_all(temp_folder, ec);
+            return {};
+        }
+    }
+
+    upload_async(
+        local_path.string(),
+        fs::path(remote_path).parent_path().string(),
+        [temp_folder, callback](ClientResult result, ProgressData) {
+            if (result == ClientResult::Next) {
+                return;
+            }
+
+            std::error_code remove_ec;
+            fs::remove_all(temp_folder, remove_ec);
+
+            if (callback) {
+                callback(result);
+            }
+        },
+        maybe_target_compid);
+
+    const auto local_file_path = local_path.string();
+    return [this, temp_folder, local_file_path]() {
+        cancel_upload(local_file_path);
+        std::error_code remove_ec;
+        fs::remove_all(temp_folder, remove_ec);
+    };
+}
+
 void MavlinkFtpClient::upload_async(
-    const std::string& local_file_path, const std::string& remote_folder, UploadCallback callback)
+    const std::string& local_file_path,
+    const std::string& remote_folder,
+    UploadCallback callback,
+    std::optional<uint8_t> maybe_target_compid)
 {
     auto item = UploadItem{};
     item.local_file_path = local_file_path;
     item.remote_folder = remote_folder;
     item.callback = callback;
-    auto new_work = Work{std::move(item), get_target_component_id()};
+    auto new_work =
+        Work{std::move(item), maybe_target_compid.value_or(get_target_component_id())};
 
     _work_queue.push_back(std::make_shared<Work>(std::move(new_work)));
 }
@@ -1490,6 +1613,27 @@ std::ostream& operator<<(std::ostream& str, MavlinkFtpClient::ClientResult const
     }
 }
 
+void MavlinkFtpClient::cancel_upload(const std::string& local_file_path)
+{
+    LockedQueue<Work>::Guard work_queue_guard(_work_queue);
+    const auto front = work_queue_guard.get_front();
+
+    for (auto it = _work_queue.begin(); it != _work_queue.end(); ++it) {
+        const auto* item = std::get_if<UploadItem>(&(*it)->item);
+        if (item == nullptr || item->local_file_path != local_file_path) {
+            continue;
+        }
+
+        if (*it == front && (*it)->started) {
+            // The remote file stays incomplete.
+            stop_timer();
+            terminate_session(**it);
+        }
+        _work_queue.erase(it);
+        return;
+    }
+}
+
 void MavlinkFtpClient::cancel_all_operations()
 {
     // Stop any pending timeout timers
@@ -65,6 +65,8 @@ public:
     using ListDirectoryCallback =
         std::function<void(ClientResult, std::vector<std::string>, std::vector<std::string>)>;
     using AreFilesIdenticalCallback = std::function<void(ClientResult, bool)>;
+    using DownloadToMemoryCallback = std::function<void(ClientResult, std::vector<uint8_t>)>;
+    using UploadFromMemoryCallback = std::function<void(ClientResult)>;
 
     void do_work();
 
@@ -75,10 +77,25 @@ public:
         bool use_burst,
         DownloadCallback callback,
         std::optional<uint8_t> maybe_target_compid = {});
+    // Burst download of a file which is only needed in memory, e.g. to be parsed.
+    // Returns false, without calling the callback, if the download can't be started.
+    bool download_to_memory_async(
+        const std::string& remote_file_path,
+        DownloadToMemoryCallback callback,
+        std::optional<uint8_t> maybe_target_compid = {});
+    // Upload of data which is only in memory, e.g. encoded before.
+    // Returns a function to cancel the upload, after which the callback is not called anymore,
+    // or nothing, without calling the callback, if the upload can't be started.
+    std::function<void()> upload_from_memory_async(
+        const std::string& remote_file_path,
+        const std::vector<uint8_t>& data,
+        UploadFromMemoryCallback callback,
+        std::optional<uint8_t> maybe_target_compid = {});
     void upload_async(
         const std::string& local_file_path,
         const std::string& remote_folder,
-        UploadCallback callback);
+        UploadCallback callback,
+        std::optional<uint8_t> maybe_target_compid = {});
     void list_directory_async(const std::string& path, ListDirectoryCallback callback);
     void create_directory_async(const std::string& path, ResultCallback callback);
     void remove_directory_async(const std::string& path, ResultCallback callback);
@@ -94,6 +111,10 @@ public:
     uint8_t get_our_compid();
     ClientResult set_target_compid(uint8_t component_id);
 
+    // Cancels an upload, its callback is not called anymore. If it has started already, the
+    // session is terminated and the remote file is left incomplete.
+    void cancel_upload(const std::string& local_file_path);
+
     void cancel_all_operations();
 
 private:
@@ -0,0 +1,149 @@
+#include "mavlink_mission_dat.h"
+#include "log.h"
+
+#include <cstring>
+#include <limits>
+
+namespace mavsdk {
+
+namespace {
+
+constexpr uint16_t MAGIC = 0x763d;
+constexpr size_t HEADER_LEN = 10;
+constexpr size_t ITEM_LEN = 38;
+
+uint16_t read_u16(const uint8_t* data)
+{
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+uint32_t read_u32(const uint8_t* data)
+{
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+float read_float(const uint8_t* data)
+{
+    const uint32_t bits = read_u32(data);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void append_le(std::vector<uint8_t>& data, uint32_t value, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        data.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void append_float(std::vector<uint8_t>& data, float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    append_le(data, bits, 4);
+}
+
+} // namespace
+
+std::string MavlinkMissionDat::remote_path(uint8_t mission_type)
+{
+    switch (mission_type) {
+        case MAV_MISSION_TYPE_MISSION:
+            return "@MISSION/mission.dat";
+        case MAV_MISSION_TYPE_FENCE:
+            return "@MISSION/fence.dat";
+        case MAV_MISSION_TYPE_RALLY:
+            return "@MISSION/rally.dat";
+        default:
+            return {};
+    }
+}
+
+bool MavlinkMissionDat::decode(
+    const std::vector<uint8_t>& data, uint8_t mission_type, std::vector<ItemInt>& items)
+{
+    if (data.size() < HEADER_LEN || read_u16(&data[0]) != MAGIC) {
+        LogWarn() << "Mission file invalid";
+        return false;
+    }
+
+    const uint16_t type = read_u16(&data[2]);
+    const uint16_t start = read_u16(&data[6]);
+    const uint16_t num_items = read_u16(&data[8]);
+
+    if (type != mission_type || start != 0) {
+        LogWarn() << "Mission file of unexpected type " << type << " or start " << start;
+        return false;
+    }
+
+    if (data.size() != HEADER_LEN + num_items * ITEM_LEN) {
+        LogWarn() << "Mission file size " << data.size() << " does not match " << num_items
+                  << " items";
+        return false;
+    }
+
+    items.clear();
+    items.reserve(num_items);
+
+    for (size_t i = 0; i < num_items; ++i) {
+        const uint8_t* item = &data[HEADER_LEN + i * ITEM_LEN];
+        // The sequence is given by the position in the file.
+        items.push_back(ItemInt{
+            static_cast<uint16_t>(i),
+            item[34], // frame
+            read_u16(&item[30]), // command
+            item[35], // current
+            item[36], // autocontinue
+            read_float(&item[0]),
+            read_float(&item[4]),
+            read_float(&item[8]),
+            read_float(&item[12]),
+            static_cast<int32_t>(read_u32(&item[16])),
+            static_cast<int32_t>(read_u32(&item[20])),
+            read_float(&item[24]),
+            mission_type});
+    }
+
+    return true;
+}
+
+std::vector<uint8_t> MavlinkMissionDat::encode(
+    uint8_t mission_type, uint8_t target_system_id, const std::vector<ItemInt>& items)
+{
+    std::vector<uint8_t> data;
+    if (items.size() > std::numeric_limits<uint16_t>::max()) {
+        return data;
+    }
+
+    data.reserve(HEADER_LEN + items.size() * ITEM_LEN);
+
+    append_le(data, MAGIC, 2);
+    append_le(data, mission_type, 2);
+    append_le(data, 0, 2); // options
+    append_le(data, 0, 2); // start
+    append_le(data, static_cast<uint32_t>(items.size()), 2);
+
+    for (const auto& item : items) {
+        append_float(data, item.param1);
+        append_float(data, item.param2);
+        append_float(data, item.param3);
+        append_float(data, item.param4);
+        append_le(data, static_cast<uint32_t>(item.x), 4);
+        append_le(data, static_cast<uint32_t>(item.y), 4);
+        append_float(data, item.z);
+        append_le(data, item.seq, 2);
+        append_le(data, item.command, 2);
+        data.push_back(target_system_id);
+        data.push_back(MAV_COMP_ID_AUTOPILOT1);
+        data.push_back(item.frame);
+        data.push_back(item.current);
+        data.push_back(item.autocontinue);
+        data.push_back(item.mission_type);
+    }
+
+    return data;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "mavlink_mission_transfer_client.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+// The mission, fence and rally files which ArduPilot provides over MAVLink FTP as
+// @MISSION/mission.dat, @MISSION/fence.dat and @MISSION/rally.dat, for reading and writing.
+//
+// A whole mission can be read or written with a few burst transfers instead of one round trip
+// per item. Layout (little endian):
+//
+//     uint16_t magic (0x763d)
+//     uint16_t mission_type (MAV_MISSION_TYPE)
+//     uint16_t options (0)
+//     uint16_t start (index of the first item, 0)
+//     uint16_t num_items
+//     num_items times the MISSION_ITEM_INT payload (38 bytes in wire order)
+class MavlinkMissionDat {
+public:
+    using ItemInt = MavlinkMissionTransferClient::ItemInt;
+
+    // Returns an empty string for unknown mission types.
+    static std::string remote_path(uint8_t mission_type);
+
+    // Returns false if the data is not a complete file of the given type.
+    static bool
+    decode(const std::vector<uint8_t>& data, uint8_t mission_type, std::vector<ItemInt>& items);
+
+    static std::vector<uint8_t> encode(
+        uint8_t mission_type, uint8_t target_system_id, const std::vector<ItemInt>& items);
+};
+
+} // namespace mavsdk
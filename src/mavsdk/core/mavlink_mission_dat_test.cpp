@@ -0,0 +1,96 @@
+#include "mavlink_mission_dat.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+using namespace mavsdk;
+
+using ItemInt = MavlinkMissionDat::ItemInt;
+
+namespace {
+
+// Home and one waypoint as ArduCopter provides them as @MISSION/mission.dat.
+const std::vector<uint8_t> recorded_mission_dat{
+    0x3d, 0x76, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1c, 0xa0,
+    0x35, 0x1c, 0xd6, 0xc5, 0x17, 0x05, 0x7b, 0x14, 0x6a, 0x44, 0x00, 0x00, 0x10, 0x00,
+    0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5c, 0xa2, 0x35, 0x1c, 0xec, 0xc7,
+    0x17, 0x05, 0x00, 0x00, 0x20, 0x41, 0x01, 0x00, 0x10, 0x00, 0x01, 0x01, 0x03, 0x00,
+    0x01, 0x00,
+};
+
+ItemInt make_item(uint8_t type, uint16_t sequence)
+{
+    return ItemInt{
+        sequence,
+        MAV_FRAME_GLOBAL_RELATIVE_ALT_INT,
+        MAV_CMD_NAV_WAYPOINT,
+        uint8_t(sequence == 0 ? 1 : 0),
+        1,
+        1.0f,
+        2.0f,
+        3.0f,
+        4.0f,
+        473977418 + sequence,
+        85455938 - sequence,
+        10.5f,
+        type};
+}
+
+} // namespace
+
+TEST(MavlinkMissionDat, DecodesRecordedFile)
+{
+    std::vector<ItemInt> items;
+    ASSERT_TRUE(MavlinkMissionDat::decode(recorded_mission_dat, MAV_MISSION_TYPE_MISSION, items));
+    ASSERT_EQ(items.size(), 2u);
+
+    EXPECT_EQ(items[0].seq, 0);
+    EXPECT_EQ(items[0].command, MAV_CMD_NAV_WAYPOINT);
+    EXPECT_EQ(items[0].frame, MAV_FRAME_GLOBAL);
+    EXPECT_EQ(items[0].x, 473276444);
+    EXPECT_EQ(items[0].y, 85444054);
+    EXPECT_EQ(items[0].z, 936.32f);
+
+    EXPECT_EQ(items[1].seq, 1);
+    EXPECT_EQ(items[1].frame, MAV_FRAME_GLOBAL_RELATIVE_ALT);
+    EXPECT_EQ(items[1].x, 473277020);
+    EXPECT_EQ(items[1].y, 85444588);
+    EXPECT_EQ(items[1].z, 10.0f);
+    EXPECT_EQ(items[1].mission_type, MAV_MISSION_TYPE_MISSION);
+}
+
+TEST(MavlinkMissionDat, RejectsInvalidFile)
+{
+    std::vector<ItemInt> items;
+
+    auto truncated = recorded_mission_dat;
+    truncated.pop_back();
+    EXPECT_FALSE(MavlinkMissionDat::decode(truncated, MAV_MISSION_TYPE_MISSION, items));
+
+    EXPECT_FALSE(MavlinkMissionDat::decode(recorded_mission_dat, MAV_MISSION_TYPE_FENCE, items));
+
+    auto wrong_magic = recorded_mission_dat;
+    wrong_magic[0] = 0;
+    EXPECT_FALSE(MavlinkMissionDat::decode(wrong_magic, MAV_MISSION_TYPE_MISSION, items));
+}
+
+TEST(MavlinkMissionDat, EncodesWhatItDecodes)
+{
+    std::vector<ItemInt> items;
+    for (uint16_t i = 0; i < 100; ++i) {
+        items.push_back(make_item(MAV_MISSION_TYPE_FENCE, i));
+    }
+
+    const auto data = MavlinkMissionDat::encode(MAV_MISSION_TYPE_FENCE, 1, items);
+    EXPECT_EQ(data.size(), 10u + 100u * 38u);
+
+    std::vector<ItemInt> decoded;
+    ASSERT_TRUE(MavlinkMissionDat::decode(data, MAV_MISSION_TYPE_FENCE, decoded));
+    EXPECT_EQ(decoded, items);
+
+    EXPECT_EQ(MavlinkMissionDat::encode(MAV_MISSION_TYPE_MISSION, 1, {}).size(), 10u);
+    EXPECT_EQ(MavlinkMissionDat::remote_path(MAV_MISSION_TYPE_FENCE), "@MISSION/fence.dat");
+}
@@ -1,5 +1,8 @@
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include "mavlink_mission_transfer_client.h"
+#include "mavlink_mission_dat.h"
 #include "log.h"
 #include "unused.h"
 
@@ -23,6 +26,16 @@ MavlinkMissionTransferClient::MavlinkMissionTransferClient(
             _debugging = true;
         }
     }
+
+    _message_handler.register_one(
+        MAVLINK_MSG_ID_MISSION_CURRENT,
+        [this](const mavlink_message_t& message) { process_mission_current(message); },
+        this);
+}
+
+MavlinkMissionTransferClient::~MavlinkMissionTransferClient()
+{
+    _message_handler.unregister_all(this);
 }
 
 std::weak_ptr<MavlinkMissionTransferClient::WorkItem>
@@ -48,11 +61,18 @@ MavlinkMissionTransferClient::upload_items_async(
         type,
         items,
         _timeout_s_callback(),
-        callback,
+        [this, type, items, callback](Result result) {
+            update_shadow(type, result, items);
+            if (callback) {
+                callback(result);
+            }
+        },
         progress_callback,
         _debugging,
         target_system_id,
-        _autopilot_callback());
+        _autopilot_callback(),
+        file_uploader(),
+        partial_upload(type, items));
 
     _work_queue.push_back(ptr);
 
@@ -80,16 +100,203 @@ MavlinkMissionTransferClient::download_items_async(
         _timeout_handler,
         type,
         _timeout_s_callback(),
-        callback,
+        [this, type, callback](Result result, std::vector<ItemInt> items) {
+            // A failed download doesn't change anything on the autopilot.
+            if (result == Result::Success) {
+                update_shadow(type, result, items);
+            }
+            if (callback) {
+                callback(result, std::move(items));
+            }
+        },
         progress_callback,
         _debugging,
-        target_system_id);
+        target_system_id,
+        file_downloader());
 
     _work_queue.push_back(ptr);
 
     return std::weak_ptr<WorkItem>(ptr);
 }
 
+void MavlinkMissionTransferClient::set_file_transfer(
+    FileDownloader file_downloader, FileUploader file_uploader)
+{
+    _file_downloader = std::move(file_downloader);
+    _file_uploader = std::move(file_uploader);
+}
+
+FileDownloader MavlinkMissionTransferClient::file_downloader()
+{
+    if (!_file_downloader) {
+        return {};
+    }
+
+    return [this](const std::string& remote_path, auto callback) {
+        if (_file_transfer_failed) {
+            return false;
+        }
+        return _file_downloader(
+            remote_path, [this, callback](bool success, std::vector<uint8_t> data) {
+                if (!success) {
+                    _file_transfer_failed = true;
+                }
+                callback(success, std::move(data));
+            });
+    };
+}
+
+FileUploader MavlinkMissionTransferClient::file_uploader()
+{
+    if (!_file_uploader) {
+        return {};
+    }
+
+    return [this](const std::string& remote_path, std::vector<uint8_t> data, auto callback)
+               -> FileTransferCancel {
+        if (_file_transfer_failed) {
+            return {};
+        }
+        return _file_uploader(remote_path, std::move(data), [this, callback](bool success) {
+            if (!success) {
+                _file_transfer_failed = true;
+            }
+            callback(success);
+        });
+    };
+}
+
+void MavlinkMissionTransferClient::set_partial_upload(std::function<bool()> enabled_callback)
+{
+    _partial_upload_enabled_callback = std::move(enabled_callback);
+}
+
+static bool is_same_param(float lhs, float rhs)
+{
+    // Unset params are commonly NaN.
+    return lhs == rhs || (std::isnan(lhs) && std::isnan(rhs));
+}
+
+static bool is_same_item(
+    const MavlinkMissionTransferClient::ItemInt& lhs,
+    const MavlinkMissionTransferClient::ItemInt& rhs)
+{
+    return lhs.seq == rhs.seq && lhs.frame == rhs.frame && lhs.command == rhs.command &&
+           lhs.current == rhs.current && lhs.autocontinue == rhs.autocontinue &&
+           is_same_param(lhs.param1, rhs.param1) && is_same_param(lhs.param2, rhs.param2) &&
+           is_same_param(lhs.param3, rhs.param3) && is_same_param(lhs.param4, rhs.param4) &&
+           lhs.x == rhs.x && lhs.y == rhs.y && is_same_param(lhs.z, rhs.z) &&
+           lhs.mission_type == rhs.mission_type;
+}
+
+std::optional<MavlinkMissionTransferClient::UploadWorkItem::PartialUpload>
+MavlinkMissionTransferClient::partial_upload(uint8_t type, const std::vector<ItemInt>& items)
+{
+    if (!_partial_upload_enabled_callback || !_partial_upload_enabled_callback() ||
+        _partial_upload_unsupported) {
+        return {};
+    }
+
+    // The indices of a partial write are int16_t.
+    if (items.size() > static_cast<std::size_t>(std::numeric_limits<int16_t>::max())) {
+        return {};
+    }
+
+    std::lock_guard<std::mutex> lock(_shadows_mutex);
+
+    auto it = _shadows.find(type);
+    // Only once the autopilot has reported the id of our items, otherwise we couldn't tell if
+    // someone else changed them in the meantime.
+    if (it == _shadows.end() || it->second.id == 0) {
+        return {};
+    }
+
+    // A partial write can only replace items, not change their number.
+    if (it->second.items.empty() || it->second.items.size() != items.size()) {
+        return {};
+    }
+
+    const auto& shadow = it->second.items;
+
+    std::size_t begin = 0;
+    while (begin < items.size() && is_same_item(shadow[begin], items[begin])) {
+        ++begin;
+    }
+
+    std::size_t end = items.size();
+    while (end > begin && is_same_item(shadow[end - 1], items[end - 1])) {
+        --end;
+    }
+
+    if (begin == 0 && end == items.size()) {
+        // Everything changed, a whole upload is at least as fast.
+        return {};
+    }
+
+    if (_debugging) {
+        LogDebug() << "Items " << begin << " to " << end << " of " << items.size()
+                   << " changed";
+    }
+
+    UploadWorkItem::PartialUpload partial{begin, end, nullptr};
+    partial.supported_callback = [this](bool supported) {
+        if (!supported) {
+            LogInfo() << "Partial mission upload not supported, uploading all items from now on";
+            _partial_upload_unsupported = true;
+        }
+    };
+    return partial;
+}
+
+void MavlinkMissionTransferClient::update_shadow(
+    uint8_t type, Result result, const std::vector<ItemInt>& items)
+{
+    std::lock_guard<std::mutex> lock(_shadows_mutex);
+
+    if (result == Result::Success) {
+        _shadows[type] = Shadow{items, 0};
+    } else {
+        // We don't know what is on the autopilot now.
+        _shadows.erase(type);
+    }
+}
+
+void MavlinkMissionTransferClient::process_mission_current(const mavlink_message_t& message)
+{
+    mavlink_mission_current_t mission_current;
+    mavlink_msg_mission_current_decode(&message, &mission_current);
+
+    check_shadow_id(MAV_MISSION_TYPE_MISSION, mission_current.mission_id);
+    check_shadow_id(MAV_MISSION_TYPE_FENCE, mission_current.fence_id);
+    check_shadow_id(MAV_MISSION_TYPE_RALLY, mission_current.rally_points_id);
+}
+
+void MavlinkMissionTransferClient::check_shadow_id(uint8_t type, uint32_t id)
+{
+    if (id == 0) {
+        // Not supported by the autopilot.
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_shadows_mutex);
+
+    auto it = _shadows.find(type);
+    if (it == _shadows.end()) {
+        return;
+    }
+
+    if (it->second.id == 0) {
+        // The first id after our own transfer.
+        it->second.id = id;
+    } else if (it->second.id != id) {
+        // Someone else changed the items in the meantime.
+        if (_debugging) {
+            LogDebug() << "Items of type " << static_cast<int>(type) << " changed";
+        }
+        _shadows.erase(it);
+    }
+}
+
 void MavlinkMissionTransferClient::clear_items_async(
     uint8_t type, uint8_t target_system_id, ResultCallback callback)
 {
@@ -99,7 +306,12 @@ void MavlinkMissionTransferClient::clear_items_async(
         _timeout_handler,
         type,
         _timeout_s_callback(),
-        callback,
+        [this, type, callback](Result result) {
+            update_shadow(type, result, {});
+            if (callback) {
+                callback(result);
+            }
+        },
         _debugging,
         target_system_id);
 
@@ -185,13 +397,17 @@ MavlinkMissionTransferClient::UploadWorkItem::UploadWorkItem(
     ProgressCallback progress_callback,
     bool debugging,
     uint8_t target_system_id,
-    Autopilot autopilot) :
+    Autopilot autopilot,
+    FileUploader file_uploader,
+    std::optional<PartialUpload> partial_upload) :
     WorkItem(sender, message_handler, timeout_handler, type, timeout_s, debugging),
     _items(items),
     _callback(callback),
     _progress_callback(progress_callback),
     _target_system_id(target_system_id),
-    _autopilot(autopilot)
+    _autopilot(autopilot),
+    _file_uploader(std::move(file_uploader)),
+    _partial_upload(std::move(partial_upload))
 {
     _message_handler.register_one(
         MAVLINK_MSG_ID_MISSION_REQUEST,
@@ -254,18 +470,144 @@ void MavlinkMissionTransferClient::UploadWorkItem::start()
 
     update_progress(0.0f);
 
+    if (_partial_upload) {
+        start_partial();
+        return;
+    }
+
+    if (upload_file()) {
+        return;
+    }
+
+    start_items();
+}
+
+bool MavlinkMissionTransferClient::UploadWorkItem::upload_file()
+{
+    if (!_file_uploader) {
+        return false;
+    }
+
+    const auto remote_path = MavlinkMissionDat::remote_path(_type);
+    auto data = MavlinkMissionDat::encode(_type, _target_system_id, _items);
+    if (remote_path.empty() || data.empty()) {
+        return false;
+    }
+
+    _step = Step::FileTransfer;
+
+    // The work item is gone if it was cancelled before the file transfer is done.
+    std::weak_ptr<WorkItem> weak_self = weak_from_this();
+    _cancel_file_upload =
+        _file_uploader(remote_path, std::move(data), [this, weak_self](bool success) {
+            if (auto self = weak_self.lock()) {
+                process_file_upload(success);
+            }
+        });
+    if (!_cancel_file_upload) {
+        _step = Step::SendCount;
+        return false;
+    }
+
+    if (_debugging) {
+        LogDebug() << "Uploading " << _items.size() << " items as " << remote_path;
+    }
+    return true;
+}
+
+void MavlinkMissionTransferClient::UploadWorkItem::process_file_upload(bool success)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_done || _step != Step::FileTransfer) {
+        return;
+    }
+
+    if (success) {
+        update_progress(1.0f);
+        callback_and_reset(Result::Success);
+        return;
+    }
+
+    LogWarn() << "Mission file upload failed, uploading items one by one";
+    start_items();
+}
+
+void MavlinkMissionTransferClient::UploadWorkItem::start_items()
+{
     _retries_done = 0;
     _step = Step::SendCount;
     _cookie = _timeout_handler.add([this]() { process_timeout(); }, _timeout_s);
 
+    _begin_sequence = 0;
+    _end_sequence = _items.size();
     _next_sequence = 0;
 
     send_count();
 }
 
+void MavlinkMissionTransferClient::UploadWorkItem::start_partial()
+{
+    _begin_sequence = _partial_upload->begin;
+    _end_sequence = _partial_upload->end;
+
+    if (_begin_sequence == _end_sequence) {
+        // Nothing changed since our last transfer, which the autopilot confirmed with its
+        // mission id, so there is nothing to write.
+        update_progress(1.0f);
+        callback_and_reset(Result::Success);
+        return;
+    }
+
+    _retries_done = 0;
+    _step = Step::SendPartialList;
+    _cookie = _timeout_handler.add([this]() { process_timeout(); }, _timeout_s);
+
+    _next_sequence = _begin_sequence;
+
+    send_partial_list();
+}
+
+void MavlinkMissionTransferClient::UploadWorkItem::fall_back_to_full_upload()
+{
+    _timeout_handler.remove(_cookie);
+
+    // If the autopilot never requested an item, it doesn't support partial writes at all.
+    if (_partial_upload->supported_callback) {
+        _partial_upload->supported_callback(_step != Step::SendPartialList);
+    }
+    _partial_upload.reset();
+
+    // Some items might have been written already, so we start over with all of them.
+    LogWarn() << "Partial mission upload failed, uploading all items";
+
+    if (upload_file()) {
+        return;
+    }
+
+    start_items();
+}
+
 void MavlinkMissionTransferClient::UploadWorkItem::cancel()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (_step == Step::FileTransfer) {
+        // The FTP session is terminated, which is how the autopilot learns about it. The file
+        // transfer calls back with its own lock held, so it has to be cancelled without ours.
+        auto cancel_file_upload = std::move(_cancel_file_upload);
+        lock.unlock();
+        if (cancel_file_upload) {
+            cancel_file_upload();
+        }
+        lock.lock();
+
+        // Unless the upload finished in the meantime.
+        if (!_done && _step == Step::FileTransfer) {
+            callback_and_reset(Result::Cancelled);
+        }
+        return;
+    }
 
     _timeout_handler.remove(_cookie);
     send_cancel_and_finish();
@@ -300,6 +642,35 @@ void MavlinkMissionTransferClient::UploadWorkItem::send_count()
     ++_retries_done;
 }
 
+void MavlinkMissionTransferClient::UploadWorkItem::send_partial_list()
+{
+    if (!_sender.queue_message([&](MavlinkAddress mavlink_address, uint8_t channel) {
+            mavlink_message_t message;
+            mavlink_msg_mission_write_partial_list_pack_chan(
+                mavlink_address.system_id,
+                mavlink_address.component_id,
+                channel,
+                &message,
+                _target_system_id,
+                MAV_COMP_ID_AUTOPILOT1,
+                static_cast<int16_t>(_begin_sequence),
+                static_cast<int16_t>(_end_sequence - 1), // inclusive
+                _type);
+            return message;
+        })) {
+        _timeout_handler.remove(_cookie);
+        callback_and_reset(Result::ConnectionError);
+        return;
+    }
+
+    if (_debugging) {
+        LogDebug() << "Sending write_partial_list, start: " << _begin_sequence
+                   << ", end: " << _end_sequence - 1 << ", retries: " << _retries_done;
+    }
+
+    ++_retries_done;
+}
+
 void MavlinkMissionTransferClient::UploadWorkItem::send_cancel_and_finish()
 {
     if (!_sender.queue_message([&](MavlinkAddress mavlink_address, uint8_t channel) {
@@ -348,6 +719,10 @@ void MavlinkMissionTransferClient::UploadWorkItem::process_mission_request(
     } else {
         std::lock_guard<std::mutex> lock(_mutex);
 
+        if (_step == Step::FileTransfer) {
+            return;
+        }
+
         // We only support int, so we nack this and thus tell the autopilot to use int.
 
         if (!_sender.queue_message([&](MavlinkAddress mavlink_address, uint8_t channel) {
@@ -377,6 +752,10 @@ void MavlinkMissionTransferClient::UploadWorkItem::process_mission_request_int(
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    if (_step == Step::FileTransfer) {
+        return;
+    }
+
     mavlink_mission_request_int_t request_int;
     mavlink_msg_mission_request_int_decode(&message, &request_int);
 
@@ -393,10 +772,18 @@ void MavlinkMissionTransferClient::UploadWorkItem::process_mission_request_int(
         LogWarn() << "mission_request_int: sequence incorrect";
         return;
 
+    } else if (request_int.seq < _begin_sequence) {
+        LogWarn() << "mission_request_int: sequence not part of the partial upload";
+        return;
+
     } else if (_next_sequence > request_int.seq) {
         // We have already sent that one before.
         if (_retries_done >= retries) {
             LogWarn() << "mission_request_int: retries exceeded";
+            if (_partial_upload) {
+                fall_back_to_full_upload();
+                return;
+            }
             _timeout_handler.remove(_cookie);
             callback_and_reset(Result::Timeout);
             return;
@@ -412,7 +799,9 @@ void MavlinkMissionTransferClient::UploadWorkItem::process_mission_request_int(
     _next_sequence = request_int.seq;
 
     // We add in a step for the final ack, so plus one.
-    update_progress(static_cast<float>(_next_sequence + 1) / static_cast<float>(_items.size() + 1));
+    update_progress(
+        static_cast<float>(_next_sequence - _begin_sequence + 1) /
+        static_cast<float>(_end_sequence - _begin_sequence + 1));
 
     send_mission_item();
 }
@@ -468,6 +857,10 @@ void MavlinkMissionTransferClient::UploadWorkItem::process_mission_ack(
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    if (_step == Step::FileTransfer) {
+        return;
+    }
+
     mavlink_mission_ack_t mission_ack;
     mavlink_msg_mission_ack_decode(&message, &mission_ack);
 
@@ -477,6 +870,12 @@ void MavlinkMissionTransferClient::UploadWorkItem::process_mission_ack(
 
     _timeout_handler.remove(_cookie);
 
+    if (_partial_upload && mission_ack.type != MAV_MISSION_OPERATION_CANCELLED &&
+        (mission_ack.type != MAV_MISSION_ACCEPTED || _next_sequence != _end_sequence)) {
+        fall_back_to_full_upload();
+        return;
+    }
+
     switch (mission_ack.type) {
         case MAV_MISSION_ERROR:
             callback_and_reset(Result::ProtocolError);
@@ -518,7 +917,7 @@ void MavlinkMissionTransferClient::UploadWorkItem::process_mission_ack(
             return;
     }
 
-    if (_next_sequence == _items.size()) {
+    if (_next_sequence == _end_sequence) {
         update_progress(1.0f);
         callback_and_reset(Result::Success);
     } else {
@@ -536,16 +935,29 @@ void MavlinkMissionTransferClient::UploadWorkItem::process_timeout()
 
     if (_retries_done >= retries) {
         LogWarn() << "timeout: retries exceeded";
+        if (_partial_upload) {
+            fall_back_to_full_upload();
+            return;
+        }
         callback_and_reset(Result::Timeout);
         return;
     }
 
     switch (_step) {
+        case Step::FileTransfer:
+            // The file transfer has timeouts of its own.
+            break;
+
         case Step::SendCount:
             _cookie = _timeout_handler.add([this]() { process_timeout(); }, _timeout_s);
             send_count();
             break;
 
+        case Step::SendPartialList:
+            _cookie = _timeout_handler.add([this]() { process_timeout(); }, _timeout_s);
+            send_partial_list();
+            break;
+
         case Step::SendItems:
             // When waiting for items requested we should wait longer than
             // just our timeout, otherwise we give up too quickly.
@@ -580,11 +992,13 @@ MavlinkMissionTransferClient::DownloadWorkItem::DownloadWorkItem(
     ResultAndItemsCallback callback,
     ProgressCallback progress_callback,
     bool debugging,
-    uint8_t target_system_id) :
+    uint8_t target_system_id,
+    FileDownloader file_downloader) :
     WorkItem(sender, message_handler, timeout_handler, type, timeout_s, debugging),
     _callback(callback),
     _progress_callback(progress_callback),
-    _target_system_id(target_system_id)
+    _target_system_id(target_system_id),
+    _file_downloader(std::move(file_downloader))
 {
     _message_handler.register_one(
         MAVLINK_MSG_ID_MISSION_COUNT,
@@ -611,6 +1025,68 @@ void MavlinkMissionTransferClient::DownloadWorkItem::start()
 
     _items.clear();
     _started = true;
+
+    if (download_file()) {
+        return;
+    }
+
+    start_items();
+}
+
+bool MavlinkMissionTransferClient::DownloadWorkItem::download_file()
+{
+    if (!_file_downloader) {
+        return false;
+    }
+
+    const auto remote_path = MavlinkMissionDat::remote_path(_type);
+    if (remote_path.empty()) {
+        return false;
+    }
+
+    _step = Step::FileTransfer;
+
+    // The work item is gone if it was cancelled before the file transfer is done.
+    std::weak_ptr<WorkItem> weak_self = weak_from_this();
+    if (!_file_downloader(
+            remote_path, [this, weak_self](bool success, std::vector<uint8_t> data) {
+                if (auto self = weak_self.lock()) {
+                    process_file_download(success, data);
+                }
+            })) {
+        _step = Step::RequestList;
+        return false;
+    }
+
+    if (_debugging) {
+        LogDebug() << "Downloading " << remote_path;
+    }
+    return true;
+}
+
+void MavlinkMissionTransferClient::DownloadWorkItem::process_file_download(
+    bool success, const std::vector<uint8_t>& data)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_done || _step != Step::FileTransfer) {
+        return;
+    }
+
+    if (success && MavlinkMissionDat::decode(data, _type, _items)) {
+        update_progress(1.0f);
+        callback_and_reset(Result::Success);
+        return;
+    }
+
+    LogWarn() << "Mission file download failed, downloading items one by one";
+    _items.clear();
+    start_items();
+}
+
+void MavlinkMissionTransferClient::DownloadWorkItem::start_items()
+{
+    _step = Step::RequestList;
     _retries_done = 0;
     _cookie = _timeout_handler.add([this]() { process_timeout(); }, _timeout_s);
     request_list();
@@ -620,6 +1096,11 @@ void MavlinkMissionTransferClient::DownloadWorkItem::cancel()
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    if (_step == Step::FileTransfer) {
+        callback_and_reset(Result::Cancelled);
+        return;
+    }
+
     _timeout_handler.remove(_cookie);
     send_cancel_and_finish();
 }
@@ -722,6 +1203,10 @@ void MavlinkMissionTransferClient::DownloadWorkItem::process_mission_count(
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    if (_step == Step::FileTransfer) {
+        return;
+    }
+
     mavlink_mission_count_t count;
     mavlink_msg_mission_count_decode(&message, &count);
 
@@ -744,6 +1229,10 @@ void MavlinkMissionTransferClient::DownloadWorkItem::process_mission_item_int(
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
+    if (_step == Step::FileTransfer) {
+        return;
+    }
+
     _timeout_handler.refresh(_cookie);
 
     mavlink_mission_item_int_t item_int;
@@ -791,6 +1280,10 @@ void MavlinkMissionTransferClient::DownloadWorkItem::process_timeout()
     }
 
     switch (_step) {
+        case Step::FileTransfer:
+            // The file transfer has timeouts of its own.
+            break;
+
         case Step::RequestList:
             _cookie = _timeout_handler.add([this]() { process_timeout(); }, _timeout_s);
             request_list();
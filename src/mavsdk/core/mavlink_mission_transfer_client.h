@@ -1,13 +1,17 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <vector>
 #include "autopilot.h"
 #include "autopilot_callback.h"
+#include "file_transfer_callbacks.h"
 #include "mavlink_address.h"
 #include "mavlink_include.h"
 #include "mavlink_message_handler.h"
@@ -68,7 +72,7 @@ public:
     using ResultAndItemsCallback = std::function<void(Result result, std::vector<ItemInt> items)>;
     using ProgressCallback = std::function<void(float progress)>;
 
-    class WorkItem {
+    class WorkItem : public std::enable_shared_from_this<WorkItem> {
     public:
         explicit WorkItem(
             Sender& sender,
@@ -102,6 +106,15 @@ public:
 
     class UploadWorkItem : public WorkItem {
     public:
+        // Replaces the items in [begin, end) using MISSION_WRITE_PARTIAL_LIST instead of
+        // uploading all of them. If the autopilot doesn't accept that, all items are uploaded.
+        struct PartialUpload {
+            std::size_t begin;
+            std::size_t end;
+            // Called with false if the autopilot doesn't support partial writes.
+            std::function<void(bool supported)> supported_callback;
+        };
+
         explicit UploadWorkItem(
             Sender& sender,
             MavlinkMessageHandler& message_handler,
@@ -113,7 +126,9 @@ public:
             ProgressCallback progress_callback,
             bool debugging,
             uint8_t target_system_id,
-            Autopilot autopilot);
+            Autopilot autopilot,
+            FileUploader file_uploader = {},
+            std::optional<PartialUpload> partial_upload = {});
 
         ~UploadWorkItem() override;
         void start() override;
@@ -125,7 +140,13 @@ public:
         UploadWorkItem& operator=(UploadWorkItem&&) = delete;
 
     private:
+        bool upload_file();
+        void process_file_upload(bool success);
+        void start_items();
+        void start_partial();
+        void fall_back_to_full_upload();
         void send_count();
+        void send_partial_list();
         void send_mission_item();
         void send_cancel_and_finish();
 
@@ -138,7 +159,9 @@ public:
         void update_progress(float progress);
 
         enum class Step {
+            FileTransfer,
             SendCount,
+            SendPartialList,
             SendItems,
         } _step{Step::SendCount};
 
@@ -146,11 +169,17 @@ public:
         ResultCallback _callback{nullptr};
         ProgressCallback _progress_callback{nullptr};
         std::size_t _next_sequence{0};
+        // The items to send are [_begin_sequence, _end_sequence).
+        std::size_t _begin_sequence{0};
+        std::size_t _end_sequence{0};
         TimeoutHandler::Cookie _cookie{};
         unsigned _retries_done{0};
 
         uint8_t _target_system_id;
         Autopilot _autopilot;
+        FileUploader _file_uploader;
+        FileTransferCancel _cancel_file_upload{};
+        std::optional<PartialUpload> _partial_upload;
     };
 
     class DownloadWorkItem : public WorkItem {
@@ -164,7 +193,8 @@ public:
             ResultAndItemsCallback callback,
             ProgressCallback progress_callback,
             bool debugging,
-            uint8_t target_system_id);
+            uint8_t target_system_id,
+            FileDownloader file_downloader = {});
 
         ~DownloadWorkItem() override;
         void start() override;
@@ -176,6 +206,9 @@ public:
         DownloadWorkItem& operator=(DownloadWorkItem&&) = delete;
 
     private:
+        bool download_file();
+        void process_file_download(bool success, const std::vector<uint8_t>& data);
+        void start_items();
         void request_list();
         void request_item();
         void send_ack_and_finish();
@@ -188,6 +221,7 @@ public:
         void update_progress(float progress);
 
         enum class Step {
+            FileTransfer,
             RequestList,
             RequestItem,
         } _step{Step::RequestList};
@@ -200,6 +234,7 @@ public:
         std::size_t _expected_count{0};
         unsigned _retries_done{0};
         uint8_t _target_system_id;
+        FileDownloader _file_downloader;
     };
 
     class ClearWorkItem : public WorkItem {
@@ -279,7 +314,7 @@ public:
         TimeoutSCallback get_timeout_s_callback,
         AutopilotCallback autopilot_callback);
 
-    ~MavlinkMissionTransferClient() = default;
+    ~MavlinkMissionTransferClient();
 
     std::weak_ptr<WorkItem> upload_items_async(
         uint8_t type,
@@ -303,11 +338,31 @@ public:
 
     void set_int_messages_supported(bool supported);
 
+    // Transfers whole missions as files (e.g. @MISSION/mission.dat using MAVLink FTP) instead
+    // of item by item, falling back to the latter if that fails. To be set before use.
+    void set_file_transfer(FileDownloader file_downloader, FileUploader file_uploader);
+
+    // Uploads only the range of items which changed since the last transfer using
+    // MISSION_WRITE_PARTIAL_LIST, while the callback returns true. To be set before use.
+    void set_partial_upload(std::function<bool()> enabled_callback);
+
     // Non-copyable
     MavlinkMissionTransferClient(const MavlinkMissionTransferClient&) = delete;
     const MavlinkMissionTransferClient& operator=(const MavlinkMissionTransferClient&) = delete;
 
 private:
+    // The file transfers for a work item, remembering if they failed.
+    FileDownloader file_downloader();
+    FileUploader file_uploader();
+
+    // The items to write instead of all of them, if only some changed since the last transfer.
+    std::optional<UploadWorkItem::PartialUpload>
+    partial_upload(uint8_t type, const std::vector<ItemInt>& items);
+    // Remembers the items on the autopilot after a transfer, or forgets them if it failed.
+    void update_shadow(uint8_t type, Result result, const std::vector<ItemInt>& items);
+    void process_mission_current(const mavlink_message_t& message);
+    void check_shadow_id(uint8_t type, uint32_t id);
+
     Sender& _sender;
     MavlinkMessageHandler& _message_handler;
     TimeoutHandler& _timeout_handler;
@@ -318,6 +373,23 @@ private:
 
     bool _int_messages_supported{true};
     bool _debugging{false};
+
+    FileDownloader _file_downloader{};
+    FileUploader _file_uploader{};
+    // Once a file transfer failed, we don't try again.
+    std::atomic<bool> _file_transfer_failed{false};
+
+    // The items on the autopilot as of the last successful transfer, per mission type.
+    struct Shadow {
+        std::vector<ItemInt> items{};
+        // The id reported in MISSION_CURRENT, 0 until the first one after the transfer.
+        uint32_t id{0};
+    };
+    std::mutex _shadows_mutex{};
+    std::map<uint8_t, Shadow> _shadows{};
+
+    std::function<bool()> _partial_upload_enabled_callback{};
+    std::atomic<bool> _partial_upload_unsupported{false};
 };
 
 } // namespace mavsdk
@@ -4,6 +4,7 @@
 #include <gtest/gtest.h>
 
 #include "mavlink_mission_transfer_client.h"
+#include "mavlink_mission_dat.h"
 #include "mocks/sender_mock.h"
 #include "unused.h"
 
@@ -1896,3 +1897,512 @@ TEST_F(MavlinkMissionTransferClientTest, IntMessagesNotSupported)
     mmt.do_work();
     EXPECT_TRUE(mmt.is_idle());
 }
+
+TEST_F(MavlinkMissionTransferClientTest, UploadMissionUsesFileTransfer)
+{
+    std::vector<ItemInt> items;
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 0));
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 1));
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 2));
+
+    std::string uploaded_path;
+    std::vector<uint8_t> uploaded_data;
+    std::function<void(bool)> upload_callback;
+    mmt.set_file_transfer(
+        {}, [&](const std::string& remote_path, std::vector<uint8_t> data, auto callback) {
+            uploaded_path = remote_path;
+            uploaded_data = std::move(data);
+            upload_callback = callback;
+            return FileTransferCancel{[] {}};
+        });
+
+    // Nothing is sent item by item.
+    EXPECT_CALL(mock_sender, queue_message(_)).Times(0);
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    mmt.upload_items_async(
+        MAV_MISSION_TYPE_MISSION, target_address.system_id, items, [&prom](Result result) {
+            EXPECT_EQ(result, Result::Success);
+            ONCE_ONLY;
+            prom.set_value();
+        });
+    mmt.do_work();
+
+    ASSERT_TRUE(upload_callback);
+    EXPECT_EQ(uploaded_path, "@MISSION/mission.dat");
+
+    std::vector<ItemInt> uploaded_items;
+    EXPECT_TRUE(
+        MavlinkMissionDat::decode(uploaded_data, MAV_MISSION_TYPE_MISSION, uploaded_items));
+    EXPECT_EQ(uploaded_items, items);
+
+    upload_callback(true);
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST_F(MavlinkMissionTransferClientTest, UploadMissionFallsBackIfFileTransferFails)
+{
+    std::vector<ItemInt> items;
+    items.push_back(make_item(MAV_MISSION_TYPE_FENCE, 0));
+    items.push_back(make_item(MAV_MISSION_TYPE_FENCE, 1));
+
+    unsigned uploads = 0;
+    std::function<void(bool)> upload_callback;
+    mmt.set_file_transfer({}, [&](const std::string&, std::vector<uint8_t>, auto callback) {
+        ++uploads;
+        upload_callback = callback;
+        return FileTransferCancel{[] {}};
+    });
+
+    EXPECT_CALL(mock_sender, queue_message(_)).WillRepeatedly(Return(true));
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    auto transfer = mmt.upload_items_async(
+        MAV_MISSION_TYPE_FENCE, target_address.system_id, items, [&prom](Result result) {
+            EXPECT_EQ(result, Result::Cancelled);
+            prom.set_value();
+        });
+    mmt.do_work();
+
+    ASSERT_TRUE(upload_callback);
+
+    // Both uploads continue item by item.
+    EXPECT_CALL(
+        mock_sender,
+        queue_message(Truly([&items](std::function<mavlink_message_t(
+                                         MavlinkAddress mavlink_address, uint8_t channel)> fun) {
+            return is_correct_mission_send_count(
+                MAV_MISSION_TYPE_FENCE, items.size(), fun(own_address, channel));
+        })))
+        .Times(2)
+        .WillRepeatedly(Return(true));
+
+    upload_callback(false);
+
+    auto ptr = transfer.lock();
+    ASSERT_TRUE(ptr);
+    ptr->cancel();
+    ptr.reset();
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    mmt.do_work();
+
+    // Once it failed, the file transfer is not tried again.
+    mmt.upload_items_async(
+        MAV_MISSION_TYPE_FENCE, target_address.system_id, items, [](Result result) {
+            UNUSED(result);
+            EXPECT_TRUE(false);
+        });
+    mmt.do_work();
+
+    EXPECT_EQ(uploads, 1);
+}
+
+TEST_F(MavlinkMissionTransferClientTest, UploadMissionFileTransferCanBeCancelled)
+{
+    std::vector<ItemInt> items;
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 0));
+
+    unsigned cancelled = 0;
+    mmt.set_file_transfer({}, [&](const std::string&, std::vector<uint8_t>, auto) {
+        return FileTransferCancel{[&cancelled] { ++cancelled; }};
+    });
+
+    EXPECT_CALL(mock_sender, queue_message(_)).Times(0);
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    auto transfer = mmt.upload_items_async(
+        MAV_MISSION_TYPE_MISSION, target_address.system_id, items, [&prom](Result result) {
+            EXPECT_EQ(result, Result::Cancelled);
+            ONCE_ONLY;
+            prom.set_value();
+        });
+    mmt.do_work();
+    EXPECT_EQ(cancelled, 0u);
+
+    auto ptr = transfer.lock();
+    ASSERT_TRUE(ptr);
+    ptr->cancel();
+    ptr.reset();
+
+    // The file transfer itself is cancelled too.
+    EXPECT_EQ(cancelled, 1u);
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST_F(MavlinkMissionTransferClientTest, DownloadMissionUsesFileTransfer)
+{
+    std::vector<ItemInt> items;
+    items.push_back(make_item(MAV_MISSION_TYPE_RALLY, 0));
+    items.push_back(make_item(MAV_MISSION_TYPE_RALLY, 1));
+
+    std::string downloaded_path;
+    std::function<void(bool, std::vector<uint8_t>)> download_callback;
+    mmt.set_file_transfer(
+        [&](const std::string& remote_path, auto callback) {
+            downloaded_path = remote_path;
+            download_callback = callback;
+            return true;
+        },
+        {});
+
+    // Nothing is requested item by item.
+    EXPECT_CALL(mock_sender, queue_message(_)).Times(0);
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    mmt.download_items_async(
+        MAV_MISSION_TYPE_RALLY,
+        target_address.system_id,
+        [&prom, &items](Result result, const std::vector<ItemInt>& downloaded_items) {
+            EXPECT_EQ(result, Result::Success);
+            EXPECT_EQ(downloaded_items, items);
+            ONCE_ONLY;
+            prom.set_value();
+        });
+    mmt.do_work();
+
+    EXPECT_EQ(downloaded_path, "@MISSION/rally.dat");
+    ASSERT_TRUE(download_callback);
+    download_callback(true, MavlinkMissionDat::encode(MAV_MISSION_TYPE_RALLY, 1, items));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST_F(MavlinkMissionTransferClientTest, DownloadMissionFileTransferCanBeCancelled)
+{
+    std::function<void(bool, std::vector<uint8_t>)> download_callback;
+    mmt.set_file_transfer(
+        [&](const std::string&, auto callback) {
+            download_callback = callback;
+            return true;
+        },
+        {});
+
+    EXPECT_CALL(mock_sender, queue_message(_)).Times(0);
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    auto transfer = mmt.download_items_async(
+        MAV_MISSION_TYPE_MISSION,
+        target_address.system_id,
+        [&prom](Result result, const std::vector<ItemInt>& items) {
+            UNUSED(items);
+            EXPECT_EQ(result, Result::Cancelled);
+            ONCE_ONLY;
+            prom.set_value();
+        });
+    mmt.do_work();
+
+    auto ptr = transfer.lock();
+    ASSERT_TRUE(ptr);
+    ptr->cancel();
+    ptr.reset();
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+
+    // A late result of the file transfer is ignored.
+    ASSERT_TRUE(download_callback);
+    download_callback(true, {});
+}
+
+mavlink_message_t make_mission_current_with_id(uint32_t mission_id)
+{
+    mavlink_message_t message;
+    mavlink_msg_mission_current_pack(
+        own_address.system_id, own_address.component_id, &message, 0, 0, 0, 0, mission_id, 0, 0);
+    return message;
+}
+
+class MavlinkMissionTransferClientPartialUploadTest : public MavlinkMissionTransferClientTest {
+protected:
+    void SetUp() override
+    {
+        MavlinkMissionTransferClientTest::SetUp();
+
+        mmt.set_partial_upload([]() { return true; });
+
+        ON_CALL(mock_sender, queue_message(_))
+            .WillByDefault([this](std::function<mavlink_message_t(MavlinkAddress, uint8_t)> fun) {
+                sent.push_back(fun(own_address, channel));
+                return true;
+            });
+
+        for (uint16_t i = 0; i < 10; ++i) {
+            items.push_back(make_item(MAV_MISSION_TYPE_MISSION, i));
+        }
+    }
+
+    // Uploads the items, answering the requests of the given range, and returns the result.
+    // Afterwards, the autopilot reports a new mission id, if enabled.
+    Result upload(std::size_t begin, std::size_t end)
+    {
+        std::promise<Result> prom;
+        auto fut = prom.get_future();
+
+        mmt.upload_items_async(
+            MAV_MISSION_TYPE_MISSION,
+            target_address.system_id,
+            items,
+            [&prom](Result result) { prom.set_value(result); });
+        mmt.do_work();
+
+        for (std::size_t i = begin; i < end; ++i) {
+            message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, i));
+        }
+        if (begin != end) {
+            message_handler.process_message(
+                make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+        }
+
+        EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+        mmt.do_work();
+        EXPECT_TRUE(mmt.is_idle());
+
+        const auto result = fut.get();
+        if (report_mission_id && result == Result::Success) {
+            message_handler.process_message(make_mission_current_with_id(++mission_id));
+        }
+        return result;
+    }
+
+    std::size_t count_sent(uint32_t msgid) const
+    {
+        return std::count_if(sent.begin(), sent.end(), [msgid](const auto& message) {
+            return message.msgid == msgid;
+        });
+    }
+
+    std::vector<ItemInt> items{};
+    std::vector<mavlink_message_t> sent{};
+    bool report_mission_id{true};
+    uint32_t mission_id{0};
+};
+
+bool is_correct_mission_write_partial_list(
+    uint8_t type, int16_t start_index, int16_t end_index, const mavlink_message_t& message)
+{
+    if (message.msgid != MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST) {
+        return false;
+    }
+
+    mavlink_mission_write_partial_list_t partial_list;
+    mavlink_msg_mission_write_partial_list_decode(&message, &partial_list);
+
+    return (
+        partial_list.target_system == target_address.system_id &&
+        partial_list.target_component == target_address.component_id &&
+        partial_list.start_index == start_index && partial_list.end_index == end_index &&
+        partial_list.mission_type == type);
+}
+
+TEST_F(MavlinkMissionTransferClientPartialUploadTest, UploadMissionWritesOnlyChangedItems)
+{
+    EXPECT_EQ(upload(0, items.size()), Result::Success);
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_COUNT), 1);
+    sent.clear();
+
+    items[3].x = 42;
+    items[5].param4 = NAN;
+
+    EXPECT_EQ(upload(3, 6), Result::Success);
+
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_COUNT), 0);
+    ASSERT_EQ(sent.size(), 4);
+    EXPECT_TRUE(is_correct_mission_write_partial_list(MAV_MISSION_TYPE_MISSION, 3, 5, sent[0]));
+    EXPECT_TRUE(is_the_same_mission_item_int(items[3], sent[1]));
+    EXPECT_TRUE(is_the_same_mission_item_int(items[4], sent[2]));
+    ASSERT_EQ(sent[3].msgid, MAVLINK_MSG_ID_MISSION_ITEM_INT);
+    mavlink_mission_item_int_t item_int;
+    mavlink_msg_mission_item_int_decode(&sent[3], &item_int);
+    EXPECT_EQ(item_int.seq, 5);
+    EXPECT_TRUE(std::isnan(item_int.param4));
+    sent.clear();
+
+    // NaN params are the same as before.
+    items[7].z = 11.0f;
+
+    EXPECT_EQ(upload(7, 8), Result::Success);
+    ASSERT_EQ(sent.size(), 2);
+    EXPECT_TRUE(is_correct_mission_write_partial_list(MAV_MISSION_TYPE_MISSION, 7, 7, sent[0]));
+    EXPECT_TRUE(is_the_same_mission_item_int(items[7], sent[1]));
+}
+
+TEST_F(MavlinkMissionTransferClientPartialUploadTest, UploadMissionWithoutChangesSendsNothing)
+{
+    EXPECT_EQ(upload(0, items.size()), Result::Success);
+    sent.clear();
+
+    EXPECT_EQ(upload(0, 0), Result::Success);
+    EXPECT_TRUE(sent.empty());
+}
+
+TEST_F(MavlinkMissionTransferClientPartialUploadTest, UploadMissionUploadsAllForDifferentCount)
+{
+    EXPECT_EQ(upload(0, items.size()), Result::Success);
+    sent.clear();
+
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, items.size()));
+
+    EXPECT_EQ(upload(0, items.size()), Result::Success);
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_COUNT), 1);
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST), 0);
+}
+
+TEST_F(MavlinkMissionTransferClientPartialUploadTest, UploadMissionFallsBackIfPartialUnsupported)
+{
+    EXPECT_EQ(upload(0, items.size()), Result::Success);
+    sent.clear();
+
+    items[4].y = 42;
+
+    std::promise<Result> prom;
+    auto fut = prom.get_future();
+    mmt.upload_items_async(
+        MAV_MISSION_TYPE_MISSION, target_address.system_id, items, [&prom](Result result) {
+            prom.set_value(result);
+        });
+    mmt.do_work();
+
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST), 1);
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_UNSUPPORTED));
+
+    // All items are uploaded instead.
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_COUNT), 1);
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, i));
+    }
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_EQ(fut.get(), Result::Success);
+    mmt.do_work();
+    sent.clear();
+
+    // And from now on without trying a partial write first.
+    items[4].y = 43;
+    EXPECT_EQ(upload(0, items.size()), Result::Success);
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST), 0);
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_COUNT), 1);
+}
+
+TEST_F(MavlinkMissionTransferClientPartialUploadTest, UploadMissionFallsBackAfterTimeout)
+{
+    EXPECT_EQ(upload(0, items.size()), Result::Success);
+    sent.clear();
+
+    items[4].y = 42;
+
+    std::promise<Result> prom;
+    auto fut = prom.get_future();
+    mmt.upload_items_async(
+        MAV_MISSION_TYPE_MISSION, target_address.system_id, items, [&prom](Result result) {
+            prom.set_value(result);
+        });
+    mmt.do_work();
+
+    // The partial list is ignored.
+    for (unsigned i = 0; i < MavlinkMissionTransferClient::retries; ++i) {
+        time.sleep_for(std::chrono::milliseconds(static_cast<int>(timeout_s * 1.1 * 1000.)));
+        timeout_handler.run_once();
+    }
+    EXPECT_EQ(
+        count_sent(MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST),
+        MavlinkMissionTransferClient::retries);
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_COUNT), 1);
+
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, i));
+    }
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_EQ(fut.get(), Result::Success);
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST_F(MavlinkMissionTransferClientPartialUploadTest, UploadMissionUploadsAllIfChangedByOthers)
+{
+    EXPECT_EQ(upload(0, items.size()), Result::Success);
+    sent.clear();
+
+    items[4].y = 42;
+    EXPECT_EQ(upload(4, 5), Result::Success);
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST), 1);
+    sent.clear();
+
+    // Someone else changed the mission.
+    message_handler.process_message(make_mission_current_with_id(5678));
+
+    items[4].y = 43;
+    EXPECT_EQ(upload(0, items.size()), Result::Success);
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST), 0);
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_COUNT), 1);
+}
+
+TEST_F(MavlinkMissionTransferClientPartialUploadTest, UploadMissionUploadsAllWithoutMissionId)
+{
+    // Without an id, changes by others can't be detected.
+    report_mission_id = false;
+
+    EXPECT_EQ(upload(0, items.size()), Result::Success);
+    sent.clear();
+
+    EXPECT_EQ(upload(0, items.size()), Result::Success);
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_COUNT), 1);
+    sent.clear();
+
+    items[4].y = 42;
+    EXPECT_EQ(upload(0, items.size()), Result::Success);
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST), 0);
+    EXPECT_EQ(count_sent(MAVLINK_MSG_ID_MISSION_COUNT), 1);
+}
+
+TEST_F(MavlinkMissionTransferClientPartialUploadTest, DownloadMissionAllowsPartialUpload)
+{
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    mmt.download_items_async(
+        MAV_MISSION_TYPE_MISSION,
+        target_address.system_id,
+        [&prom, this](Result result, const std::vector<ItemInt>& downloaded) {
+            EXPECT_EQ(result, Result::Success);
+            EXPECT_EQ(downloaded, items);
+            prom.set_value();
+        });
+    mmt.do_work();
+
+    message_handler.process_message(make_mission_count(items.size()));
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        message_handler.process_message(make_mission_item(items, i));
+    }
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    mmt.do_work();
+    message_handler.process_message(make_mission_current_with_id(++mission_id));
+    sent.clear();
+
+    items[9].param1 = 42.0f;
+    EXPECT_EQ(upload(9, 10), Result::Success);
+    ASSERT_EQ(sent.size(), 2);
+    EXPECT_TRUE(is_correct_mission_write_partial_list(MAV_MISSION_TYPE_MISSION, 9, 9, sent[0]));
+    EXPECT_TRUE(is_the_same_mission_item_int(items[9], sent[1]));
+}
@@ -9,11 +9,13 @@ MavlinkMissionTransferServer::MavlinkMissionTransferServer(
     Sender& sender,
     MavlinkMessageHandler& message_handler,
     TimeoutHandler& timeout_handler,
-    TimeoutSCallback timeout_s_callback) :
+    TimeoutSCallback timeout_s_callback,
+    RequestWindowCallback request_window_callback) :
     _sender(sender),
     _message_handler(message_handler),
     _timeout_handler(timeout_handler),
-    _timeout_s_callback(std::move(timeout_s_callback))
+    _timeout_s_callback(std::move(timeout_s_callback)),
+    _request_window_callback(std::move(request_window_callback))
 {
     if (const char* env_p = std::getenv("MAVSDK_MISSION_TRANSFER_DEBUGGING")) {
         if (std::string(env_p) == "1") {
@@ -41,6 +43,7 @@ MavlinkMissionTransferServer::receive_incoming_items_async(
         mission_count,
         target_system,
         target_component,
+        _request_window_callback ? std::max<std::size_t>(_request_window_callback(), 1) : 1,
         _debugging);
 
     _work_queue.push_back(ptr);
@@ -135,8 +138,10 @@ MavlinkMissionTransferServer::ReceiveIncomingMission::ReceiveIncomingMission(
     uint32_t mission_count,
     uint8_t target_system_id,
     uint8_t target_component_id,
+    std::size_t request_window,
     bool debugging) :
     WorkItem(sender, message_handler, timeout_handler, type, timeout_s, debugging),
+    _request_window(request_window),
     _callback(callback),
     _mission_count(mission_count),
     _target_system_id(target_system_id),
@@ -174,27 +179,45 @@ void MavlinkMissionTransferServer::ReceiveIncomingMission::cancel()
     send_cancel_and_finish();
 }
 
-void MavlinkMissionTransferServer::ReceiveIncomingMission::request_item()
+void MavlinkMissionTransferServer::ReceiveIncomingMission::request_items(
+    std::size_t begin, std::size_t end)
 {
-    if (!_sender.queue_message([&](MavlinkAddress mavlink_address, uint8_t channel) {
-            mavlink_message_t message;
-            mavlink_msg_mission_request_int_pack_chan(
-                mavlink_address.system_id,
-                mavlink_address.component_id,
-                channel,
-                &message,
-                _target_system_id,
-                _target_component_id,
-                _next_sequence,
-                _type);
-            return message;
-        })) {
-        _timeout_handler.remove(_cookie);
-        callback_and_reset(Result::ConnectionError);
-        return;
+    for (std::size_t sequence = begin; sequence < end; ++sequence) {
+        if (_debugging) {
+            LogDebug() << "Requesting mission_item_int seq: " << sequence
+                       << ", retry: " << _retries_done;
+        }
+
+        if (!_sender.queue_message([&](MavlinkAddress mavlink_address, uint8_t channel) {
+                mavlink_message_t message;
+                mavlink_msg_mission_request_int_pack_chan(
+                    mavlink_address.system_id,
+                    mavlink_address.component_id,
+                    channel,
+                    &message,
+                    _target_system_id,
+                    _target_component_id,
+                    sequence,
+                    _type);
+                return message;
+            })) {
+            _timeout_handler.remove(_cookie);
+            callback_and_reset(Result::ConnectionError);
+            return;
+        }
     }
+}
 
-    ++_retries_done;
+void MavlinkMissionTransferServer::ReceiveIncomingMission::request_new_items()
+{
+    // The window starts at the first missing item, rather than at the last requested one, so
+    // that a gap is filled before requesting too far ahead.
+    const std::size_t end = std::min(_first_missing + _request_window, _items.size());
+    if (_next_request < end) {
+        const std::size_t begin = _next_request;
+        _next_request = end;
+        request_items(begin, end);
+    }
 }
 
 void MavlinkMissionTransferServer::ReceiveIncomingMission::send_ack_and_finish()
@@ -254,22 +277,36 @@ void MavlinkMissionTransferServer::ReceiveIncomingMission::process_mission_count
     }
 
     _timeout_handler.refresh(_cookie);
-    _next_sequence = 0;
-    _retries_done = 0;
-    _expected_count = _mission_count;
-    request_item();
+    _items.assign(_mission_count, ItemInt{});
+    _received.assign(_mission_count, false);
+    _num_received = 0;
+    _first_missing = 0;
+    _next_request = 0;
+    _retries_done = 1;
+    request_new_items();
 }
 
 void MavlinkMissionTransferServer::ReceiveIncomingMission::process_mission_item_int(
     const mavlink_message_t& message)
 {
     std::lock_guard<std::mutex> lock(_mutex);
-    _timeout_handler.refresh(_cookie);
 
     mavlink_mission_item_int_t item_int;
     mavlink_msg_mission_item_int_decode(&message, &item_int);
 
-    _items.push_back(ItemInt{
+    if (item_int.seq >= _items.size()) {
+        LogWarn() << "mission_item_int: sequence " << item_int.seq << " out of range";
+        return;
+    }
+
+    if (_received[item_int.seq]) {
+        // Requested again after a timeout, but the first one arrived as well.
+        return;
+    }
+
+    _timeout_handler.refresh(_cookie);
+
+    _items[item_int.seq] = ItemInt{
         item_int.seq,
         item_int.frame,
         item_int.command,
@@ -282,17 +319,22 @@ void MavlinkMissionTransferServer::ReceiveIncomingMission::process_mission_item_
         item_int.x,
         item_int.y,
         item_int.z,
-        item_int.mission_type});
+        item_int.mission_type};
+    _received[item_int.seq] = true;
+    ++_num_received;
 
-    if (_next_sequence + 1 == _expected_count) {
+    if (_num_received == _items.size()) {
         _timeout_handler.remove(_cookie);
         send_ack_and_finish();
+        return;
+    }
 
-    } else {
-        _next_sequence = item_int.seq + 1;
-        _retries_done = 0;
-        request_item();
+    while (_received[_first_missing]) {
+        ++_first_missing;
     }
+
+    _retries_done = 1;
+    request_new_items();
 }
 
 void MavlinkMissionTransferServer::ReceiveIncomingMission::process_timeout()
@@ -305,7 +347,11 @@ void MavlinkMissionTransferServer::ReceiveIncomingMission::process_timeout()
     }
 
     _cookie = _timeout_handler.add([this]() { process_timeout(); }, _timeout_s);
-    request_item();
+    ++_retries_done;
+    // Requested again in order, including ones which have arrived meanwhile. A client which
+    // only answers the requests in sequence, e.g. because it went back to a lost item, can
+    // then still continue.
+    request_items(_first_missing, _next_request);
 }
 
 void MavlinkMissionTransferServer::ReceiveIncomingMission::callback_and_reset(Result result)
@@ -366,6 +412,8 @@ void MavlinkMissionTransferServer::SendOutgoingMission::start()
     _cookie = _timeout_handler.add([this]() { process_timeout(); }, _timeout_s);
 
     _next_sequence = 0;
+    _sent.assign(_items.size(), false);
+    _num_sent = 0;
 
     send_count();
 }
@@ -476,13 +524,11 @@ void MavlinkMissionTransferServer::SendOutgoingMission::process_mission_request_
                    << ", next expected sequence: " << _next_sequence;
     }
 
-    if (_next_sequence < request_int.seq) {
-        // We should not go back to a previous one.
-        // TODO: figure out if we should error here.
+    if (request_int.seq >= _items.size()) {
         LogWarn() << "mission_request_int: sequence incorrect";
         return;
 
-    } else if (_next_sequence > request_int.seq) {
+    } else if (_sent[request_int.seq]) {
         // We have already sent that one before.
         if (_retries_done >= retries) {
             LogWarn() << "mission_request_int: retries exceeded";
@@ -492,7 +538,7 @@ void MavlinkMissionTransferServer::SendOutgoingMission::process_mission_request_
         }
 
     } else {
-        // Correct one, sending it the first time.
+        // Sending it the first time, the client might request several ahead.
         _retries_done = 0;
     }
 
@@ -544,6 +590,11 @@ void MavlinkMissionTransferServer::SendOutgoingMission::send_mission_item()
         return;
     }
 
+    if (!_sent[_next_sequence]) {
+        _sent[_next_sequence] = true;
+        ++_num_sent;
+    }
+
     ++_next_sequence;
 
     ++_retries_done;
@@ -604,7 +655,7 @@ void MavlinkMissionTransferServer::SendOutgoingMission::process_mission_ack(
             return;
     }
 
-    if (_next_sequence == _items.size()) {
+    if (_num_sent == _items.size()) {
         callback_and_reset(Result::Success);
     } else {
         callback_and_reset(Result::ProtocolError);
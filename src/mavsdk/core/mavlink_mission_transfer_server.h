@@ -66,6 +66,7 @@ public:
     using ResultAndItemsCallback =
         std::function<void(Result result, uint8_t type, std::vector<ItemInt> items)>;
     using ProgressCallback = std::function<void(float progress)>;
+    using RequestWindowCallback = std::function<std::size_t()>;
 
     class WorkItem {
     public:
@@ -111,6 +112,7 @@ public:
             uint32_t mission_count,
             uint8_t target_system_id,
             uint8_t target_component_id,
+            std::size_t request_window,
             bool debugging);
         ~ReceiveIncomingMission() override;
 
@@ -123,7 +125,8 @@ public:
         ReceiveIncomingMission& operator=(ReceiveIncomingMission&&) = delete;
 
     private:
-        void request_item();
+        void request_items(std::size_t begin, std::size_t end);
+        void request_new_items();
         void send_ack_and_finish();
         void send_cancel_and_finish();
         void process_mission_count();
@@ -131,11 +134,18 @@ public:
         void process_timeout();
         void callback_and_reset(Result result);
 
+        // Items can arrive in any order, they are stored at their sequence.
         std::vector<ItemInt> _items{};
+        std::vector<bool> _received{};
+        std::size_t _num_received{0};
+        // All items before this one have been received.
+        std::size_t _first_missing{0};
+        // All items before this one have been requested at least once.
+        std::size_t _next_request{0};
+        // Items after the first missing one which can be requested at the same time.
+        std::size_t _request_window{1};
         ResultAndItemsCallback _callback{nullptr};
         TimeoutHandler::Cookie _cookie{};
-        std::size_t _next_sequence{0};
-        std::size_t _expected_count{0};
         unsigned _retries_done{0};
         uint32_t _mission_count{0};
         uint8_t _target_system_id{0};
@@ -184,6 +194,8 @@ public:
         } _step{Step::SendCount};
 
         std::vector<ItemInt> _items{};
+        std::vector<bool> _sent{};
+        std::size_t _num_sent{0};
         ResultCallback _callback{nullptr};
         TimeoutHandler::Cookie _cookie{};
         std::size_t _next_sequence{0};
@@ -196,7 +208,8 @@ public:
         Sender& sender,
         MavlinkMessageHandler& message_handler,
         TimeoutHandler& timeout_handler,
-        TimeoutSCallback get_timeout_s_callback);
+        TimeoutSCallback get_timeout_s_callback,
+        RequestWindowCallback get_request_window_callback = nullptr);
 
     ~MavlinkMissionTransferServer() = default;
 
@@ -226,6 +239,7 @@ private:
     MavlinkMessageHandler& _message_handler;
     TimeoutHandler& _timeout_handler;
     TimeoutSCallback _timeout_s_callback;
+    RequestWindowCallback _request_window_callback;
 
     LockedQueue<WorkItem> _work_queue{};
 
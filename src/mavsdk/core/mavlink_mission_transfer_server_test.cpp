@@ -4,6 +4,7 @@
 #include <vector>
 #include <gtest/gtest.h>
 
+#include "log.h"
 #include "mavlink_mission_transfer_server.h"
 #include "mocks/sender_mock.h"
 #include "unused.h"
@@ -1224,5 +1225,273 @@ TEST_P(MissionTypeParameterTest, SendOutgoingMissionNacksNonIntCase)
     EXPECT_TRUE(mmt.is_idle());
 }
 
+static std::vector<unsigned> requested_sequences(std::vector<mavlink_message_t>& sent)
+{
+    std::vector<unsigned> sequences;
+    for (const auto& message : sent) {
+        if (message.msgid == MAVLINK_MSG_ID_MISSION_REQUEST_INT) {
+            mavlink_mission_request_int_t request_int;
+            mavlink_msg_mission_request_int_decode(&message, &request_int);
+            sequences.push_back(request_int.seq);
+        }
+    }
+    sent.clear();
+    return sequences;
+}
+
+TEST_P(MissionTypeParameterTest, ReceiveIncomingMissionWithWindowAcceptsItemsOutOfOrder)
+{
+    MavlinkMissionTransferServer mmt_window(
+        mock_sender, message_handler, timeout_handler, []() { return timeout_s; }, []() {
+            return 3;
+        });
+
+    std::vector<mavlink_message_t> sent;
+    ON_CALL(mock_sender, queue_message(_))
+        .WillByDefault([&sent](std::function<mavlink_message_t(MavlinkAddress, uint8_t)> fun) {
+            sent.push_back(fun(own_address, channel));
+            return true;
+        });
+
+    std::vector<ItemInt> items;
+    for (uint16_t i = 0; i < 5; ++i) {
+        items.push_back(make_item(mission_type, i));
+    }
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    mmt_window.receive_incoming_items_async(
+        mission_type,
+        items.size(),
+        target_address.system_id,
+        target_address.component_id,
+        [&prom, &items](Result result, uint8_t type, const std::vector<ItemInt>& output_items) {
+            UNUSED(type);
+            EXPECT_EQ(result, Result::Success);
+            EXPECT_EQ(items, output_items);
+            prom.set_value();
+        });
+
+    mmt_window.do_work();
+    EXPECT_EQ(requested_sequences(sent), (std::vector<unsigned>{0, 1, 2}));
+
+    // The window can't move on until the first one has arrived.
+    message_handler.process_message(make_mission_item(items, 2));
+    EXPECT_EQ(requested_sequences(sent), (std::vector<unsigned>{}));
+
+    message_handler.process_message(make_mission_item(items, 0));
+    EXPECT_EQ(requested_sequences(sent), (std::vector<unsigned>{3}));
+
+    message_handler.process_message(make_mission_item(items, 1));
+    EXPECT_EQ(requested_sequences(sent), (std::vector<unsigned>{4}));
+
+    // Duplicates are ignored.
+    message_handler.process_message(make_mission_item(items, 1));
+    message_handler.process_message(make_mission_item(items, 4));
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+
+    message_handler.process_message(make_mission_item(items, 3));
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    ASSERT_FALSE(sent.empty());
+    EXPECT_TRUE(is_correct_autopilot_mission_ack(
+        mission_type, MAV_MISSION_ACCEPTED, target_address.component_id, sent.back()));
+
+    mmt_window.do_work();
+    EXPECT_TRUE(mmt_window.is_idle());
+}
+
+TEST_P(MissionTypeParameterTest, ReceiveIncomingMissionWithWindowRequestsMissingAgainInOrder)
+{
+    MavlinkMissionTransferServer mmt_window(
+        mock_sender, message_handler, timeout_handler, []() { return timeout_s; }, []() {
+            return 3;
+        });
+
+    std::vector<mavlink_message_t> sent;
+    ON_CALL(mock_sender, queue_message(_))
+        .WillByDefault([&sent](std::function<mavlink_message_t(MavlinkAddress, uint8_t)> fun) {
+            sent.push_back(fun(own_address, channel));
+            return true;
+        });
+
+    std::vector<ItemInt> items;
+    for (uint16_t i = 0; i < 4; ++i) {
+        items.push_back(make_item(mission_type, i));
+    }
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    mmt_window.receive_incoming_items_async(
+        mission_type,
+        items.size(),
+        target_address.system_id,
+        target_address.component_id,
+        [&prom, &items](Result result, uint8_t type, const std::vector<ItemInt>& output_items) {
+            UNUSED(type);
+            EXPECT_EQ(result, Result::Success);
+            EXPECT_EQ(items, output_items);
+            prom.set_value();
+        });
+
+    mmt_window.do_work();
+    EXPECT_EQ(requested_sequences(sent), (std::vector<unsigned>{0, 1, 2}));
+
+    // Items 0 and 2 got lost.
+    message_handler.process_message(make_mission_item(items, 1));
+
+    time.sleep_for(std::chrono::milliseconds(static_cast<int>(timeout_s * 1.1 * 1000.)));
+    timeout_handler.run_once();
+
+    // Everything from the first missing one is requested again, in order, so that a client
+    // which answers strictly in sequence can continue.
+    EXPECT_EQ(requested_sequences(sent), (std::vector<unsigned>{0, 1, 2}));
+
+    message_handler.process_message(make_mission_item(items, 0));
+    EXPECT_EQ(requested_sequences(sent), (std::vector<unsigned>{3}));
+
+    message_handler.process_message(make_mission_item(items, 1));
+    message_handler.process_message(make_mission_item(items, 2));
+    message_handler.process_message(make_mission_item(items, 3));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt_window.do_work();
+    EXPECT_TRUE(mmt_window.is_idle());
+}
+
+TEST_P(MissionTypeParameterTest, SendOutgoingMissionServesRequestsAhead)
+{
+    std::vector<ItemInt> items;
+    items.push_back(make_item(mission_type, 0));
+    items.push_back(make_item(mission_type, 1));
+    items.push_back(make_item(mission_type, 2));
+
+    std::vector<mavlink_message_t> sent;
+    ON_CALL(mock_sender, queue_message(_))
+        .WillByDefault([&sent](std::function<mavlink_message_t(MavlinkAddress, uint8_t)> fun) {
+            sent.push_back(fun(own_address, channel));
+            return true;
+        });
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+
+    mmt.send_outgoing_items_async(
+        mission_type,
+        items,
+        target_address.system_id,
+        target_address.component_id,
+        [&prom, this](Result result) {
+            EXPECT_EQ(result, Result::Success);
+            ONCE_ONLY;
+            prom.set_value();
+        });
+    mmt.do_work();
+    sent.clear();
+
+    // A client requesting several at once, with one of the requests arriving late.
+    message_handler.process_message(make_mission_request_int(mission_type, 0));
+    message_handler.process_message(make_mission_request_int(mission_type, 2));
+    message_handler.process_message(make_mission_request_int(mission_type, 1));
+
+    ASSERT_EQ(sent.size(), 3);
+    EXPECT_TRUE(is_the_same_mission_item_int(items[0], sent[0]));
+    EXPECT_TRUE(is_the_same_mission_item_int(items[2], sent[1]));
+    EXPECT_TRUE(is_the_same_mission_item_int(items[1], sent[2]));
+
+    message_handler.process_message(make_mission_ack(mission_type, MAV_MISSION_ACCEPTED));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
 INSTANTIATE_TEST_SUITE_P(
     MavlinkMissionTransferServer, MissionTypeParameterTest, MISSION_TYPE_PARAMETERS);
+
+TEST_F(MavlinkMissionTransferServerTest, ReceiveIncomingMissionCompletionTimeWithLatency)
+{
+    // A client answering each request after a round trip time of 100 ms.
+    constexpr auto round_trip_time = std::chrono::milliseconds(100);
+    constexpr std::size_t num_items = 100;
+
+    std::vector<ItemInt> items;
+    for (uint16_t i = 0; i < num_items; ++i) {
+        items.push_back(make_item(MAV_MISSION_TYPE_MISSION, i));
+    }
+
+    auto upload_time = [&](std::size_t window) {
+        MavlinkMissionTransferServer mmt_window(
+            mock_sender, message_handler, timeout_handler, []() { return timeout_s; }, [window]() {
+                return window;
+            });
+
+        std::vector<std::pair<SteadyTimePoint, unsigned>> in_flight;
+        bool acked = false;
+        ON_CALL(mock_sender, queue_message(_))
+            .WillByDefault([&](std::function<mavlink_message_t(MavlinkAddress, uint8_t)> fun) {
+                const auto message = fun(own_address, channel);
+                if (message.msgid == MAVLINK_MSG_ID_MISSION_REQUEST_INT) {
+                    mavlink_mission_request_int_t request_int;
+                    mavlink_msg_mission_request_int_decode(&message, &request_int);
+                    in_flight.emplace_back(
+                        time.steady_time() + round_trip_time, request_int.seq);
+                } else if (message.msgid == MAVLINK_MSG_ID_MISSION_ACK) {
+                    acked = true;
+                }
+                return true;
+            });
+
+        Result transfer_result{Result::Timeout};
+        mmt_window.receive_incoming_items_async(
+            MAV_MISSION_TYPE_MISSION,
+            items.size(),
+            target_address.system_id,
+            target_address.component_id,
+            [&](Result result, uint8_t type, const std::vector<ItemInt>& output_items) {
+                UNUSED(type);
+                transfer_result = result;
+                EXPECT_EQ(items, output_items);
+            });
+
+        const auto start = time.steady_time();
+        mmt_window.do_work();
+
+        while (!acked && !in_flight.empty()) {
+            // Move on to the next reply and deliver all which are due.
+            const auto next = std::min_element(in_flight.begin(), in_flight.end())->first;
+            time.sleep_for(next - time.steady_time());
+
+            std::vector<unsigned> due;
+            for (auto it = in_flight.begin(); it != in_flight.end();) {
+                if (it->first <= time.steady_time()) {
+                    due.push_back(it->second);
+                    it = in_flight.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            for (const auto sequence : due) {
+                message_handler.process_message(make_mission_item(items, sequence));
+            }
+            timeout_handler.run_once();
+        }
+
+        EXPECT_EQ(transfer_result, Result::Success);
+        mmt_window.do_work();
+        EXPECT_TRUE(mmt_window.is_idle());
+
+        return std::chrono::duration_cast<std::chrono::milliseconds>(time.steady_time() - start);
+    };
+
+    const auto one_by_one = upload_time(1);
+    const auto windowed = upload_time(8);
+
+    LogInfo() << "Receiving " << num_items << " items with " << round_trip_time.count()
+              << " ms round trip time took " << one_by_one.count() << " ms one by one, "
+              << windowed.count() << " ms with a window of 8";
+
+    EXPECT_GE(one_by_one, round_trip_time * num_items);
+    EXPECT_LT(windowed * 4, one_by_one);
+}
@@ -0,0 +1,214 @@
+#include "mavlink_param_pck.h"
+#include "log.h"
+
+#include <cstring>
+
+namespace mavsdk {
+
+namespace {
+
+constexpr uint16_t MAGIC = 0x671b;
+constexpr uint16_t MAGIC_WITH_DEFAULTS = 0x671c;
+constexpr size_t HEADER_LEN = 6;
+constexpr size_t MAX_NAME_LEN = 16;
+constexpr uint8_t FLAG_DEFAULT = 1;
+
+enum Type : uint8_t {
+    TypeNone = 0,
+    TypeInt8 = 1,
+    TypeInt16 = 2,
+    TypeInt32 = 3,
+    TypeFloat = 4,
+};
+
+size_t type_size(uint8_t type)
+{
+    switch (type) {
+        case TypeInt8:
+            return 1;
+        case TypeInt16:
+            return 2;
+        case TypeInt32:
+            // FALLTHROUGH
+        case TypeFloat:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+uint16_t read_u16(const uint8_t* data)
+{
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+uint32_t read_u32(const uint8_t* data)
+{
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+void append_le(std::vector<uint8_t>& data, uint32_t value, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        data.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+ParamValue read_value(uint8_t type, const uint8_t* data)
+{
+    ParamValue value;
+    switch (type) {
+        case TypeInt8:
+            value.set(static_cast<int8_t>(data[0]));
+            break;
+        case TypeInt16:
+            value.set(static_cast<int16_t>(read_u16(data)));
+            break;
+        case TypeInt32:
+            value.set(static_cast<int32_t>(read_u32(data)));
+            break;
+        case TypeFloat: {
+            const uint32_t bits = read_u32(data);
+            float float_value;
+            std::memcpy(&float_value, &bits, sizeof(float_value));
+            value.set(float_value);
+            break;
+        }
+        default:
+            break;
+    }
+    return value;
+}
+
+} // namespace
+
+bool MavlinkParamPck::decode(const std::vector<uint8_t>& data, MavlinkParameterCache& cache)
+{
+    if (data.size() < HEADER_LEN) {
+        LogWarn() << "param.pck too short";
+        return false;
+    }
+
+    const uint16_t magic = read_u16(&data[0]);
+    if (magic != MAGIC && magic != MAGIC_WITH_DEFAULTS) {
+        LogWarn() << "param.pck has wrong magic: " << magic;
+        return false;
+    }
+
+    const uint16_t num_params = read_u16(&data[2]);
+    const uint16_t total_params = read_u16(&data[4]);
+    if (num_params != total_params) {
+        LogWarn() << "param.pck only contains " << num_params << " of " << total_params
+                  << " params";
+        return false;
+    }
+
+    char name[MAX_NAME_LEN + 1]{};
+    uint16_t index = 0;
+    size_t pos = HEADER_LEN;
+
+    while (pos < data.size() && index < num_params) {
+        // Zero bytes are padding so that params don't span FTP packets.
+        if (data[pos] == 0) {
+            ++pos;
+            continue;
+        }
+
+        if (pos + 2 > data.size()) {
+            break;
+        }
+
+        const uint8_t type = data[pos] & 0x0f;
+        const uint8_t flags = data[pos] >> 4;
+        const size_t common_len = data[pos + 1] & 0x0f;
+        const size_t name_len = (data[pos + 1] >> 4) + 1;
+        pos += 2;
+
+        const size_t value_size = type_size(type);
+        const size_t values_size = (flags & FLAG_DEFAULT) ? 2 * value_size : value_size;
+
+        if (value_size == 0 || common_len + name_len > MAX_NAME_LEN ||
+            pos + name_len + values_size > data.size()) {
+            LogWarn() << "param.pck corrupt at param " << index;
+            return false;
+        }
+
+        std::memcpy(name + common_len, &data[pos], name_len);
+        name[common_len + name_len] = '\0';
+        pos += name_len;
+
+        const std::string param_id(name);
+        if (cache.add_new_param(param_id, read_value(type, &data[pos]), index) !=
+            MavlinkParameterCache::AddNewParamResult::Ok) {
+            LogWarn() << "param.pck: could not add " << param_id;
+            return false;
+        }
+        pos += values_size;
+        ++index;
+    }
+
+    if (index != num_params) {
+        LogWarn() << "param.pck incomplete: " << index << " of " << num_params << " params";
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<uint8_t>
+MavlinkParamPck::encode(const std::vector<std::pair<std::string, ParamValue>>& params)
+{
+    std::vector<uint8_t> data;
+    append_le(data, MAGIC, 2);
+    // The count is filled in at the end.
+    append_le(data, 0, 4);
+
+    uint16_t count = 0;
+    std::string previous;
+    for (const auto& [name, value] : params) {
+        uint8_t type = TypeNone;
+        uint32_t bits = 0;
+        if (value.is<int8_t>()) {
+            type = TypeInt8;
+            bits = static_cast<uint8_t>(value.get<int8_t>());
+        } else if (value.is<int16_t>()) {
+            type = TypeInt16;
+            bits = static_cast<uint16_t>(value.get<int16_t>());
+        } else if (value.is<int32_t>()) {
+            type = TypeInt32;
+            bits = static_cast<uint32_t>(value.get<int32_t>());
+        } else if (value.is<float>()) {
+            type = TypeFloat;
+            const float float_value = value.get<float>();
+            std::memcpy(&bits, &float_value, sizeof(bits));
+        }
+
+        if (type == TypeNone || name.empty() || name.size() > MAX_NAME_LEN) {
+            LogWarn() << "param.pck: can't encode " << name;
+            continue;
+        }
+
+        // At least one char is not shared with the previous name.
+        size_t common_len = 0;
+        while (common_len < 15 && common_len + 1 < name.size() &&
+               common_len < previous.size() && name[common_len] == previous[common_len]) {
+            ++common_len;
+        }
+        const size_t name_len = name.size() - common_len;
+
+        data.push_back(type);
+        data.push_back(static_cast<uint8_t>(common_len | ((name_len - 1) << 4)));
+        data.insert(data.end(), name.begin() + common_len, name.end());
+        append_le(data, bits, type_size(type));
+
+        previous = name;
+        ++count;
+    }
+
+    data[2] = data[4] = static_cast<uint8_t>(count);
+    data[3] = data[5] = static_cast<uint8_t>(count >> 8);
+    return data;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "mavlink_parameter_cache.h"
+#include "param_value.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+
+// The packed parameter file which ArduPilot provides over MAVLink FTP as @PARAM/param.pck.
+//
+// It contains all parameters in index order and transfers several times faster than
+// PARAM_REQUEST_LIST. Layout (little endian):
+//
+//     uint16_t magic (0x671b, or 0x671c if defaults are included)
+//     uint16_t num_params
+//     uint16_t total_params
+//     for each param, possibly preceded by zero bytes of padding:
+//         uint8_t type:4 (1: int8, 2: int16, 3: int32, 4: float), flags:4 (bit 0: default)
+//         uint8_t common_len:4, name_len:4 (minus one)
+//         char name[name_len + 1], appended to the first common_len chars of the previous name
+//         value, and default value if flagged, of the size of the type
+class MavlinkParamPck {
+public:
+    static constexpr const char* REMOTE_PATH = "@PARAM/param.pck";
+
+    // Adds the parameters to the cache, returns false if the data is not a complete param.pck.
+    static bool decode(const std::vector<uint8_t>& data, MavlinkParameterCache& cache);
+
+    // Params with other types than int8, int16, int32 and float can't be encoded.
+    static std::vector<uint8_t>
+    encode(const std::vector<std::pair<std::string, ParamValue>>& params);
+};
+
+} // namespace mavsdk
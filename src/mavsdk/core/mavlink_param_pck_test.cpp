@@ -0,0 +1,111 @@
+#include "mavlink_param_pck.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+// Layout as sent by ArduCopter with ?withdefaults=1, including padding before the last param
+// so that it does not span two FTP packets.
+const std::vector<uint8_t> recorded_param_pck{
+    0x1c, 0x67, 0x0e, 0x00, 0x0e, 0x00, 0x14, 0xd0, 0x41, 0x43, 0x52, 0x4f,
+    0x5f, 0x42, 0x41, 0x4c, 0x5f, 0x50, 0x49, 0x54, 0x43, 0x48, 0x00, 0x00,
+    0x80, 0x3f, 0x00, 0x00, 0x80, 0x3f, 0x14, 0x39, 0x52, 0x4f, 0x4c, 0x4c,
+    0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0x80, 0x3f, 0x12, 0x65, 0x4f, 0x50,
+    0x54, 0x49, 0x4f, 0x4e, 0x53, 0x00, 0x00, 0x00, 0x00, 0x14, 0x65, 0x52,
+    0x50, 0x5f, 0x45, 0x58, 0x50, 0x4f, 0x9a, 0x99, 0x99, 0x3e, 0x9a, 0x99,
+    0x99, 0x3e, 0x11, 0x65, 0x54, 0x52, 0x41, 0x49, 0x4e, 0x45, 0x52, 0x02,
+    0x02, 0x13, 0xa1, 0x52, 0x4d, 0x49, 0x4e, 0x47, 0x5f, 0x43, 0x48, 0x45,
+    0x43, 0x4b, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x13, 0xc0,
+    0x42, 0x41, 0x54, 0x54, 0x5f, 0x43, 0x41, 0x50, 0x41, 0x43, 0x49, 0x54,
+    0x59, 0x50, 0x14, 0x00, 0x00, 0xe4, 0x0c, 0x00, 0x00, 0x11, 0x65, 0x4d,
+    0x4f, 0x4e, 0x49, 0x54, 0x4f, 0x52, 0x04, 0x00, 0x11, 0xa0, 0x46, 0x52,
+    0x41, 0x4d, 0x45, 0x5f, 0x43, 0x4c, 0x41, 0x53, 0x53, 0x01, 0x00, 0x13,
+    0xa0, 0x4c, 0x4f, 0x47, 0x5f, 0x42, 0x49, 0x54, 0x4d, 0x41, 0x53, 0x4b,
+    0xfe, 0xaf, 0x02, 0x00, 0xfe, 0xaf, 0x02, 0x00, 0x12, 0xd0, 0x50, 0x49,
+    0x4c, 0x4f, 0x54, 0x5f, 0x53, 0x50, 0x45, 0x45, 0x44, 0x5f, 0x55, 0x50,
+    0xfa, 0x00, 0xfa, 0x00, 0x13, 0x60, 0x52, 0x54, 0x4c, 0x5f, 0x41, 0x4c,
+    0x54, 0x24, 0xfa, 0xff, 0xff, 0xdc, 0x05, 0x00, 0x00, 0x12, 0xc0, 0x53,
+    0x59, 0x53, 0x49, 0x44, 0x5f, 0x54, 0x48, 0x49, 0x53, 0x4d, 0x41, 0x56,
+    0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x14,
+    0xa0, 0x57, 0x50, 0x4e, 0x41, 0x56, 0x5f, 0x53, 0x50, 0x45, 0x45, 0x44,
+    0x00, 0x00, 0x7a, 0x44, 0x00, 0x00, 0x7a, 0x44,
+};
+
+template<typename T> ParamValue make_value(T value)
+{
+    ParamValue param_value;
+    param_value.set(value);
+    return param_value;
+}
+
+} // namespace
+
+TEST(MavlinkParamPck, DecodesRecordedFile)
+{
+    MavlinkParameterCache cache;
+    ASSERT_TRUE(MavlinkParamPck::decode(recorded_param_pck, cache));
+
+    const auto params = cache.all_parameters(false);
+    ASSERT_EQ(params.size(), 14u);
+
+    EXPECT_EQ(params[0].id, "ACRO_BAL_PITCH");
+    EXPECT_EQ(params[0].value, make_value(1.0f));
+    EXPECT_EQ(params[2].id, "ACRO_OPTIONS");
+    EXPECT_EQ(params[2].value, make_value(int16_t{0}));
+    EXPECT_EQ(params[4].id, "ACRO_TRAINER");
+    EXPECT_EQ(params[4].value, make_value(int8_t{2}));
+    EXPECT_EQ(params[6].id, "BATT_CAPACITY");
+    EXPECT_EQ(params[6].value, make_value(int32_t{5200}));
+    EXPECT_EQ(params[11].id, "RTL_ALT");
+    EXPECT_EQ(params[11].value, make_value(int32_t{-1500}));
+    EXPECT_EQ(params[13].id, "WPNAV_SPEED");
+    EXPECT_EQ(params[13].value, make_value(1000.0f));
+    EXPECT_EQ(params[13].index, 13);
+}
+
+TEST(MavlinkParamPck, RejectsIncompleteFile)
+{
+    MavlinkParameterCache cache;
+
+    auto truncated = recorded_param_pck;
+    truncated.resize(truncated.size() - 3);
+    EXPECT_FALSE(MavlinkParamPck::decode(truncated, cache));
+
+    cache.clear();
+    auto wrong_magic = recorded_param_pck;
+    wrong_magic[0] = 0x00;
+    EXPECT_FALSE(MavlinkParamPck::decode(wrong_magic, cache));
+
+    cache.clear();
+    EXPECT_FALSE(MavlinkParamPck::decode({}, cache));
+}
+
+TEST(MavlinkParamPck, EncodesWhatItDecodes)
+{
+    const std::vector<std::pair<std::string, ParamValue>> params{
+        {"SR0_EXTRA1", make_value(int16_t{10})},
+        {"SR0_EXTRA2", make_value(int16_t{-3})},
+        {"SR0_EXT_STAT", make_value(int8_t{2})},
+        {"SERVO_RATE", make_value(int32_t{50})},
+        {"WPNAV_ACCEL", make_value(250.5f)},
+        {"ABCDEFGHIJKLMNOP", make_value(int32_t{1})},
+    };
+
+    const auto data = MavlinkParamPck::encode(params);
+
+    MavlinkParameterCache cache;
+    ASSERT_TRUE(MavlinkParamPck::decode(data, cache));
+
+    const auto decoded = cache.all_parameters(false);
+    ASSERT_EQ(decoded.size(), params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+        EXPECT_EQ(decoded[i].id, params[i].first);
+        EXPECT_EQ(decoded[i].value, params[i].second);
+    }
+}
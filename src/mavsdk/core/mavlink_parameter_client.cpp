@@ -1,6 +1,7 @@
 #include "mavlink_parameter_helper.h"
 #include "mavlink_parameter_client.h"
 #include "mavlink_message_handler.h"
+#include "mavlink_param_pck.h"
 #include "system_impl.h"
 #include "overloaded.h"
 #include <algorithm>
@@ -18,7 +19,8 @@ MavlinkParameterClient::MavlinkParameterClient(
     AutopilotCallback autopilot_callback,
     uint8_t target_system_id,
     uint8_t target_component_id,
-    bool use_extended) :
+    bool use_extended,
+    FileDownloader file_downloader) :
     _sender(sender),
     _message_handler(message_handler),
     _timeout_handler(timeout_handler),
@@ -26,7 +28,8 @@ MavlinkParameterClient::MavlinkParameterClient(
     _autopilot_callback(std::move(autopilot_callback)),
     _target_system_id(target_system_id),
     _target_component_id(target_component_id),
-    _use_extended(use_extended)
+    _use_extended(use_extended),
+    _file_downloader(std::move(file_downloader))
 {
     if (const char* env_p = std::getenv("MAVSDK_PARAMETER_DEBUGGING")) {
         if (std::string(env_p) == "1") {
@@ -483,6 +486,10 @@ void MavlinkParameterClient::do_work()
                     _timeout_handler.add([this] { receive_timeout(); }, _timeout_s_callback());
             },
             [&](WorkItemGetAll& item) {
+                if (request_param_pck(*work)) {
+                    return;
+                }
+
                 // We can't rely on the cache as we haven't implemented the hash check.
                 clear_cache();
                 if (!send_request_list_message()) {
@@ -503,6 +510,80 @@ void MavlinkParameterClient::do_work()
         work->work_item_variant);
 }
 
+bool MavlinkParameterClient::request_param_pck(WorkItem& work)
+{
+    // The packed file only contains the params of the standard protocol.
+    if (_use_extended || !_file_downloader || _param_pck_failed) {
+        return false;
+    }
+
+    auto& item = std::get<WorkItemGetAll>(work.work_item_variant);
+    item.param_pck_requested = true;
+    work.already_requested = true;
+
+    // We're called with the work queue locked, so the result is processed later once the
+    // callback can take the lock.
+    const WorkItem* requested_work = &work;
+    const bool started = _file_downloader(
+        MavlinkParamPck::REMOTE_PATH,
+        [this, requested_work](bool success, std::vector<uint8_t> data) {
+            process_param_pck(requested_work, success, data);
+        });
+
+    if (!started) {
+        item.param_pck_requested = false;
+        work.already_requested = false;
+        return false;
+    }
+
+    if (_parameter_debugging) {
+        LogDebug() << "Requested " << MavlinkParamPck::REMOTE_PATH;
+    }
+    return true;
+}
+
+void MavlinkParameterClient::process_param_pck(
+    const WorkItem* requested_work, bool success, const std::vector<uint8_t>& data)
+{
+    auto work_queue_guard = std::make_unique<LockedQueue<WorkItem>::Guard>(_work_queue);
+    auto work = work_queue_guard->get_front();
+
+    // The work item might have been cancelled in the meantime.
+    if (!work || work.get() != requested_work) {
+        return;
+    }
+
+    auto* item = std::get_if<WorkItemGetAll>(&work->work_item_variant);
+    if (item == nullptr || !item->param_pck_requested) {
+        return;
+    }
+
+    item->param_pck_requested = false;
+
+    clear_cache();
+    if (!success || !MavlinkParamPck::decode(data, _param_cache)) {
+        LogWarn() << "Could not get " << MavlinkParamPck::REMOTE_PATH
+                  << ", requesting params one by one";
+        _param_pck_failed = true;
+        clear_cache();
+        // do_work will send PARAM_REQUEST_LIST instead.
+        work->already_requested = false;
+        return;
+    }
+
+    if (_parameter_debugging) {
+        LogDebug() << "Got " << _param_cache.count(false) << " params from "
+                   << MavlinkParamPck::REMOTE_PATH;
+    }
+
+    work_queue_guard->pop_front();
+    if (item->callback) {
+        auto callback = item->callback;
+        work_queue_guard.reset();
+        callback(Result::Success, _param_cache.all_parameters_map(false));
+    }
+}
+
 bool MavlinkParameterClient::send_set_param_message(WorkItemSet& work_item)
 {
     auto param_id = param_id_to_message_buffer(work_item.param_name);
@@ -796,6 +877,11 @@ void MavlinkParameterClient::process_param_value(const mavlink_message_t& messag
                 }
             },
             [&](WorkItemGetAll& item) {
+                if (item.param_pck_requested) {
+                    // The params are coming as a file.
+                    return;
+                }
+
                 auto maybe_current_missing_index = _param_cache.last_missing_requested();
 
                 switch (_param_cache.add_new_param(
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "autopilot_callback.h"
+#include "file_transfer_callbacks.h"
 #include "log.h"
 #include "mavlink_include.h"
 #include "timeout_s_callback.h"
@@ -12,6 +13,7 @@
 #include "timeout_handler.h"
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <string>
@@ -38,7 +40,8 @@ public:
         AutopilotCallback autopilot_callback,
         uint8_t target_system_id,
         uint8_t target_component_id = MAV_COMP_ID_AUTOPILOT1,
-        bool use_extended_protocol = false);
+        bool use_extended_protocol = false,
+        FileDownloader file_downloader = {});
     ~MavlinkParameterClient();
 
     // Non-copyable
@@ -178,6 +181,7 @@ private:
         const GetAllParamsCallback callback;
         uint16_t count;
         bool rerequesting;
+        bool param_pck_requested{false};
     };
 
     struct WorkItem {
@@ -198,6 +202,9 @@ private:
     void process_param_error(const mavlink_message_t& message);
     void receive_timeout();
 
+    bool request_param_pck(WorkItem& work);
+    void process_param_pck(const WorkItem* work, bool success, const std::vector<uint8_t>& data);
+
     bool send_set_param_message(WorkItemSet& work_item);
     bool send_get_param_message(WorkItemGet& work_item);
     bool send_get_param_message(
@@ -215,6 +222,11 @@ private:
     uint8_t _target_component_id = MAV_COMP_ID_AUTOPILOT1;
     bool _use_extended = false;
 
+    // Used to get all params at once as @PARAM/param.pck, if available.
+    FileDownloader _file_downloader{};
+    // Once it failed, we don't try again and use PARAM_REQUEST_LIST.
+    std::atomic<bool> _param_pck_failed{false};
+
     // These are specific depending on the work item type
     LockedQueue<WorkItem> _work_queue{};
     TimeoutHandler::Cookie _timeout_cookie{};
@@ -38,6 +38,9 @@ bool MavlinkReceiver::parse_message()
             // And decrease the length, so we don't overshoot in the next round.
             _datagram_len -= (i + 1);
 
+            _last_message_bad_crc = false;
+            _last_message_unknown_id = false;
+
             if (_drop_debugging_on) {
                 debug_drop_rate();
             }
@@ -71,6 +74,9 @@ bool MavlinkReceiver::parse_message()
                 // And decrease the length, so we don't overshoot in the next round.
                 _datagram_len -= (i + 1);
 
+                _last_message_bad_crc = true;
+                _last_message_unknown_id = mavlink_get_msg_entry(_last_message.msgid) == nullptr;
+
                 // Return true to indicate we have something to process (raw message)
                 return true;
             }
@@ -14,6 +14,14 @@ public:
 
     mavlink_status_t& get_status() { return _status; }
 
+    // Whether the last message returned by parse_message() failed the CRC check, e.g.
+    // because the message ID is unknown to us.
+    bool last_message_bad_crc() const { return _last_message_bad_crc; }
+
+    // Whether the CRC check of the last message failed because the message ID is unknown
+    // to us, so the checksum could not be checked at all.
+    bool last_message_unknown_id() const { return _last_message_unknown_id; }
+
     void set_new_datagram(char* datagram, unsigned datagram_len);
 
     bool parse_message();
@@ -34,6 +42,8 @@ private:
     mavlink_status_t _mavlink_status{};
     char* _datagram = nullptr;
     unsigned _datagram_len = 0;
+    bool _last_message_bad_crc{false};
+    bool _last_message_unknown_id{false};
 
     Time _time{};
 
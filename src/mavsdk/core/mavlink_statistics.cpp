@@ -0,0 +1,255 @@
+#include "mavlink_statistics.h"
+
+#include <cmath>
+#include <limits>
+
+namespace mavsdk {
+
+size_t mavlink_frame_length(const mavlink_message_t& message)
+{
+    if (message.magic == MAVLINK_STX_MAVLINK1) {
+        return MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + message.len + MAVLINK_NUM_CHECKSUM_BYTES;
+    }
+
+    size_t length = MAVLINK_CORE_HEADER_LEN + 1 + message.len + MAVLINK_NUM_CHECKSUM_BYTES;
+    if ((message.incompat_flags & MAVLINK_IFLAG_SIGNED) != 0) {
+        length += MAVLINK_SIGNATURE_BLOCK_LEN;
+    }
+    return length;
+}
+
+void MessageIdCounters::record(uint32_t message_id, size_t bytes)
+{
+    _total.messages.fetch_add(1, std::memory_order_relaxed);
+    _total.bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+    if (auto* counter = _table.get(message_id)) {
+        counter->messages.fetch_add(1, std::memory_order_relaxed);
+        counter->bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+void MessageIdCounters::update_rates(double elapsed_s)
+{
+    if (elapsed_s <= 0.0) {
+        return;
+    }
+
+    _total.update_rates(elapsed_s);
+    _table.for_each([elapsed_s](uint32_t, Counter& counter) { counter.update_rates(elapsed_s); });
+}
+
+void MessageIdCounters::Counter::update_rates(double elapsed_s)
+{
+    const uint64_t messages_now = messages.load(std::memory_order_relaxed);
+    const uint64_t bytes_now = bytes.load(std::memory_order_relaxed);
+
+    rate_hz.store(
+        static_cast<double>(messages_now - messages_last) / elapsed_s, std::memory_order_relaxed);
+    bytes_rate.store(
+        static_cast<double>(bytes_now - bytes_last) / elapsed_s, std::memory_order_relaxed);
+
+    messages_last = messages_now;
+    bytes_last = bytes_now;
+}
+
+std::vector<MessageIdStatistics> MessageIdCounters::snapshot() const
+{
+    std::vector<MessageIdStatistics> result;
+    _table.for_each([&result](uint32_t message_id, const Counter& counter) {
+        const uint64_t messages = counter.messages.load(std::memory_order_relaxed);
+        if (messages == 0) {
+            return;
+        }
+        MessageIdStatistics statistics;
+        statistics.message_id = message_id;
+        statistics.messages = messages;
+        statistics.bytes = counter.bytes.load(std::memory_order_relaxed);
+        statistics.rate_hz = counter.rate_hz.load(std::memory_order_relaxed);
+        result.push_back(statistics);
+    });
+    return result;
+}
+
+void DurationRecorder::record(std::chrono::steady_clock::duration duration)
+{
+    const auto us_signed = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    const uint64_t us = us_signed > 0 ? static_cast<uint64_t>(us_signed) : 0;
+
+    // Bucket i counts durations below 2^i us.
+    size_t bucket = 0;
+    while (bucket < DurationHistogram::NUM_BUCKETS - 1 && (us >> bucket) != 0) {
+        ++bucket;
+    }
+
+    _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _total_us.fetch_add(us, std::memory_order_relaxed);
+
+    uint64_t max_us = _max_us.load(std::memory_order_relaxed);
+    while (us > max_us &&
+           !_max_us.compare_exchange_weak(max_us, us, std::memory_order_relaxed)) {}
+}
+
+DurationHistogram DurationRecorder::snapshot() const
+{
+    DurationHistogram histogram;
+    for (size_t i = 0; i < DurationHistogram::NUM_BUCKETS; ++i) {
+        histogram.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+    }
+    histogram.count = _count.load(std::memory_order_relaxed);
+    histogram.total_us = _total_us.load(std::memory_order_relaxed);
+    histogram.max_us = _max_us.load(std::memory_order_relaxed);
+    return histogram;
+}
+
+void MessageIdDurations::record(uint32_t message_id, std::chrono::steady_clock::duration duration)
+{
+    if (auto* recorder = _table.get(message_id)) {
+        recorder->record(duration);
+    }
+}
+
+std::vector<HandlerStatistics> MessageIdDurations::snapshot() const
+{
+    std::vector<HandlerStatistics> result;
+    _table.for_each([&result](uint32_t message_id, const DurationRecorder& recorder) {
+        if (recorder.count() == 0) {
+            return;
+        }
+        HandlerStatistics statistics;
+        statistics.message_id = message_id;
+        statistics.duration = recorder.snapshot();
+        result.push_back(statistics);
+    });
+    return result;
+}
+
+LinkQualityTracker::Source* LinkQualityTracker::find_or_insert(uint32_t key)
+{
+    for (size_t i = 0; i < MAX_SOURCES; ++i) {
+        auto& source = _sources[(key + i) % MAX_SOURCES];
+        uint32_t existing = source.key.load(std::memory_order_acquire);
+
+        if (existing == 0 &&
+            source.key.compare_exchange_strong(existing, key, std::memory_order_acq_rel)) {
+            return &source;
+        }
+
+        if (existing == key) {
+            return &source;
+        }
+    }
+
+    // Too many senders on this link, we don't track the rest.
+    return nullptr;
+}
+
+uint32_t LinkQualityTracker::record(uint8_t system_id, uint8_t component_id, uint8_t sequence)
+{
+    const uint32_t key = ((static_cast<uint32_t>(system_id) << 8) | component_id) + 1;
+
+    auto* source = find_or_insert(key);
+    if (source == nullptr) {
+        return 0;
+    }
+
+    source->received.fetch_add(1, std::memory_order_relaxed);
+
+    const int16_t last = source->last_sequence.exchange(sequence, std::memory_order_relaxed);
+    if (last < 0) {
+        // First message from this sender, nothing to compare against.
+        return 0;
+    }
+
+    const uint32_t lost = static_cast<uint8_t>(sequence - last - 1);
+    // A huge gap is much more likely a restarted sender than lost messages.
+    if (lost > 0 && lost < 128) {
+        source->lost.fetch_add(lost, std::memory_order_relaxed);
+        _lost.fetch_add(lost, std::memory_order_relaxed);
+        return lost;
+    }
+    return 0;
+}
+
+void LinkQualityTracker::record_round_trip_time(
+    uint8_t system_id, uint8_t component_id, std::chrono::steady_clock::duration rtt)
+{
+    const uint32_t key = ((static_cast<uint32_t>(system_id) << 8) | component_id) + 1;
+
+    auto* source = find_or_insert(key);
+    if (source == nullptr) {
+        return;
+    }
+
+    const double rtt_s = std::chrono::duration<double>(rtt).count();
+
+    if (source->rtt_valid.load(std::memory_order_relaxed)) {
+        // Smoothed like the interarrival jitter in RFC 3550.
+        const double difference =
+            std::abs(rtt_s - source->rtt_s.load(std::memory_order_relaxed));
+        const double jitter = source->rtt_jitter_s.load(std::memory_order_relaxed);
+        source->rtt_jitter_s.store(
+            jitter + (difference - jitter) / 16.0, std::memory_order_relaxed);
+    }
+
+    source->rtt_s.store(rtt_s, std::memory_order_relaxed);
+    source->rtt_valid.store(true, std::memory_order_relaxed);
+}
+
+void LinkQualityTracker::update_rates(double elapsed_s)
+{
+    for (auto& source : _sources) {
+        if (source.key.load(std::memory_order_acquire) == 0) {
+            continue;
+        }
+
+        const uint64_t received = source.received.load(std::memory_order_relaxed);
+        const uint64_t lost = source.lost.load(std::memory_order_relaxed);
+        const uint64_t received_interval = received - source.received_last;
+        const uint64_t lost_interval = lost - source.lost_last;
+
+        source.loss_ratio.store(
+            (received_interval + lost_interval) > 0 ?
+                static_cast<double>(lost_interval) /
+                    static_cast<double>(received_interval + lost_interval) :
+                0.0,
+            std::memory_order_relaxed);
+
+        source.idle_s.store(
+            received_interval > 0 ? 0.0 :
+                                    source.idle_s.load(std::memory_order_relaxed) + elapsed_s,
+            std::memory_order_relaxed);
+
+        source.received_last = received;
+        source.lost_last = lost;
+    }
+}
+
+std::vector<LinkQuality> LinkQualityTracker::snapshot(uint8_t system_id) const
+{
+    std::vector<LinkQuality> result;
+
+    for (const auto& source : _sources) {
+        const uint32_t key = source.key.load(std::memory_order_acquire);
+        if (key == 0 || ((key - 1) >> 8) != system_id) {
+            continue;
+        }
+
+        LinkQuality link_quality;
+        link_quality.component_id = static_cast<uint8_t>((key - 1) & 0xff);
+        link_quality.messages_received = source.received.load(std::memory_order_relaxed);
+        link_quality.messages_lost = source.lost.load(std::memory_order_relaxed);
+        link_quality.loss_ratio = source.loss_ratio.load(std::memory_order_relaxed);
+        link_quality.rtt_s = source.rtt_valid.load(std::memory_order_relaxed) ?
+                                 source.rtt_s.load(std::memory_order_relaxed) :
+                                 std::numeric_limits<double>::quiet_NaN();
+        link_quality.rtt_jitter_s = source.rtt_jitter_s.load(std::memory_order_relaxed);
+        link_quality.idle_s = source.idle_s.load(std::memory_order_relaxed);
+        result.push_back(link_quality);
+    }
+
+    return result;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "mavlink_include.h"
+#include "statistics.h"
+
+namespace mavsdk {
+
+// The classes in here are meant to be updated for every message, so they only use relaxed
+// atomics and fixed size tables. They can be updated from the receive threads and read from
+// any other thread without taking a lock.
+
+// Length of the message on the wire including header, checksum and signature.
+size_t mavlink_frame_length(const mavlink_message_t& message);
+
+// Table indexed by MAVLink message ID. The common IDs are looked up directly, everything
+// else (e.g. dialect messages) goes into a small open addressing table.
+//
+// The storage is allocated lazily in pages of PAGE_SIZE IDs, so only the ranges of IDs which
+// are actually used take up memory.
+template<typename T> class MessageIdTable {
+public:
+    MessageIdTable() = default;
+
+    ~MessageIdTable()
+    {
+        for (auto& page : _pages) {
+            delete page.load(std::memory_order_acquire);
+        }
+        delete _hashed.load(std::memory_order_acquire);
+    }
+
+    // Returns nullptr if the table is full.
+    T* get(uint32_t message_id)
+    {
+        if (message_id < DIRECT_SLOTS) {
+            auto* page = get_or_allocate(_pages[message_id / PAGE_SIZE]);
+            return &(*page)[message_id % PAGE_SIZE];
+        }
+
+        auto& hashed = *get_or_allocate(_hashed);
+        for (size_t i = 0; i < HASHED_SLOTS; ++i) {
+            auto& slot = hashed[(message_id + i) % HASHED_SLOTS];
+            uint32_t key = slot.message_id.load(std::memory_order_acquire);
+            if (key == message_id) {
+                return &slot.value;
+            }
+            if (key == EMPTY &&
+                slot.message_id.compare_exchange_strong(
+                    key, message_id, std::memory_order_acq_rel)) {
+                return &slot.value;
+            }
+            if (key == message_id) {
+                // Someone else inserted the same ID just now.
+                return &slot.value;
+            }
+        }
+        return nullptr;
+    }
+
+    // Like get() but doesn't insert, returns nullptr if the ID hasn't been used before.
+    const T* find(uint32_t message_id) const
+    {
+        if (message_id < DIRECT_SLOTS) {
+            const auto* page = _pages[message_id / PAGE_SIZE].load(std::memory_order_acquire);
+            return page != nullptr ? &(*page)[message_id % PAGE_SIZE] : nullptr;
+        }
+
+        const auto* hashed = _hashed.load(std::memory_order_acquire);
+        if (hashed == nullptr) {
+            return nullptr;
+        }
+
+        for (size_t i = 0; i < HASHED_SLOTS; ++i) {
+            const auto& slot = (*hashed)[(message_id + i) % HASHED_SLOTS];
+            const uint32_t key = slot.message_id.load(std::memory_order_acquire);
+            if (key == message_id) {
+                return &slot.value;
+            }
+            if (key == EMPTY) {
+                return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+    // Only visits the IDs in allocated pages.
+    template<typename F> void for_each(F&& f) const
+    {
+        for (uint32_t page_index = 0; page_index < NUM_PAGES; ++page_index) {
+            const auto* page = _pages[page_index].load(std::memory_order_acquire);
+            if (page == nullptr) {
+                continue;
+            }
+            for (uint32_t i = 0; i < PAGE_SIZE; ++i) {
+                f(page_index * PAGE_SIZE + i, (*page)[i]);
+            }
+        }
+
+        const auto* hashed = _hashed.load(std::memory_order_acquire);
+        if (hashed == nullptr) {
+            return;
+        }
+        for (const auto& slot : *hashed) {
+            const uint32_t key = slot.message_id.load(std::memory_order_acquire);
+            if (key != EMPTY) {
+                f(key, slot.value);
+            }
+        }
+    }
+
+    template<typename F> void for_each(F&& f)
+    {
+        std::as_const(*this).for_each(
+            [&f](uint32_t message_id, const T& value) { f(message_id, const_cast<T&>(value)); });
+    }
+
+    MessageIdTable(const MessageIdTable&) = delete;
+    MessageIdTable& operator=(const MessageIdTable&) = delete;
+
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+    static constexpr uint32_t DIRECT_SLOTS = 512;
+    static constexpr uint32_t PAGE_SIZE = 32;
+    static constexpr uint32_t NUM_PAGES = DIRECT_SLOTS / PAGE_SIZE;
+    static constexpr size_t HASHED_SLOTS = 64;
+
+    struct HashedSlot {
+        std::atomic<uint32_t> message_id{EMPTY};
+        T value{};
+    };
+
+    using Page = std::array<T, PAGE_SIZE>;
+    using Hashed = std::array<HashedSlot, HASHED_SLOTS>;
+
+    template<typename Storage> static Storage* get_or_allocate(std::atomic<Storage*>& pointer)
+    {
+        Storage* storage = pointer.load(std::memory_order_acquire);
+        if (storage != nullptr) {
+            return storage;
+        }
+
+        auto* new_storage = new Storage{};
+        if (pointer.compare_exchange_strong(storage, new_storage, std::memory_order_acq_rel)) {
+            return new_storage;
+        }
+        // Someone else was faster.
+        delete new_storage;
+        return storage;
+    }
+
+    std::array<std::atomic<Page*>, NUM_PAGES> _pages{};
+    std::atomic<Hashed*> _hashed{nullptr};
+};
+
+// Message and byte counters, in total and per message ID, including the rates during the
+// last rate interval.
+class MessageIdCounters {
+public:
+    MessageIdCounters() = default;
+
+    void record(uint32_t message_id, size_t bytes);
+
+    // To be called periodically from one thread only.
+    void update_rates(double elapsed_s);
+
+    uint64_t messages() const { return _total.messages.load(std::memory_order_relaxed); }
+    uint64_t bytes() const { return _total.bytes.load(std::memory_order_relaxed); }
+    double rate_hz() const { return _total.rate_hz.load(std::memory_order_relaxed); }
+    double bytes_rate() const { return _total.bytes_rate.load(std::memory_order_relaxed); }
+
+    std::vector<MessageIdStatistics> snapshot() const;
+
+private:
+    struct Counter {
+        std::atomic<uint64_t> messages{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<double> rate_hz{0.0};
+        std::atomic<double> bytes_rate{0.0};
+        // Only used by update_rates.
+        uint64_t messages_last{0};
+        uint64_t bytes_last{0};
+
+        void update_rates(double elapsed_s);
+    };
+
+    Counter _total{};
+    MessageIdTable<Counter> _table{};
+};
+
+class DurationRecorder {
+public:
+    DurationRecorder() = default;
+
+    void record(std::chrono::steady_clock::duration duration);
+
+    uint64_t count() const { return _count.load(std::memory_order_relaxed); }
+
+    DurationHistogram snapshot() const;
+
+private:
+    std::array<std::atomic<uint64_t>, DurationHistogram::NUM_BUCKETS> _buckets{};
+    std::atomic<uint64_t> _count{0};
+    std::atomic<uint64_t> _total_us{0};
+    std::atomic<uint64_t> _max_us{0};
+};
+
+class MessageIdDurations {
+public:
+    MessageIdDurations() = default;
+
+    void record(uint32_t message_id, std::chrono::steady_clock::duration duration);
+
+    std::vector<HandlerStatistics> snapshot() const;
+
+private:
+    MessageIdTable<DurationRecorder> _table{};
+};
+
+// Counts gaps in the MAVLink sequence numbers and keeps the round trip time per sender
+// (system ID and component ID) on one link.
+class LinkQualityTracker {
+public:
+    LinkQualityTracker() = default;
+
+    // Returns the number of messages which went missing before this one.
+    uint32_t record(uint8_t system_id, uint8_t component_id, uint8_t sequence);
+
+    // To be called from one thread only.
+    void record_round_trip_time(
+        uint8_t system_id, uint8_t component_id, std::chrono::steady_clock::duration rtt);
+
+    // To be called periodically from one thread only.
+    void update_rates(double elapsed_s);
+
+    uint64_t lost() const { return _lost.load(std::memory_order_relaxed); }
+
+    // The connection handle is not known here and left empty.
+    std::vector<LinkQuality> snapshot(uint8_t system_id) const;
+
+private:
+    struct Source {
+        // (system_id << 8 | component_id) + 1, 0 means empty.
+        std::atomic<uint32_t> key{0};
+        // -1 until the first message arrived.
+        std::atomic<int16_t> last_sequence{-1};
+        std::atomic<uint64_t> received{0};
+        std::atomic<uint64_t> lost{0};
+        std::atomic<double> loss_ratio{0.0};
+        std::atomic<double> rtt_s{0.0};
+        std::atomic<double> rtt_jitter_s{0.0};
+        std::atomic<bool> rtt_valid{false};
+        std::atomic<double> idle_s{0.0};
+        // Only used by update_rates.
+        uint64_t received_last{0};
+        uint64_t lost_last{0};
+    };
+
+    Source* find_or_insert(uint32_t key);
+
+    static constexpr size_t MAX_SOURCES = 64;
+    std::array<Source, MAX_SOURCES> _sources{};
+    std::atomic<uint64_t> _lost{0};
+};
+
+class QueueDepthRecorder {
+public:
+    void record(size_t depth)
+    {
+        size_t peak = _peak.load(std::memory_order_relaxed);
+        while (depth > peak &&
+               !_peak.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {}
+    }
+
+    size_t peak() const { return _peak.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<size_t> _peak{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,210 @@
+#include "mavlink_statistics.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+TEST(MavlinkStatistics, CountsPerMessageId)
+{
+    MessageIdCounters counters;
+
+    counters.record(0, 21);
+    counters.record(0, 21);
+    counters.record(33, 40);
+    // Dialect message with an ID outside the directly indexed range.
+    counters.record(42000, 30);
+
+    EXPECT_EQ(counters.messages(), 4);
+    EXPECT_EQ(counters.bytes(), 112);
+
+    auto snapshot = counters.snapshot();
+    ASSERT_EQ(snapshot.size(), 3);
+
+    auto find = [&](uint32_t message_id) {
+        return std::find_if(snapshot.begin(), snapshot.end(), [&](const auto& entry) {
+            return entry.message_id == message_id;
+        });
+    };
+
+    ASSERT_NE(find(0), snapshot.end());
+    EXPECT_EQ(find(0)->messages, 2);
+    EXPECT_EQ(find(0)->bytes, 42);
+    ASSERT_NE(find(33), snapshot.end());
+    EXPECT_EQ(find(33)->messages, 1);
+    ASSERT_NE(find(42000), snapshot.end());
+    EXPECT_EQ(find(42000)->bytes, 30);
+}
+
+TEST(MavlinkStatistics, TableIsAllocatedLazily)
+{
+    MessageIdTable<std::atomic<uint32_t>> table;
+
+    EXPECT_EQ(table.find(0), nullptr);
+    EXPECT_EQ(table.find(42000), nullptr);
+
+    size_t visited = 0;
+    table.for_each([&visited](uint32_t, const std::atomic<uint32_t>&) { ++visited; });
+    EXPECT_EQ(visited, 0);
+
+    ASSERT_NE(table.get(33), nullptr);
+    table.get(33)->fetch_add(1);
+
+    // Only the page with ID 33 has been allocated.
+    ASSERT_NE(table.find(34), nullptr);
+    EXPECT_EQ(table.find(34)->load(), 0);
+    EXPECT_EQ(table.find(300), nullptr);
+    EXPECT_EQ(table.find(42000), nullptr);
+    EXPECT_EQ(table.find(33)->load(), 1);
+
+    ASSERT_NE(table.get(42000), nullptr);
+    EXPECT_NE(table.find(42000), nullptr);
+    EXPECT_EQ(table.find(42001), nullptr);
+}
+
+TEST(MavlinkStatistics, Rates)
+{
+    MessageIdCounters counters;
+
+    for (int i = 0; i < 50; ++i) {
+        counters.record(30, 40);
+    }
+    counters.update_rates(0.5);
+
+    EXPECT_DOUBLE_EQ(counters.rate_hz(), 100.0);
+    EXPECT_DOUBLE_EQ(counters.bytes_rate(), 4000.0);
+    EXPECT_DOUBLE_EQ(counters.snapshot()[0].rate_hz, 100.0);
+
+    // Nothing new, rate goes back to 0.
+    counters.update_rates(1.0);
+    EXPECT_DOUBLE_EQ(counters.rate_hz(), 0.0);
+    EXPECT_EQ(counters.messages(), 50);
+}
+
+TEST(MavlinkStatistics, ConcurrentRecording)
+{
+    MessageIdCounters counters;
+
+    constexpr int num_threads = 4;
+    constexpr int messages_per_thread = 10000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&counters, t]() {
+            for (int i = 0; i < messages_per_thread; ++i) {
+                counters.record(10000 + (i % 8) * 10 + t, 1);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(counters.messages(), num_threads * messages_per_thread);
+
+    uint64_t sum = 0;
+    const auto snapshot = counters.snapshot();
+    for (const auto& entry : snapshot) {
+        sum += entry.messages;
+    }
+    EXPECT_EQ(snapshot.size(), num_threads * 8);
+    EXPECT_EQ(sum, num_threads * messages_per_thread);
+}
+
+TEST(MavlinkStatistics, SequenceLoss)
+{
+    LinkQualityTracker tracker;
+
+    EXPECT_EQ(tracker.record(1, 1, 10), 0);
+    EXPECT_EQ(tracker.record(1, 1, 11), 0);
+    EXPECT_EQ(tracker.record(1, 1, 14), 2);
+
+    // Another component has its own sequence.
+    EXPECT_EQ(tracker.record(1, 100, 200), 0);
+    EXPECT_EQ(tracker.record(1, 100, 201), 0);
+
+    // Wrap around.
+    EXPECT_EQ(tracker.record(1, 1, 254), 0); // Big jump, treated as restart.
+    EXPECT_EQ(tracker.record(1, 1, 255), 0);
+    EXPECT_EQ(tracker.record(1, 1, 1), 1);
+
+    EXPECT_EQ(tracker.lost(), 3);
+}
+
+TEST(MavlinkStatistics, DurationHistogram)
+{
+    DurationRecorder recorder;
+
+    recorder.record(std::chrono::nanoseconds(500));
+    recorder.record(std::chrono::microseconds(1));
+    recorder.record(std::chrono::microseconds(3));
+    recorder.record(std::chrono::microseconds(1000));
+    recorder.record(std::chrono::seconds(10));
+
+    const auto histogram = recorder.snapshot();
+    EXPECT_EQ(histogram.count, 5);
+    EXPECT_EQ(histogram.buckets[0], 1);
+    EXPECT_EQ(histogram.buckets[1], 1);
+    EXPECT_EQ(histogram.buckets[2], 1);
+    EXPECT_EQ(histogram.buckets[10], 1);
+    EXPECT_EQ(histogram.buckets[DurationHistogram::NUM_BUCKETS - 1], 1);
+    EXPECT_EQ(histogram.max_us, 10000000);
+    EXPECT_EQ(histogram.total_us, 10001004);
+}
+
+TEST(MavlinkStatistics, FrameLength)
+{
+    mavlink_message_t message{};
+    message.magic = MAVLINK_STX;
+    message.len = 9;
+    EXPECT_EQ(mavlink_frame_length(message), 21);
+
+    message.incompat_flags = MAVLINK_IFLAG_SIGNED;
+    EXPECT_EQ(mavlink_frame_length(message), 34);
+
+    message.magic = MAVLINK_STX_MAVLINK1;
+    message.incompat_flags = 0;
+    EXPECT_EQ(mavlink_frame_length(message), 17);
+}
+
+TEST(MavlinkStatistics, LinkQuality)
+{
+    LinkQualityTracker tracker;
+
+    // Message 2 and 3 lost.
+    for (uint8_t sequence : {0, 1, 4, 5, 6, 7, 8, 9}) {
+        tracker.record(1, 1, sequence);
+    }
+    tracker.record(2, 1, 0);
+    tracker.update_rates(1.0);
+
+    auto snapshot = tracker.snapshot(1);
+    ASSERT_EQ(snapshot.size(), 1);
+    EXPECT_EQ(snapshot[0].component_id, 1);
+    EXPECT_EQ(snapshot[0].messages_received, 8);
+    EXPECT_EQ(snapshot[0].messages_lost, 2);
+    EXPECT_DOUBLE_EQ(snapshot[0].loss_ratio, 0.2);
+    EXPECT_TRUE(std::isnan(snapshot[0].rtt_s));
+
+    tracker.record_round_trip_time(1, 1, std::chrono::milliseconds(100));
+    tracker.record_round_trip_time(1, 1, std::chrono::milliseconds(116));
+    tracker.record(1, 1, 10);
+    tracker.update_rates(1.0);
+
+    snapshot = tracker.snapshot(1);
+    ASSERT_EQ(snapshot.size(), 1);
+    EXPECT_NEAR(snapshot[0].rtt_s, 0.116, 1e-9);
+    EXPECT_NEAR(snapshot[0].rtt_jitter_s, 0.001, 1e-9);
+    EXPECT_DOUBLE_EQ(snapshot[0].loss_ratio, 0.0);
+    EXPECT_DOUBLE_EQ(snapshot[0].idle_s, 0.0);
+
+    tracker.update_rates(1.0);
+    tracker.update_rates(1.0);
+    EXPECT_DOUBLE_EQ(tracker.snapshot(1)[0].idle_s, 2.0);
+
+    EXPECT_EQ(tracker.snapshot(2).size(), 1);
+    EXPECT_TRUE(tracker.snapshot(3).empty());
+}
@@ -224,6 +224,56 @@ void Mavsdk::Configuration::set_mav_type(uint8_t mav_type)
     _mav_type = static_cast<MAV_TYPE>(mav_type);
 }
 
+double Mavsdk::Configuration::get_outbound_bandwidth_limit() const
+{
+    return _outbound_bandwidth_limit;
+}
+
+void Mavsdk::Configuration::set_outbound_bandwidth_limit(double bytes_per_second)
+{
+    _outbound_bandwidth_limit = bytes_per_second > 0.0 ? bytes_per_second : 0.0;
+}
+
+bool Mavsdk::Configuration::get_serial_low_latency() const
+{
+    return _serial_low_latency;
+}
+
+void Mavsdk::Configuration::set_serial_low_latency(bool low_latency)
+{
+    _serial_low_latency = low_latency;
+}
+
+bool Mavsdk::Configuration::get_mission_transfer_over_ftp() const
+{
+    return _mission_transfer_over_ftp;
+}
+
+void Mavsdk::Configuration::set_mission_transfer_over_ftp(bool over_ftp)
+{
+    _mission_transfer_over_ftp = over_ftp;
+}
+
+bool Mavsdk::Configuration::get_mission_partial_upload() const
+{
+    return _mission_partial_upload;
+}
+
+void Mavsdk::Configuration::set_mission_partial_upload(bool partial_upload)
+{
+    _mission_partial_upload = partial_upload;
+}
+
+unsigned Mavsdk::Configuration::get_mission_server_request_window() const
+{
+    return _mission_server_request_window;
+}
+
+void Mavsdk::Configuration::set_mission_server_request_window(unsigned window)
+{
+    _mission_server_request_window = window;
+}
+
 void Mavsdk::intercept_incoming_messages_async(std::function<bool(mavlink_message_t&)> callback)
 {
     _impl->intercept_incoming_messages_async(callback);
@@ -260,6 +310,11 @@ void Mavsdk::unsubscribe_connection_errors(ConnectionErrorHandle handle)
     return _impl->unsubscribe_connection_errors(handle);
 }
 
+MavsdkStatistics Mavsdk::statistics() const
+{
+    return _impl->statistics();
+}
+
 Mavsdk::InterceptJsonHandle
 Mavsdk::subscribe_incoming_messages_json(const InterceptJsonCallback& callback)
 {
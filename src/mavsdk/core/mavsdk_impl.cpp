@@ -5,6 +5,7 @@
 #include <tcp_server_connection.h>
 
 #include "connection.h"
+#include "link_selector.h"
 #include "log.h"
 #include "tcp_client_connection.h"
 #include "tcp_server_connection.h"
@@ -26,6 +27,83 @@ namespace mavsdk {
 
 template class CallbackList<>;
 
+namespace {
+
+std::unique_ptr<mav::MessageSet> create_message_set(const std::vector<std::string>& custom_xml)
+{
+    auto message_set = std::make_unique<mav::MessageSet>();
+    message_set->addFromXMLString(mav_embedded::MINIMAL_XML);
+    message_set->addFromXMLString(mav_embedded::STANDARD_XML);
+    message_set->addFromXMLString(mav_embedded::COMMON_XML);
+    message_set->addFromXMLString(mav_embedded::ARDUPILOTMEGA_XML);
+
+    for (const auto& xml : custom_xml) {
+        if (message_set->addFromXMLString(xml, false /* recursive_open_includes */) !=
+            ::mav::MessageSetResult::Success) {
+            return nullptr;
+        }
+    }
+    return message_set;
+}
+
+// Every thread parses with its own BufferParser so that the receive threads don't have
+// to wait for each other. The thread also keeps the message set it used last alive, so that
+// parsed messages and definitions it got from it stay valid until it moves on to a newer one.
+// This is kept per MavsdkImpl instance, so that using several instances on the same thread
+// doesn't release the set of one while its messages are still in use.
+struct ThreadMessageSet {
+    // Expires when the owning instance is destroyed.
+    std::weak_ptr<void> owner;
+    std::shared_ptr<mav::MessageSet> message_set;
+    std::unique_ptr<mav::BufferParser> parser;
+};
+
+ThreadMessageSet&
+thread_message_set(const std::shared_ptr<void>& owner, std::shared_ptr<mav::MessageSet> message_set)
+{
+    // Usually there is only one instance, so this stays tiny. The entries are on the heap so
+    // that references to them stay valid when others are added or removed.
+    thread_local std::vector<std::unique_ptr<ThreadMessageSet>> entries;
+
+    // Let go of the sets of instances which are gone.
+    entries.erase(
+        std::remove_if(
+            entries.begin(),
+            entries.end(),
+            [](const auto& entry) { return entry->owner.expired(); }),
+        entries.end());
+
+    auto it = std::find_if(entries.begin(), entries.end(), [&](const auto& entry) {
+        return !entry->owner.owner_before(owner) && !owner.owner_before(entry->owner);
+    });
+    if (it == entries.end()) {
+        entries.push_back(std::make_unique<ThreadMessageSet>());
+        entries.back()->owner = owner;
+        it = std::prev(entries.end());
+    }
+
+    auto& current = **it;
+
+    // The set we hold can't be freed, so its address can't be reused by another set.
+    if (current.message_set != message_set) {
+        current.parser.reset();
+        current.message_set = std::move(message_set);
+    }
+    return current;
+}
+
+mav::BufferParser& thread_buffer_parser(
+    const std::shared_ptr<void>& owner, std::shared_ptr<mav::MessageSet> message_set)
+{
+    auto& current = thread_message_set(owner, std::move(message_set));
+    if (!current.parser) {
+        current.parser = std::make_unique<mav::BufferParser>(*current.message_set);
+    }
+    return *current.parser;
+}
+
+} // namespace
+
 MavsdkImpl::MavsdkImpl(const Mavsdk::Configuration& configuration) :
     timeout_handler(time),
     call_every_handler(time)
@@ -57,15 +135,11 @@ MavsdkImpl::MavsdkImpl(const Mavsdk::Configuration& configuration) :
     set_configuration(configuration);
 
     // Initialize MessageSet with embedded XML content in dependency order
-    // This happens at startup before any connections are created, so no synchronization needed
-    _message_set = std::make_unique<mav::MessageSet>();
-    _message_set->addFromXMLString(mav_embedded::MINIMAL_XML);
-    _message_set->addFromXMLString(mav_embedded::STANDARD_XML);
-    _message_set->addFromXMLString(mav_embedded::COMMON_XML);
-    _message_set->addFromXMLString(mav_embedded::ARDUPILOTMEGA_XML);
+    std::atomic_store(&_message_set, std::shared_ptr<mav::MessageSet>(create_message_set({})));
 
-    // Initialize BufferParser for thread-safe parsing
-    _buffer_parser = std::make_unique<mav::BufferParser>(*_message_set);
+    _statistics_last_update = time.steady_time();
+    _statistics_cookie =
+        call_every_handler.add([this]() { update_statistics_rates(); }, STATISTICS_INTERVAL_S);
 
     // Start the user callback thread first, so it is ready for anything generated by
     // the work thread.
@@ -83,6 +157,8 @@ MavsdkImpl::~MavsdkImpl()
         call_every_handler.remove(_heartbeat_send_cookie);
     }
 
+    call_every_handler.remove(_statistics_cookie);
+
     _should_exit = true;
 
     // Stop work first because we don't want to trigger anything that would
@@ -327,7 +403,9 @@ void MavsdkImpl::forward_message(mavlink_message_t& message, Connection* connect
         (message.msgid != MAVLINK_MSG_ID_HEARTBEAT || forward_heartbeats_enabled);
 
     if (!targeted_only_at_us && heartbeat_check_ok) {
-        unsigned successful_emissions = 0;
+        // Encoded once for all connections, sent in flush_connections().
+        MavlinkFramePtr frame;
+
         for (auto& entry : _connections) {
             // Check whether the connection is not the one from which we received the message.
             // And also check if the connection was set to forward messages.
@@ -335,16 +413,12 @@ void MavsdkImpl::forward_message(mavlink_message_t& message, Connection* connect
                 !entry.connection->should_forward_messages()) {
                 continue;
             }
-            auto result = (*entry.connection).send_message(message);
-            if (result.first) {
-                successful_emissions++;
-            } else {
-                _connections_errors_subscriptions.queue(
-                    Mavsdk::ConnectionError{result.second, entry.handle},
-                    [this](const auto& func) { call_user_callback(func); });
+            if (!frame) {
+                frame = make_mavlink_frame(message);
             }
+            entry.connection->queue_frame(frame);
         }
-        if (successful_emissions == 0) {
+        if (!frame) {
             LogErr() << "Message forwarding failed";
         }
     }
@@ -355,12 +429,12 @@ void MavsdkImpl::receive_message(mavlink_message_t& message, Connection* connect
     {
         std::lock_guard lock(_received_messages_mutex);
         _received_messages.emplace(ReceivedMessage{std::move(message), connection});
+        _received_queue_depth.record(_received_messages.size());
     }
     _received_messages_cv.notify_one();
 }
 
-void MavsdkImpl::receive_libmav_message(
-    const Mavsdk::MavlinkMessage& message, Connection* connection)
+void MavsdkImpl::receive_libmav_message(const LibmavMessage& message, Connection* connection)
 {
     {
         std::lock_guard lock(_received_libmav_messages_mutex);
@@ -510,6 +584,9 @@ void MavsdkImpl::process_message(mavlink_message_t& message, Connection* connect
         }
     }
 
+    const auto handler_start = std::chrono::steady_clock::now();
+    _processing_connection = connection;
+
     mavlink_message_handler.process_message(message);
 
     for (auto& system : _systems) {
@@ -518,12 +595,16 @@ void MavsdkImpl::process_message(mavlink_message_t& message, Connection* connect
             break;
         }
     }
+
+    _processing_connection = nullptr;
+    _handler_durations.record(message.msgid, std::chrono::steady_clock::now() - handler_start);
 }
 
 void MavsdkImpl::process_libmav_message(
-    const Mavsdk::MavlinkMessage& message, Connection* /* connection */)
+    const LibmavMessage& libmav_message, Connection* /* connection */)
 {
     // Assumes _received_libmav_messages_mutex
+    const auto& message = libmav_message.message;
 
     if (_message_logging_on) {
         LogDebug() << "MavsdkImpl::process_libmav_message: " << message.message_name << " from "
@@ -607,7 +688,7 @@ void MavsdkImpl::process_libmav_message(
                 LogDebug() << "Distributing libmav message " << message.message_name
                            << " to SystemImpl for system " << system.first;
             }
-            system.second->system_impl()->process_libmav_message(message);
+            system.second->system_impl()->process_libmav_message(libmav_message);
             found_system = true;
             // Don't break - distribute to all matching system instances
         }
@@ -622,18 +703,23 @@ void MavsdkImpl::process_libmav_message(
 bool MavsdkImpl::send_message(mavlink_message_t& message)
 {
     // Create a copy of the message to avoid reference issues
-    mavlink_message_t message_copy = message;
+    const mavlink_message_t message_copy = message;
 
     {
         std::lock_guard lock(_messages_to_send_mutex);
-        _messages_to_send.push(std::move(message_copy));
+        _messages_to_send.push(message_copy);
+        _send_queue_depth.record(_messages_to_send.size());
     }
 
-    // For heartbeat messages, we want to process them immediately to speed up system discovery
-    if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-        // Trigger message processing in the work thread
-        // This is a hint to process messages sooner, but doesn't block
-        std::this_thread::yield();
+    // Control messages and commands are sent right away instead of with the next iteration
+    // of the work thread, this also speeds up system discovery for heartbeats.
+    const auto traffic_class = traffic_class_for_message(message.msgid);
+    if (traffic_class == TrafficClass::Control || traffic_class == TrafficClass::Command) {
+        {
+            std::lock_guard lock(_received_messages_mutex);
+            _send_requested = true;
+        }
+        _received_messages_cv.notify_one();
     }
 
     return true;
@@ -641,7 +727,8 @@ bool MavsdkImpl::send_message(mavlink_message_t& message)
 
 void MavsdkImpl::deliver_messages()
 {
-    // Process messages one at a time to avoid holding the mutex while delivering
+    // Process messages one at a time to avoid holding the mutex while delivering.
+    // Messages are taken in order of their traffic class.
     while (true) {
         mavlink_message_t message;
         {
@@ -683,58 +770,15 @@ void MavsdkImpl::deliver_message(mavlink_message_t& message)
         return;
     }
 
-    // JSON message interception for outgoing messages
-    // Convert mavlink_message_t to Mavsdk::MavlinkMessage for JSON interception
-    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-    uint16_t len = mavlink_msg_to_send_buffer(buffer, &message);
+    // Encode once, the same frame is used by the JSON interception and by every
+    // connection.
+    const auto frame = make_mavlink_frame(message);
 
-    size_t bytes_consumed = 0;
-    auto libmav_msg_opt = parse_message_safe(buffer, len, bytes_consumed);
-
-    if (libmav_msg_opt) {
-        // Create Mavsdk::MavlinkMessage directly for JSON interception
-        Mavsdk::MavlinkMessage json_message;
-        json_message.message_name = libmav_msg_opt.value().name();
-        json_message.system_id = message.sysid;
-        json_message.component_id = message.compid;
-
-        // Extract target_system and target_component if present
-        uint8_t target_system_id = 0;
-        uint8_t target_component_id = 0;
-        if (libmav_msg_opt.value().get("target_system", target_system_id) ==
-            mav::MessageResult::Success) {
-            json_message.target_system_id = target_system_id;
-        } else {
-            json_message.target_system_id = 0;
-        }
-        if (libmav_msg_opt.value().get("target_component", target_component_id) ==
-            mav::MessageResult::Success) {
-            json_message.target_component_id = target_component_id;
-        } else {
-            json_message.target_component_id = 0;
-        }
-
-        // Generate JSON using LibmavReceiver's public method
-        auto connections = get_connections();
-        if (!connections.empty() && connections[0]->get_libmav_receiver()) {
-            json_message.fields_json =
-                connections[0]->get_libmav_receiver()->libmav_message_to_json(
-                    libmav_msg_opt.value());
-        } else {
-            // Fallback: create minimal JSON if no receiver available
-            json_message.fields_json =
-                "{\"message_id\":" + std::to_string(libmav_msg_opt.value().id()) +
-                ",\"message_name\":\"" + libmav_msg_opt.value().name() + "\"}";
-        }
-
-        if (!call_json_interception_callbacks(json_message, _outgoing_json_message_subscriptions)) {
-            // Message was dropped by JSON interception callback
-            if (_message_logging_on) {
-                LogDebug() << "Outgoing JSON message " << json_message.message_name
-                           << " dropped by interception";
-            }
-            return;
-        }
+    // Parsing the message again and generating JSON is expensive, so only do it if someone
+    // actually wants it.
+    if (_has_outgoing_json_subscriptions.load(std::memory_order_relaxed) &&
+        !intercept_outgoing_json(message, *frame)) {
+        return;
     }
 
     std::lock_guard lock(_mutex);
@@ -745,28 +789,198 @@ void MavsdkImpl::deliver_message(mavlink_message_t& message)
         return;
     }
 
+    const uint8_t target_system_id = get_target_system_id(message);
+
+    Connection* selected_connection = nullptr;
+    uint8_t selection_system_id = 0;
+    if (!_link_selections.empty()) {
+        selection_system_id = link_selection_system_id(
+            message.msgid,
+            target_system_id,
+            _link_selections.size() == 1 ?
+                std::optional<uint8_t>{_link_selections.begin()->first} :
+                std::nullopt);
+        const auto it = _link_selections.find(selection_system_id);
+        if (it != _link_selections.end()) {
+            selected_connection = it->second.selected;
+        }
+    }
+
     uint8_t successful_emissions = 0;
+    bool dropped = false;
     for (auto& _connection : _connections) {
-        const uint8_t target_system_id = get_target_system_id(message);
-
         if (target_system_id != 0 && !(*_connection.connection).has_system_id(target_system_id)) {
             continue;
         }
-        const auto result = (*_connection.connection).send_message(message);
-        if (result.first) {
+
+        if (selected_connection != nullptr && _connection.connection.get() != selected_connection) {
+            // Messages without target still go to other systems on other links.
+            if (target_system_id != 0 ||
+                _connection.connection->has_only_system_id(selection_system_id)) {
+                continue;
+            }
+        }
+
+        if (_connection.shaper) {
+            // Sent later in send_shaped_messages() as the bandwidth allows.
+            if (!_connection.shaper->push(message)) {
+                dropped = true;
+                // The queue is full because we are sending more than the link can take, so
+                // let's not add to it by flooding the log.
+                ++_connection.dropped_since_warning;
+                if (time.elapsed_since_s(_connection.last_drop_warning) >= 1.0) {
+                    LogWarn() << "Outbound queue full, dropped "
+                              << _connection.dropped_since_warning << " message(s), last "
+                              << message.msgid;
+                    _connection.dropped_since_warning = 0;
+                    _connection.last_drop_warning = time.steady_time();
+                }
+                continue;
+            }
             successful_emissions++;
-        } else {
-            _connections_errors_subscriptions.queue(
-                Mavsdk::ConnectionError{result.second, _connection.handle},
-                [this](const auto& func) { call_user_callback(func); });
+            continue;
         }
+
+        // Sent together with the other frames of this iteration in flush_connections().
+        _connection.connection->queue_frame(frame);
+        successful_emissions++;
     }
 
-    if (successful_emissions == 0) {
+    if (successful_emissions == 0 && !dropped) {
         LogErr() << "Sending message failed";
     }
 }
 
+bool MavsdkImpl::intercept_outgoing_json(
+    const mavlink_message_t& message, const MavlinkFrame& frame)
+{
+    // Convert mavlink_message_t to Mavsdk::MavlinkMessage for JSON interception
+    size_t bytes_consumed = 0;
+    auto libmav_msg_opt = parse_message_safe(
+        reinterpret_cast<const uint8_t*>(frame.data()), frame.size(), bytes_consumed);
+
+    if (!libmav_msg_opt) {
+        return true;
+    }
+
+    // Create Mavsdk::MavlinkMessage directly for JSON interception
+    Mavsdk::MavlinkMessage json_message;
+    json_message.message_name = libmav_msg_opt.value().name();
+    json_message.system_id = message.sysid;
+    json_message.component_id = message.compid;
+
+    // Extract target_system and target_component if present
+    uint8_t target_system_id = 0;
+    uint8_t target_component_id = 0;
+    if (libmav_msg_opt.value().get("target_system", target_system_id) ==
+        mav::MessageResult::Success) {
+        json_message.target_system_id = target_system_id;
+    } else {
+        json_message.target_system_id = 0;
+    }
+    if (libmav_msg_opt.value().get("target_component", target_component_id) ==
+        mav::MessageResult::Success) {
+        json_message.target_component_id = target_component_id;
+    } else {
+        json_message.target_component_id = 0;
+    }
+
+    {
+        // Messages can be sent from any thread, so the serializer is shared.
+        std::lock_guard<std::mutex> lock(_outgoing_json_serializer_mutex);
+        _outgoing_json_serializer.set_message_set(get_message_set());
+        json_message.fields_json = _outgoing_json_serializer.to_json(libmav_msg_opt.value());
+    }
+
+    if (!call_json_interception_callbacks(json_message, _outgoing_json_message_subscriptions)) {
+        // Message was dropped by JSON interception callback
+        if (_message_logging_on) {
+            LogDebug() << "Outgoing JSON message " << json_message.message_name
+                       << " dropped by interception";
+        }
+        return false;
+    }
+
+    return true;
+}
+
+void MavsdkImpl::send_shaped_messages()
+{
+    std::lock_guard lock(_mutex);
+
+    if (_outbound_bandwidth_limit != _outbound_bandwidth_limit_applied) {
+        apply_outbound_bandwidth_limit();
+    }
+
+    double backlog_s = 0.0;
+    const auto now = time.steady_time();
+
+    for (auto& entry : _connections) {
+        if (!entry.shaper) {
+            continue;
+        }
+
+        entry.shaper->drain(now, [&](const mavlink_message_t& message) {
+            entry.connection->queue_frame(make_mavlink_frame(message));
+        });
+
+        backlog_s = std::max(backlog_s, entry.shaper->backlog_s());
+    }
+
+    _outbound_backlog_s = backlog_s;
+}
+
+void MavsdkImpl::apply_outbound_bandwidth_limit()
+{
+    const double limit = _outbound_bandwidth_limit;
+    _outbound_bandwidth_limit_applied = limit;
+
+    for (auto& entry : _connections) {
+        if (limit > 0.0) {
+            if (entry.shaper) {
+                entry.shaper->set_rate(limit);
+            } else {
+                entry.shaper = std::make_unique<OutboundShaper>(limit, time.steady_time());
+            }
+        } else if (entry.shaper) {
+            // Don't lose what is still queued.
+            entry.shaper->flush([&](const mavlink_message_t& message) {
+                entry.connection->queue_frame(make_mavlink_frame(message));
+            });
+            entry.shaper.reset();
+        }
+    }
+
+    if (limit <= 0.0) {
+        _outbound_backlog_s = 0.0;
+    }
+}
+
+void MavsdkImpl::flush_connections(bool overdue_only)
+{
+    std::lock_guard lock(_mutex);
+
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto& entry : _connections) {
+        if (!entry.connection->has_queued_frames()) {
+            continue;
+        }
+
+        if (overdue_only &&
+            now - entry.connection->first_queued_frame_time() < MAX_COALESCING_DELAY) {
+            continue;
+        }
+
+        const auto result = entry.connection->flush_frames();
+        if (!result.first) {
+            _connections_errors_subscriptions.queue(
+                Mavsdk::ConnectionError{result.second, entry.handle},
+                [this](const auto& func) { call_user_callback(func); });
+        }
+    }
+}
+
 std::pair<ConnectionResult, Mavsdk::ConnectionHandle> MavsdkImpl::add_any_connection(
     const std::string& connection_url, ForwardingOption forwarding_option)
 {
@@ -805,7 +1019,7 @@ MavsdkImpl::add_udp_connection(const CliArg::Udp& udp, ForwardingOption forwardi
         [this](mavlink_message_t& message, Connection* connection) {
             receive_message(message, connection);
         },
-        [this](const Mavsdk::MavlinkMessage& message, Connection* connection) {
+        [this](const LibmavMessage& message, Connection* connection) {
             receive_libmav_message(message, connection);
         },
         *this, // Pass MavsdkImpl reference for thread-safe MessageSet access
@@ -854,7 +1068,7 @@ MavsdkImpl::add_tcp_connection(const CliArg::Tcp& tcp, ForwardingOption forwardi
             [this](mavlink_message_t& message, Connection* connection) {
                 receive_message(message, connection);
             },
-            [this](const Mavsdk::MavlinkMessage& message, Connection* connection) {
+            [this](const LibmavMessage& message, Connection* connection) {
                 receive_libmav_message(message, connection);
             },
             *this, // Pass MavsdkImpl reference for thread-safe MessageSet access
@@ -875,7 +1089,7 @@ MavsdkImpl::add_tcp_connection(const CliArg::Tcp& tcp, ForwardingOption forwardi
             [this](mavlink_message_t& message, Connection* connection) {
                 receive_message(message, connection);
             },
-            [this](const Mavsdk::MavlinkMessage& message, Connection* connection) {
+            [this](const LibmavMessage& message, Connection* connection) {
                 receive_libmav_message(message, connection);
             },
             *this, // Pass MavsdkImpl reference for thread-safe MessageSet access
@@ -904,13 +1118,14 @@ std::pair<ConnectionResult, Mavsdk::ConnectionHandle> MavsdkImpl::add_serial_con
         [this](mavlink_message_t& message, Connection* connection) {
             receive_message(message, connection);
         },
-        [this](const Mavsdk::MavlinkMessage& message, Connection* connection) {
+        [this](const LibmavMessage& message, Connection* connection) {
             receive_libmav_message(message, connection);
         },
         *this, // Pass MavsdkImpl reference for thread-safe MessageSet access
         dev_path,
         baudrate,
         flow_control,
+        get_configuration().get_serial_low_latency(),
         forwarding_option);
     if (!new_conn) {
         return {ConnectionResult::ConnectionError, Mavsdk::ConnectionHandle{}};
@@ -947,7 +1162,7 @@ MavsdkImpl::add_raw_connection(ForwardingOption forwarding_option)
         [this](mavlink_message_t& message, Connection* connection) {
             receive_message(message, connection);
         },
-        [this](const Mavsdk::MavlinkMessage& message, Connection* connection) {
+        [this](const LibmavMessage& message, Connection* connection) {
             receive_libmav_message(message, connection);
         },
         *this,
@@ -977,6 +1192,7 @@ Mavsdk::ConnectionHandle MavsdkImpl::add_connection(std::unique_ptr<Connection>&
     std::lock_guard lock(_mutex);
     auto handle = _connections_handle_factory.create();
     _connections.emplace_back(ConnectionEntry{std::move(new_connection), handle});
+    apply_outbound_bandwidth_limit();
 
     return handle;
 }
@@ -988,6 +1204,12 @@ void MavsdkImpl::remove_connection(Mavsdk::ConnectionHandle handle)
     _connections.erase(std::remove_if(_connections.begin(), _connections.end(), [&](auto&& entry) {
         return (entry.handle == handle);
     }));
+
+    // The selected connection might have been removed, so we need to pick again.
+    for (auto& link_selection : _link_selections) {
+        link_selection.second.selected = nullptr;
+    }
+    update_link_selection();
 }
 
 Mavsdk::Configuration MavsdkImpl::get_configuration() const
@@ -1018,6 +1240,11 @@ void MavsdkImpl::set_configuration(Mavsdk::Configuration new_configuration)
     // We cache these values as atomic to avoid having to lock any mutex for them.
     _our_system_id = new_configuration.get_system_id();
     _our_component_id = new_configuration.get_component_id();
+    // Applied to the connections by the work thread.
+    _outbound_bandwidth_limit = new_configuration.get_outbound_bandwidth_limit();
+    _mission_transfer_over_ftp = new_configuration.get_mission_transfer_over_ftp();
+    _mission_partial_upload = new_configuration.get_mission_partial_upload();
+    _mission_server_request_window = new_configuration.get_mission_server_request_window();
 }
 
 uint8_t MavsdkImpl::get_own_system_id() const
@@ -1119,6 +1346,9 @@ void MavsdkImpl::work_thread()
         // Process incoming libmav messages
         process_libmav_messages();
 
+        // Don't hold back forwarded messages while the rest of the iteration runs.
+        flush_connections(true);
+
         // Run timers
         timeout_handler.run_once();
         call_every_handler.run_once();
@@ -1135,15 +1365,18 @@ void MavsdkImpl::work_thread()
 
         // Deliver outgoing messages
         deliver_messages();
+        send_shaped_messages();
+        flush_connections();
 
         // If no messages to send, check if there are messages to receive
         std::unique_lock lock_received(_received_messages_mutex);
         if (_received_messages.empty()) {
             // No messages to process, wait for a signal or timeout
             _received_messages_cv.wait_for(lock_received, std::chrono::milliseconds(10), [this]() {
-                return !_received_messages.empty() || _should_exit;
+                return !_received_messages.empty() || _send_requested || _should_exit;
             });
         }
+        _send_requested = false;
     }
 }
 
@@ -1183,6 +1416,7 @@ void MavsdkImpl::call_user_callback_located(
         _callback_debugging ? UserCallback{func, filename, linenumber} : UserCallback{func};
 
     _user_callback_queue.push_back(std::make_shared<UserCallback>(user_callback));
+    _user_callback_queue_depth.record(callback_size + 1);
 }
 
 void MavsdkImpl::process_user_callbacks_thread()
@@ -1227,6 +1461,8 @@ void MavsdkImpl::process_user_callbacks_thread()
         auto callback_end = std::chrono::steady_clock::now();
         timeout_handler.remove(cookie);
 
+        _user_callback_durations.record(callback_end - callback_start);
+
         if (_callback_tracker) {
             auto callback_duration_us =
                 std::chrono::duration_cast<std::chrono::microseconds>(callback_end - callback_start)
@@ -1318,12 +1554,25 @@ bool MavsdkImpl::call_json_interception_callbacks(
     return keep_message;
 }
 
+bool MavsdkImpl::libmav_message_wanted(uint32_t message_id) const
+{
+    return _has_incoming_json_subscriptions.load(std::memory_order_relaxed) ||
+           libmav_message_interest.wanted(message_id);
+}
+
+bool MavsdkImpl::libmav_json_wanted(uint32_t message_id) const
+{
+    return _has_incoming_json_subscriptions.load(std::memory_order_relaxed) ||
+           libmav_json_interest.wanted(message_id);
+}
+
 Mavsdk::InterceptJsonHandle
 MavsdkImpl::subscribe_incoming_messages_json(const Mavsdk::InterceptJsonCallback& callback)
 {
     std::lock_guard<std::mutex> lock(_json_subscriptions_mutex);
     auto handle = _json_handle_factory.create();
     _incoming_json_message_subscriptions.push_back(std::make_pair(handle, callback));
+    _has_incoming_json_subscriptions = true;
     return handle;
 }
 
@@ -1337,6 +1586,7 @@ void MavsdkImpl::unsubscribe_incoming_messages_json(Mavsdk::InterceptJsonHandle
     if (it != _incoming_json_message_subscriptions.end()) {
         _incoming_json_message_subscriptions.erase(it);
     }
+    _has_incoming_json_subscriptions = !_incoming_json_message_subscriptions.empty();
 }
 
 Mavsdk::InterceptJsonHandle
@@ -1345,6 +1595,7 @@ MavsdkImpl::subscribe_outgoing_messages_json(const Mavsdk::InterceptJsonCallback
     std::lock_guard<std::mutex> lock(_json_subscriptions_mutex);
     auto handle = _json_handle_factory.create();
     _outgoing_json_message_subscriptions.push_back(std::make_pair(handle, callback));
+    _has_outgoing_json_subscriptions = true;
     return handle;
 }
 
@@ -1358,6 +1609,7 @@ void MavsdkImpl::unsubscribe_outgoing_messages_json(Mavsdk::InterceptJsonHandle
     if (it != _outgoing_json_message_subscriptions.end()) {
         _outgoing_json_message_subscriptions.erase(it);
     }
+    _has_outgoing_json_subscriptions = !_outgoing_json_message_subscriptions.empty();
 }
 
 RawConnection* MavsdkImpl::find_raw_connection()
@@ -1469,6 +1721,144 @@ Sender& MavsdkImpl::sender()
     return default_server_component_with_lock().sender();
 }
 
+MavsdkStatistics MavsdkImpl::statistics() const
+{
+    MavsdkStatistics statistics;
+
+    {
+        std::lock_guard lock(_mutex);
+        for (const auto& entry : _connections) {
+            auto connection_statistics = entry.connection->statistics();
+            connection_statistics.connection_handle = entry.handle;
+            statistics.connections.push_back(std::move(connection_statistics));
+        }
+    }
+
+    {
+        std::lock_guard lock(_received_messages_mutex);
+        statistics.received_queue.depth = _received_messages.size();
+    }
+    statistics.received_queue.peak_depth = _received_queue_depth.peak();
+
+    {
+        std::lock_guard lock(_messages_to_send_mutex);
+        statistics.send_queue.depth = _messages_to_send.size();
+    }
+    statistics.send_queue.peak_depth = _send_queue_depth.peak();
+
+    statistics.user_callback_queue.depth = _user_callback_queue.size();
+    statistics.user_callback_queue.peak_depth = _user_callback_queue_depth.peak();
+
+    statistics.handlers = _handler_durations.snapshot();
+    statistics.user_callbacks = _user_callback_durations.snapshot();
+
+    return statistics;
+}
+
+std::vector<LinkQuality> MavsdkImpl::link_quality(uint8_t system_id) const
+{
+    std::vector<LinkQuality> result;
+
+    std::lock_guard lock(_mutex);
+    for (const auto& entry : _connections) {
+        for (auto& link_quality : entry.connection->link_quality(system_id)) {
+            link_quality.connection_handle = entry.handle;
+            result.push_back(link_quality);
+        }
+    }
+    return result;
+}
+
+void MavsdkImpl::record_round_trip_time(
+    const mavlink_message_t& message, std::chrono::steady_clock::duration rtt)
+{
+    if (_processing_connection == nullptr) {
+        return;
+    }
+
+    _processing_connection->record_round_trip_time(message.sysid, message.compid, rtt);
+}
+
+void MavsdkImpl::update_statistics_rates()
+{
+    // Called from the work thread only.
+    const auto now = time.steady_time();
+    const double elapsed_s =
+        std::chrono::duration<double>(now - _statistics_last_update).count();
+    _statistics_last_update = now;
+
+    std::lock_guard lock(_mutex);
+    for (auto& entry : _connections) {
+        entry.connection->update_statistics_rates(elapsed_s);
+    }
+    update_link_selection();
+
+    for (auto& system : _systems) {
+        system.second->system_impl()->update_statistics_rates(elapsed_s);
+    }
+}
+
+void MavsdkImpl::set_link_policy(uint8_t system_id, const LinkPolicy& link_policy)
+{
+    std::lock_guard lock(_mutex);
+
+    if (link_policy.mode == LinkPolicy::Mode::BroadcastAll) {
+        _link_selections.erase(system_id);
+        return;
+    }
+
+    auto& link_selection = _link_selections[system_id];
+    link_selection.policy = link_policy;
+    update_link_selection();
+}
+
+LinkPolicy MavsdkImpl::link_policy(uint8_t system_id) const
+{
+    std::lock_guard lock(_mutex);
+
+    const auto it = _link_selections.find(system_id);
+    return it != _link_selections.end() ? it->second.policy : LinkPolicy{};
+}
+
+void MavsdkImpl::update_link_selection()
+{
+    for (auto& [system_id, link_selection] : _link_selections) {
+        std::vector<LinkCandidate> candidates;
+        std::vector<Connection*> connections;
+        std::optional<size_t> current;
+
+        for (auto& entry : _connections) {
+            if (!entry.connection->has_system_id(system_id)) {
+                continue;
+            }
+
+            auto candidate = make_link_candidate(
+                entry.connection->link_quality(system_id),
+                link_selection.policy.failover_timeout_s);
+            candidate.is_primary = entry.handle == link_selection.policy.primary_connection;
+
+            if (entry.connection.get() == link_selection.selected) {
+                current = candidates.size();
+            }
+            candidates.push_back(candidate);
+            connections.push_back(entry.connection.get());
+        }
+
+        const auto selected = select_link(link_selection.policy, candidates, current);
+        Connection* selected_connection = selected ? connections[*selected] : nullptr;
+
+        if (selected_connection != link_selection.selected) {
+            if (selected_connection == nullptr) {
+                LogWarn() << "No healthy link to system " << static_cast<int>(system_id)
+                          << ", sending on all links";
+            } else {
+                LogInfo() << "Switching link to system " << static_cast<int>(system_id);
+            }
+            link_selection.selected = selected_connection;
+        }
+    }
+}
+
 std::vector<Connection*> MavsdkImpl::get_connections() const
 {
     std::lock_guard lock(_mutex);
@@ -1479,28 +1869,35 @@ std::vector<Connection*> MavsdkImpl::get_connections() const
     return connections;
 }
 
-mav::MessageSet& MavsdkImpl::get_message_set() const
+std::shared_ptr<mav::MessageSet> MavsdkImpl::get_message_set() const
 {
-    // Note: This returns a reference to MessageSet without locking.
-    // Thread safety for MessageSet operations must be ensured by:
-    // 1. Using load_custom_xml_to_message_set() for write operations (XML loading)
-    // 2. libmav MessageSet should be internally thread-safe for read operations
-    // 3. If race conditions persist, consider implementing a thread-safe MessageSet wrapper
-    return *_message_set;
+    // The message set is never modified once published. After custom XML has been loaded,
+    // a previously returned one stays valid but doesn't know the new messages.
+    return std::atomic_load(&_message_set);
 }
 
 bool MavsdkImpl::load_custom_xml_to_message_set(const std::string& xml_content)
 {
     std::lock_guard<std::mutex> lock(_message_set_mutex);
-    auto result = _message_set->addFromXMLString(xml_content, false /* recursive_open_includes */);
-    return result == ::mav::MessageSetResult::Success;
+
+    // Build the new message set on the side, readers keep using the current one meanwhile.
+    auto custom_xml = _custom_xml;
+    custom_xml.push_back(xml_content);
+    std::shared_ptr<mav::MessageSet> message_set = create_message_set(custom_xml);
+    if (!message_set) {
+        return false;
+    }
+
+    _custom_xml = std::move(custom_xml);
+    // The old set is freed once the last thread which used it has moved on.
+    std::atomic_store(&_message_set, std::move(message_set));
+    return true;
 }
 
 // Thread-safe MessageSet read operations
 std::optional<std::string> MavsdkImpl::message_id_to_name_safe(uint32_t id) const
 {
-    std::lock_guard<std::mutex> lock(_message_set_mutex);
-    auto message_def = _message_set->getMessageDefinition(static_cast<int>(id));
+    auto message_def = get_message_set()->getMessageDefinition(static_cast<int>(id));
     if (message_def) {
         return message_def.get().name();
     }
@@ -1509,29 +1906,29 @@ std::optional<std::string> MavsdkImpl::message_id_to_name_safe(uint32_t id) cons
 
 std::optional<int> MavsdkImpl::message_name_to_id_safe(const std::string& name) const
 {
-    std::lock_guard<std::mutex> lock(_message_set_mutex);
-    return _message_set->idForMessage(name);
+    return get_message_set()->idForMessage(name);
 }
 
 std::optional<mav::Message> MavsdkImpl::create_message_safe(const std::string& message_name) const
 {
-    std::lock_guard<std::mutex> lock(_message_set_mutex);
-    return _message_set->create(message_name);
+    // The message refers to its definition, so the set needs to stay alive.
+    return thread_message_set(_thread_cache_owner, get_message_set())
+        .message_set->create(message_name);
 }
 
 // Thread-safe parsing for LibmavReceiver
 std::optional<mav::Message> MavsdkImpl::parse_message_safe(
     const uint8_t* buffer, size_t buffer_len, size_t& bytes_consumed) const
 {
-    std::lock_guard<std::mutex> lock(_message_set_mutex);
-    return _buffer_parser->parseMessage(buffer, buffer_len, bytes_consumed);
+    return thread_buffer_parser(_thread_cache_owner, get_message_set())
+        .parseMessage(buffer, buffer_len, bytes_consumed);
 }
 
 mav::OptionalReference<const mav::MessageDefinition>
 MavsdkImpl::get_message_definition_safe(int message_id) const
 {
-    std::lock_guard<std::mutex> lock(_message_set_mutex);
-    return _message_set->getMessageDefinition(message_id);
+    return thread_message_set(_thread_cache_owner, get_message_set())
+        .message_set->getMessageDefinition(message_id);
 }
 
 } // namespace mavsdk
@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <sys/types.h>
 #include <utility>
@@ -9,12 +10,16 @@
 #include <atomic>
 #include <thread>
 #include <queue>
+#include <unordered_map>
 
 #include "autopilot.h"
 #include "call_every_handler.h"
 #include "component_type.h"
 #include "connection.h"
+#include "libmav_json_serializer.h"
+#include "libmav_message_router.h"
 #include "libmav_receiver.h"
+#include "link_policy.h"
 #include <mav/BufferParser.h>
 #include "cli_arg.h"
 #include "handle_factory.h"
@@ -24,6 +29,8 @@
 #include "mavlink_address.h"
 #include "mavlink_message_handler.h"
 #include "mavlink_command_receiver.h"
+#include "mavlink_statistics.h"
+#include "outbound_queue.h"
 #include "locked_queue.h"
 #include "server_component.h"
 #include "system.h"
@@ -55,7 +62,7 @@ public:
 
     void forward_message(mavlink_message_t& message, Connection* connection);
     void receive_message(mavlink_message_t& message, Connection* connection);
-    void receive_libmav_message(const Mavsdk::MavlinkMessage& message, Connection* connection);
+    void receive_libmav_message(const LibmavMessage& message, Connection* connection);
 
     std::pair<ConnectionResult, Mavsdk::ConnectionHandle>
     add_any_connection(const std::string& connection_url, ForwardingOption forwarding_option);
@@ -108,6 +115,17 @@ public:
     void unsubscribe_raw_bytes_to_be_sent(Mavsdk::RawBytesHandle handle);
     bool notify_raw_bytes_sent(const char* bytes, size_t length);
 
+    MavsdkStatistics statistics() const;
+    std::vector<LinkQuality> link_quality(uint8_t system_id) const;
+
+    void set_link_policy(uint8_t system_id, const LinkPolicy& link_policy);
+    LinkPolicy link_policy(uint8_t system_id) const;
+
+    // Attributes the round trip time to the connection the message currently being
+    // processed was received on.
+    void record_round_trip_time(
+        const mavlink_message_t& message, std::chrono::steady_clock::duration rtt);
+
     std::shared_ptr<ServerComponent> server_component(unsigned instance = 0);
 
     std::shared_ptr<ServerComponent>
@@ -123,17 +141,36 @@ public:
 
     void set_timeout_s(double timeout_s) { _timeout_s = timeout_s; }
 
+    // Time it takes until messages queued now are sent on the slowest shaped connection.
+    double outbound_backlog_s() const { return _outbound_backlog_s; }
+
     double timeout_s() const { return _timeout_s; };
 
+    bool mission_transfer_over_ftp() const { return _mission_transfer_over_ftp; }
+
+    bool mission_partial_upload() const { return _mission_partial_upload; }
+
+    unsigned mission_server_request_window() const { return _mission_server_request_window; }
+
     MavlinkMessageHandler mavlink_message_handler{};
 
+    // Message IDs which the libmav handlers of all systems are subscribed to, and the ones
+    // of those which need the fields as JSON.
+    MessageIdInterest libmav_message_interest{};
+    MessageIdInterest libmav_json_interest{};
+
+    // Whether the receive threads need to parse a message using libmav.
+    bool libmav_message_wanted(uint32_t message_id) const;
+    // Whether the receive threads need to convert the fields of a message to JSON.
+    bool libmav_json_wanted(uint32_t message_id) const;
+
     ServerComponentImpl& default_server_component_impl();
 
     // Get connections for sending messages
     std::vector<Connection*> get_connections() const;
 
     // Get MessageSet for message creation and parsing
-    mav::MessageSet& get_message_set() const;
+    std::shared_ptr<mav::MessageSet> get_message_set() const;
 
     // Thread-safe MessageSet operations
     bool load_custom_xml_to_message_set(const std::string& xml_content);
@@ -168,6 +205,10 @@ private:
 
     void send_heartbeats();
 
+    void update_statistics_rates();
+    // Needs _mutex.
+    void update_link_selection();
+
     void work_thread();
     void process_user_callbacks_thread();
 
@@ -175,10 +216,21 @@ private:
     void process_message(mavlink_message_t& message, Connection* connection);
 
     void process_libmav_messages();
-    void process_libmav_message(const Mavsdk::MavlinkMessage& message, Connection* connection);
+    void process_libmav_message(const LibmavMessage& libmav_message, Connection* connection);
 
     void deliver_messages();
     void deliver_message(mavlink_message_t& message);
+    bool intercept_outgoing_json(const mavlink_message_t& message, const MavlinkFrame& frame);
+    void send_shaped_messages();
+    // Needs _mutex.
+    void apply_outbound_bandwidth_limit();
+    // Sends what was queued on the connections in this iteration of the work thread.
+    // With overdue_only, only frames held for longer than MAX_COALESCING_DELAY are sent.
+    void flush_connections(bool overdue_only = false);
+
+    // Frames are coalesced for one iteration of the work thread, but not longer than this,
+    // e.g. when a lot of messages arrive at once.
+    static constexpr auto MAX_COALESCING_DELAY = std::chrono::milliseconds(2);
 
     bool is_any_system_connected() const;
 
@@ -199,21 +251,42 @@ private:
 
     mutable std::recursive_mutex _mutex{};
 
-    // Message set for libmav message handling (shared across all connections)
-    std::unique_ptr<mav::MessageSet> _message_set;
-    std::unique_ptr<mav::BufferParser> _buffer_parser; // Thread-safe parser
-    mutable std::mutex _message_set_mutex;
+    // Message set for libmav message handling (shared across all connections).
+    // A published message set is never modified, so it can be used for parsing from any
+    // thread without locking. Loading custom XML publishes a new one instead. Parsed messages
+    // and message definitions keep references into a set, so every thread holds on to the
+    // set it used last. Only accessed with std::atomic_load/std::atomic_store.
+    std::shared_ptr<mav::MessageSet> _message_set{};
+    // Identifies this instance in the per-thread message sets, which are released once it
+    // is gone.
+    const std::shared_ptr<void> _thread_cache_owner{std::make_shared<char>()};
+    std::vector<std::string> _custom_xml{};
+    // Only serializes loading custom XML.
+    std::mutex _message_set_mutex;
 
     HandleFactory<> _connections_handle_factory;
     struct ConnectionEntry {
         std::unique_ptr<Connection> connection;
         Handle<> handle;
+        // Only set if the outbound bandwidth is limited, only used on the work thread.
+        std::unique_ptr<OutboundShaper> shaper{};
+        // Messages dropped because the shaper was full, warned about at most once a second.
+        uint64_t dropped_since_warning{0};
+        SteadyTimePoint last_drop_warning{};
     };
     std::vector<ConnectionEntry> _connections{};
     CallbackList<Mavsdk::ConnectionError> _connections_errors_subscriptions{};
 
     std::vector<std::pair<uint8_t, std::shared_ptr<System>>> _systems{};
 
+    struct LinkSelection {
+        LinkPolicy policy{};
+        // nullptr means all connections.
+        Connection* selected{nullptr};
+    };
+    // Guarded by _mutex.
+    std::unordered_map<uint8_t, LinkSelection> _link_selections{};
+
     std::recursive_mutex _server_components_mutex;
     std::vector<std::pair<uint8_t, std::shared_ptr<ServerComponent>>> _server_components{};
     std::shared_ptr<ServerComponent> _default_server_component{nullptr};
@@ -256,6 +329,11 @@ private:
         _incoming_json_message_subscriptions{};
     std::vector<std::pair<Mavsdk::InterceptJsonHandle, Mavsdk::InterceptJsonCallback>>
         _outgoing_json_message_subscriptions{};
+    // Let the send and receive paths skip the JSON conversion without taking the mutex.
+    std::atomic<bool> _has_incoming_json_subscriptions{false};
+    std::atomic<bool> _has_outgoing_json_subscriptions{false};
+    LibmavJsonSerializer _outgoing_json_serializer{};
+    std::mutex _outgoing_json_serializer_mutex{};
     mutable std::mutex _json_subscriptions_mutex{};
     HandleFactory<bool(Mavsdk::MavlinkMessage)> _json_handle_factory{};
 
@@ -271,9 +349,12 @@ private:
     mutable std::mutex _received_messages_mutex{};
     std::queue<ReceivedMessage> _received_messages;
     std::condition_variable _received_messages_cv{};
+    // Wakes up the work thread to send a control message without waiting, needs
+    // _received_messages_mutex.
+    bool _send_requested{false};
 
     struct ReceivedLibmavMessage {
-        Mavsdk::MavlinkMessage message;
+        LibmavMessage message;
         Connection* connection_ptr;
     };
     mutable std::mutex _received_libmav_messages_mutex{};
@@ -281,12 +362,30 @@ private:
     std::condition_variable _received_libmav_messages_cv{};
 
     mutable std::mutex _messages_to_send_mutex{};
-    std::queue<mavlink_message_t> _messages_to_send;
+    OutboundQueue _messages_to_send{};
+    std::atomic<double> _outbound_backlog_s{0.0};
+    std::atomic<double> _outbound_bandwidth_limit{0.0};
+    // Guarded by _mutex.
+    double _outbound_bandwidth_limit_applied{0.0};
+    std::atomic<bool> _mission_transfer_over_ftp{false};
+    std::atomic<bool> _mission_partial_upload{false};
+    std::atomic<unsigned> _mission_server_request_window{1};
 
     static constexpr double HEARTBEAT_SEND_INTERVAL_S = 1.0;
     std::mutex _heartbeat_mutex{};
     CallEveryHandler::Cookie _heartbeat_send_cookie{};
 
+    static constexpr double STATISTICS_INTERVAL_S = 1.0;
+    CallEveryHandler::Cookie _statistics_cookie{};
+    // Connection of the message currently being processed, only used on the work thread.
+    Connection* _processing_connection{nullptr};
+    SteadyTimePoint _statistics_last_update{};
+    QueueDepthRecorder _received_queue_depth{};
+    QueueDepthRecorder _send_queue_depth{};
+    QueueDepthRecorder _user_callback_queue_depth{};
+    MessageIdDurations _handler_durations{};
+    DurationRecorder _user_callback_durations{};
+
     std::atomic<bool> _should_exit{false};
 };
 
@@ -0,0 +1,298 @@
+#include "mavsdk_impl.h"
+#include "socket_holder.h"
+
+#ifdef WINDOWS
+#include <winsock2.h>
+#include <Ws2tcpip.h>
+#else
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#endif
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+uint32_t message_id_of(const char* bytes, size_t length)
+{
+    if (length < 10 || static_cast<uint8_t>(bytes[0]) != MAVLINK_STX) {
+        return UINT32_MAX;
+    }
+    return static_cast<uint8_t>(bytes[7]) | (static_cast<uint8_t>(bytes[8]) << 8) |
+           (static_cast<uint8_t>(bytes[9]) << 16);
+}
+
+// A UDP socket bound to an ephemeral port on localhost which udpout connections can send to
+// without clashing with anything else running on the machine.
+struct UdpSink {
+    UdpSink()
+    {
+        socket.reset(::socket(AF_INET, SOCK_DGRAM, 0));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        if (bind(socket.get(), reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            return;
+        }
+        socklen_t addr_len = sizeof(addr);
+        if (getsockname(socket.get(), reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0) {
+            port = ntohs(addr.sin_port);
+        }
+    }
+
+    std::string url() const { return "udpout://127.0.0.1:" + std::to_string(port); }
+
+    SocketHolder socket;
+    uint16_t port{0};
+};
+
+} // namespace
+
+// Benchmark, run with --gtest_also_run_disabled_tests.
+TEST(MavsdkImpl, DISABLED_SendPathCpuTime)
+{
+    constexpr unsigned num_messages = 20000;
+
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{ComponentType::GroundStation}};
+    ASSERT_EQ(
+        mavsdk_impl.add_any_connection("raw://", ForwardingOption::ForwardingOff).first,
+        ConnectionResult::Success);
+    // More connections, so the message has to be sent more than once.
+    UdpSink sinks[2];
+    for (const auto& sink : sinks) {
+        ASSERT_NE(sink.port, 0);
+        ASSERT_EQ(
+            mavsdk_impl.add_any_connection(sink.url(), ForwardingOption::ForwardingOff).first,
+            ConnectionResult::Success);
+    }
+
+    std::atomic<unsigned> sent{0};
+    auto raw_handle = mavsdk_impl.subscribe_raw_bytes_to_be_sent([&](const char* bytes,
+                                                                     size_t length) {
+        if (message_id_of(bytes, length) == MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED) {
+            ++sent;
+        }
+    });
+
+    // Returns the CPU time of the whole process per message sent.
+    auto run = [&]() {
+        sent = 0;
+        const auto cpu_start = std::clock();
+
+        for (unsigned i = 0; i < num_messages; ++i) {
+            mavlink_message_t message;
+            mavlink_msg_set_position_target_local_ned_pack_chan(
+                mavsdk_impl.get_own_system_id(),
+                mavsdk_impl.get_own_component_id(),
+                mavsdk_impl.channel(),
+                &message,
+                i,
+                0,
+                0,
+                MAV_FRAME_LOCAL_NED,
+                0,
+                1.0f,
+                2.0f,
+                -3.0f,
+                0.0f,
+                0.0f,
+                0.0f,
+                0.0f,
+                0.0f,
+                0.0f,
+                0.0f,
+                0.0f);
+            mavsdk_impl.send_message(message);
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+        while (sent < num_messages && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        EXPECT_EQ(sent, num_messages);
+        return static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC / num_messages;
+    };
+
+    const double without_json_s = run();
+
+    auto json_handle =
+        mavsdk_impl.subscribe_outgoing_messages_json([](const Mavsdk::MavlinkMessage&) {
+            return true;
+        });
+    const double with_json_s = run();
+    mavsdk_impl.unsubscribe_outgoing_messages_json(json_handle);
+
+    // CPU time per message sent on 3 connections.
+    ::testing::Test::RecordProperty("without_json_ns", static_cast<int>(without_json_s * 1e9));
+    ::testing::Test::RecordProperty("with_json_ns", static_cast<int>(with_json_s * 1e9));
+
+    mavsdk_impl.unsubscribe_raw_bytes_to_be_sent(raw_handle);
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests.
+TEST(MavsdkImpl, DISABLED_ParseScalingWithConnections)
+{
+    constexpr unsigned messages_per_connection = 20000;
+
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{ComponentType::GroundStation}};
+
+    mavlink_message_t message;
+    mavlink_msg_attitude_pack_chan(
+        1, 1, mavsdk_impl.channel(), &message, 0, 0.1f, 0.2f, 0.3f, 0.0f, 0.0f, 0.0f);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+
+    // Every receiving connection parses on its own thread.
+    for (unsigned num_connections = 1; num_connections <= 8; num_connections *= 2) {
+        std::atomic<unsigned> parsed{0};
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < num_connections; ++t) {
+            threads.emplace_back([&]() {
+                for (unsigned i = 0; i < messages_per_connection; ++i) {
+                    size_t bytes_consumed = 0;
+                    if (mavsdk_impl.parse_message_safe(buffer, buffer_len, bytes_consumed)) {
+                        ++parsed;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        const auto elapsed =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+        EXPECT_EQ(parsed, num_connections * messages_per_connection);
+        ::testing::Test::RecordProperty(
+            "messages_per_s_" + std::to_string(num_connections) + "_connections",
+            static_cast<int>(parsed / elapsed.count()));
+    }
+}
+
+TEST(MavsdkImpl, LoadCustomXmlWhileParsing)
+{
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{ComponentType::GroundStation}};
+
+    mavlink_message_t message;
+    mavlink_msg_attitude_pack_chan(
+        1, 1, mavsdk_impl.channel(), &message, 0, 0.1f, 0.2f, 0.3f, 0.0f, 0.0f, 0.0f);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+
+    std::atomic<bool> done{false};
+    std::atomic<unsigned> failed{0};
+    std::thread parser([&]() {
+        while (!done) {
+            size_t bytes_consumed = 0;
+            auto parsed = mavsdk_impl.parse_message_safe(buffer, buffer_len, bytes_consumed);
+            if (!parsed || parsed.value().name() != "ATTITUDE") {
+                ++failed;
+            }
+        }
+    });
+
+    const std::string custom_xml = R"(<?xml version="1.0"?>
+<mavlink>
+  <messages>
+    <message id="42999" name="CUSTOM_TEST_MESSAGE">
+      <description>Test message.</description>
+      <field type="uint32_t" name="value">Value.</field>
+    </message>
+  </messages>
+</mavlink>
+)";
+
+    EXPECT_FALSE(mavsdk_impl.message_name_to_id_safe("CUSTOM_TEST_MESSAGE").has_value());
+    EXPECT_TRUE(mavsdk_impl.load_custom_xml_to_message_set(custom_xml));
+    EXPECT_EQ(mavsdk_impl.message_name_to_id_safe("CUSTOM_TEST_MESSAGE"), 42999);
+    // Messages from before are still known.
+    EXPECT_EQ(mavsdk_impl.message_name_to_id_safe("ATTITUDE"), MAVLINK_MSG_ID_ATTITUDE);
+
+    done = true;
+    parser.join();
+    EXPECT_EQ(failed, 0);
+}
+
+TEST(MavsdkImpl, LoadCustomXmlReleasesOldMessageSet)
+{
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{ComponentType::GroundStation}};
+
+    mavlink_message_t message;
+    mavlink_msg_attitude_pack_chan(
+        1, 1, mavsdk_impl.channel(), &message, 0, 0.1f, 0.2f, 0.3f, 0.0f, 0.0f, 0.0f);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+
+    size_t bytes_consumed = 0;
+    auto parsed = mavsdk_impl.parse_message_safe(buffer, buffer_len, bytes_consumed);
+    ASSERT_TRUE(parsed);
+
+    std::weak_ptr<mav::MessageSet> old_message_set = mavsdk_impl.get_message_set();
+
+    const std::string custom_xml = R"(<?xml version="1.0"?>
+<mavlink>
+  <messages>
+    <message id="42998" name="OTHER_TEST_MESSAGE">
+      <description>Test message.</description>
+      <field type="uint32_t" name="value">Value.</field>
+    </message>
+  </messages>
+</mavlink>
+)";
+    ASSERT_TRUE(mavsdk_impl.load_custom_xml_to_message_set(custom_xml));
+
+    // This thread parsed with the old set, so the message it got is still valid.
+    EXPECT_FALSE(old_message_set.expired());
+    EXPECT_EQ(parsed.value().name(), "ATTITUDE");
+    parsed.reset();
+
+    // Once it parses with the new one, the old one is gone.
+    EXPECT_TRUE(mavsdk_impl.parse_message_safe(buffer, buffer_len, bytes_consumed));
+    EXPECT_TRUE(old_message_set.expired());
+}
+
+TEST(MavsdkImpl, InstancesKeepTheirMessageSetOnTheSameThread)
+{
+    MavsdkImpl first{Mavsdk::Configuration{ComponentType::GroundStation}};
+    MavsdkImpl second{Mavsdk::Configuration{ComponentType::GroundStation}};
+
+    auto message = first.create_message_safe("ATTITUDE");
+    ASSERT_TRUE(message);
+    std::weak_ptr<mav::MessageSet> first_message_set = first.get_message_set();
+
+    const std::string custom_xml = R"(<?xml version="1.0"?>
+<mavlink>
+  <messages>
+    <message id="42997" name="THIRD_TEST_MESSAGE">
+      <description>Test message.</description>
+      <field type="uint32_t" name="value">Value.</field>
+    </message>
+  </messages>
+</mavlink>
+)";
+    ASSERT_TRUE(first.load_custom_xml_to_message_set(custom_xml));
+
+    // Using the other instance on this thread must not release the set the message of the
+    // first one refers to.
+    EXPECT_TRUE(second.create_message_safe("ATTITUDE"));
+    EXPECT_FALSE(first_message_set.expired());
+    EXPECT_EQ(message.value().name(), "ATTITUDE");
+    message.reset();
+
+    EXPECT_TRUE(first.create_message_safe("ATTITUDE"));
+    EXPECT_TRUE(first_message_set.expired());
+}
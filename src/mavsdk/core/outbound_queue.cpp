@@ -0,0 +1,216 @@
+#include "outbound_queue.h"
+
+#include <algorithm>
+
+#include "mavlink_statistics.h"
+
+namespace mavsdk {
+
+TrafficClass traffic_class_for_message(uint32_t message_id)
+{
+    switch (message_id) {
+        case MAVLINK_MSG_ID_HEARTBEAT:
+        case MAVLINK_MSG_ID_MANUAL_CONTROL:
+        case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
+        case MAVLINK_MSG_ID_SET_ATTITUDE_TARGET:
+        case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
+        case MAVLINK_MSG_ID_SET_POSITION_TARGET_GLOBAL_INT:
+        case MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET:
+        case MAVLINK_MSG_ID_ATT_POS_MOCAP:
+        case MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE:
+        case MAVLINK_MSG_ID_ODOMETRY:
+            return TrafficClass::Control;
+
+        case MAVLINK_MSG_ID_COMMAND_LONG:
+        case MAVLINK_MSG_ID_COMMAND_INT:
+        case MAVLINK_MSG_ID_COMMAND_ACK:
+        case MAVLINK_MSG_ID_COMMAND_CANCEL:
+        case MAVLINK_MSG_ID_SET_MODE:
+            return TrafficClass::Command;
+
+        case MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL:
+        case MAVLINK_MSG_ID_MISSION_ITEM:
+        case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+        case MAVLINK_MSG_ID_MISSION_REQUEST:
+        case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+        case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+        case MAVLINK_MSG_ID_MISSION_COUNT:
+        case MAVLINK_MSG_ID_MISSION_ACK:
+        case MAVLINK_MSG_ID_MISSION_CLEAR_ALL:
+        case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+        case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+        case MAVLINK_MSG_ID_PARAM_VALUE:
+        case MAVLINK_MSG_ID_PARAM_SET:
+        case MAVLINK_MSG_ID_PARAM_EXT_REQUEST_READ:
+        case MAVLINK_MSG_ID_PARAM_EXT_REQUEST_LIST:
+        case MAVLINK_MSG_ID_PARAM_EXT_VALUE:
+        case MAVLINK_MSG_ID_PARAM_EXT_SET:
+        case MAVLINK_MSG_ID_PARAM_EXT_ACK:
+        case MAVLINK_MSG_ID_LOG_REQUEST_LIST:
+        case MAVLINK_MSG_ID_LOG_ENTRY:
+        case MAVLINK_MSG_ID_LOG_REQUEST_DATA:
+        case MAVLINK_MSG_ID_LOG_DATA:
+        case MAVLINK_MSG_ID_LOG_REQUEST_END:
+            return TrafficClass::Bulk;
+
+        default:
+            return TrafficClass::Telemetry;
+    }
+}
+
+bool OutboundQueue::push(const mavlink_message_t& message)
+{
+    auto& queue = _queues[static_cast<size_t>(traffic_class_for_message(message.msgid))];
+
+    if (_max_per_class != 0 && queue.size() >= _max_per_class) {
+        return false;
+    }
+
+    queue.push_back(message);
+    ++_size;
+    _bytes += mavlink_frame_length(message);
+    return true;
+}
+
+size_t OutboundQueue::next_class() const
+{
+    constexpr auto bulk = static_cast<size_t>(TrafficClass::Bulk);
+    if (!_queues[bulk].empty() &&
+        _bulk_credit >= static_cast<double>(mavlink_frame_length(_queues[bulk].front()))) {
+        return bulk;
+    }
+
+    for (size_t i = 0; i < _queues.size(); ++i) {
+        if (!_queues[i].empty()) {
+            return i;
+        }
+    }
+    // Caller's responsibility to check empty() first.
+    return bulk;
+}
+
+const mavlink_message_t& OutboundQueue::front() const
+{
+    return _queues[next_class()].front();
+}
+
+void OutboundQueue::pop()
+{
+    if (empty()) {
+        return;
+    }
+
+    constexpr auto bulk = static_cast<size_t>(TrafficClass::Bulk);
+    const size_t index = next_class();
+    auto& queue = _queues[index];
+    const auto length = static_cast<double>(mavlink_frame_length(queue.front()));
+
+    if (index == bulk) {
+        _bulk_credit = std::max(0.0, _bulk_credit - length);
+    } else if (!_queues[bulk].empty()) {
+        // Bulk is waiting, it earns its share of what is sent instead.
+        _bulk_credit += length * BULK_MIN_SHARE / (1.0 - BULK_MIN_SHARE);
+    }
+
+    _bytes -= mavlink_frame_length(queue.front());
+    --_size;
+    queue.pop_front();
+
+    if (_queues[bulk].empty()) {
+        // No saving up while there is nothing to send.
+        _bulk_credit = 0.0;
+    }
+}
+
+TokenBucket::TokenBucket(double rate_bytes_s, double burst_bytes, SteadyTimePoint now) :
+    _rate(rate_bytes_s),
+    _burst(burst_bytes),
+    _tokens(burst_bytes),
+    _last_refill(now)
+{}
+
+void TokenBucket::set_rate(double rate_bytes_s, double burst_bytes)
+{
+    _rate = rate_bytes_s;
+    _burst = burst_bytes;
+    _tokens = std::min(_tokens, _burst);
+}
+
+void TokenBucket::refill(SteadyTimePoint now)
+{
+    if (now <= _last_refill) {
+        return;
+    }
+
+    const double elapsed_s = std::chrono::duration<double>(now - _last_refill).count();
+    _tokens = std::min(_burst, _tokens + elapsed_s * _rate);
+    _last_refill = now;
+}
+
+bool TokenBucket::try_consume(size_t bytes)
+{
+    if (_tokens < static_cast<double>(bytes)) {
+        return false;
+    }
+
+    _tokens -= static_cast<double>(bytes);
+    return true;
+}
+
+OutboundShaper::OutboundShaper(double rate_bytes_s, SteadyTimePoint now) :
+    _bucket(rate_bytes_s, burst_for_rate(rate_bytes_s), now)
+{}
+
+double OutboundShaper::burst_for_rate(double rate_bytes_s)
+{
+    // Allow short bursts of 100 ms but at least enough for the biggest message.
+    return std::max(rate_bytes_s * 0.1, static_cast<double>(MAVLINK_MAX_PACKET_LEN));
+}
+
+void OutboundShaper::set_rate(double rate_bytes_s)
+{
+    _bucket.set_rate(rate_bytes_s, burst_for_rate(rate_bytes_s));
+    update_backlog();
+}
+
+bool OutboundShaper::push(const mavlink_message_t& message)
+{
+    const bool pushed = _queue.push(message);
+    update_backlog();
+    return pushed;
+}
+
+void OutboundShaper::drain(SteadyTimePoint now, const SendFunction& send)
+{
+    _bucket.refill(now);
+
+    while (!_queue.empty()) {
+        const auto& message = _queue.front();
+        if (!_bucket.try_consume(mavlink_frame_length(message))) {
+            break;
+        }
+        send(message);
+        _queue.pop();
+    }
+
+    update_backlog();
+}
+
+void OutboundShaper::flush(const SendFunction& send)
+{
+    while (!_queue.empty()) {
+        send(_queue.front());
+        _queue.pop();
+    }
+
+    update_backlog();
+}
+
+void OutboundShaper::update_backlog()
+{
+    _backlog_s.store(
+        _bucket.rate() > 0.0 ? static_cast<double>(_queue.bytes()) / _bucket.rate() : 0.0,
+        std::memory_order_relaxed);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+#include "mavlink_include.h"
+#include "mavsdk_time.h"
+
+namespace mavsdk {
+
+// Outgoing messages are scheduled by traffic class, lower value means higher priority.
+enum class TrafficClass : uint8_t {
+    Control = 0, // Heartbeats, setpoints, manual control
+    Command = 1, // Commands and their acks
+    Telemetry = 2, // Everything else
+    Bulk = 3, // Mission, parameter, FTP and log transfers
+};
+
+static constexpr size_t NUM_TRAFFIC_CLASSES = 4;
+
+TrafficClass traffic_class_for_message(uint32_t message_id);
+
+// Priority queue of outgoing messages, FIFO within each traffic class.
+// This is not thread-safe.
+//
+// Strict priority would starve the Bulk class as long as enough higher priority messages
+// are queued, and mission or FTP transfers would time out. Therefore, Bulk messages go first
+// once higher priority messages have taken more than BULK_MIN_SHARE of the bytes sent
+// since Bulk messages are waiting.
+class OutboundQueue {
+public:
+    static constexpr double BULK_MIN_SHARE = 0.1;
+
+    // A limit of 0 means unlimited.
+    explicit OutboundQueue(size_t max_per_class = 0) : _max_per_class(max_per_class) {}
+
+    // Returns false if the message was dropped because its class is full.
+    bool push(const mavlink_message_t& message);
+
+    [[nodiscard]] bool empty() const { return _size == 0; }
+    [[nodiscard]] size_t size() const { return _size; }
+    // Bytes on the wire of all queued messages.
+    [[nodiscard]] size_t bytes() const { return _bytes; }
+
+    // Next message to send, queue must not be empty.
+    [[nodiscard]] const mavlink_message_t& front() const;
+    void pop();
+
+private:
+    [[nodiscard]] size_t next_class() const;
+
+    std::array<std::deque<mavlink_message_t>, NUM_TRAFFIC_CLASSES> _queues{};
+    size_t _max_per_class;
+    size_t _size{0};
+    size_t _bytes{0};
+    // Bytes the Bulk class may send ahead of higher priority classes.
+    double _bulk_credit{0.0};
+};
+
+// Classic token bucket, filled at rate bytes per second up to burst bytes.
+class TokenBucket {
+public:
+    TokenBucket(double rate_bytes_s, double burst_bytes, SteadyTimePoint now);
+
+    void set_rate(double rate_bytes_s, double burst_bytes);
+    void refill(SteadyTimePoint now);
+    bool try_consume(size_t bytes);
+
+    [[nodiscard]] double rate() const { return _rate; }
+
+private:
+    double _rate;
+    double _burst;
+    double _tokens;
+    SteadyTimePoint _last_refill;
+};
+
+// Outgoing messages for one connection, sent in priority order without exceeding the
+// configured bandwidth.
+//
+// Only to be used from one thread, except for backlog_s().
+class OutboundShaper {
+public:
+    using SendFunction = std::function<void(const mavlink_message_t&)>;
+
+    OutboundShaper(double rate_bytes_s, SteadyTimePoint now);
+
+    void set_rate(double rate_bytes_s);
+
+    // Returns false if the message had to be dropped.
+    bool push(const mavlink_message_t& message);
+
+    // Sends the queued messages which fit into the current budget. Apart from the minimum
+    // share of the Bulk class, lower priority messages never overtake higher priority ones.
+    void drain(SteadyTimePoint now, const SendFunction& send);
+
+    // Sends everything queued, regardless of the budget.
+    void flush(const SendFunction& send);
+
+    [[nodiscard]] size_t queued() const { return _queue.size(); }
+
+    // Time it takes until everything queued now is sent.
+    [[nodiscard]] double backlog_s() const { return _backlog_s.load(std::memory_order_relaxed); }
+
+    static double burst_for_rate(double rate_bytes_s);
+
+private:
+    void update_backlog();
+
+    static constexpr size_t MAX_QUEUED_PER_CLASS = 500;
+
+    OutboundQueue _queue{MAX_QUEUED_PER_CLASS};
+    TokenBucket _bucket;
+    std::atomic<double> _backlog_s{0.0};
+};
+
+} // namespace mavsdk
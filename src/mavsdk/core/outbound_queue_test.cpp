@@ -0,0 +1,173 @@
+#include "outbound_queue.h"
+#include "mavlink_statistics.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t make_message(uint32_t message_id, uint8_t payload_len, uint8_t seq = 0)
+{
+    mavlink_message_t message{};
+    message.magic = MAVLINK_STX;
+    message.msgid = message_id;
+    message.len = payload_len;
+    message.seq = seq;
+    return message;
+}
+
+} // namespace
+
+TEST(OutboundQueue, PriorityOrder)
+{
+    OutboundQueue queue;
+
+    queue.push(make_message(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, 251, 1));
+    queue.push(make_message(MAVLINK_MSG_ID_ATTITUDE, 28, 2));
+    queue.push(make_message(MAVLINK_MSG_ID_COMMAND_LONG, 33, 3));
+    queue.push(make_message(MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED, 51, 4));
+    queue.push(make_message(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, 251, 5));
+
+    EXPECT_EQ(queue.size(), 5);
+    EXPECT_EQ(queue.bytes(), 263 + 40 + 45 + 63 + 263);
+
+    std::vector<uint8_t> order;
+    while (!queue.empty()) {
+        order.push_back(queue.front().seq);
+        queue.pop();
+    }
+
+    EXPECT_EQ(order, (std::vector<uint8_t>{4, 3, 2, 1, 5}));
+    EXPECT_EQ(queue.bytes(), 0);
+}
+
+TEST(OutboundQueue, LimitPerClass)
+{
+    OutboundQueue queue(2);
+
+    EXPECT_TRUE(queue.push(make_message(MAVLINK_MSG_ID_PARAM_SET, 23)));
+    EXPECT_TRUE(queue.push(make_message(MAVLINK_MSG_ID_PARAM_SET, 23)));
+    EXPECT_FALSE(queue.push(make_message(MAVLINK_MSG_ID_PARAM_SET, 23)));
+    // Other classes are not affected.
+    EXPECT_TRUE(queue.push(make_message(MAVLINK_MSG_ID_HEARTBEAT, 9)));
+}
+
+TEST(OutboundQueue, BulkIsNotStarved)
+{
+    OutboundQueue queue;
+
+    for (int i = 0; i < 100; ++i) {
+        queue.push(make_message(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, 251));
+    }
+
+    // Telemetry alone would take up the whole bandwidth.
+    size_t telemetry_bytes = 0;
+    size_t bulk_bytes = 0;
+    queue.push(make_message(MAVLINK_MSG_ID_ATTITUDE, 28));
+    for (int i = 0; i < 2000; ++i) {
+        const auto& message = queue.front();
+        if (message.msgid == MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL) {
+            bulk_bytes += mavlink_frame_length(message);
+            queue.pop();
+        } else {
+            telemetry_bytes += mavlink_frame_length(message);
+            queue.pop();
+            queue.push(make_message(MAVLINK_MSG_ID_ATTITUDE, 28));
+        }
+    }
+
+    const double bulk_share =
+        static_cast<double>(bulk_bytes) / static_cast<double>(bulk_bytes + telemetry_bytes);
+    EXPECT_GT(bulk_share, OutboundQueue::BULK_MIN_SHARE * 0.9);
+    EXPECT_LT(bulk_share, OutboundQueue::BULK_MIN_SHARE * 1.5);
+}
+
+TEST(OutboundQueue, TokenBucket)
+{
+    const auto start = std::chrono::steady_clock::now();
+    TokenBucket bucket(1000.0, 100.0, start);
+
+    EXPECT_TRUE(bucket.try_consume(100));
+    EXPECT_FALSE(bucket.try_consume(1));
+
+    bucket.refill(start + std::chrono::milliseconds(50));
+    EXPECT_TRUE(bucket.try_consume(50));
+    EXPECT_FALSE(bucket.try_consume(1));
+
+    // Never more than the burst.
+    bucket.refill(start + std::chrono::seconds(10));
+    EXPECT_TRUE(bucket.try_consume(100));
+    EXPECT_FALSE(bucket.try_consume(1));
+}
+
+// Simulates a 57600 baud link where an FTP download keeps the queue full of FTP
+// requests while setpoints are sent at 50 Hz. The setpoints have to overtake the
+// FTP traffic and the link must never exceed its rate.
+TEST(OutboundQueue, SetpointLatencyBoundedDuringFtpTransfer)
+{
+    constexpr double rate_bytes_s = 5760.0;
+    const auto start = std::chrono::steady_clock::now();
+    OutboundShaper shaper(rate_bytes_s, start);
+
+    const auto setpoint = make_message(MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED, 51);
+    const auto ftp = make_message(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, 251);
+
+    // A burst of FTP requests which alone would take several seconds to send.
+    for (int i = 0; i < 100; ++i) {
+        shaper.push(ftp);
+    }
+    EXPECT_GT(shaper.backlog_s(), 4.0);
+
+    std::vector<std::chrono::steady_clock::time_point> setpoints_queued;
+    std::vector<std::chrono::steady_clock::duration> setpoint_latencies;
+    size_t bytes_sent = 0;
+    size_t ftp_sent = 0;
+
+    auto now = start;
+    const auto step = std::chrono::milliseconds(1);
+    const auto setpoint_interval = std::chrono::milliseconds(20);
+    auto next_setpoint = start;
+
+    for (int i = 0; i < 3000; ++i) {
+        if (now >= next_setpoint) {
+            shaper.push(setpoint);
+            setpoints_queued.push_back(now);
+            next_setpoint += setpoint_interval;
+        }
+
+        shaper.drain(now, [&](const mavlink_message_t& message) {
+            bytes_sent += mavlink_frame_length(message);
+            if (message.msgid == MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL) {
+                ++ftp_sent;
+                // The download keeps going, every response triggers the next request.
+                shaper.push(ftp);
+            } else {
+                ASSERT_LT(setpoint_latencies.size(), setpoints_queued.size());
+                setpoint_latencies.push_back(now - setpoints_queued[setpoint_latencies.size()]);
+            }
+        });
+
+        now += step;
+    }
+
+    const auto elapsed_s = std::chrono::duration<double>(now - start).count();
+
+    ASSERT_GE(setpoint_latencies.size(), setpoints_queued.size() - 1);
+    const auto max_latency =
+        *std::max_element(setpoint_latencies.begin(), setpoint_latencies.end());
+
+    // At most one FTP message can be in the way: 263 bytes at 5760 bytes/s is ~46 ms.
+    EXPECT_LT(max_latency, std::chrono::milliseconds(60));
+
+    // The transfer still makes progress with the remaining bandwidth.
+    EXPECT_GT(ftp_sent, 20);
+
+    // Rate limit including the initial burst.
+    EXPECT_LE(
+        static_cast<double>(bytes_sent),
+        rate_bytes_s * elapsed_s + OutboundShaper::burst_for_rate(rate_bytes_s));
+}
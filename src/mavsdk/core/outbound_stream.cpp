@@ -0,0 +1,124 @@
+#include "outbound_stream.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#if !defined(WINDOWS)
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#endif
+
+namespace mavsdk {
+
+bool OutboundStream::push(MavlinkFramePtr frame)
+{
+    if (_pending_bytes + frame->size() > MAX_PENDING_BYTES) {
+        return false;
+    }
+
+    _pending_bytes += frame->size();
+    _frames.push_back(std::move(frame));
+    return true;
+}
+
+int OutboundStream::write(const WriteFunction& write_function)
+{
+    while (!_frames.empty()) {
+        _chunks.clear();
+        for (size_t i = 0; i < _frames.size() && _chunks.size() < MAX_CHUNKS; ++i) {
+            const size_t offset = (i == 0) ? _offset : 0;
+            _chunks.push_back({_frames[i]->data() + offset, _frames[i]->size() - offset});
+        }
+
+        const auto result = write_function(_chunks.data(), _chunks.size());
+        if (result.error != 0) {
+            clear();
+            return result.error;
+        }
+
+        if (result.written == 0) {
+            // Would block, the rest is written next time.
+            return 0;
+        }
+
+        consume(result.written);
+    }
+
+    return 0;
+}
+
+void OutboundStream::clear()
+{
+    _frames.clear();
+    _offset = 0;
+    _pending_bytes = 0;
+}
+
+void OutboundStream::consume(size_t written)
+{
+    _pending_bytes -= std::min(written, _pending_bytes);
+
+    while (written > 0 && !_frames.empty()) {
+        const size_t remaining = _frames.front()->size() - _offset;
+        if (written < remaining) {
+            _offset += written;
+            return;
+        }
+        written -= remaining;
+        _offset = 0;
+        _frames.pop_front();
+    }
+}
+
+#if !defined(WINDOWS)
+namespace {
+
+template<typename Write>
+OutboundStream::WriteResult
+write_iovecs(const OutboundStream::Chunk* chunks, size_t count, Write&& write)
+{
+    iovec iov[OutboundStream::MAX_CHUNKS];
+    count = std::min(count, OutboundStream::MAX_CHUNKS);
+    for (size_t i = 0; i < count; ++i) {
+        iov[i].iov_base = const_cast<char*>(chunks[i].data);
+        iov[i].iov_len = chunks[i].size;
+    }
+
+    while (true) {
+        const ssize_t written = write(iov, static_cast<int>(count));
+        if (written >= 0) {
+            return {static_cast<size_t>(written), 0};
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return {0, 0};
+        }
+        return {0, errno};
+    }
+}
+
+} // namespace
+
+OutboundStream::WriteResult
+write_chunks(int fd, const OutboundStream::Chunk* chunks, size_t count)
+{
+    return write_iovecs(
+        chunks, count, [fd](iovec* iov, int iovcnt) { return writev(fd, iov, iovcnt); });
+}
+
+OutboundStream::WriteResult
+send_chunks(int fd, const OutboundStream::Chunk* chunks, size_t count, int flags)
+{
+    return write_iovecs(chunks, count, [fd, flags](iovec* iov, int iovcnt) {
+        msghdr message{};
+        message.msg_iov = iov;
+        message.msg_iovlen = iovcnt;
+        return sendmsg(fd, &message, flags);
+    });
+}
+#endif
+
+} // namespace mavsdk
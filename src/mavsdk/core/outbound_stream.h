@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "mavlink_frame.h"
+
+namespace mavsdk {
+
+// Outgoing frames of a stream based connection (serial or TCP).
+//
+// The frames are written with as few system calls as possible, using scatter/gather writes
+// directly from the frames without copying them. If only part of the data could be written,
+// the rest is kept and written first the next time, so that frames are never cut or
+// reordered on the wire.
+//
+// Not thread-safe, only to be used from the work thread.
+class OutboundStream {
+public:
+    struct Chunk {
+        const char* data;
+        size_t size;
+    };
+
+    struct WriteResult {
+        // Can be less than requested, 0 if the write would block.
+        size_t written{0};
+        // The errno of a failed write, 0 otherwise.
+        int error{0};
+    };
+
+    using WriteFunction = std::function<WriteResult(const Chunk* chunks, size_t count)>;
+
+    // Limit of chunks per write, IOV_MAX is at least 16 (_XOPEN_IOV_MAX).
+    static constexpr size_t MAX_CHUNKS = 16;
+
+    // If the other end doesn't keep up, frames are dropped rather than buffered without limit.
+    static constexpr size_t MAX_PENDING_BYTES = 64 * 1024;
+
+    // Returns false if the frame was dropped because too much is pending already.
+    bool push(MavlinkFramePtr frame);
+
+    // Writes pending frames until everything is written or the write would block.
+    // Returns 0, or the errno of the failed write in which case all pending frames are dropped.
+    int write(const WriteFunction& write_function);
+
+    [[nodiscard]] bool has_pending() const { return !_frames.empty(); }
+    [[nodiscard]] size_t pending_bytes() const { return _pending_bytes; }
+
+    void clear();
+
+private:
+    void consume(size_t written);
+
+    std::deque<MavlinkFramePtr> _frames{};
+    // Bytes of the first frame which have been written already.
+    size_t _offset{0};
+    size_t _pending_bytes{0};
+    std::vector<Chunk> _chunks{};
+};
+
+#if !defined(WINDOWS)
+// Write functions for file descriptors using writev() and sendmsg().
+// Interrupted writes are retried, EAGAIN/EWOULDBLOCK is reported as 0 bytes written.
+OutboundStream::WriteResult
+write_chunks(int fd, const OutboundStream::Chunk* chunks, size_t count);
+OutboundStream::WriteResult
+send_chunks(int fd, const OutboundStream::Chunk* chunks, size_t count, int flags);
+#endif
+
+} // namespace mavsdk
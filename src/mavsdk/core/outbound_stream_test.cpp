@@ -0,0 +1,301 @@
+#include "outbound_stream.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(WINDOWS)
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace mavsdk;
+
+namespace {
+
+MavlinkFramePtr make_heartbeat(uint8_t sequence)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack_chan(
+        1, 1, MAVLINK_COMM_0, &message, MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID, 0, 0, 0);
+    message.seq = sequence;
+    return make_mavlink_frame(message);
+}
+
+std::string bytes_of(const std::vector<MavlinkFramePtr>& frames)
+{
+    std::string bytes;
+    for (const auto& frame : frames) {
+        bytes.append(frame->data(), frame->size());
+    }
+    return bytes;
+}
+
+// Accepts at most max_bytes per call, like a socket with a small send buffer.
+struct FakeStream {
+    size_t max_bytes{std::numeric_limits<size_t>::max()};
+    bool would_block{false};
+    int error{0};
+    unsigned calls{0};
+    std::string written{};
+
+    OutboundStream::WriteResult write(const OutboundStream::Chunk* chunks, size_t count)
+    {
+        ++calls;
+        if (error != 0) {
+            return {0, error};
+        }
+        if (would_block) {
+            return {0, 0};
+        }
+        size_t total = 0;
+        for (size_t i = 0; i < count && total < max_bytes; ++i) {
+            const size_t size = std::min(chunks[i].size, max_bytes - total);
+            written.append(chunks[i].data, size);
+            total += size;
+        }
+        return {total, 0};
+    }
+
+    OutboundStream::WriteFunction function()
+    {
+        return [this](const OutboundStream::Chunk* chunks, size_t count) {
+            return write(chunks, count);
+        };
+    }
+};
+
+} // namespace
+
+TEST(OutboundStream, WritesAllFramesWithOneCall)
+{
+    OutboundStream stream;
+    FakeStream fake;
+
+    std::vector<MavlinkFramePtr> frames{make_heartbeat(0), make_heartbeat(1), make_heartbeat(2)};
+    for (const auto& frame : frames) {
+        EXPECT_TRUE(stream.push(frame));
+    }
+    EXPECT_EQ(stream.pending_bytes(), bytes_of(frames).size());
+
+    EXPECT_EQ(stream.write(fake.function()), 0);
+    EXPECT_EQ(fake.calls, 1u);
+    EXPECT_EQ(fake.written, bytes_of(frames));
+    EXPECT_FALSE(stream.has_pending());
+    EXPECT_EQ(stream.pending_bytes(), 0u);
+}
+
+TEST(OutboundStream, SplitsIntoChunkLimit)
+{
+    OutboundStream stream;
+    FakeStream fake;
+
+    std::vector<MavlinkFramePtr> frames;
+    for (unsigned i = 0; i < OutboundStream::MAX_CHUNKS + 1; ++i) {
+        frames.push_back(make_heartbeat(static_cast<uint8_t>(i)));
+        stream.push(frames.back());
+    }
+
+    EXPECT_EQ(stream.write(fake.function()), 0);
+    EXPECT_EQ(fake.calls, 2u);
+    EXPECT_EQ(fake.written, bytes_of(frames));
+}
+
+TEST(OutboundStream, ContinuesPartialWrites)
+{
+    OutboundStream stream;
+    FakeStream fake;
+    fake.max_bytes = 7;
+
+    std::vector<MavlinkFramePtr> frames{make_heartbeat(0), make_heartbeat(1), make_heartbeat(2)};
+    for (const auto& frame : frames) {
+        stream.push(frame);
+    }
+
+    EXPECT_EQ(stream.write(fake.function()), 0);
+    EXPECT_EQ(fake.written, bytes_of(frames));
+    EXPECT_GT(fake.calls, 3u);
+    EXPECT_FALSE(stream.has_pending());
+}
+
+TEST(OutboundStream, KeepsRestWhenWriteWouldBlock)
+{
+    OutboundStream stream;
+    FakeStream fake;
+    fake.max_bytes = 5;
+
+    const auto first = make_heartbeat(0);
+    const auto second = make_heartbeat(1);
+    stream.push(first);
+    stream.push(second);
+
+    // First write is partial, the next one would block.
+    auto function = [&, calls = 0u](const OutboundStream::Chunk* chunks, size_t count) mutable {
+        fake.would_block = (++calls > 1);
+        return fake.write(chunks, count);
+    };
+    EXPECT_EQ(stream.write(function), 0);
+    EXPECT_TRUE(stream.has_pending());
+    EXPECT_EQ(stream.pending_bytes(), first->size() + second->size() - 5);
+
+    // The rest goes out next time, in order and without gaps.
+    fake.would_block = false;
+    fake.max_bytes = std::numeric_limits<size_t>::max();
+    const auto third = make_heartbeat(2);
+    stream.push(third);
+    EXPECT_EQ(stream.write(fake.function()), 0);
+    EXPECT_EQ(fake.written, bytes_of({first, second, third}));
+    EXPECT_FALSE(stream.has_pending());
+}
+
+TEST(OutboundStream, DropsEverythingOnError)
+{
+    OutboundStream stream;
+    FakeStream fake;
+    fake.error = EPIPE;
+
+    stream.push(make_heartbeat(0));
+    EXPECT_EQ(stream.write(fake.function()), EPIPE);
+    EXPECT_FALSE(stream.has_pending());
+}
+
+TEST(OutboundStream, DropsFramesWhenFull)
+{
+    OutboundStream stream;
+
+    const auto frame = make_heartbeat(0);
+    size_t pushed = 0;
+    while (stream.push(frame)) {
+        ++pushed;
+    }
+    EXPECT_EQ(pushed, OutboundStream::MAX_PENDING_BYTES / frame->size());
+    EXPECT_LE(stream.pending_bytes(), OutboundStream::MAX_PENDING_BYTES);
+}
+
+#if !defined(WINDOWS)
+namespace {
+
+struct SocketResult {
+    unsigned syscalls;
+    double seconds;
+};
+
+// Sends the frames of every iteration over a socket pair, writing every message on its own or
+// coalescing the messages of one iteration of the work thread.
+SocketResult send_over_socket(
+    const std::vector<MavlinkFramePtr>& frames, unsigned iterations, bool coalesce)
+{
+    const size_t total_bytes = bytes_of(frames).size() * iterations;
+
+    int fds[2];
+    EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    std::atomic<size_t> received{0};
+    std::thread reader([&]() {
+        char buffer[4096];
+        while (received < total_bytes) {
+            const auto len = read(fds[1], buffer, sizeof(buffer));
+            if (len <= 0) {
+                break;
+            }
+            received += static_cast<size_t>(len);
+        }
+    });
+
+    auto send_single = [&](int fd) {
+        unsigned syscalls = 0;
+        for (const auto& frame : frames) {
+            size_t written = 0;
+            while (written < frame->size()) {
+                const auto len = write(fd, frame->data() + written, frame->size() - written);
+                ++syscalls;
+                if (len <= 0) {
+                    return syscalls;
+                }
+                written += static_cast<size_t>(len);
+            }
+        }
+        return syscalls;
+    };
+
+    OutboundStream stream;
+    auto send_coalesced = [&](int fd) {
+        unsigned syscalls = 0;
+        for (const auto& frame : frames) {
+            stream.push(frame);
+        }
+        stream.write([&](const OutboundStream::Chunk* chunks, size_t count) {
+            ++syscalls;
+            return write_chunks(fd, chunks, count);
+        });
+        return syscalls;
+    };
+
+    unsigned syscalls = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < iterations; ++i) {
+        syscalls += coalesce ? send_coalesced(fds[0]) : send_single(fds[0]);
+    }
+    reader.join();
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(received, total_bytes);
+    close(fds[0]);
+    close(fds[1]);
+    return {syscalls, seconds};
+}
+
+std::vector<MavlinkFramePtr> make_heartbeats(unsigned count)
+{
+    std::vector<MavlinkFramePtr> frames;
+    for (unsigned i = 0; i < count; ++i) {
+        frames.push_back(make_heartbeat(static_cast<uint8_t>(i)));
+    }
+    return frames;
+}
+
+} // namespace
+
+// 1000 messages per second with a 10 ms iteration of the work thread are 10 per iteration.
+TEST(OutboundStream, CoalescesWritesToSocket)
+{
+    constexpr unsigned iterations = 100;
+    constexpr unsigned messages_per_iteration = 10;
+    const auto frames = make_heartbeats(messages_per_iteration);
+
+    const auto single = send_over_socket(frames, iterations, false);
+    const auto coalesced = send_over_socket(frames, iterations, true);
+
+    EXPECT_EQ(single.syscalls, iterations * messages_per_iteration);
+    EXPECT_LE(coalesced.syscalls, iterations * 2);
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests.
+TEST(OutboundStream, DISABLED_Benchmark)
+{
+    constexpr unsigned iterations = 1000;
+    constexpr unsigned messages_per_iteration = 10;
+    const auto frames = make_heartbeats(messages_per_iteration);
+
+    const auto single = send_over_socket(frames, iterations, false);
+    const auto coalesced = send_over_socket(frames, iterations, true);
+
+    const unsigned messages = iterations * messages_per_iteration;
+    ::testing::Test::RecordProperty("single_syscalls", static_cast<int>(single.syscalls));
+    ::testing::Test::RecordProperty(
+        "single_msgs_per_s", static_cast<int>(messages / single.seconds));
+    ::testing::Test::RecordProperty("coalesced_syscalls", static_cast<int>(coalesced.syscalls));
+    ::testing::Test::RecordProperty(
+        "coalesced_msgs_per_s", static_cast<int>(messages / coalesced.seconds));
+
+    EXPECT_EQ(single.syscalls, messages);
+    EXPECT_LE(coalesced.syscalls, iterations * 2);
+}
+#endif
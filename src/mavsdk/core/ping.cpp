@@ -64,12 +64,17 @@ void Ping::process_ping(const mavlink_message_t& message)
             return;
         }
 
+        const uint64_t ping_time_us = _system_impl.get_time().elapsed_us() - ping.time_usec;
+
+        // The request goes out on all links, so we get a reply for each of them.
+        _system_impl.report_round_trip_time(message, std::chrono::microseconds(ping_time_us));
+
         if (message.compid != MAV_COMP_ID_AUTOPILOT1) {
             // We're currently only interested in the ping of the autopilot.
             return;
         }
 
-        _last_ping_time_us = _system_impl.get_time().elapsed_us() - ping.time_usec;
+        _last_ping_time_us = ping_time_us;
     }
 }
 
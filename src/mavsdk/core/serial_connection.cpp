@@ -1,4 +1,5 @@
 #include "serial_connection.h"
+#include "serial_port_linux.h"
 #include "log.h"
 
 #if defined(APPLE) || defined(LINUX)
@@ -64,6 +65,7 @@ SerialConnection::SerialConnection(
     std::string path,
     int baudrate,
     bool flow_control,
+    bool low_latency,
     ForwardingOption forwarding_option) :
     Connection(
         std::move(receiver_callback),
@@ -72,7 +74,8 @@ SerialConnection::SerialConnection(
         forwarding_option),
     _serial_node(std::move(path)),
     _baudrate(baudrate),
-    _flow_control(flow_control)
+    _flow_control(flow_control),
+    _low_latency(low_latency)
 {}
 
 SerialConnection::~SerialConnection()
@@ -153,8 +156,9 @@ ConnectionResult SerialConnection::setup_port()
     tc.c_cflag &= ~(CSIZE | PARENB | CRTSCTS);
     tc.c_cflag |= CS8;
 
-    tc.c_cc[VMIN] = 0; // We are ok with 0 bytes.
-    tc.c_cc[VTIME] = 10; // Timeout after 1 second.
+    // We wait for data with poll(), so read() should return whatever has arrived right away.
+    tc.c_cc[VMIN] = 0;
+    tc.c_cc[VTIME] = 0;
 
     if (_flow_control) {
         tc.c_cflag |= CRTSCTS;
@@ -165,12 +169,15 @@ ConnectionResult SerialConnection::setup_port()
     tc.c_cflag |= CLOCAL; // Without this a write() blocks indefinitely.
 
 #if defined(LINUX)
-    const int baudrate_or_define = define_from_baudrate(_baudrate);
+    const int baudrate_define = define_from_baudrate(_baudrate);
+    // Non-standard baudrates are set with termios2 after the other settings.
+    const int baudrate_or_define = baudrate_define != -1 ? baudrate_define : B38400;
 #elif defined(APPLE)
     const int baudrate_or_define = _baudrate;
 #endif
 
-    if (baudrate_or_define == -1) {
+    if (_baudrate <= 0) {
+        close(_fd);
         return ConnectionResult::BaudrateUnknown;
     }
 
@@ -193,6 +200,20 @@ ConnectionResult SerialConnection::setup_port()
     }
 #endif
 
+#if defined(LINUX)
+    if (baudrate_define == -1) {
+        if (!set_custom_baudrate(_fd, _baudrate)) {
+            LogErr() << "Baudrate " << _baudrate << " not supported: " << GET_ERROR();
+            close(_fd);
+            return ConnectionResult::BaudrateUnknown;
+        }
+    }
+
+    if (_low_latency && !set_low_latency(_fd)) {
+        LogWarn() << "Could not set serial port to low latency: " << GET_ERROR();
+    }
+#endif
+
 #if defined(WINDOWS)
     DCB dcb;
     SecureZeroMemory(&dcb, sizeof(DCB));
@@ -282,8 +303,9 @@ std::pair<bool, std::string> SerialConnection::send_message(const mavlink_messag
 
 void SerialConnection::receive()
 {
-    // Enough for MTU 1500 bytes.
-    char buffer[2048];
+    // Everything which arrived since the last wakeup is read at once, at 3 Mbaud that is
+    // about 300 bytes per millisecond.
+    char buffer[16384];
 
 #if defined(LINUX) || defined(APPLE)
     struct pollfd fds[1];
@@ -295,15 +317,21 @@ void SerialConnection::receive()
         int recv_len;
 #if defined(LINUX) || defined(APPLE)
         int pollrc = poll(fds, 1, 1000);
-        if (pollrc == 0 || !(fds[0].revents & POLLIN)) {
+        if (pollrc == -1) {
+            if (errno != EINTR) {
+                LogErr() << "read poll failure: " << GET_ERROR();
+            }
+            continue;
+        } else if (pollrc == 0 || !(fds[0].revents & POLLIN)) {
             continue;
-        } else if (pollrc == -1) {
-            LogErr() << "read poll failure: " << GET_ERROR();
         }
         // We enter here if (fds[0].revents & POLLIN) == true
         recv_len = static_cast<int>(read(_fd, buffer, sizeof(buffer)));
-        if (recv_len < -1) {
-            LogErr() << "read failure: " << GET_ERROR();
+        if (recv_len < 0) {
+            if (errno != EAGAIN && errno != EINTR) {
+                LogErr() << "read failure: " << GET_ERROR();
+            }
+            continue;
         }
 #else
         if (!ReadFile(_handle, buffer, sizeof(buffer), LPDWORD(&recv_len), NULL)) {
@@ -371,14 +399,26 @@ int SerialConnection::define_from_baudrate(int baudrate)
             return B3500000;
         case 4000000:
             return B4000000;
-        default: {
-            LogErr() << "Unknown baudrate";
+        default:
             return -1;
-        }
     }
 }
 #endif
 
+std::pair<bool, std::string>
+SerialConnection::send_frames(const std::vector<MavlinkFramePtr>& frames)
+{
+    // It's a byte stream, so several frames can go out with one write.
+#if defined(LINUX) || defined(APPLE)
+    return send_frames_buffered(
+        frames, [this](const OutboundStream::Chunk* chunks, size_t count) {
+            return write_chunks(_fd, chunks, count);
+        });
+#else
+    return send_frames_concatenated(frames);
+#endif
+}
+
 std::pair<bool, std::string> SerialConnection::send_raw_bytes(const char* bytes, size_t length)
 {
     std::pair<bool, std::string> result;
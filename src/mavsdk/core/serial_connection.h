@@ -21,6 +21,7 @@ public:
         std::string path,
         int baudrate,
         bool flow_control,
+        bool low_latency,
         ForwardingOption forwarding_option = ForwardingOption::ForwardingOff);
     ConnectionResult start() override;
     ConnectionResult stop() override;
@@ -33,6 +34,9 @@ public:
     SerialConnection(const SerialConnection&) = delete;
     const SerialConnection& operator=(const SerialConnection&) = delete;
 
+protected:
+    std::pair<bool, std::string> send_frames(const std::vector<MavlinkFramePtr>& frames) override;
+
 private:
     ConnectionResult setup_port();
     void start_recv_thread();
@@ -45,6 +49,7 @@ private:
     const std::string _serial_node;
     const int _baudrate;
     const bool _flow_control;
+    const bool _low_latency;
 
     std::mutex _mutex = {};
 #if !defined(WINDOWS)
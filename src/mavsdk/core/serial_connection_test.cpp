@@ -0,0 +1,168 @@
+#include "serial_connection.h"
+#include "mavsdk_impl.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(LINUX)
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+using namespace mavsdk;
+
+#if defined(LINUX)
+namespace {
+
+// A pseudo terminal, the connection opens the slave side like a serial device.
+class Pty {
+public:
+    Pty()
+    {
+        _master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (_master_fd >= 0 && grantpt(_master_fd) == 0 && unlockpt(_master_fd) == 0) {
+            _slave_path = ptsname(_master_fd);
+        }
+    }
+
+    ~Pty()
+    {
+        if (_master_fd >= 0) {
+            close(_master_fd);
+        }
+    }
+
+    bool valid() const { return !_slave_path.empty(); }
+    const std::string& slave_path() const { return _slave_path; }
+
+    bool write_all(const std::vector<uint8_t>& bytes)
+    {
+        size_t written = 0;
+        while (written < bytes.size()) {
+            const auto len = ::write(_master_fd, bytes.data() + written, bytes.size() - written);
+            if (len <= 0) {
+                return false;
+            }
+            written += static_cast<size_t>(len);
+        }
+        return true;
+    }
+
+private:
+    int _master_fd{-1};
+    std::string _slave_path{};
+};
+
+std::vector<uint8_t> heartbeats(unsigned count)
+{
+    std::vector<uint8_t> bytes;
+    for (unsigned i = 0; i < count; ++i) {
+        mavlink_message_t message;
+        mavlink_msg_heartbeat_pack_chan(
+            1, 1, MAVLINK_COMM_0, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, 0);
+        message.seq = static_cast<uint8_t>(i);
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const auto len = mavlink_msg_to_send_buffer(buffer, &message);
+        bytes.insert(bytes.end(), buffer, buffer + len);
+    }
+    return bytes;
+}
+
+bool wait_for(const std::atomic<unsigned>& value, unsigned expected)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (value < expected) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(SerialConnection, AcceptsNonStandardBaudrate)
+{
+    Pty pty;
+    ASSERT_TRUE(pty.valid());
+
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{ComponentType::GroundStation}};
+    SerialConnection connection{
+        [](mavlink_message_t&, Connection*) {},
+        [](const LibmavMessage&, Connection*) {},
+        mavsdk_impl,
+        pty.slave_path(),
+        250000,
+        false,
+        false};
+
+    EXPECT_EQ(connection.start(), ConnectionResult::Success);
+    connection.stop();
+}
+
+// Sends bursts of messages through a pty, which runs on any Linux machine, so it shows the
+// overhead of the receive path rather than of a real adapter.
+// Benchmark, run with --gtest_also_run_disabled_tests.
+TEST(SerialConnection, DISABLED_PtyLoopbackBenchmark)
+{
+    constexpr unsigned bursts = 200;
+    constexpr unsigned messages_per_burst = 50;
+    constexpr unsigned latency_samples = 100;
+
+    Pty pty;
+    ASSERT_TRUE(pty.valid());
+
+    std::atomic<unsigned> received{0};
+
+    MavsdkImpl mavsdk_impl{Mavsdk::Configuration{ComponentType::GroundStation}};
+    SerialConnection connection{
+        [&](mavlink_message_t&, Connection*) { ++received; },
+        [](const LibmavMessage&, Connection*) {},
+        mavsdk_impl,
+        pty.slave_path(),
+        3000000,
+        false,
+        true};
+    ASSERT_EQ(connection.start(), ConnectionResult::Success);
+
+    // Throughput
+    const auto burst = heartbeats(messages_per_burst);
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < bursts; ++i) {
+        ASSERT_TRUE(pty.write_all(burst));
+        ASSERT_TRUE(wait_for(received, (i + 1) * messages_per_burst));
+    }
+    const double throughput_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Latency of single messages
+    const auto single = heartbeats(1);
+    std::chrono::steady_clock::duration latency_total{};
+    for (unsigned i = 0; i < latency_samples; ++i) {
+        const unsigned expected = received + 1;
+        const auto sent = std::chrono::steady_clock::now();
+        ASSERT_TRUE(pty.write_all(single));
+        ASSERT_TRUE(wait_for(received, expected));
+        latency_total += std::chrono::steady_clock::now() - sent;
+    }
+
+    connection.stop();
+
+    const unsigned messages = bursts * messages_per_burst;
+    ::testing::Test::RecordProperty("msgs_per_s", static_cast<int>(messages / throughput_s));
+    ::testing::Test::RecordProperty(
+        "bytes_per_s", static_cast<int>(burst.size() * bursts / throughput_s));
+    ::testing::Test::RecordProperty(
+        "latency_us",
+        static_cast<int>(
+            std::chrono::duration<double, std::micro>(latency_total).count() / latency_samples));
+
+    EXPECT_EQ(received, messages + latency_samples);
+}
+#endif
@@ -0,0 +1,41 @@
+#include "serial_port_linux.h"
+
+#if defined(LINUX)
+#include <asm/termbits.h>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace mavsdk {
+
+#if defined(LINUX)
+bool set_custom_baudrate(int fd, int baudrate)
+{
+    struct termios2 tc2;
+    if (ioctl(fd, TCGETS2, &tc2) != 0) {
+        return false;
+    }
+
+    // Output and input speed.
+    tc2.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+    tc2.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+    tc2.c_ispeed = static_cast<speed_t>(baudrate);
+    tc2.c_ospeed = static_cast<speed_t>(baudrate);
+
+    return ioctl(fd, TCSETS2, &tc2) == 0;
+}
+
+bool set_low_latency(int fd)
+{
+    struct serial_struct serial;
+    if (ioctl(fd, TIOCGSERIAL, &serial) != 0) {
+        return false;
+    }
+
+    serial.flags |= ASYNC_LOW_LATENCY;
+
+    return ioctl(fd, TIOCSSERIAL, &serial) == 0;
+}
+#endif
+
+} // namespace mavsdk
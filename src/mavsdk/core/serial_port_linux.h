@@ -0,0 +1,19 @@
+#pragma once
+
+namespace mavsdk {
+
+// Serial port settings only available on Linux.
+//
+// They need the kernel's termios definitions, which can't be included together with
+// <termios.h>, so they are kept in their own translation unit.
+#if defined(LINUX)
+// Sets a baudrate which has no Bxxx define, using termios2 and BOTHER.
+// Returns false and sets errno if the driver doesn't support it.
+bool set_custom_baudrate(int fd, int baudrate);
+
+// Sets ASYNC_LOW_LATENCY, so that USB serial adapters pass on data right away.
+// Returns false and sets errno if the driver doesn't support it, e.g. for ptys.
+bool set_low_latency(int fd);
+#endif
+
+} // namespace mavsdk
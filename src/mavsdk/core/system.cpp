@@ -55,6 +55,36 @@ std::vector<uint8_t> System::component_ids() const
     return _system_impl->component_ids();
 }
 
+std::vector<MessageIdStatistics> System::message_statistics() const
+{
+    return _system_impl->message_statistics();
+}
+
+std::vector<LinkQuality> System::link_quality() const
+{
+    return _system_impl->link_quality();
+}
+
+System::LinkQualityHandle System::subscribe_link_quality(const LinkQualityCallback& callback)
+{
+    return _system_impl->subscribe_link_quality(callback);
+}
+
+void System::unsubscribe_link_quality(LinkQualityHandle handle)
+{
+    _system_impl->unsubscribe_link_quality(handle);
+}
+
+void System::set_link_policy(const LinkPolicy& link_policy)
+{
+    _system_impl->set_link_policy(link_policy);
+}
+
+LinkPolicy System::link_policy() const
+{
+    return _system_impl->link_policy();
+}
+
 System::IsConnectedHandle System::subscribe_is_connected(const IsConnectedCallback& callback)
 {
     return _system_impl->subscribe_is_connected(callback);
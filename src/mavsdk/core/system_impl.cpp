@@ -20,6 +20,7 @@ namespace mavsdk {
 template class CallbackList<bool>;
 template class CallbackList<ComponentType>;
 template class CallbackList<ComponentType, uint8_t>;
+template class CallbackList<std::vector<LinkQuality>>;
 
 SystemImpl::SystemImpl(MavsdkImpl& mavsdk_impl) :
     _mavsdk_impl(mavsdk_impl),
@@ -43,6 +44,36 @@ SystemImpl::SystemImpl(MavsdkImpl& mavsdk_impl) :
         }
     }
 
+    // ArduPilot provides whole missions as files using MAVLink FTP.
+    _mission_transfer_client.set_file_transfer(
+        [this](const std::string& remote_path, auto callback) {
+            if (!mission_file_transfer_supported()) {
+                return false;
+            }
+            return _mavlink_ftp_client.download_to_memory_async(
+                remote_path,
+                [callback](MavlinkFtpClient::ClientResult result, std::vector<uint8_t> data) {
+                    callback(result == MavlinkFtpClient::ClientResult::Success, std::move(data));
+                },
+                MAV_COMP_ID_AUTOPILOT1);
+        },
+        [this](const std::string& remote_path, std::vector<uint8_t> data, auto callback)
+            -> FileTransferCancel {
+            if (!mission_file_transfer_supported()) {
+                return {};
+            }
+            return _mavlink_ftp_client.upload_from_memory_async(
+                remote_path,
+                data,
+                [callback](MavlinkFtpClient::ClientResult result) {
+                    callback(result == MavlinkFtpClient::ClientResult::Success);
+                },
+                MAV_COMP_ID_AUTOPILOT1);
+        });
+
+    _mission_transfer_client.set_partial_upload(
+        [this]() { return _mavsdk_impl.mission_partial_upload(); });
+
     _system_thread = new std::thread(&SystemImpl::system_thread, this);
 }
 
@@ -51,7 +82,9 @@ SystemImpl::~SystemImpl()
     _should_exit = true;
     _mavlink_message_handler.unregister_all(this);
     // Clear all libmav message callbacks
-    _libmav_message_callbacks.clear();
+    for (const auto& filter : _libmav_message_router.clear()) {
+        remove_libmav_interest(filter);
+    }
 
     unregister_timeout_handler(_heartbeat_timeout_cookie);
 
@@ -122,92 +155,67 @@ void SystemImpl::update_component_id_messages_handler(
     _mavlink_message_handler.update_component_id(msg_id, component_id, cookie);
 }
 
-void SystemImpl::process_libmav_message(const Mavsdk::MavlinkMessage& message)
+void SystemImpl::process_libmav_message(const LibmavMessage& message)
 {
     if (_message_debugging) {
-        LogDebug() << "SystemImpl::process_libmav_message: " << message.message_name;
+        LogDebug() << "SystemImpl::process_libmav_message: " << message.message.message_name;
     }
 
-    // CallbackList handles thread safety - just call all callbacks and let them filter internally
-    _libmav_message_callbacks.queue(
-        message, [this](const std::function<void()>& callback_wrapper) { callback_wrapper(); });
+    const auto called = _libmav_message_router.route(message);
+
+    if (_message_debugging) {
+        LogDebug() << "Called " << called
+                   << " libmav handlers for: " << message.message.message_name;
+    }
 }
 
 Handle<Mavsdk::MavlinkMessage> SystemImpl::register_libmav_message_handler(
     const std::string& message_name, const LibmavMessageCallback& callback)
 {
-    // Create a filtering callback that only calls the user callback for matching messages
-    auto filtering_callback =
-        [this, message_name, callback](const Mavsdk::MavlinkMessage& message) {
-            if (_message_debugging) {
-                LogDebug() << "Checking handler for message: '" << message_name << "' against '"
-                           << message.message_name << "'";
-            }
-
-            // Check if message name matches (empty string means match all messages)
-            if (!message_name.empty() && message_name != message.message_name) {
-                if (_message_debugging) {
-                    LogDebug() << "Handler message name mismatch, skipping";
-                }
-                return;
-            }
-
-            // Call the user callback
-            if (_message_debugging) {
-                LogDebug() << "Calling libmav handler for: " << message.message_name;
-            }
-            callback(message);
-        };
-
-    auto handle = _libmav_message_callbacks.subscribe(filtering_callback);
-
-    if (_message_debugging) {
-        LogDebug() << "Registering libmav handler for message: '" << message_name << "'";
-    }
-
-    return handle;
+    return register_libmav_message_handler_impl(message_name, std::nullopt, true, callback);
 }
 
 Handle<Mavsdk::MavlinkMessage> SystemImpl::register_libmav_message_handler_with_compid(
     const std::string& message_name, uint8_t cmp_id, const LibmavMessageCallback& callback)
 {
-    // Create a filtering callback that only calls the user callback for matching messages
-    auto filtering_callback =
-        [this, message_name, cmp_id, callback](const Mavsdk::MavlinkMessage& message) {
-            if (_message_debugging) {
-                LogDebug() << "Checking handler for message: '" << message_name << "' against '"
-                           << message.message_name
-                           << "' with component ID: " << static_cast<int>(cmp_id);
-            }
+    return register_libmav_message_handler_impl(message_name, cmp_id, true, callback);
+}
 
-            // Check if message name matches (empty string means match all messages)
-            if (!message_name.empty() && message_name != message.message_name) {
-                if (_message_debugging) {
-                    LogDebug() << "Handler message name mismatch, skipping";
-                }
-                return;
-            }
+Handle<Mavsdk::MavlinkMessage> SystemImpl::register_libmav_payload_handler(
+    const std::string& message_name, const LibmavMessageCallback& callback)
+{
+    return register_libmav_message_handler_impl(message_name, std::nullopt, false, callback);
+}
 
-            // Check if component ID matches
-            if (cmp_id != message.component_id) {
-                if (_message_debugging) {
-                    LogDebug() << "Handler component ID mismatch, skipping";
-                }
-                return;
-            }
+Handle<Mavsdk::MavlinkMessage> SystemImpl::register_libmav_message_handler_impl(
+    const std::string& message_name,
+    std::optional<uint8_t> cmp_id,
+    bool json,
+    const LibmavMessageCallback& callback)
+{
+    LibmavMessageRouter::Filter filter;
+    filter.component_id = cmp_id;
+    filter.json = json;
 
-            // Call the user callback
-            if (_message_debugging) {
-                LogDebug() << "Calling libmav handler for: " << message.message_name;
-            }
-            callback(message);
-        };
+    // Resolve the name once here, so that incoming messages are routed by ID (empty string
+    // means all messages).
+    if (!message_name.empty()) {
+        const auto message_id = _mavsdk_impl.message_name_to_id_safe(message_name);
+        if (message_id) {
+            filter.message_id = static_cast<uint32_t>(message_id.value());
+        } else {
+            // Possibly defined by custom XML which is loaded later, so we have to look at
+            // all messages by name.
+            LogWarn() << "Unknown message " << message_name << ", matching by name";
+            filter.message_name = message_name;
+        }
+    }
 
-    auto handle = _libmav_message_callbacks.subscribe(filtering_callback);
+    add_libmav_interest(filter);
+    auto handle = _libmav_message_router.subscribe(filter, callback);
 
     if (_message_debugging) {
-        LogDebug() << "Registering libmav handler for message: '" << message_name
-                   << "' with component ID: " << static_cast<int>(cmp_id);
+        LogDebug() << "Registering libmav handler for message: '" << message_name << "'";
     }
 
     return handle;
@@ -215,13 +223,32 @@ Handle<Mavsdk::MavlinkMessage> SystemImpl::register_libmav_message_handler_with_
 
 void SystemImpl::unregister_libmav_message_handler(Handle<Mavsdk::MavlinkMessage> handle)
 {
-    _libmav_message_callbacks.unsubscribe(handle);
+    const auto filter = _libmav_message_router.unsubscribe(handle);
+    if (filter) {
+        remove_libmav_interest(filter.value());
+    }
 
     if (_message_debugging) {
         LogDebug() << "Unregistered libmav handler";
     }
 }
 
+void SystemImpl::add_libmav_interest(const LibmavMessageRouter::Filter& filter)
+{
+    _mavsdk_impl.libmav_message_interest.add(filter.message_id);
+    if (filter.json) {
+        _mavsdk_impl.libmav_json_interest.add(filter.message_id);
+    }
+}
+
+void SystemImpl::remove_libmav_interest(const LibmavMessageRouter::Filter& filter)
+{
+    _mavsdk_impl.libmav_message_interest.remove(filter.message_id);
+    if (filter.json) {
+        _mavsdk_impl.libmav_json_interest.remove(filter.message_id);
+    }
+}
+
 TimeoutHandler::Cookie
 SystemImpl::register_timeout_handler(const std::function<void()>& callback, double duration_s)
 {
@@ -240,7 +267,9 @@ void SystemImpl::unregister_timeout_handler(TimeoutHandler::Cookie cookie)
 
 double SystemImpl::timeout_s() const
 {
-    return _mavsdk_impl.timeout_s();
+    // If outgoing messages are queued due to a bandwidth limit, the reply can only
+    // arrive once our request has actually been sent.
+    return _mavsdk_impl.timeout_s() + _mavsdk_impl.outbound_backlog_s();
 }
 
 void SystemImpl::enable_timesync()
@@ -261,9 +290,57 @@ void SystemImpl::unsubscribe_is_connected(System::IsConnectedHandle handle)
 
 void SystemImpl::process_mavlink_message(mavlink_message_t& message)
 {
+    _received_counters.record(message.msgid, mavlink_frame_length(message));
     _mavlink_message_handler.process_message(message);
 }
 
+std::vector<MessageIdStatistics> SystemImpl::message_statistics() const
+{
+    return _received_counters.snapshot();
+}
+
+void SystemImpl::update_statistics_rates(double elapsed_s)
+{
+    _received_counters.update_rates(elapsed_s);
+
+    if (!_link_quality_callbacks.empty()) {
+        _link_quality_callbacks.queue(
+            link_quality(), [this](const auto& func) { _mavsdk_impl.call_user_callback(func); });
+    }
+}
+
+std::vector<LinkQuality> SystemImpl::link_quality() const
+{
+    return _mavsdk_impl.link_quality(get_system_id());
+}
+
+System::LinkQualityHandle
+SystemImpl::subscribe_link_quality(const System::LinkQualityCallback& callback)
+{
+    return _link_quality_callbacks.subscribe(callback);
+}
+
+void SystemImpl::unsubscribe_link_quality(System::LinkQualityHandle handle)
+{
+    _link_quality_callbacks.unsubscribe(handle);
+}
+
+void SystemImpl::set_link_policy(const LinkPolicy& link_policy)
+{
+    _mavsdk_impl.set_link_policy(get_system_id(), link_policy);
+}
+
+LinkPolicy SystemImpl::link_policy() const
+{
+    return _mavsdk_impl.link_policy(get_system_id());
+}
+
+void SystemImpl::report_round_trip_time(
+    const mavlink_message_t& message, std::chrono::steady_clock::duration rtt)
+{
+    _mavsdk_impl.record_round_trip_time(message, rtt);
+}
+
 CallEveryHandler::Cookie
 SystemImpl::add_call_every(std::function<void()> callback, float interval_s)
 {
@@ -363,6 +440,14 @@ void SystemImpl::process_autopilot_version(const mavlink_message_t& message)
 
     _mission_transfer_client.set_int_messages_supported(
         autopilot_version.capabilities & MAV_PROTOCOL_CAPABILITY_MISSION_INT);
+
+    _ftp_supported = (autopilot_version.capabilities & MAV_PROTOCOL_CAPABILITY_FTP) != 0;
+}
+
+bool SystemImpl::mission_file_transfer_supported() const
+{
+    return _ftp_supported && _autopilot == Autopilot::ArduPilot &&
+           _mavsdk_impl.mission_transfer_over_ftp();
 }
 
 void SystemImpl::heartbeats_timed_out()
@@ -1412,6 +1497,22 @@ MavlinkParameterClient* SystemImpl::param_sender(uint8_t component_id, bool exte
         }
     }
 
+    // All params of ArduPilot can be downloaded at once using MAVLink FTP, if supported.
+    FileDownloader file_downloader{};
+    if (component_id == MAV_COMP_ID_AUTOPILOT1 && !extended) {
+        file_downloader = [this, component_id](const std::string& remote_path, auto callback) {
+            if (!_ftp_supported || _autopilot != Autopilot::ArduPilot) {
+                return false;
+            }
+            return _mavlink_ftp_client.download_to_memory_async(
+                remote_path,
+                [callback](MavlinkFtpClient::ClientResult result, std::vector<uint8_t> data) {
+                    callback(result == MavlinkFtpClient::ClientResult::Success, std::move(data));
+                },
+                component_id);
+        };
+    }
+
     _mavlink_parameter_clients.push_back(
         {std::make_unique<MavlinkParameterClient>(
              _mavsdk_impl.default_server_component_impl().sender(),
@@ -1421,7 +1522,8 @@ MavlinkParameterClient* SystemImpl::param_sender(uint8_t component_id, bool exte
              [this]() { return autopilot(); },
              get_system_id(),
              component_id,
-             extended),
+             extended,
+             std::move(file_downloader)),
          component_id,
          extended});
 
@@ -1433,7 +1535,7 @@ std::vector<Connection*> SystemImpl::get_connections() const
     return _mavsdk_impl.get_connections();
 }
 
-mav::MessageSet& SystemImpl::get_message_set() const
+std::shared_ptr<mav::MessageSet> SystemImpl::get_message_set() const
 {
     return _mavsdk_impl.get_message_set();
 }
@@ -13,6 +13,7 @@
 #include "mavlink_message_handler.h"
 #include "mavlink_mission_transfer_client.h"
 #include "mavlink_request_message.h"
+#include "mavlink_statistics.h"
 #include "mavlink_statustext_handler.h"
 #include "ardupilot_custom_mode.h"
 #include "ping.h"
@@ -20,6 +21,7 @@
 #include "timesync.h"
 #include "system.h"
 #include "vehicle.h"
+#include "libmav_message_router.h"
 #include "libmav_receiver.h"
 #include <cstdint>
 #include <functional>
@@ -58,6 +60,21 @@ public:
 
     void process_mavlink_message(mavlink_message_t& message);
 
+    std::vector<MessageIdStatistics> message_statistics() const;
+    void update_statistics_rates(double elapsed_s);
+
+    std::vector<LinkQuality> link_quality() const;
+    System::LinkQualityHandle subscribe_link_quality(const System::LinkQualityCallback& callback);
+    void unsubscribe_link_quality(System::LinkQualityHandle handle);
+
+    void set_link_policy(const LinkPolicy& link_policy);
+    LinkPolicy link_policy() const;
+
+    // To be called from message handlers when the message is a reply which allowed
+    // to measure the round trip time.
+    void report_round_trip_time(
+        const mavlink_message_t& message, std::chrono::steady_clock::duration rtt);
+
     void register_mavlink_message_handler(
         uint16_t msg_id, const MavlinkMessageHandler::Callback& callback, const void* cookie);
     void register_mavlink_message_handler_with_compid(
@@ -73,22 +90,27 @@ public:
     update_component_id_messages_handler(uint16_t msg_id, uint8_t component_id, const void* cookie);
 
     // Libmav message handling
-    using LibmavMessageCallback = std::function<void(const Mavsdk::MavlinkMessage&)>;
+    // The message is shared between all handlers and must not be modified.
+    using LibmavMessageCallback = LibmavMessageRouter::Callback;
 
-    void process_libmav_message(const Mavsdk::MavlinkMessage& message);
+    void process_libmav_message(const LibmavMessage& message);
 
     Handle<Mavsdk::MavlinkMessage> register_libmav_message_handler(
         const std::string& message_name, const LibmavMessageCallback& callback);
     Handle<Mavsdk::MavlinkMessage> register_libmav_message_handler_with_compid(
         const std::string& message_name, uint8_t cmp_id, const LibmavMessageCallback& callback);
 
+    // For handlers only using the binary payload, the fields are not converted to JSON.
+    Handle<Mavsdk::MavlinkMessage> register_libmav_payload_handler(
+        const std::string& message_name, const LibmavMessageCallback& callback);
+
     void unregister_libmav_message_handler(Handle<Mavsdk::MavlinkMessage> handle);
 
     // Get connections for sending messages
     std::vector<Connection*> get_connections() const;
 
     // Get MessageSet for message creation and parsing
-    mav::MessageSet& get_message_set() const;
+    std::shared_ptr<mav::MessageSet> get_message_set() const;
 
     // Thread-safe MessageSet operations
     bool load_custom_xml_to_message_set(const std::string& xml_content);
@@ -332,7 +354,15 @@ private:
     static bool is_camera(uint8_t comp_id);
 
     void process_heartbeat(const mavlink_message_t& message);
+    Handle<Mavsdk::MavlinkMessage> register_libmav_message_handler_impl(
+        const std::string& message_name,
+        std::optional<uint8_t> cmp_id,
+        bool json,
+        const LibmavMessageCallback& callback);
+    void add_libmav_interest(const LibmavMessageRouter::Filter& filter);
+    void remove_libmav_interest(const LibmavMessageRouter::Filter& filter);
     void process_autopilot_version(const mavlink_message_t& message);
+    bool mission_file_transfer_supported() const;
     void process_statustext(const mavlink_message_t& message);
     void heartbeats_timed_out();
     void set_connected();
@@ -377,9 +407,11 @@ private:
     AutopilotTime _autopilot_time{};
 
     MavlinkMessageHandler _mavlink_message_handler{};
+    MessageIdCounters _received_counters{};
+    CallbackList<std::vector<LinkQuality>> _link_quality_callbacks{};
 
-    // Libmav message handling using CallbackList for thread safety
-    CallbackList<Mavsdk::MavlinkMessage> _libmav_message_callbacks{};
+    // Libmav message handlers by message ID
+    LibmavMessageRouter _libmav_message_router{};
 
     bool _message_debugging = false;
 
@@ -408,6 +440,7 @@ private:
     TimeoutHandler::Cookie _heartbeat_timeout_cookie{};
 
     std::atomic<bool> _autopilot_version_pending{false};
+    std::atomic<bool> _ftp_supported{false};
 
     static constexpr double _ping_interval_s = 5.0;
 
@@ -155,6 +155,36 @@ std::pair<bool, std::string> TcpClientConnection::send_message(const mavlink_mes
     return send_raw_bytes(reinterpret_cast<const char*>(buffer), buffer_len);
 }
 
+std::pair<bool, std::string>
+TcpClientConnection::send_frames(const std::vector<MavlinkFramePtr>& frames)
+{
+    // It's a byte stream, so several frames can go out with one write.
+#ifdef WINDOWS
+    return send_frames_concatenated(frames);
+#else
+    SocketHolder::DescriptorType socket_fd;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_socket_fd.empty()) {
+            _outbound_stream.clear();
+            return {false, "Not connected"};
+        }
+        socket_fd = _socket_fd.get();
+    }
+
+#if !defined(MSG_NOSIGNAL)
+    auto flags = 0;
+#else
+    auto flags = MSG_NOSIGNAL;
+#endif
+
+    return send_frames_buffered(
+        frames, [socket_fd, flags](const OutboundStream::Chunk* chunks, size_t count) {
+            return send_chunks(socket_fd, chunks, count, flags);
+        });
+#endif
+}
+
 std::pair<bool, std::string> TcpClientConnection::send_raw_bytes(const char* bytes, size_t length)
 {
     std::pair<bool, std::string> result;
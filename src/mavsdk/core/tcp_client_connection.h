@@ -39,6 +39,9 @@ public:
     TcpClientConnection(const TcpClientConnection&) = delete;
     const TcpClientConnection& operator=(const TcpClientConnection&) = delete;
 
+protected:
+    std::pair<bool, std::string> send_frames(const std::vector<MavlinkFramePtr>& frames) override;
+
 private:
     ConnectionResult setup_port();
     void start_recv_thread();
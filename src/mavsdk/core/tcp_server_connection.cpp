@@ -296,6 +296,38 @@ void TcpServerConnection::receive()
     }
 }
 
+std::pair<bool, std::string>
+TcpServerConnection::send_frames(const std::vector<MavlinkFramePtr>& frames)
+{
+    // It's a byte stream, so several frames can go out with one write.
+#ifdef WINDOWS
+    return send_frames_concatenated(frames);
+#else
+    SocketHolder::DescriptorType client_socket_fd;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_client_socket_fd.empty()) {
+            _outbound_stream.clear();
+            return {false, "Not connected"};
+        }
+        client_socket_fd = _client_socket_fd.get();
+    }
+
+#if !defined(MSG_NOSIGNAL)
+    auto flags = 0;
+#else
+    auto flags = MSG_NOSIGNAL;
+#endif
+
+    // Accepted sockets can inherit O_NONBLOCK from the server socket on some platforms,
+    // in which case writes can be partial.
+    return send_frames_buffered(
+        frames, [client_socket_fd, flags](const OutboundStream::Chunk* chunks, size_t count) {
+            return send_chunks(client_socket_fd, chunks, count, flags);
+        });
+#endif
+}
+
 std::pair<bool, std::string> TcpServerConnection::send_raw_bytes(const char* bytes, size_t length)
 {
     // Basic implementation for TCP server connections
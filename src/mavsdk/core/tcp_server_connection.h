@@ -26,6 +26,9 @@ public:
     std::pair<bool, std::string> send_message(const mavlink_message_t& message) override;
     std::pair<bool, std::string> send_raw_bytes(const char* bytes, size_t length) override;
 
+protected:
+    std::pair<bool, std::string> send_frames(const std::vector<MavlinkFramePtr>& frames) override;
+
 private:
     void accept_client();
     void receive();
@@ -35,6 +35,8 @@ void Timesync::do_work()
                                   _system_impl.get_autopilot_time().now().time_since_epoch())
                                   .count();
             send_timesync(0, now_ns);
+            _last_request_ts1 = now_ns;
+            _last_request_time = _system_impl.get_time().steady_time();
         } else {
             _autopilot_timesync_acquired = false;
         }
@@ -56,6 +58,11 @@ void Timesync::process_timesync(const mavlink_message_t& message)
         // Send synced time to remote system
         send_timesync(now_ns, timesync.ts1);
     } else if (timesync.tc1 > 0) {
+        if (static_cast<uint64_t>(timesync.ts1) == _last_request_ts1) {
+            _system_impl.report_round_trip_time(
+                message, _system_impl.get_time().steady_time() - _last_request_time);
+        }
+
         // Time offset between this system and the remote system is calculated assuming RTT for
         // the timesync packet is roughly equal both ways.
         set_timesync_offset((timesync.tc1 * 2 - (timesync.ts1 + now_ns)) / 2, timesync.ts1);
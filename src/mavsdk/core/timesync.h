@@ -28,6 +28,11 @@ private:
     static constexpr double TIMESYNC_SEND_INTERVAL_S = 5.0;
     SteadyTimePoint _last_time{};
 
+    // Our last request, to measure the round trip time independent of timesync
+    // offset changes.
+    uint64_t _last_request_ts1{0};
+    SteadyTimePoint _last_request_time{};
+
     static constexpr uint64_t MAX_CONS_HIGH_RTT = 5;
     static constexpr uint64_t MAX_RTT_SAMPLE_MS = 10;
     uint64_t _high_rtt_count{};
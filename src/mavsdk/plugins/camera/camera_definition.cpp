@@ -1,74 +1,146 @@
 #include "log.h"
 #include "camera_definition.h"
+#include "file_cache.h"
+
+#include <picosha2.h>
+#include <mutex>
 
 namespace mavsdk {
 
 bool CameraDefinition::load_file(const std::string& filepath)
 {
-    tinyxml2::XMLError xml_error = _doc.LoadFile(filepath.c_str());
+    tinyxml2::XMLDocument doc;
+    tinyxml2::XMLError xml_error = doc.LoadFile(filepath.c_str());
     if (xml_error != tinyxml2::XML_SUCCESS) {
-        LogErr() << "tinyxml2::LoadFile failed: " << _doc.ErrorStr();
+        LogErr() << "tinyxml2::LoadFile failed: " << doc.ErrorStr();
         return false;
     }
 
-    return parse_xml();
+    return set_definition(parse_xml(doc));
 }
 
-bool CameraDefinition::load_string(const std::string& content)
+bool CameraDefinition::load_string(std::string_view content)
 {
-    tinyxml2::XMLError xml_error = _doc.Parse(content.c_str());
+    tinyxml2::XMLDocument doc;
+    tinyxml2::XMLError xml_error = doc.Parse(content.data(), content.size());
     if (xml_error != tinyxml2::XML_SUCCESS) {
-        LogErr() << "tinyxml2::Parse failed: " << _doc.ErrorStr();
+        LogErr() << "tinyxml2::Parse failed: " << doc.ErrorStr();
+        return false;
+    }
+
+    return set_definition(parse_xml(doc));
+}
+
+bool CameraDefinition::load_file_shared(const std::string& filepath)
+{
+    // Definitions are small and there are only a few kinds of cameras, so we keep them.
+    // They are keyed by content, as the same name, e.g. model and version, doesn't
+    // guarantee the same file if it wasn't taken from the FileCache.
+    static std::mutex cache_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const Definition>> cache;
+
+    // Parse straight from the mapped file, e.g. from the FileCache.
+    const auto mapped_file = FileCache::MappedFile::open(filepath);
+    if (!mapped_file) {
+        return false;
+    }
+
+    const auto content = mapped_file->data();
+    std::vector<unsigned char> hash(picosha2::k_digest_size);
+    picosha2::hash256(content.begin(), content.end(), hash);
+    const auto content_hash = picosha2::bytes_to_hex_string(hash);
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    auto it = cache.find(content_hash);
+    if (it != cache.end()) {
+        return set_definition(it->second);
+    }
+
+    if (!load_string(content)) {
+        return false;
+    }
+
+    cache[content_hash] = _definition;
+    return true;
+}
+
+bool CameraDefinition::set_definition(std::shared_ptr<const Definition> definition)
+{
+    if (definition == nullptr) {
         return false;
     }
 
-    return parse_xml();
+    _definition = std::move(definition);
+
+    InternalCurrentSetting empty_setting{};
+    empty_setting.needs_updating = true;
+    _current_settings.assign(_definition->parameters.size(), empty_setting);
+
+    return true;
 }
 
 std::string CameraDefinition::get_model() const
 {
-    return _model;
+    return _definition ? _definition->model : std::string{};
 }
 
 std::string CameraDefinition::get_vendor() const
 {
-    return _vendor;
+    return _definition ? _definition->vendor : std::string{};
 }
 
-bool CameraDefinition::parse_xml()
+std::optional<CameraDefinition::ParameterId>
+CameraDefinition::id_for(const std::string& name) const
 {
-    auto e_mavlinkcamera = _doc.FirstChildElement("mavlinkcamera");
+    if (_definition == nullptr) {
+        return std::nullopt;
+    }
+
+    auto it = _definition->ids.find(name);
+    if (it == _definition->ids.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::shared_ptr<const CameraDefinition::Definition>
+CameraDefinition::parse_xml(tinyxml2::XMLDocument& doc)
+{
+    auto definition = std::make_shared<Definition>();
+
+    auto e_mavlinkcamera = doc.FirstChildElement("mavlinkcamera");
     if (!e_mavlinkcamera) {
         LogErr() << "Tag mavlinkcamera not found";
-        return false;
+        return nullptr;
     }
 
     auto e_definition = e_mavlinkcamera->FirstChildElement("definition");
     if (!e_definition) {
         LogErr() << "definition not found";
-        return false;
+        return nullptr;
     }
 
     auto e_model = e_definition->FirstChildElement("model");
     if (!e_model) {
         LogErr() << "model not found";
-        return false;
+        return nullptr;
     }
 
-    _model = e_model->GetText();
+    definition->model = e_model->GetText();
 
     auto e_vendor = e_definition->FirstChildElement("vendor");
     if (!e_vendor) {
         LogErr() << "vendor not found";
-        return false;
+        return nullptr;
     }
 
-    _vendor = e_vendor->GetText();
+    definition->vendor = e_vendor->GetText();
 
     auto e_parameters = e_mavlinkcamera->FirstChildElement("parameters");
     if (!e_parameters) {
         LogErr() << "Tag parameters not found";
-        return false;
+        return nullptr;
     }
 
     std::unordered_map<std::string, std::string> type_map{};
@@ -78,32 +150,37 @@ bool CameraDefinition::parse_xml()
         const char* param_name = e_parameter->Attribute("name");
         if (!param_name) {
             LogErr() << "name attribute missing";
-            return false;
+            return nullptr;
         }
 
         const char* type_str = e_parameter->Attribute("type");
         if (!type_str) {
             LogErr() << "type attribute missing";
-            return false;
+            return nullptr;
         }
 
         type_map[param_name] = type_str;
     }
 
+    std::vector<UnresolvedNames> names{};
+
     for (auto e_parameter = e_parameters->FirstChildElement("parameter"); e_parameter != nullptr;
          e_parameter = e_parameter->NextSiblingElement("parameter")) {
-        auto new_parameter = std::make_shared<Parameter>();
+        Parameter new_parameter{};
+        UnresolvedNames new_names{};
 
         const char* param_name = e_parameter->Attribute("name");
         if (!param_name) {
             LogErr() << "name attribute missing";
-            return false;
+            return nullptr;
         }
 
+        new_parameter.name = param_name;
+
         const char* type_str_res = e_parameter->Attribute("type");
         if (!type_str_res) {
             LogErr() << "type attribute missing for " << param_name;
-            return false;
+            return nullptr;
         }
 
         auto type_str = std::string(type_str_res);
@@ -117,59 +194,59 @@ bool CameraDefinition::parse_xml()
             continue;
         }
 
-        if (!new_parameter->type.set_empty_type_from_xml(type_str)) {
+        if (!new_parameter.type.set_empty_type_from_xml(type_str)) {
             LogErr() << "Unknown type attribute: " << type_str;
-            return false;
+            return nullptr;
         }
 
         // By default control is on.
-        new_parameter->is_control = true;
+        new_parameter.is_control = true;
         const char* control_str = e_parameter->Attribute("control");
         if (control_str) {
             if (std::string(control_str) == "0") {
-                new_parameter->is_control = false;
+                new_parameter.is_control = false;
             }
         }
 
-        new_parameter->is_readonly = false;
+        new_parameter.is_readonly = false;
         const char* readonly_str = e_parameter->Attribute("readonly");
         if (readonly_str) {
             if (std::string(readonly_str) == "1") {
-                new_parameter->is_readonly = true;
+                new_parameter.is_readonly = true;
             }
         }
 
-        new_parameter->is_writeonly = false;
+        new_parameter.is_writeonly = false;
         const char* writeonly_str = e_parameter->Attribute("writeonly");
         if (writeonly_str) {
             if (std::string(writeonly_str) == "1") {
-                new_parameter->is_writeonly = true;
+                new_parameter.is_writeonly = true;
             }
         }
 
-        if (new_parameter->is_readonly && new_parameter->is_writeonly) {
+        if (new_parameter.is_readonly && new_parameter.is_writeonly) {
             LogErr() << "parameter can't be readonly and writeonly";
-            return false;
+            return nullptr;
         }
 
         // Be definition custom types do not have control.
         if (std::string(type_map[param_name]) == "custom") {
-            new_parameter->is_control = false;
+            new_parameter.is_control = false;
         }
 
         auto e_description = e_parameter->FirstChildElement("description");
         if (!e_description) {
             LogErr() << "Description missing";
-            return false;
+            return nullptr;
         }
 
-        new_parameter->description = e_description->GetText();
+        new_parameter.description = e_description->GetText();
 
-        // LogDebug() << "Found: " << new_parameter->description
+        // LogDebug() << "Found: " << new_parameter.description
         //            << " (" << param_name
-        //            << ", control: " << (new_parameter->is_control ? "yes" : "no")
-        //            << ", readonly: " << (new_parameter->is_readonly ? "yes" : "no")
-        //            << ", writeonly: " << (new_parameter->is_writeonly ? "yes" : "no")
+        //            << ", control: " << (new_parameter.is_control ? "yes" : "no")
+        //            << ", readonly: " << (new_parameter.is_readonly ? "yes" : "no")
+        //            << ", writeonly: " << (new_parameter.is_writeonly ? "yes" : "no")
         //            << ")";
 
         auto e_updates = e_parameter->FirstChildElement("updates");
@@ -177,7 +254,7 @@ bool CameraDefinition::parse_xml()
             for (auto e_update = e_updates->FirstChildElement("update"); e_update != nullptr;
                  e_update = e_update->NextSiblingElement("update")) {
                 // LogDebug() << "Updates: " << e_update->GetText();
-                new_parameter->updates.emplace_back(e_update->GetText());
+                new_names.updates.emplace_back(e_update->GetText());
             }
         }
 
@@ -188,7 +265,7 @@ bool CameraDefinition::parse_xml()
         }
 
         auto get_default_opt = [&]() {
-            auto maybe_default = find_default(new_parameter->options, default_str);
+            auto maybe_default = find_default(new_parameter.options, default_str);
 
             if (!maybe_default.first) {
                 LogWarn() << "Default not found for " << param_name;
@@ -200,16 +277,16 @@ bool CameraDefinition::parse_xml()
 
         auto e_options = e_parameter->FirstChildElement("options");
         if (e_options) {
-            auto maybe_options = parse_options(e_options, param_name, type_map);
+            auto maybe_options = parse_options(e_options, param_name, type_map, new_names);
             if (!maybe_options.first) {
                 continue;
             }
-            new_parameter->options = maybe_options.second;
+            new_parameter.options = maybe_options.second;
 
             if (auto default_option = get_default_opt()) {
-                new_parameter->default_option = *default_option;
+                new_parameter.default_option = *default_option;
             } else {
-                return false;
+                return nullptr;
             }
         } else if (type_str == "bool") {
             // Automaticaly create bool options if the parameter type is bool as per documentation.
@@ -220,14 +297,12 @@ bool CameraDefinition::parse_xml()
             true_option.name = "off";
             false_option.value.set<uint8_t>(false);
 
-            new_parameter->options = {
-                std::make_shared<Option>(std::move(true_option)),
-                std::make_shared<Option>(std::move(false_option))};
+            new_parameter.options = {std::move(true_option), std::move(false_option)};
 
             if (auto default_option = get_default_opt()) {
-                new_parameter->default_option = *default_option;
+                new_parameter.default_option = *default_option;
             } else {
-                return false;
+                return nullptr;
             }
         } else {
             auto maybe_range_options = parse_range_options(e_parameter, param_name, type_map);
@@ -236,28 +311,80 @@ bool CameraDefinition::parse_xml()
                 continue;
             }
 
-            new_parameter->options = std::get<1>(maybe_range_options);
-            new_parameter->is_range = true;
-            new_parameter->default_option = std::get<2>(maybe_range_options);
+            new_parameter.options = std::get<1>(maybe_range_options);
+            new_parameter.is_range = true;
+            new_parameter.default_option = std::get<2>(maybe_range_options);
         }
 
-        _parameter_map[param_name] = new_parameter;
-
-        InternalCurrentSetting empty_setting{};
-        empty_setting.needs_updating = true;
-        _current_settings[param_name] = empty_setting;
+        const auto id = definition->parameters.size();
+        const auto inserted = definition->ids.emplace(param_name, id);
+        if (!inserted.second) {
+            // A parameter defined twice is replaced by the later one.
+            definition->parameters[inserted.first->second] = std::move(new_parameter);
+            names[inserted.first->second] = std::move(new_names);
+            continue;
+        }
+        definition->parameters.push_back(std::move(new_parameter));
+        names.push_back(std::move(new_names));
     }
 
-    return true;
+    resolve_names(*definition, names);
+
+    return definition;
+}
+
+void CameraDefinition::resolve_names(Definition& definition, std::vector<UnresolvedNames>& names)
+{
+    for (size_t id = 0; id < definition.parameters.size(); ++id) {
+        auto& parameter = definition.parameters[id];
+        auto& parameter_names = names[id];
+
+        for (const auto& update : parameter_names.updates) {
+            auto it = definition.ids.find(update);
+            if (it == definition.ids.end()) {
+                LogDebug() << "Update to '" << update << "' not understood.";
+                continue;
+            }
+            parameter.updates.push_back(it->second);
+        }
+
+        for (size_t i = 0; i < parameter.options.size(); ++i) {
+            auto& option = parameter.options[i];
+
+            if (i < parameter_names.exclusions.size()) {
+                for (const auto& exclusion : parameter_names.exclusions[i]) {
+                    // Exclusions of unknown parameters don't change anything.
+                    auto it = definition.ids.find(exclusion);
+                    if (it != definition.ids.end()) {
+                        option.exclusions.push_back(it->second);
+                    }
+                }
+            }
+
+            if (i < parameter_names.parameter_ranges.size()) {
+                for (const auto& range : parameter_names.parameter_ranges[i]) {
+                    auto it = definition.ids.find(range.first);
+                    if (it == definition.ids.end()) {
+                        continue;
+                    }
+                    std::vector<ParamValue> values;
+                    for (const auto& roption : range.second) {
+                        values.push_back(roption.second);
+                    }
+                    option.parameter_ranges.emplace_back(it->second, std::move(values));
+                }
+            }
+        }
+    }
 }
 
-std::pair<bool, std::vector<std::shared_ptr<CameraDefinition::Option>>>
-CameraDefinition::parse_options(
+std::pair<bool, std::vector<CameraDefinition::Option>> CameraDefinition::parse_options(
     const tinyxml2::XMLElement* options_handle,
     const std::string& param_name,
-    std::unordered_map<std::string, std::string>& type_map)
+    std::unordered_map<std::string, std::string>& type_map,
+    UnresolvedNames& names)
 {
-    std::vector<std::shared_ptr<Option>> options{};
+    std::vector<Option> options{};
 
     for (auto e_option = options_handle->FirstChildElement("option"); e_option != nullptr;
          e_option = e_option->NextSiblingElement("option")) {
@@ -273,11 +400,13 @@ CameraDefinition::parse_options(
             return std::make_pair<>(false, options);
         }
 
-        auto new_option = std::make_shared<Option>();
+        Option new_option{};
+        std::vector<std::string> new_exclusions{};
+        std::unordered_map<std::string, ParameterRange> new_parameter_ranges{};
 
-        new_option->name = option_name;
+        new_option.name = option_name;
 
-        new_option->value.set_from_xml(type_map[param_name], option_value);
+        new_option.value.set_from_xml(type_map[param_name], option_value);
 
         // LogDebug() << "Type: " << type_map[param_name] << ", name: " << option_name;
 
@@ -286,7 +415,7 @@ CameraDefinition::parse_options(
             for (auto e_exclude = e_exclusions->FirstChildElement("exclude"); e_exclude != nullptr;
                  e_exclude = e_exclude->NextSiblingElement("exclude")) {
                 // LogDebug() << "Exclude: " << e_exclude->GetText();
-                new_option->exclusions.emplace_back(e_exclude->GetText());
+                new_exclusions.emplace_back(e_exclude->GetText());
             }
         }
 
@@ -335,24 +464,26 @@ CameraDefinition::parse_options(
                     //            << " (" << new_param_value.typestr() << ")";
                 }
 
-                new_option->parameter_ranges[roption_parameter_str] = new_parameter_range;
+                new_parameter_ranges[roption_parameter_str] = new_parameter_range;
 
                 // LogDebug() << "adding to: " << roption_parameter_str;
             }
         }
 
-        options.push_back(new_option);
+        options.push_back(std::move(new_option));
+        names.exclusions.push_back(std::move(new_exclusions));
+        names.parameter_ranges.push_back(std::move(new_parameter_ranges));
     }
     return std::make_pair<>(true, options);
 }
 
-std::tuple<bool, std::vector<std::shared_ptr<CameraDefinition::Option>>, CameraDefinition::Option>
+std::tuple<bool, std::vector<CameraDefinition::Option>, CameraDefinition::Option>
 CameraDefinition::parse_range_options(
     const tinyxml2::XMLElement* param_handle,
     const std::string& param_name,
     std::unordered_map<std::string, std::string>& type_map)
 {
-    std::vector<std::shared_ptr<Option>> options{};
+    std::vector<Option> options{};
     Option default_option{};
 
     const char* min_str = param_handle->Attribute("min");
@@ -370,16 +501,16 @@ CameraDefinition::parse_range_options(
         return std::make_tuple<>(false, options, default_option);
     }
 
-    auto min_option = std::make_shared<Option>();
-    min_option->name = "min";
-    min_option->value = min_value;
+    Option min_option{};
+    min_option.name = "min";
+    min_option.value = min_value;
 
     ParamValue max_value;
     max_value.set_from_xml(type_map[param_name], max_str);
 
-    auto max_option = std::make_shared<Option>();
-    max_option->name = "max";
-    max_option->value = max_value;
+    Option max_option{};
+    max_option.name = "max";
+    max_option.value = max_value;
 
     const char* step_str = param_handle->Attribute("step");
     if (!step_str) {
@@ -390,9 +521,9 @@ CameraDefinition::parse_range_options(
         ParamValue step_value;
         step_value.set_from_xml(type_map[param_name], step_str);
 
-        auto step_option = std::make_shared<Option>();
-        step_option->name = "step";
-        step_option->value = step_value;
+        Option step_option{};
+        step_option.name = "step";
+        step_option.value = step_value;
 
         options.push_back(min_option);
         options.push_back(max_option);
@@ -417,16 +548,16 @@ CameraDefinition::parse_range_options(
     return std::make_tuple<>(true, options, default_option);
 }
 
-std::pair<bool, CameraDefinition::Option> CameraDefinition::find_default(
-    const std::vector<std::shared_ptr<Option>>& options, const std::string& default_str)
+std::pair<bool, CameraDefinition::Option>
+CameraDefinition::find_default(const std::vector<Option>& options, const std::string& default_str)
 {
     Option default_option{};
 
     bool found_default = false;
     for (auto& option : options) {
-        if (option->value == default_str) {
+        if (option.value == default_str) {
             if (!found_default) {
-                default_option = *option;
+                default_option = option;
                 found_default = true;
             } else {
                 LogErr() << "Found more than one default";
@@ -449,60 +580,67 @@ void CameraDefinition::assume_default_settings()
 void CameraDefinition::reset_to_default_settings(bool needs_updating)
 {
     _current_settings.clear();
+    if (needs_updating) {
+        ++_unknown_params_generation;
+    }
 
-    for (const auto& parameter : _parameter_map) {
+    if (_definition == nullptr) {
+        return;
+    }
+
+    for (const auto& parameter : _definition->parameters) {
         InternalCurrentSetting new_setting;
-        new_setting.value = parameter.second->default_option.value;
+        new_setting.value = parameter.default_option.value;
         new_setting.needs_updating = needs_updating;
-        _current_settings[parameter.first] = new_setting;
+        _current_settings.push_back(new_setting);
     }
 }
 
 bool CameraDefinition::get_all_settings(std::unordered_map<std::string, ParamValue>& settings)
 {
     settings.clear();
-    for (const auto& current_setting : _current_settings) {
-        settings[current_setting.first] = current_setting.second.value;
+    for (ParameterId id = 0; id < _current_settings.size(); ++id) {
+        settings[_definition->parameters[id].name] = _current_settings[id].value;
     }
 
     return !settings.empty();
 }
 
-bool CameraDefinition::get_possible_settings(std::unordered_map<std::string, ParamValue>& settings)
+std::vector<bool> CameraDefinition::excluded_with_current_settings(bool only_known) const
 {
-    settings.clear();
+    std::vector<bool> excluded(_current_settings.size(), false);
 
-    // Find all exclusions
-    // TODO: use set instead of vector
-    std::vector<std::string> exclusions{};
-
-    for (const auto& parameter : _parameter_map) {
-        for (const auto& option : parameter.second->options) {
-            if (_current_settings[parameter.first].value == option->value) {
-                for (const auto& exclusion : option->exclusions) {
-                    // LogDebug() << "found exclusion for " << parameter.first
-                    //            << "(" << option->value << "): " << exclusion;
-                    exclusions.push_back(exclusion);
+    for (ParameterId id = 0; id < _current_settings.size(); ++id) {
+        if (only_known && _current_settings[id].needs_updating) {
+            continue;
+        }
+        for (const auto& option : _definition->parameters[id].options) {
+            if (_current_settings[id].value == option.value) {
+                for (const auto exclusion : option.exclusions) {
+                    excluded[exclusion] = true;
                 }
             }
         }
     }
 
-    for (const auto& setting : _current_settings) {
-        bool excluded = false;
-        for (const auto& exclusion : exclusions) {
-            if (setting.first == exclusion) {
-                excluded = true;
-            }
-        }
-        if (!_parameter_map[setting.first]->is_control) {
+    return excluded;
+}
+
+bool CameraDefinition::get_possible_settings(std::unordered_map<std::string, ParamValue>& settings)
+{
+    settings.clear();
+
+    const auto excluded = excluded_with_current_settings(false);
+
+    for (ParameterId id = 0; id < _current_settings.size(); ++id) {
+        if (!_definition->parameters[id].is_control) {
             continue;
         }
 
-        if (excluded) {
+        if (excluded[id]) {
             continue;
         }
-        settings[setting.first] = setting.second.value;
+        settings[_definition->parameters[id].name] = _current_settings[id].value;
     }
 
     return !settings.empty();
@@ -510,20 +648,45 @@ bool CameraDefinition::get_possible_settings(std::unordered_map<std::string, Par
 
 bool CameraDefinition::set_setting(const std::string& name, const ParamValue& value)
 {
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    const auto maybe_id = id_for(name);
+    if (!maybe_id) {
         LogErr() << "Unknown setting to set: " << name;
         return false;
     }
 
+    const auto& parameter = _definition->parameters[maybe_id.value()];
+
+    if (!is_in_range(parameter, value)) {
+        return false;
+    }
+
+    _current_settings[maybe_id.value()].value = value;
+    _current_settings[maybe_id.value()].needs_updating = false;
+
+    // Some param changes cause other params to change, so they need to be updated.
+    // The camera definition just keeps track of these params but the actual param fetching
+    // needs to happen outside of this class.
+    for (const auto update : parameter.updates) {
+        _current_settings[update].needs_updating = true;
+    }
+    if (!parameter.updates.empty()) {
+        ++_unknown_params_generation;
+    }
+
+    return true;
+}
+
+bool CameraDefinition::is_in_range(const Parameter& parameter, const ParamValue& value) const
+{
     // For range params, we need to verify the range.
-    if (_parameter_map[name]->is_range) {
+    if (parameter.is_range) {
         // Check against the minimum
-        if (value < _parameter_map[name]->options[0]->value) {
+        if (value < parameter.options[0].value) {
             LogErr() << "Chosen value smaller than minimum";
             return false;
         }
 
-        if (value > _parameter_map[name]->options[1]->value) {
+        if (value > parameter.options[1].value) {
             LogErr() << "Chosen value bigger than maximum";
             return false;
         }
@@ -531,32 +694,20 @@ bool CameraDefinition::set_setting(const std::string& name, const ParamValue& va
         // TODO: Check step as well, until now we have only seen steps of 1 in the wild though.
     }
 
-    _current_settings[name].value = value;
-    _current_settings[name].needs_updating = false;
-
-    // Some param changes cause other params to change, so they need to be updated.
-    // The camera definition just keeps track of these params but the actual param fetching
-    // needs to happen outside of this class.
-    for (const auto& update : _parameter_map[name]->updates) {
-        if (_current_settings.find(update) == _current_settings.end()) {
-            LogDebug() << "Update to '" << update << "' not understood.";
-            continue;
-        }
-        _current_settings[update].needs_updating = true;
-    }
-
     return true;
 }
 
 bool CameraDefinition::get_setting(const std::string& name, ParamValue& value)
 {
-    if (_current_settings.find(name) == _current_settings.end()) {
+    const auto maybe_id = id_for(name);
+    if (!maybe_id) {
         LogErr() << "Unknown setting to get: " << name;
         return false;
     }
 
-    if (!_current_settings.at(name).needs_updating) {
-        value = _current_settings.at(name).value;
+    const auto& current_setting = _current_settings[maybe_id.value()];
+    if (!current_setting.needs_updating) {
+        value = current_setting.value;
         return true;
     } else {
         return false;
@@ -566,14 +717,15 @@ bool CameraDefinition::get_setting(const std::string& name, ParamValue& value)
 bool CameraDefinition::get_option_value(
     const std::string& param_name, const std::string& option_value, ParamValue& value)
 {
-    if (_parameter_map.find(param_name) == _parameter_map.end()) {
+    const auto maybe_id = id_for(param_name);
+    if (!maybe_id) {
         LogErr() << "Unknown parameter to get option: " << param_name;
         return false;
     }
 
-    for (const auto& option : _parameter_map[param_name]->options) {
-        if (option->value == option_value) {
-            value = option->value;
+    for (const auto& option : _definition->parameters[maybe_id.value()].options) {
+        if (option.value == option_value) {
+            value = option.value;
             return true;
         }
     }
@@ -585,13 +737,14 @@ bool CameraDefinition::get_all_options(const std::string& name, std::vector<Para
 {
     values.clear();
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    const auto maybe_id = id_for(name);
+    if (!maybe_id) {
         LogErr() << "Unknown parameter to get all options";
         return false;
     }
 
-    for (const auto& option : _parameter_map[name]->options) {
-        values.push_back(option->value);
+    for (const auto& option : _definition->parameters[maybe_id.value()].options) {
+        values.push_back(option.value);
     }
 
     return true;
@@ -602,88 +755,62 @@ bool CameraDefinition::get_possible_options(
 {
     values.clear();
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    const auto maybe_id = id_for(name);
+    if (!maybe_id) {
         LogErr() << "Unknown parameter to get possible options";
         return false;
     }
+    const auto setting_id = maybe_id.value();
 
-    std::unordered_map<std::string, ParamValue> settings;
-    if (!get_possible_settings(settings)) {
-        return false;
-    }
-    if (settings.find(name) == settings.end()) {
+    // Excluded parameters need to be neglected for the range check below.
+    const auto excluded = excluded_with_current_settings(true);
+
+    if (!_definition->parameters[setting_id].is_control ||
+        excluded_with_current_settings(false)[setting_id]) {
         LogErr() << "Setting " << name << " currently not applicable";
         return false;
     }
 
-    // Find all exclusions because excluded parameters need to be neglected for range
-    // check below.
-    // TODO: use set instead of vector
-    std::vector<std::string> exclusions{};
-
-    for (const auto& parameter : _parameter_map) {
-        for (const auto& option : parameter.second->options) {
-            if (_current_settings[parameter.first].needs_updating) {
-                // LogWarn() << parameter.first << " needs updating";
-                continue;
-            }
-            if (_current_settings[parameter.first].value == option->value) {
-                for (const auto& exclusion : option->exclusions) {
-                    // LogDebug() << "found exclusion for " << parameter.first
-                    //            << "(" << option->value << "): " << exclusion;
-                    exclusions.push_back(exclusion);
-                }
-            }
-        }
-    }
-
     // TODO: use set instead of vector for this
     std::vector<ParamValue> allowed_ranges{};
 
     // Check allowed ranges.
-    for (const auto& parameter : _parameter_map) {
-        if (!parameter.second->is_control) {
+    for (ParameterId id = 0; id < _current_settings.size(); ++id) {
+        const auto& parameter = _definition->parameters[id];
+        if (!parameter.is_control || excluded[id]) {
             continue;
         }
 
-        bool excluded = false;
-        for (const auto& exclusion : exclusions) {
-            if (parameter.first == exclusion) {
-                excluded = true;
-            }
-        }
-        if (excluded) {
+        if (_current_settings[id].needs_updating) {
             continue;
         }
 
-        for (const auto& option : parameter.second->options) {
-            if (_current_settings[parameter.first].needs_updating) {
-                // LogWarn() << parameter.first << " needs updating";
+        for (const auto& option : parameter.options) {
+            // Only look at current set option.
+            if (_current_settings[id].value != option.value) {
                 continue;
             }
-            // Only look at current set option.
-            if (_current_settings[parameter.first].value == option->value) {
-                // Go through parameter ranges but only concerning the parameter that
-                // we're interested in.
-                if (option->parameter_ranges.find(name) != option->parameter_ranges.end()) {
-                    for (const auto& range : option->parameter_ranges[name]) {
-                        allowed_ranges.push_back(range.second);
-                    }
+            // Go through parameter ranges but only concerning the parameter that
+            // we're interested in.
+            for (const auto& range : option.parameter_ranges) {
+                if (range.first == setting_id) {
+                    allowed_ranges.insert(
+                        allowed_ranges.end(), range.second.begin(), range.second.end());
                 }
             }
         }
     }
 
     // Intersect
-    for (const auto& option : _parameter_map[name]->options) {
+    for (const auto& option : _definition->parameters[setting_id].options) {
         bool option_allowed = false;
         for (const auto& allowed_range : allowed_ranges) {
-            if (option->value == allowed_range) {
+            if (option.value == allowed_range) {
                 option_allowed = true;
             }
         }
         if (option_allowed || allowed_ranges.empty()) {
-            values.push_back(option->value);
+            values.push_back(option.value);
         }
     }
 
@@ -694,40 +821,64 @@ void CameraDefinition::get_unknown_params(std::vector<std::pair<std::string, Par
 {
     params.clear();
 
-    for (const auto& parameter : _parameter_map) {
-        if (_current_settings[parameter.first].needs_updating) {
-            params.push_back(std::make_pair<>(parameter.first, parameter.second->type));
+    for (ParameterId id = 0; id < _current_settings.size(); ++id) {
+        if (_current_settings[id].needs_updating) {
+            const auto& parameter = _definition->parameters[id];
+            params.emplace_back(parameter.name, parameter.type);
         }
     }
 }
 
+void CameraDefinition::set_unknown_params(const std::map<std::string, ParamValue>& params)
+{
+    for (ParameterId id = 0; id < _current_settings.size(); ++id) {
+        auto& current_setting = _current_settings[id];
+        if (!current_setting.needs_updating) {
+            continue;
+        }
+
+        const auto& parameter = _definition->parameters[id];
+        const auto it = params.find(parameter.name);
+        if (it == params.end() || !it->second.is_same_type(parameter.type) ||
+            !is_in_range(parameter, it->second)) {
+            continue;
+        }
+
+        current_setting.value = it->second;
+        current_setting.needs_updating = false;
+    }
+}
+
 void CameraDefinition::set_all_params_unknown()
 {
-    for (auto& parameter : _parameter_map) {
-        _current_settings[parameter.first].needs_updating = true;
+    for (auto& current_setting : _current_settings) {
+        current_setting.needs_updating = true;
     }
+    ++_unknown_params_generation;
 }
 
 bool CameraDefinition::is_setting_range(const std::string& name)
 {
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    const auto maybe_id = id_for(name);
+    if (!maybe_id) {
         LogWarn() << "Setting " << name << " not found.";
         return false;
     }
 
-    return _parameter_map[name]->is_range;
+    return _definition->parameters[maybe_id.value()].is_range;
 }
 
 bool CameraDefinition::get_setting_str(const std::string& name, std::string& description)
 {
     description.clear();
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    const auto maybe_id = id_for(name);
+    if (!maybe_id) {
         LogWarn() << "Setting " << name << " not found.";
         return false;
     }
 
-    description = _parameter_map[name]->description;
+    description = _definition->parameters[maybe_id.value()].description;
     return true;
 }
 
@@ -736,14 +887,15 @@ bool CameraDefinition::get_option_str(
 {
     description.clear();
 
-    if (_parameter_map.find(setting_name) == _parameter_map.end()) {
+    const auto maybe_id = id_for(setting_name);
+    if (!maybe_id) {
         LogWarn() << "Setting " << setting_name << " not found.";
         return false;
     }
 
-    for (const auto& option : _parameter_map[setting_name]->options) {
-        if (option->value == option_name) {
-            description = option->name;
+    for (const auto& option : _definition->parameters[maybe_id.value()].options) {
+        if (option.value == option_name) {
+            description = option.name;
             return true;
         }
     }
@@ -3,9 +3,12 @@
 #include "mavlink_parameter_client.h"
 #include <tinyxml2.h>
 #include <vector>
+#include <map>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <utility>
 namespace mavsdk {
@@ -16,7 +19,11 @@ public:
     ~CameraDefinition() = default;
 
     bool load_file(const std::string& filepath);
-    bool load_string(const std::string& content);
+    bool load_string(std::string_view content);
+
+    // The parsed definition is shared with all other definitions loaded from a file with
+    // the same content, so identical cameras only parse the file once.
+    bool load_file_shared(const std::string& filepath);
 
     std::string get_vendor() const;
     std::string get_model() const;
@@ -51,6 +58,15 @@ public:
     void get_unknown_params(std::vector<std::pair<std::string, ParamValue>>& params);
     void set_all_params_unknown();
 
+    // Changes whenever params are marked as unknown, e.g. because a setting changed. A param
+    // list requested before that might have values from before the change.
+    unsigned unknown_params_generation() const { return _unknown_params_generation; }
+
+    // Sets the unknown params found in a list of params received together, e.g. the whole
+    // param list of the camera. As these values are current, they don't cause each other
+    // to be updated. Params not found, or of the wrong type, remain unknown.
+    void set_unknown_params(const std::map<std::string, ParamValue>& params);
+
     // Non-copyable
     CameraDefinition(const CameraDefinition&) = delete;
     const CameraDefinition& operator=(const CameraDefinition&) = delete;
@@ -58,53 +74,81 @@ public:
 private:
     using ParameterRange = std::unordered_map<std::string, ParamValue>;
 
+    // Parameters are referred to by their index in Definition::parameters.
+    using ParameterId = size_t;
+
     struct Option {
         std::string name{};
         ParamValue value{};
-        std::vector<std::string> exclusions{};
-        std::unordered_map<std::string, ParameterRange> parameter_ranges{};
+        std::vector<ParameterId> exclusions{};
+        // The values allowed for other parameters while this option is set.
+        std::vector<std::pair<ParameterId, std::vector<ParamValue>>> parameter_ranges{};
     };
 
     struct Parameter {
+        std::string name{};
         std::string description{};
         bool is_control{false};
         bool is_readonly{false};
         bool is_writeonly{false};
         ParamValue type{}; // for type only, doesn't hold a value
-        std::vector<std::string> updates{};
-        std::vector<std::shared_ptr<Option>> options{};
+        std::vector<ParameterId> updates{};
+        std::vector<Option> options{};
         Option default_option{};
         bool is_range{false};
     };
 
-    bool parse_xml();
+    // The parsed definition file, which doesn't change once loaded.
+    struct Definition {
+        std::string model{};
+        std::string vendor{};
+        std::vector<Parameter> parameters{};
+        std::unordered_map<std::string, ParameterId> ids{};
+    };
+
+    // Parameter names referenced by options and updates, which are only resolved to ids
+    // once all parameters are parsed.
+    struct UnresolvedNames {
+        std::vector<std::string> updates{};
+        // Per option: the excluded parameters, and the parameter ranges.
+        std::vector<std::vector<std::string>> exclusions{};
+        std::vector<std::unordered_map<std::string, ParameterRange>> parameter_ranges{};
+    };
+
+    static std::shared_ptr<const Definition> parse_xml(tinyxml2::XMLDocument& doc);
+    static void resolve_names(Definition& definition, std::vector<UnresolvedNames>& names);
 
     // Until we have std::optional we need to use std::pair to return something that might be
     // nothing.
-    std::pair<bool, std::vector<std::shared_ptr<Option>>> parse_options(
+    static std::pair<bool, std::vector<Option>> parse_options(
         const tinyxml2::XMLElement* options_handle,
         const std::string& param_name,
-        std::unordered_map<std::string, std::string>& type_map);
-    std::tuple<bool, std::vector<std::shared_ptr<Option>>, Option> parse_range_options(
+        std::unordered_map<std::string, std::string>& type_map,
+        UnresolvedNames& names);
+    static std::tuple<bool, std::vector<Option>, Option> parse_range_options(
         const tinyxml2::XMLElement* param_handle,
         const std::string& param_name,
         std::unordered_map<std::string, std::string>& type_map);
-    std::pair<bool, Option> find_default(
-        const std::vector<std::shared_ptr<Option>>& options, const std::string& default_str);
+    static std::pair<bool, Option>
+    find_default(const std::vector<Option>& options, const std::string& default_str);
 
-    tinyxml2::XMLDocument _doc{};
+    bool set_definition(std::shared_ptr<const Definition> definition);
 
-    std::unordered_map<std::string, std::shared_ptr<Parameter>> _parameter_map{};
+    std::optional<ParameterId> id_for(const std::string& name) const;
+    std::vector<bool> excluded_with_current_settings(bool only_known) const;
+
+    bool is_in_range(const Parameter& parameter, const ParamValue& value) const;
+
+    std::shared_ptr<const Definition> _definition{};
 
     struct InternalCurrentSetting {
         ParamValue value{};
         bool needs_updating{false};
     };
 
-    std::unordered_map<std::string, InternalCurrentSetting> _current_settings{};
-
-    std::string _model{};
-    std::string _vendor{};
+    // Indexed by ParameterId.
+    std::vector<InternalCurrentSetting> _current_settings{};
+    unsigned _unknown_params_generation{0};
 };
 
 } // namespace mavsdk
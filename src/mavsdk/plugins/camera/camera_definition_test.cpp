@@ -1,11 +1,14 @@
 #include "camera_definition.h"
 #include "log.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
 #include <vector>
 #include <unordered_map>
 #include <memory>
 #include <fstream>
 #include <sstream>
+#include <filesystem>
 
 using namespace mavsdk;
 
@@ -311,6 +314,32 @@ TEST(CameraDefinition, E90SettingsToUpdate)
     }
 }
 
+TEST(CameraDefinition, E90UnknownParamsGeneration)
+{
+    // Run this from root.
+    CameraDefinition cd;
+    ASSERT_TRUE(cd.load_file(e90_unit_test_file));
+    cd.assume_default_settings();
+
+    const auto generation = cd.unknown_params_generation();
+
+    // Values from a list are current and don't make anything unknown.
+    std::map<std::string, ParamValue> param_list;
+    param_list["CAM_EV"].set<float>(0.5f);
+    cd.set_unknown_params(param_list);
+    EXPECT_EQ(cd.unknown_params_generation(), generation);
+
+    // CAM_MODE causes other params to be updated.
+    ParamValue value;
+    value.set<int32_t>(1);
+    EXPECT_TRUE(cd.set_setting("CAM_MODE", value));
+    const auto generation_after_set = cd.unknown_params_generation();
+    EXPECT_NE(generation_after_set, generation);
+
+    cd.set_all_params_unknown();
+    EXPECT_NE(cd.unknown_params_generation(), generation_after_set);
+}
+
 TEST(CameraDefinition, E90SettingsCauseUpdates)
 {
     // Run this from root.
@@ -374,6 +403,99 @@ TEST(CameraDefinition, E90SettingsCauseUpdates)
     }
 }
 
+TEST(CameraDefinition, E90SetUnknownParamsFromList)
+{
+    // Run this from root.
+    CameraDefinition cd;
+    ASSERT_TRUE(cd.load_file(e90_unit_test_file));
+
+    // Use the defaults as the param list of the camera.
+    std::map<std::string, ParamValue> param_list;
+    {
+        CameraDefinition cd_defaults;
+        ASSERT_TRUE(cd_defaults.load_file(e90_unit_test_file));
+        cd_defaults.assume_default_settings();
+
+        std::unordered_map<std::string, ParamValue> settings;
+        EXPECT_TRUE(cd_defaults.get_all_settings(settings));
+        param_list.insert(settings.begin(), settings.end());
+    }
+    ASSERT_EQ(param_list.size(), 18);
+
+    // One param is missing, and one has the wrong type.
+    param_list.erase("CAM_ISO");
+    param_list["CAM_EV"].set<std::string>("0.5");
+
+    cd.set_unknown_params(param_list);
+
+    // CAM_MODE causes other params to be updated, but not if they are in the same list.
+    std::vector<std::pair<std::string, ParamValue>> params;
+    cd.get_unknown_params(params);
+    ASSERT_EQ(params.size(), 2);
+
+    std::sort(params.begin(), params.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+    EXPECT_EQ(params[0].first, "CAM_EV");
+    EXPECT_EQ(params[1].first, "CAM_ISO");
+}
+
+TEST(CameraDefinition, E90SharedBetweenSameContent)
+{
+    // Run this from root.
+    CameraDefinition cd1;
+    ASSERT_TRUE(cd1.load_file_shared(e90_unit_test_file));
+
+    // The same content in another file is parsed only once.
+    const auto other_file =
+        std::filesystem::temp_directory_path() / "mavsdk_camera_definition_shared_test.xml";
+    std::filesystem::copy_file(
+        e90_unit_test_file, other_file, std::filesystem::copy_options::overwrite_existing);
+
+    CameraDefinition cd2;
+    ASSERT_TRUE(cd2.load_file_shared(other_file.string()));
+    EXPECT_EQ(cd2.get_vendor(), "Yuneec");
+    EXPECT_EQ(cd2.get_model(), "E90");
+
+    // A changed file under the same name is not mixed up with the previous one.
+    {
+        std::ifstream in(e90_unit_test_file);
+        std::stringstream content;
+        content << in.rdbuf();
+        auto changed = content.str();
+        const auto pos = changed.find("<model>E90</model>");
+        ASSERT_NE(pos, std::string::npos);
+        changed.replace(pos, std::string("<model>E90</model>").size(), "<model>E90X</model>");
+        std::ofstream out(other_file, std::ios::trunc);
+        out << changed;
+    }
+
+    CameraDefinition cd3;
+    ASSERT_TRUE(cd3.load_file_shared(other_file.string()));
+    EXPECT_EQ(cd3.get_model(), "E90X");
+    std::filesystem::remove(other_file);
+
+    // Failed loads are not kept.
+    CameraDefinition cd4;
+    EXPECT_FALSE(cd4.load_file_shared("does_not_exist.xml"));
+
+    // The settings are not shared.
+    cd1.assume_default_settings();
+    cd2.assume_default_settings();
+
+    ParamValue value;
+    value.set<int32_t>(0);
+    EXPECT_TRUE(cd1.set_setting("CAM_MODE", value));
+
+    ParamValue value1;
+    EXPECT_TRUE(cd1.get_setting("CAM_MODE", value1));
+    EXPECT_EQ(value1, value);
+
+    ParamValue value2;
+    EXPECT_TRUE(cd2.get_setting("CAM_MODE", value2));
+    EXPECT_EQ(value2.get<int32_t>(), 1);
+}
+
 TEST(CameraDefinition, E90OptionValues)
 {
     // Run this from root.
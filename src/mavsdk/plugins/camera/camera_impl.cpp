@@ -1443,7 +1443,8 @@ void CameraImpl::load_camera_definition_with_lock(
         potential_camera.camera_definition = std::make_unique<CameraDefinition>();
     }
 
-    if (!potential_camera.camera_definition->load_file(path.string())) {
+    // Identical cameras share the parsed definition.
+    if (!potential_camera.camera_definition->load_file_shared(path.string())) {
         LogErr() << "Failed to load camera definition: " << path;
         // We can't keep something around that's not loaded correctly.
         potential_camera.camera_definition = nullptr;
@@ -2101,6 +2102,87 @@ void CameraImpl::refresh_params_with_lock(PotentialCamera& potential_camera, boo
         return;
     }
 
+    if (initial_load) {
+        for (const auto& param : params) {
+            subscribe_to_param_changes_with_lock(potential_camera, param.first, param.second);
+        }
+    }
+
+    // Getting the whole param list takes one round trip instead of one per param, so it's
+    // worth it unless only a few params need to be updated, e.g. after setting one.
+    if (params.size() >= _min_params_for_param_list && !potential_camera.param_list_failed) {
+        request_param_list_with_lock(potential_camera);
+        return;
+    }
+
+    request_params_with_lock(potential_camera, params);
+}
+
+void CameraImpl::request_param_list_with_lock(PotentialCamera& potential_camera)
+{
+    // The params still unknown once the list arrives are requested then.
+    if (potential_camera.is_fetching_param_list) {
+        return;
+    }
+    potential_camera.is_fetching_param_list = true;
+
+    if (_debugging) {
+        LogDebug() << "Trying to get param list";
+    }
+
+    auto component_id = potential_camera.component_id;
+    const auto generation = potential_camera.camera_definition->unknown_params_generation();
+
+    _system_impl->param_sender(component_id, true)
+        ->get_all_params_async(
+            [component_id, generation, this](
+                MavlinkParameterClient::Result result, std::map<std::string, ParamValue> values) {
+                std::lock_guard lock_later(_mutex);
+                auto maybe_potential_camera_later =
+                    maybe_potential_camera_for_component_id_with_lock(component_id, 0);
+                // We already checked these fields earlier, so we don't check again.
+                assert(maybe_potential_camera_later != nullptr);
+                assert(maybe_potential_camera_later->camera_definition != nullptr);
+
+                auto& camera_later = *maybe_potential_camera_later;
+                camera_later.is_fetching_param_list = false;
+
+                if (camera_later.camera_definition->unknown_params_generation() != generation) {
+                    // Settings changed while the list was being fetched, so its values might
+                    // be from before the change.
+                    if (_debugging) {
+                        LogDebug() << "Discarding outdated param list";
+                    }
+                    refresh_params_with_lock(camera_later, false);
+                    return;
+                }
+
+                if (result == MavlinkParameterClient::Result::Success) {
+                    camera_later.camera_definition->set_unknown_params(values);
+                } else {
+                    LogWarn() << "Could not get param list (" << result
+                              << "), getting params one by one";
+                    camera_later.param_list_failed = true;
+                }
+
+                std::vector<std::pair<std::string, ParamValue>> params;
+                camera_later.camera_definition->get_unknown_params(params);
+
+                if (params.empty()) {
+                    notify_current_settings_with_lock(camera_later);
+                    notify_possible_setting_options_with_lock(camera_later);
+                    return;
+                }
+
+                request_params_with_lock(camera_later, params);
+            },
+            this);
+}
+
+void CameraImpl::request_params_with_lock(
+    PotentialCamera& potential_camera,
+    const std::vector<std::pair<std::string, ParamValue>>& params)
+{
     auto component_id = potential_camera.component_id;
 
     unsigned count = 0;
@@ -2143,10 +2225,6 @@ void CameraImpl::refresh_params_with_lock(PotentialCamera& potential_camera, boo
                     }
                 },
                 this);
-
-        if (initial_load) {
-            subscribe_to_param_changes_with_lock(potential_camera, param_name, param_value_type);
-        }
         ++count;
     }
 }
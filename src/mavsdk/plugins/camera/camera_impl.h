@@ -200,6 +200,9 @@ private:
         bool received_storage{false};
         bool received_video_stream_info{false};
 
+        bool is_fetching_param_list{false};
+        bool param_list_failed{false};
+
         // This is 1-6 for autopilot based cameras. Commands need to be sent out to 1 (autopilot).
         uint8_t component_id;
 
@@ -293,6 +296,9 @@ private:
     void notify_storage_with_lock(PotentialCamera& camera);
 
     void refresh_params_with_lock(PotentialCamera& camera, bool initial_load);
+    void request_param_list_with_lock(PotentialCamera& camera);
+    void request_params_with_lock(
+        PotentialCamera& camera, const std::vector<std::pair<std::string, ParamValue>>& params);
 
     void save_camera_mode_with_lock(PotentialCamera& potential_camera, Camera::Mode mode);
 
@@ -366,6 +372,9 @@ private:
 
     static uint8_t fixup_component_target(uint8_t component_id);
 
+    // Below this many unknown params, they are requested one by one instead of as a list.
+    static constexpr size_t _min_params_for_param_list = 4;
+
     std::mutex _mutex;
     std::vector<PotentialCamera> _potential_cameras;
     CallbackList<Camera::CameraList> _camera_list_subscription_callbacks{};
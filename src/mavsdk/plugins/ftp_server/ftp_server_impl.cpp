@@ -13,7 +13,10 @@ FtpServerImpl::~FtpServerImpl()
     _server_component_impl->unregister_plugin(this);
 }
 
-void FtpServerImpl::init() {}
+void FtpServerImpl::init()
+{
+    _server_component_impl->add_capabilities(MAV_PROTOCOL_CAPABILITY_FTP);
+}
 
 void FtpServerImpl::deinit() {}
 
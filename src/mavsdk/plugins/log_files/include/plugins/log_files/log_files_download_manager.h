@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "plugins/log_files/log_files.h"
+
+namespace mavsdk {
+
+class LogFilesDownloadManagerImpl;
+
+/**
+ * @brief Downloads many log files one after the other using LogFiles.
+ *
+ * Partial downloads are kept next to the target file (as `<path>.part` together with a
+ * journal of the received ranges), so a download that failed, e.g. because the vehicle
+ * disconnected, continues where it stopped when it is started again, even after a restart
+ * of the application.
+ *
+ * The entries have to be listed using LogFiles::get_entries() first.
+ */
+class LogFilesDownloadManager {
+public:
+    /**
+     * @brief Constructor.
+     *
+     * @param log_files The LogFiles plugin to download with, it has to outlive the manager.
+     */
+    explicit LogFilesDownloadManager(LogFiles& log_files);
+
+    /**
+     * @brief Destructor, stops after the download that is going on.
+     */
+    ~LogFilesDownloadManager();
+
+    /**
+     * @brief Aggregate progress of all queued downloads.
+     */
+    struct Progress {
+        uint32_t entries_done{}; /**< @brief Number of finished entries (whatever the result) */
+        uint32_t entries_total{}; /**< @brief Number of queued entries */
+        uint64_t bytes_done{}; /**< @brief Bytes received, including resumed parts */
+        uint64_t bytes_total{}; /**< @brief Size of all queued entries */
+        double bytes_per_second{}; /**< @brief Download rate since start, without resumed parts */
+    };
+
+    /**
+     * @brief Result of one entry.
+     */
+    struct EntryResult {
+        LogFiles::Entry entry{}; /**< @brief The entry */
+        std::string path{}; /**< @brief Where it was downloaded to */
+        LogFiles::Result result{LogFiles::Result::Unknown}; /**< @brief Result of download */
+    };
+
+    /**
+     * @brief Callback type for progress updates.
+     */
+    using ProgressCallback = std::function<void(Progress)>;
+
+    /**
+     * @brief Callback type once all queued entries have been tried.
+     */
+    using DoneCallback = std::function<void(std::vector<EntryResult>)>;
+
+    /**
+     * @brief Queue an entry to download, also while downloads are going on.
+     *
+     * @param entry The entry to download.
+     * @param path Path of the file to download it to.
+     */
+    void add(const LogFiles::Entry& entry, const std::string& path);
+
+    /**
+     * @brief Set how often a download is resumed after a timeout before moving on (default: 3).
+     */
+    void set_max_retries(unsigned max_retries);
+
+    /**
+     * @brief Download all queued entries that have not been downloaded successfully yet.
+     *
+     * Calling it again after a failure, e.g. after a reconnect, resumes the downloads.
+     *
+     * @param progress_callback Called with the aggregate progress.
+     * @param done_callback Called with the results once all entries have been tried.
+     */
+    void start(const ProgressCallback& progress_callback, const DoneCallback& done_callback);
+
+    /**
+     * @brief Copy constructor (object is not copyable).
+     */
+    LogFilesDownloadManager(const LogFilesDownloadManager&) = delete;
+
+    /**
+     * @brief Equality operator (object is not copyable).
+     */
+    const LogFilesDownloadManager& operator=(const LogFilesDownloadManager&) = delete;
+
+private:
+    /** @private Underlying implementation, set at instantiation */
+    std::shared_ptr<LogFilesDownloadManagerImpl> _impl;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,117 @@
+#include "log_download_journal.h"
+#include "log.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+namespace mavsdk {
+
+namespace fs = std::filesystem;
+
+static constexpr const char* JOURNAL_MAGIC = "mavsdk-log-journal 1";
+
+bool LogDownloadJournal::save(
+    const std::string& path, const LogFiles::Entry& entry, const std::vector<Range>& ranges)
+{
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::out | std::ios::trunc);
+        if (!file) {
+            LogWarn() << "Could not write log download journal " << tmp_path;
+            return false;
+        }
+
+        file << JOURNAL_MAGIC << '\n';
+        file << "id " << entry.id << '\n';
+        file << "size " << entry.size_bytes << '\n';
+        file << "date " << entry.date << '\n';
+        for (const auto& range : ranges) {
+            file << "range " << range.offset << ' ' << range.count << '\n';
+        }
+
+        if (!file.flush()) {
+            LogWarn() << "Could not write log download journal " << tmp_path;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+        LogWarn() << "Could not replace log download journal " << path << ": " << ec.message();
+        return false;
+    }
+    return true;
+}
+
+std::optional<std::vector<LogDownloadJournal::Range>>
+LogDownloadJournal::load(const std::string& path, const LogFiles::Entry& entry)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return std::nullopt;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != JOURNAL_MAGIC) {
+        LogWarn() << "Ignoring unknown log download journal " << path;
+        return std::nullopt;
+    }
+
+    std::optional<uint32_t> id;
+    std::optional<uint32_t> size_bytes;
+    std::optional<std::string> date;
+    std::vector<Range> ranges;
+
+    while (std::getline(file, line)) {
+        const auto space = line.find(' ');
+        const std::string key = line.substr(0, space);
+        const std::string value = space == std::string::npos ? "" : line.substr(space + 1);
+        std::istringstream values(value);
+
+        if (key == "id") {
+            uint32_t value_id;
+            if (values >> value_id) {
+                id = value_id;
+            }
+        } else if (key == "size") {
+            uint32_t value_size;
+            if (values >> value_size) {
+                size_bytes = value_size;
+            }
+        } else if (key == "date") {
+            date = value;
+        } else if (key == "range") {
+            Range range{};
+            if (!(values >> range.offset >> range.count)) {
+                LogWarn() << "Ignoring corrupt log download journal " << path;
+                return std::nullopt;
+            }
+            ranges.push_back(range);
+        }
+    }
+
+    if (id != entry.id || size_bytes != entry.size_bytes || date != entry.date) {
+        LogInfo() << "Log download journal " << path << " is of another log";
+        return std::nullopt;
+    }
+
+    for (const auto& range : ranges) {
+        if (range.offset > entry.size_bytes || range.count > entry.size_bytes - range.offset) {
+            LogWarn() << "Ignoring corrupt log download journal " << path;
+            return std::nullopt;
+        }
+    }
+
+    return ranges;
+}
+
+void LogDownloadJournal::remove(const std::string& path)
+{
+    std::error_code ec;
+    fs::remove(path, ec);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "log_download_window.h"
+#include "plugins/log_files/log_files.h"
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+// The ranges received so far of a partial log download, stored next to the partial file so
+// that the download can be resumed later, e.g. after a reconnect.
+//
+// It's a small text file:
+//
+//     mavsdk-log-journal 1
+//     id 3
+//     size 123456
+//     date 2024-05-01T12:00:00Z
+//     range 0 46080
+//     range 46170 900
+//
+class LogDownloadJournal {
+public:
+    using Range = LogDownloadWindow::Request;
+
+    // Written atomically, so a crash leaves either the previous or the new journal.
+    static bool
+    save(const std::string& path, const LogFiles::Entry& entry, const std::vector<Range>& ranges);
+
+    // Returns nothing if there is no journal, or if it is of another log.
+    static std::optional<std::vector<Range>>
+    load(const std::string& path, const LogFiles::Entry& entry);
+
+    static void remove(const std::string& path);
+};
+
+} // namespace mavsdk
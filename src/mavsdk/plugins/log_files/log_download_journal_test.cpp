@@ -0,0 +1,156 @@
+#include "log_download_journal.h"
+#include "log_file_writer.h"
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint32_t BIN_SIZE = LogDownloadWindow::BIN_SIZE;
+
+LogFiles::Entry make_entry(uint32_t size_bytes)
+{
+    LogFiles::Entry entry;
+    entry.id = 3;
+    entry.date = "2024-05-01T12:00:00Z";
+    entry.size_bytes = size_bytes;
+    return entry;
+}
+
+std::string temp_path(const std::string& name)
+{
+    const auto path = fs::temp_directory_path() / ("mavsdk_log_download_test_" + name);
+    fs::remove(path);
+    return path.string();
+}
+
+std::string read_file(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+TEST(LogDownloadJournal, SavesAndLoadsRanges)
+{
+    const auto path = temp_path("journal");
+    const auto entry = make_entry(10 * BIN_SIZE + 5);
+
+    LogDownloadWindow window(entry.size_bytes, 4 * BIN_SIZE);
+    window.add(0, BIN_SIZE);
+    window.add(BIN_SIZE, BIN_SIZE);
+    window.add(5 * BIN_SIZE, BIN_SIZE);
+    window.add(10 * BIN_SIZE, 5);
+
+    ASSERT_TRUE(LogDownloadJournal::save(path, entry, window.received_ranges()));
+
+    const auto ranges = LogDownloadJournal::load(path, entry);
+    ASSERT_TRUE(ranges);
+    ASSERT_EQ(ranges->size(), 3u);
+
+    // Resuming from the journal gives the same state.
+    LogDownloadWindow resumed(entry.size_bytes, 4 * BIN_SIZE);
+    for (const auto& range : ranges.value()) {
+        resumed.add_range(range.offset, range.count);
+    }
+    EXPECT_EQ(resumed.received_bytes(), window.received_bytes());
+
+    // It continues with the first gap.
+    const auto request = resumed.next_request();
+    ASSERT_TRUE(request);
+    EXPECT_EQ(request->offset, 2 * BIN_SIZE);
+
+    LogDownloadJournal::remove(path);
+    EXPECT_FALSE(fs::exists(path));
+}
+
+TEST(LogDownloadJournal, IgnoresJournalOfOtherLog)
+{
+    const auto path = temp_path("journal_other");
+    auto entry = make_entry(1000);
+    ASSERT_TRUE(LogDownloadJournal::save(path, entry, {{0, 900}}));
+
+    auto other = entry;
+    other.date = "2024-05-02T12:00:00Z";
+    EXPECT_FALSE(LogDownloadJournal::load(path, other));
+
+    other = entry;
+    other.size_bytes = 2000;
+    EXPECT_FALSE(LogDownloadJournal::load(path, other));
+
+    EXPECT_TRUE(LogDownloadJournal::load(path, entry));
+    LogDownloadJournal::remove(path);
+}
+
+TEST(LogDownloadJournal, IgnoresCorruptJournal)
+{
+    const auto path = temp_path("journal_corrupt");
+    const auto entry = make_entry(1000);
+
+    EXPECT_FALSE(LogDownloadJournal::load(path, entry));
+
+    ASSERT_TRUE(LogDownloadJournal::save(path, entry, {{900, 200}}));
+    EXPECT_FALSE(LogDownloadJournal::load(path, entry));
+
+    {
+        std::ofstream file(path);
+        file << "something else\n";
+    }
+    EXPECT_FALSE(LogDownloadJournal::load(path, entry));
+    LogDownloadJournal::remove(path);
+}
+
+TEST(LogFileWriter, WritesOutOfOrderIntoPreallocatedFile)
+{
+    const auto path = temp_path("writer");
+    const std::string content = "0123456789abcdefghij";
+
+    LogFileWriter writer;
+    ASSERT_TRUE(writer.open(path, content.size(), false));
+    EXPECT_EQ(fs::file_size(path), content.size());
+
+    auto write = [&](uint32_t offset, uint32_t count) {
+        return writer.write(
+            offset, reinterpret_cast<const uint8_t*>(content.data()) + offset, count);
+    };
+    EXPECT_TRUE(write(10, 5));
+    EXPECT_TRUE(write(15, 5));
+    EXPECT_TRUE(write(0, 10));
+    EXPECT_FALSE(write(18, 5));
+    EXPECT_TRUE(writer.close());
+
+    EXPECT_EQ(read_file(path), content);
+    fs::remove(path);
+}
+
+TEST(LogFileWriter, KeepsContentWhenResuming)
+{
+    const auto path = temp_path("writer_resume");
+    const uint8_t first[] = {'a', 'b'};
+    const uint8_t second[] = {'c', 'd'};
+
+    LogFileWriter writer;
+    ASSERT_TRUE(writer.open(path, 4, false));
+    EXPECT_TRUE(writer.write(0, first, 2));
+    EXPECT_TRUE(writer.close());
+
+    ASSERT_TRUE(writer.open(path, 4, true));
+    EXPECT_TRUE(writer.write(2, second, 2));
+    EXPECT_TRUE(writer.close());
+    EXPECT_EQ(read_file(path), "abcd");
+
+    // Starting over discards it.
+    ASSERT_TRUE(writer.open(path, 4, false));
+    EXPECT_TRUE(writer.close());
+    EXPECT_EQ(read_file(path), std::string(4, '\0'));
+    fs::remove(path);
+}
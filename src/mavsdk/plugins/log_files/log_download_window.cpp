@@ -0,0 +1,126 @@
+#include "log_download_window.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+LogDownloadWindow::LogDownloadWindow(uint32_t size_bytes, uint32_t window_bytes) :
+    _size_bytes(size_bytes),
+    _window_bins(std::max(window_bytes / BIN_SIZE, 1u)),
+    _total_bins(size_bytes / BIN_SIZE + (size_bytes % BIN_SIZE ? 1 : 0)),
+    _received(_total_bins, false)
+{}
+
+LogDownloadWindow::Received LogDownloadWindow::add(uint32_t offset, uint32_t count)
+{
+    if (offset % BIN_SIZE != 0) {
+        return Received::Invalid;
+    }
+
+    const uint32_t bin = offset / BIN_SIZE;
+    if (bin >= _total_bins || count != bin_size(bin)) {
+        return Received::Invalid;
+    }
+
+    if (_received[bin]) {
+        return Received::Duplicate;
+    }
+
+    _received[bin] = true;
+    ++_received_bins;
+    _received_bytes += count;
+    return Received::New;
+}
+
+void LogDownloadWindow::add_range(uint32_t offset, uint32_t count)
+{
+    if (offset % BIN_SIZE != 0 || offset >= _size_bytes) {
+        return;
+    }
+
+    const uint32_t begin = offset / BIN_SIZE;
+    const uint32_t bins = count / BIN_SIZE + (count % BIN_SIZE ? 1 : 0);
+    const uint32_t end = begin + std::min(bins, _total_bins - begin);
+    for (uint32_t bin = begin; bin < end; ++bin) {
+        add(bin * BIN_SIZE, bin_size(bin));
+    }
+
+    // Gaps before it are treated like gaps of earlier requests.
+    _requested_end = std::max(_requested_end, end);
+}
+
+std::vector<LogDownloadWindow::Request> LogDownloadWindow::received_ranges() const
+{
+    std::vector<Request> ranges;
+
+    uint32_t bin = _first_missing;
+    if (bin > 0) {
+        ranges.push_back(request_bins(0, bin));
+    }
+
+    while (bin < _total_bins) {
+        while (bin < _total_bins && !_received[bin]) {
+            ++bin;
+        }
+        const uint32_t begin = bin;
+        while (bin < _total_bins && _received[bin]) {
+            ++bin;
+        }
+        if (begin < bin) {
+            ranges.push_back(request_bins(begin, bin));
+        }
+    }
+
+    return ranges;
+}
+
+bool LogDownloadWindow::is_end_of_request(uint32_t offset, uint32_t count) const
+{
+    return offset >= _request.offset && offset + count == _request.offset + _request.count;
+}
+
+std::optional<LogDownloadWindow::Request> LogDownloadWindow::next_request()
+{
+    while (_first_missing < _total_bins && _received[_first_missing]) {
+        ++_first_missing;
+    }
+
+    if (_first_missing == _total_bins) {
+        return std::nullopt;
+    }
+
+    const uint32_t begin = _first_missing;
+    const uint32_t limit = std::min(_total_bins, begin + _window_bins);
+
+    // Extend the range over further gaps unless too much has been received in between, and
+    // fill the rest of the window with new data once everything requested so far is covered.
+    uint32_t end = begin + 1;
+    for (uint32_t bin = end; bin < limit; ++bin) {
+        if (bin >= _requested_end) {
+            end = limit;
+            break;
+        }
+        if (!_received[bin]) {
+            end = bin + 1;
+        } else if (bin - end >= MERGE_BINS) {
+            break;
+        }
+    }
+
+    _requested_end = std::max(_requested_end, end);
+    _request = request_bins(begin, end);
+    return _request;
+}
+
+uint32_t LogDownloadWindow::bin_size(uint32_t bin) const
+{
+    return std::min(BIN_SIZE, _size_bytes - bin * BIN_SIZE);
+}
+
+LogDownloadWindow::Request LogDownloadWindow::request_bins(uint32_t begin, uint32_t end) const
+{
+    const uint32_t offset = begin * BIN_SIZE;
+    return Request{offset, std::min(end * BIN_SIZE, _size_bytes) - offset};
+}
+
+} // namespace mavsdk
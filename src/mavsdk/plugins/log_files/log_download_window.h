@@ -0,0 +1,78 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace mavsdk {
+
+// Keeps track of the received parts of a log download and decides what to request next.
+//
+// The autopilots serve one LOG_REQUEST_DATA at a time, a new request replaces the one that is
+// being sent. To keep the link busy, a whole window of several chunks is therefore requested at
+// once, and the next request is sent as soon as the last packet of the current one arrives.
+//
+// Packets are accepted anywhere in the log, in any order, and are marked in a bitmap of bins
+// covering the whole log. Missing bins are requested again as ranges, small received parts in
+// between are requested again as well, rather than spending a round trip per gap.
+class LogDownloadWindow {
+public:
+    static constexpr uint32_t BIN_SIZE = MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+
+    // Received parts shorter than this between two gaps are requested again with the gaps.
+    static constexpr uint32_t MERGE_BINS = 64;
+
+    struct Request {
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    enum class Received {
+        New,
+        Duplicate,
+        Invalid,
+    };
+
+    LogDownloadWindow() = default;
+    LogDownloadWindow(uint32_t size_bytes, uint32_t window_bytes);
+
+    Received add(uint32_t offset, uint32_t count);
+
+    // Marks a range of whole bins as received, e.g. from the journal of a previous download.
+    void add_range(uint32_t offset, uint32_t count);
+
+    // The received data as ranges of contiguous bins, in order.
+    std::vector<Request> received_ranges() const;
+
+    // True if the packet was the last one of the current request, so the next one can be sent.
+    bool is_end_of_request(uint32_t offset, uint32_t count) const;
+
+    // Sets and returns the next request, or nothing once everything has been received.
+    std::optional<Request> next_request();
+
+    bool complete() const { return _received_bins == _total_bins; }
+    uint32_t received_bytes() const { return _received_bytes; }
+    uint32_t size_bytes() const { return _size_bytes; }
+
+private:
+    uint32_t bin_size(uint32_t bin) const;
+    Request request_bins(uint32_t begin, uint32_t end) const;
+
+    uint32_t _size_bytes{0};
+    uint32_t _window_bins{0};
+    uint32_t _total_bins{0};
+
+    std::vector<bool> _received{};
+    uint32_t _received_bins{0};
+    uint32_t _received_bytes{0};
+
+    // All bins before this one have been received.
+    uint32_t _first_missing{0};
+    // All bins before this one have been requested at least once.
+    uint32_t _requested_end{0};
+
+    Request _request{0, 0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,353 @@
+#include "log_download_window.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+constexpr uint32_t BIN_SIZE = LogDownloadWindow::BIN_SIZE;
+constexpr uint32_t CHUNK_SIZE = 128 * BIN_SIZE;
+
+using Request = LogDownloadWindow::Request;
+
+// Receiving side of a download, how it was done before and how it's done now.
+class Client {
+public:
+    virtual ~Client() = default;
+    virtual std::optional<Request> start() = 0;
+    virtual std::optional<Request> received(uint32_t offset, uint32_t count) = 0;
+    virtual std::optional<Request> timeout() = 0;
+    virtual bool complete() const = 0;
+};
+
+// One chunk after the other, the previous implementation.
+class StopAndWaitClient : public Client {
+public:
+    explicit StopAndWaitClient(uint32_t size_bytes) : _size_bytes(size_bytes)
+    {
+        _table.assign(bins_in_chunk(), false);
+    }
+
+    std::optional<Request> start() override { return Request{0, chunk_size()}; }
+
+    std::optional<Request> received(uint32_t offset, uint32_t /*count*/) override
+    {
+        if (offset / CHUNK_SIZE != _chunk) {
+            return std::nullopt;
+        }
+        const uint32_t bin = (offset - _chunk * CHUNK_SIZE) / BIN_SIZE;
+        _table[bin] = true;
+
+        if (std::all_of(_table.begin(), _table.end(), [](bool received) { return received; })) {
+            _written += chunk_size();
+            ++_chunk;
+            if (complete()) {
+                return std::nullopt;
+            }
+            _table.assign(bins_in_chunk(), false);
+            return Request{_chunk * CHUNK_SIZE, chunk_size()};
+        }
+
+        if (bin == _table.size() - 1 || _table.back()) {
+            return first_missing_range();
+        }
+        return std::nullopt;
+    }
+
+    std::optional<Request> timeout() override { return first_missing_range(); }
+
+    bool complete() const override { return _written == _size_bytes; }
+
+private:
+    uint32_t chunk_size() const { return std::min(CHUNK_SIZE, _size_bytes - _chunk * CHUNK_SIZE); }
+    uint32_t bins_in_chunk() const { return (chunk_size() + BIN_SIZE - 1) / BIN_SIZE; }
+
+    std::optional<Request> first_missing_range() const
+    {
+        const auto begin = std::find(_table.begin(), _table.end(), false);
+        if (begin == _table.end()) {
+            return std::nullopt;
+        }
+        const auto end = std::find(begin, _table.end(), true);
+        const uint32_t offset =
+            _chunk * CHUNK_SIZE + static_cast<uint32_t>(begin - _table.begin()) * BIN_SIZE;
+        return Request{offset, static_cast<uint32_t>(end - begin) * BIN_SIZE};
+    }
+
+    const uint32_t _size_bytes;
+    uint32_t _chunk{0};
+    uint32_t _written{0};
+    std::vector<bool> _table{};
+};
+
+class WindowClient : public Client {
+public:
+    WindowClient(uint32_t size_bytes, uint32_t window_chunks) :
+        _window(size_bytes, window_chunks * CHUNK_SIZE)
+    {}
+
+    std::optional<Request> start() override { return _window.next_request(); }
+
+    std::optional<Request> received(uint32_t offset, uint32_t count) override
+    {
+        EXPECT_NE(_window.add(offset, count), LogDownloadWindow::Received::Invalid);
+        if (_window.complete() || !_window.is_end_of_request(offset, count)) {
+            return std::nullopt;
+        }
+        return _window.next_request();
+    }
+
+    std::optional<Request> timeout() override { return _window.next_request(); }
+
+    bool complete() const override { return _window.complete(); }
+
+private:
+    LogDownloadWindow _window;
+};
+
+struct Link {
+    // One packet is sent per tick.
+    unsigned delay_ticks;
+    double loss;
+    unsigned timeout_ticks;
+};
+
+struct Stats {
+    unsigned ticks{0};
+    unsigned packets_sent{0};
+    unsigned requests{0};
+    bool complete{false};
+};
+
+// Autopilot side: sends the current request packet by packet, a new request replaces it.
+Stats simulate(Client& client, uint32_t size_bytes, const Link& link, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::bernoulli_distribution lost(link.loss);
+
+    struct InFlight {
+        unsigned arrival;
+        Request data;
+    };
+    std::deque<InFlight> requests_in_flight;
+    std::deque<InFlight> packets_in_flight;
+
+    Stats stats;
+    unsigned last_received = 0;
+
+    auto send_request = [&](std::optional<Request> request) {
+        if (request) {
+            ++stats.requests;
+            if (!lost(random)) {
+                requests_in_flight.push_back({stats.ticks + link.delay_ticks, request.value()});
+            }
+        }
+    };
+
+    std::optional<Request> serving;
+    send_request(client.start());
+
+    constexpr unsigned max_ticks = 10'000'000;
+    for (; stats.ticks < max_ticks && !client.complete(); ++stats.ticks) {
+        while (!requests_in_flight.empty() && requests_in_flight.front().arrival <= stats.ticks) {
+            serving = requests_in_flight.front().data;
+            requests_in_flight.pop_front();
+        }
+
+        if (serving && serving->count > 0) {
+            const uint32_t count =
+                std::min({BIN_SIZE, serving->count, size_bytes - serving->offset});
+            if (!lost(random)) {
+                packets_in_flight.push_back(
+                    {stats.ticks + link.delay_ticks, Request{serving->offset, count}});
+            }
+            ++stats.packets_sent;
+            serving->offset += count;
+            serving->count = (count < serving->count && serving->offset < size_bytes) ?
+                                 serving->count - count :
+                                 0;
+        }
+
+        while (!packets_in_flight.empty() && packets_in_flight.front().arrival <= stats.ticks) {
+            const auto packet = packets_in_flight.front().data;
+            packets_in_flight.pop_front();
+            last_received = stats.ticks;
+            send_request(client.received(packet.offset, packet.count));
+        }
+
+        if (stats.ticks - last_received >= link.timeout_ticks) {
+            last_received = stats.ticks;
+            send_request(client.timeout());
+        }
+    }
+
+    stats.complete = client.complete();
+    return stats;
+}
+
+} // namespace
+
+TEST(LogDownloadWindow, RequestsFirstWindow)
+{
+    LogDownloadWindow window(10 * CHUNK_SIZE, 4 * CHUNK_SIZE);
+
+    const auto request = window.next_request();
+    ASSERT_TRUE(request);
+    EXPECT_EQ(request->offset, 0u);
+    EXPECT_EQ(request->count, 4 * CHUNK_SIZE);
+}
+
+TEST(LogDownloadWindow, AcceptsOutOfOrderData)
+{
+    const uint32_t size_bytes = 3 * BIN_SIZE + 10;
+    LogDownloadWindow window(size_bytes, CHUNK_SIZE);
+
+    EXPECT_EQ(window.add(3 * BIN_SIZE, 10), LogDownloadWindow::Received::New);
+    EXPECT_EQ(window.add(BIN_SIZE, BIN_SIZE), LogDownloadWindow::Received::New);
+    EXPECT_EQ(window.add(BIN_SIZE, BIN_SIZE), LogDownloadWindow::Received::Duplicate);
+    EXPECT_EQ(window.add(2 * BIN_SIZE, BIN_SIZE), LogDownloadWindow::Received::New);
+    EXPECT_FALSE(window.complete());
+    EXPECT_EQ(window.add(0, BIN_SIZE), LogDownloadWindow::Received::New);
+
+    EXPECT_TRUE(window.complete());
+    EXPECT_EQ(window.received_bytes(), size_bytes);
+    EXPECT_FALSE(window.next_request());
+}
+
+TEST(LogDownloadWindow, RejectsInvalidData)
+{
+    LogDownloadWindow window(2 * BIN_SIZE + 10, CHUNK_SIZE);
+
+    EXPECT_EQ(window.add(5, BIN_SIZE), LogDownloadWindow::Received::Invalid);
+    EXPECT_EQ(window.add(0, BIN_SIZE - 1), LogDownloadWindow::Received::Invalid);
+    EXPECT_EQ(window.add(2 * BIN_SIZE, BIN_SIZE), LogDownloadWindow::Received::Invalid);
+    EXPECT_EQ(window.add(3 * BIN_SIZE, 0), LogDownloadWindow::Received::Invalid);
+    EXPECT_EQ(window.received_bytes(), 0u);
+}
+
+TEST(LogDownloadWindow, CoalescesGaps)
+{
+    const uint32_t window_bins = 4 * 128;
+    LogDownloadWindow window(10 * CHUNK_SIZE, window_bins * BIN_SIZE);
+    ASSERT_TRUE(window.next_request());
+
+    // Everything but bins 10, 12, 300 and 500 arrives.
+    for (uint32_t bin = 0; bin < window_bins; ++bin) {
+        if (bin != 10 && bin != 12 && bin != 300 && bin != 500) {
+            window.add(bin * BIN_SIZE, BIN_SIZE);
+        }
+    }
+    const uint32_t last = (window_bins - 1) * BIN_SIZE;
+    EXPECT_TRUE(window.is_end_of_request(last, BIN_SIZE));
+
+    // Close gaps are requested together, far ones separately.
+    auto request = window.next_request();
+    ASSERT_TRUE(request);
+    EXPECT_EQ(request->offset, 10 * BIN_SIZE);
+    EXPECT_EQ(request->count, 3 * BIN_SIZE);
+
+    window.add(10 * BIN_SIZE, BIN_SIZE);
+    window.add(12 * BIN_SIZE, BIN_SIZE);
+
+    request = window.next_request();
+    ASSERT_TRUE(request);
+    EXPECT_EQ(request->offset, 300 * BIN_SIZE);
+    EXPECT_EQ(request->count, BIN_SIZE);
+
+    window.add(300 * BIN_SIZE, BIN_SIZE);
+
+    // The last gap is close to the end of what was requested, so it continues with new data.
+    request = window.next_request();
+    ASSERT_TRUE(request);
+    EXPECT_EQ(request->offset, 500 * BIN_SIZE);
+    EXPECT_EQ(request->count, window_bins * BIN_SIZE);
+}
+
+TEST(LogDownloadWindow, CompletesOverLossyLink)
+{
+    const uint32_t size_bytes = 20 * CHUNK_SIZE + 1234;
+
+    for (const double loss : {0.0, 0.01, 0.1, 0.3}) {
+        for (unsigned seed = 0; seed < 5; ++seed) {
+            WindowClient client(size_bytes, 4);
+            const auto stats = simulate(client, size_bytes, Link{20, loss, 200}, seed);
+            EXPECT_TRUE(stats.complete) << "loss: " << loss << ", seed: " << seed;
+        }
+    }
+}
+
+// Downloads a log over a simulated link with a round trip of 100 packets, which is e.g. a
+// 1 MBit/s link with 50 ms round trip time, comparing the previous stop-and-wait download of
+// one chunk at a time with the window.
+TEST(LogDownloadWindow, FasterThanStopAndWait)
+{
+    const uint32_t size_bytes = 100 * CHUNK_SIZE;
+
+    for (const double loss : {0.0, 0.01, 0.05}) {
+        StopAndWaitClient stop_and_wait(size_bytes);
+        const auto before = simulate(stop_and_wait, size_bytes, Link{50, loss, 500}, 1);
+
+        WindowClient windowed(size_bytes, 4);
+        const auto after = simulate(windowed, size_bytes, Link{50, loss, 500}, 1);
+
+        ASSERT_TRUE(before.complete);
+        ASSERT_TRUE(after.complete);
+        EXPECT_LT(after.ticks, before.ticks) << "loss: " << loss;
+    }
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests.
+TEST(LogDownloadWindow, DISABLED_Benchmark)
+{
+    const uint32_t size_bytes = 100 * CHUNK_SIZE;
+    const uint32_t packets = size_bytes / BIN_SIZE;
+
+    for (const double loss : {0.0, 0.01, 0.05}) {
+        StopAndWaitClient stop_and_wait(size_bytes);
+        const auto before = simulate(stop_and_wait, size_bytes, Link{50, loss, 500}, 1);
+
+        WindowClient windowed(size_bytes, 4);
+        const auto after = simulate(windowed, size_bytes, Link{50, loss, 500}, 1);
+
+        ASSERT_TRUE(before.complete);
+        ASSERT_TRUE(after.complete);
+
+        // Link use in percent, for the loss in per mille.
+        const auto suffix = "_" + std::to_string(static_cast<int>(loss * 1000)) + "_permille_loss";
+        ::testing::Test::RecordProperty(
+            "stop_and_wait_link_use" + suffix, static_cast<int>(100 * packets / before.ticks));
+        ::testing::Test::RecordProperty(
+            "window_link_use" + suffix, static_cast<int>(100 * packets / after.ticks));
+        ::testing::Test::RecordProperty(
+            "window_packets_sent_again" + suffix,
+            static_cast<int>(after.packets_sent - packets));
+    }
+
+    // Bookkeeping of a 200 MB log
+    const uint32_t large_size_bytes = 200 * 1000 * 1000;
+    LogDownloadWindow window(large_size_bytes, 4 * CHUNK_SIZE);
+    const auto start = std::chrono::steady_clock::now();
+    uint32_t requests = 0;
+    while (auto request = window.next_request()) {
+        ++requests;
+        for (uint32_t offset = request->offset; offset < request->offset + request->count;
+             offset += BIN_SIZE) {
+            window.add(offset, std::min(BIN_SIZE, large_size_bytes - offset));
+        }
+    }
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ::testing::Test::RecordProperty("large_log_requests", static_cast<int>(requests));
+    ::testing::Test::RecordProperty("large_log_bookkeeping_ms", static_cast<int>(seconds * 1e3));
+
+    EXPECT_TRUE(window.complete());
+}
@@ -0,0 +1,156 @@
+#include "log_file_writer.h"
+#include "log.h"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#if defined(WINDOWS)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mavsdk {
+
+LogFileWriter::~LogFileWriter()
+{
+    close();
+}
+
+LogFileWriter::LogFileWriter(LogFileWriter&& other) noexcept :
+    _fd(std::exchange(other._fd, -1)),
+    _size_bytes(other._size_bytes),
+    _buffer(std::move(other._buffer)),
+    _buffer_offset(other._buffer_offset)
+{}
+
+LogFileWriter& LogFileWriter::operator=(LogFileWriter&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        _fd = std::exchange(other._fd, -1);
+        _size_bytes = other._size_bytes;
+        _buffer = std::move(other._buffer);
+        _buffer_offset = other._buffer_offset;
+    }
+    return *this;
+}
+
+bool LogFileWriter::open(const std::string& path, uint32_t size_bytes, bool keep_content)
+{
+    close();
+
+    const int flags = O_RDWR | O_CREAT | (keep_content ? 0 : O_TRUNC);
+#if defined(WINDOWS)
+    _fd = ::_open(path.c_str(), flags | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    _fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+#endif
+    if (_fd < 0) {
+        LogErr() << "Could not open " << path << ": " << strerror(errno);
+        return false;
+    }
+
+    // Allocate the whole file, so it can't run out of disk space halfway through.
+#if defined(WINDOWS)
+    const bool allocated = ::_chsize_s(_fd, size_bytes) == 0;
+#elif defined(LINUX)
+    const bool allocated = posix_fallocate(_fd, 0, size_bytes) == 0 ||
+                           ::ftruncate(_fd, static_cast<off_t>(size_bytes)) == 0;
+#else
+    const bool allocated = ::ftruncate(_fd, static_cast<off_t>(size_bytes)) == 0;
+#endif
+    if (!allocated) {
+        LogErr() << "Could not allocate " << size_bytes << " bytes for " << path;
+        close();
+        return false;
+    }
+
+    _size_bytes = size_bytes;
+    _buffer.clear();
+    _buffer.reserve(BUFFER_SIZE);
+    _buffer_offset = 0;
+    return true;
+}
+
+bool LogFileWriter::write(uint32_t offset, const uint8_t* data, uint32_t count)
+{
+    if (!is_open() || offset > _size_bytes || count > _size_bytes - offset) {
+        return false;
+    }
+
+    const bool contiguous = offset == _buffer_offset + _buffer.size();
+    if (!contiguous || _buffer.size() + count > BUFFER_SIZE) {
+        if (!flush()) {
+            return false;
+        }
+    }
+
+    if (_buffer.empty()) {
+        _buffer_offset = offset;
+    }
+    _buffer.insert(_buffer.end(), data, data + count);
+    return true;
+}
+
+bool LogFileWriter::flush()
+{
+    if (_buffer.empty()) {
+        return true;
+    }
+
+    const bool success = write_at(_buffer_offset, _buffer.data(), _buffer.size());
+    _buffer.clear();
+    return success;
+}
+
+bool LogFileWriter::close()
+{
+    if (!is_open()) {
+        return true;
+    }
+
+    const bool success = flush();
+#if defined(WINDOWS)
+    ::_close(_fd);
+#else
+    ::close(_fd);
+#endif
+    _fd = -1;
+    return success;
+}
+
+bool LogFileWriter::write_at(uint32_t offset, const char* data, size_t count)
+{
+#if defined(WINDOWS)
+    if (::_lseeki64(_fd, offset, SEEK_SET) < 0) {
+        return false;
+    }
+#endif
+
+    size_t written = 0;
+    while (written < count) {
+#if defined(WINDOWS)
+        const auto len = ::_write(_fd, data + written, static_cast<unsigned>(count - written));
+#else
+        const auto len = ::pwrite(
+            _fd, data + written, count - written, static_cast<off_t>(offset + written));
+#endif
+        if (len < 0 && errno == EINTR) {
+            continue;
+        }
+        if (len <= 0) {
+            LogErr() << "Writing log file failed: " << strerror(errno);
+            return false;
+        }
+        written += static_cast<size_t>(len);
+    }
+    return true;
+}
+
+} // namespace mavsdk
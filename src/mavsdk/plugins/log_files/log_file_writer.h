@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+// Writes a log download into a file which is allocated with its full size up front.
+//
+// The packets mostly arrive in order, so contiguous ones are collected and written together
+// rather than seeking and writing for each 90 byte packet.
+class LogFileWriter {
+public:
+    LogFileWriter() = default;
+    ~LogFileWriter();
+
+    LogFileWriter(LogFileWriter&& other) noexcept;
+    LogFileWriter& operator=(LogFileWriter&& other) noexcept;
+    LogFileWriter(const LogFileWriter&) = delete;
+    LogFileWriter& operator=(const LogFileWriter&) = delete;
+
+    // Keeps what is already in the file if keep_content is set, e.g. to resume a download.
+    bool open(const std::string& path, uint32_t size_bytes, bool keep_content);
+    bool is_open() const { return _fd >= 0; }
+
+    bool write(uint32_t offset, const uint8_t* data, uint32_t count);
+    bool flush();
+    bool close();
+
+private:
+    bool write_at(uint32_t offset, const char* data, size_t count);
+
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    int _fd{-1};
+    uint32_t _size_bytes{0};
+
+    std::vector<char> _buffer{};
+    uint32_t _buffer_offset{0};
+};
+
+} // namespace mavsdk
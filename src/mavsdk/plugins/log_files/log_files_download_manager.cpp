@@ -0,0 +1,37 @@
+#include "plugins/log_files/log_files_download_manager.h"
+#include "log_files_download_manager_impl.h"
+
+namespace mavsdk {
+
+LogFilesDownloadManager::LogFilesDownloadManager(LogFiles& log_files) :
+    _impl{std::make_shared<LogFilesDownloadManagerImpl>(
+        [&log_files](
+            const LogFiles::Entry& entry,
+            const std::string& path,
+            const LogFiles::DownloadLogFileCallback& callback) {
+            log_files.download_log_file_async(entry, path, callback);
+        })}
+{}
+
+LogFilesDownloadManager::~LogFilesDownloadManager()
+{
+    _impl->stop();
+}
+
+void LogFilesDownloadManager::add(const LogFiles::Entry& entry, const std::string& path)
+{
+    _impl->add(entry, path);
+}
+
+void LogFilesDownloadManager::set_max_retries(unsigned max_retries)
+{
+    _impl->set_max_retries(max_retries);
+}
+
+void LogFilesDownloadManager::start(
+    const ProgressCallback& progress_callback, const DoneCallback& done_callback)
+{
+    _impl->start(progress_callback, done_callback);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,210 @@
+#include "log_files_download_manager_impl.h"
+#include "log_download_journal.h"
+#include "log.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <optional>
+#include <system_error>
+#include <utility>
+
+namespace mavsdk {
+
+namespace fs = std::filesystem;
+
+LogFilesDownloadManagerImpl::LogFilesDownloadManagerImpl(DownloadFunction download_function) :
+    _download_function(std::move(download_function))
+{}
+
+void LogFilesDownloadManagerImpl::add(const LogFiles::Entry& entry, const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Item item;
+    item.result.entry = entry;
+    item.result.path = path;
+    item.pending = _running;
+    _items.push_back(item);
+}
+
+void LogFilesDownloadManagerImpl::set_max_retries(unsigned max_retries)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _max_retries = max_retries;
+}
+
+void LogFilesDownloadManagerImpl::start(
+    const LogFilesDownloadManager::ProgressCallback& progress_callback,
+    const LogFilesDownloadManager::DoneCallback& done_callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_running) {
+            LogWarn() << "Log downloads already going on";
+            return;
+        }
+
+        for (auto& item : _items) {
+            item.pending = item.result.result != LogFiles::Result::Success;
+            item.retries = 0;
+        }
+        _running = true;
+        _progress_callback = progress_callback;
+        _done_callback = done_callback;
+        _start_time = std::chrono::steady_clock::now();
+        _session_bytes = 0;
+    }
+
+    download_next();
+}
+
+void LogFilesDownloadManagerImpl::stop()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopped = true;
+    _progress_callback = nullptr;
+    _done_callback = nullptr;
+}
+
+void LogFilesDownloadManagerImpl::download_next()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_stopped) {
+        auto it = std::find_if(
+            _items.begin(), _items.end(), [](const Item& item) { return item.pending; });
+
+        if (it == _items.end()) {
+            _running = false;
+            const auto done_callback = _done_callback;
+            std::vector<LogFilesDownloadManager::EntryResult> results;
+            for (const auto& item : _items) {
+                results.push_back(item.result);
+            }
+            lock.unlock();
+
+            if (done_callback) {
+                done_callback(results);
+            }
+            return;
+        }
+
+        const size_t index = static_cast<size_t>(it - _items.begin());
+        if (already_downloaded(*it)) {
+            it->received_bytes = it->result.entry.size_bytes;
+            finish(index, LogFiles::Result::Success);
+            continue;
+        }
+
+        // Resumed data does not count for the download rate.
+        it->received_bytes = journaled_bytes(*it);
+
+        const auto entry = it->result.entry;
+        const auto path = it->result.path;
+        lock.unlock();
+
+        std::weak_ptr<LogFilesDownloadManagerImpl> weak_self = shared_from_this();
+        _download_function(
+            entry,
+            path,
+            [weak_self, index](LogFiles::Result result, LogFiles::ProgressData progress) {
+                if (auto self = weak_self.lock()) {
+                    self->process_download(index, result, progress);
+                }
+            });
+        return;
+    }
+}
+
+void LogFilesDownloadManagerImpl::process_download(
+    size_t index, LogFiles::Result result, LogFiles::ProgressData progress)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_stopped) {
+        return;
+    }
+
+    auto& item = _items[index];
+
+    if (result == LogFiles::Result::Next) {
+        const auto received_bytes =
+            static_cast<uint64_t>(progress.progress * item.result.entry.size_bytes);
+        if (received_bytes > item.received_bytes) {
+            _session_bytes += received_bytes - item.received_bytes;
+            item.received_bytes = received_bytes;
+        }
+        report_progress(lock);
+        return;
+    }
+
+    if (result == LogFiles::Result::Timeout && item.retries < _max_retries) {
+        ++item.retries;
+        LogWarn() << "Resuming download of " << item.result.path << " (retry " << item.retries
+                  << "/" << _max_retries << ")";
+    } else {
+        finish(index, result);
+    }
+
+    report_progress(lock);
+    lock.unlock();
+    download_next();
+}
+
+void LogFilesDownloadManagerImpl::finish(size_t index, LogFiles::Result result)
+{
+    // Note: This function assumes _mutex is already locked by caller
+
+    auto& item = _items[index];
+    if (result == LogFiles::Result::Success) {
+        const uint64_t size_bytes = item.result.entry.size_bytes;
+        _session_bytes += size_bytes - std::min(item.received_bytes, size_bytes);
+        item.received_bytes = size_bytes;
+    }
+    item.result.result = result;
+    item.pending = false;
+}
+
+void LogFilesDownloadManagerImpl::report_progress(std::unique_lock<std::mutex>& lock)
+{
+    LogFilesDownloadManager::Progress progress;
+    for (const auto& item : _items) {
+        ++progress.entries_total;
+        if (!item.pending) {
+            ++progress.entries_done;
+        }
+        progress.bytes_done += item.received_bytes;
+        progress.bytes_total += item.result.entry.size_bytes;
+    }
+
+    const double elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - _start_time).count();
+    progress.bytes_per_second = elapsed_s > 0.0 ? _session_bytes / elapsed_s : 0.0;
+
+    const auto progress_callback = _progress_callback;
+    lock.unlock();
+    if (progress_callback) {
+        progress_callback(progress);
+    }
+    lock.lock();
+}
+
+bool LogFilesDownloadManagerImpl::already_downloaded(const Item& item)
+{
+    std::error_code ec;
+    return !fs::exists(item.result.path + ".part", ec) &&
+           fs::file_size(item.result.path, ec) == item.result.entry.size_bytes && !ec;
+}
+
+uint64_t LogFilesDownloadManagerImpl::journaled_bytes(const Item& item)
+{
+    const auto ranges =
+        LogDownloadJournal::load(item.result.path + ".part.journal", item.result.entry);
+    uint64_t bytes = 0;
+    if (ranges) {
+        for (const auto& range : ranges.value()) {
+            bytes += range.count;
+        }
+    }
+    return bytes;
+}
+
+} // namespace mavsdk
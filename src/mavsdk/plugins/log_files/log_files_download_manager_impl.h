@@ -0,0 +1,63 @@
+#pragma once
+
+#include "plugins/log_files/log_files.h"
+#include "plugins/log_files/log_files_download_manager.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+class LogFilesDownloadManagerImpl
+    : public std::enable_shared_from_this<LogFilesDownloadManagerImpl> {
+public:
+    // Downloads one entry, as LogFiles::download_log_file_async() does.
+    using DownloadFunction = std::function<void(
+        const LogFiles::Entry&, const std::string&, const LogFiles::DownloadLogFileCallback&)>;
+
+    explicit LogFilesDownloadManagerImpl(DownloadFunction download_function);
+
+    void add(const LogFiles::Entry& entry, const std::string& path);
+    void set_max_retries(unsigned max_retries);
+    void start(
+        const LogFilesDownloadManager::ProgressCallback& progress_callback,
+        const LogFilesDownloadManager::DoneCallback& done_callback);
+    void stop();
+
+private:
+    struct Item {
+        LogFilesDownloadManager::EntryResult result{};
+        bool pending{false};
+        unsigned retries{0};
+        uint64_t received_bytes{0};
+    };
+
+    void download_next();
+    void process_download(size_t index, LogFiles::Result result, LogFiles::ProgressData progress);
+    void finish(size_t index, LogFiles::Result result);
+    void report_progress(std::unique_lock<std::mutex>& lock);
+
+    static bool already_downloaded(const Item& item);
+    static uint64_t journaled_bytes(const Item& item);
+
+    const DownloadFunction _download_function;
+
+    std::mutex _mutex{};
+    std::vector<Item> _items{};
+    unsigned _max_retries{3};
+    bool _running{false};
+    bool _stopped{false};
+
+    LogFilesDownloadManager::ProgressCallback _progress_callback{};
+    LogFilesDownloadManager::DoneCallback _done_callback{};
+
+    std::chrono::steady_clock::time_point _start_time{};
+    uint64_t _session_bytes{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,297 @@
+#include "log_files_download_manager_impl.h"
+#include "log_download_journal.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint32_t BIN_SIZE = LogDownloadWindow::BIN_SIZE;
+
+LogFiles::Entry make_entry(uint32_t id, uint32_t size_bytes)
+{
+    LogFiles::Entry entry;
+    entry.id = id;
+    entry.date = "2024-05-01T12:00:00Z";
+    entry.size_bytes = size_bytes;
+    return entry;
+}
+
+std::string temp_path(const std::string& name)
+{
+    const auto path = fs::temp_directory_path() / ("mavsdk_log_download_manager_test_" + name);
+    fs::remove(path);
+    fs::remove(path.string() + ".part");
+    fs::remove(path.string() + ".part.journal");
+    return path.string();
+}
+
+void write_file(const std::string& path, uint32_t size_bytes)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << std::string(size_bytes, 'x');
+}
+
+// Stands in for LogFiles, the test answers the downloads it was asked for.
+class FakeLogFiles {
+public:
+    struct Download {
+        LogFiles::Entry entry;
+        std::string path;
+        LogFiles::DownloadLogFileCallback callback;
+    };
+
+    LogFilesDownloadManagerImpl::DownloadFunction download_function()
+    {
+        return [this](
+                   const LogFiles::Entry& entry,
+                   const std::string& path,
+                   const LogFiles::DownloadLogFileCallback& callback) {
+            downloads.push_back(Download{entry, path, callback});
+        };
+    }
+
+    void progress(float progress)
+    {
+        // Copied, the callback can start the next download.
+        const auto callback = downloads.back().callback;
+        callback(LogFiles::Result::Next, LogFiles::ProgressData{progress});
+    }
+
+    void fail(LogFiles::Result result)
+    {
+        const auto callback = downloads.back().callback;
+        callback(result, LogFiles::ProgressData{});
+    }
+
+    void complete()
+    {
+        const auto download = downloads.back();
+        write_file(download.path, download.entry.size_bytes);
+        download.callback(LogFiles::Result::Success, LogFiles::ProgressData{1.0f});
+    }
+
+    std::vector<Download> downloads{};
+};
+
+struct Results {
+    std::vector<LogFilesDownloadManager::Progress> progress{};
+    std::vector<LogFilesDownloadManager::EntryResult> done{};
+    unsigned done_count{0};
+};
+
+void start(LogFilesDownloadManagerImpl& manager, Results& results)
+{
+    manager.start(
+        [&](LogFilesDownloadManager::Progress progress) { results.progress.push_back(progress); },
+        [&](std::vector<LogFilesDownloadManager::EntryResult> done) {
+            results.done = done;
+            ++results.done_count;
+        });
+}
+
+} // namespace
+
+TEST(LogFilesDownloadManager, DownloadsAllEntries)
+{
+    FakeLogFiles log_files;
+    auto manager = std::make_shared<LogFilesDownloadManagerImpl>(log_files.download_function());
+
+    const auto first_path = temp_path("first");
+    const auto second_path = temp_path("second");
+    manager->add(make_entry(1, 10 * BIN_SIZE), first_path);
+    manager->add(make_entry(2, 20 * BIN_SIZE), second_path);
+
+    Results results;
+    start(*manager, results);
+
+    // One after the other.
+    ASSERT_EQ(log_files.downloads.size(), 1u);
+    EXPECT_EQ(log_files.downloads[0].entry.id, 1u);
+    EXPECT_EQ(log_files.downloads[0].path, first_path);
+
+    log_files.progress(0.5f);
+    ASSERT_EQ(results.progress.size(), 1u);
+    EXPECT_EQ(results.progress.back().entries_done, 0u);
+    EXPECT_EQ(results.progress.back().entries_total, 2u);
+    EXPECT_EQ(results.progress.back().bytes_done, 5 * BIN_SIZE);
+    EXPECT_EQ(results.progress.back().bytes_total, 30 * BIN_SIZE);
+
+    log_files.complete();
+    ASSERT_EQ(log_files.downloads.size(), 2u);
+    EXPECT_EQ(log_files.downloads[1].entry.id, 2u);
+    EXPECT_EQ(results.progress.back().entries_done, 1u);
+    EXPECT_EQ(results.progress.back().bytes_done, 10 * BIN_SIZE);
+
+    EXPECT_EQ(results.done_count, 0u);
+    log_files.complete();
+    EXPECT_EQ(results.progress.back().entries_done, 2u);
+    EXPECT_EQ(results.progress.back().bytes_done, 30 * BIN_SIZE);
+
+    ASSERT_EQ(results.done_count, 1u);
+    ASSERT_EQ(results.done.size(), 2u);
+    EXPECT_EQ(results.done[0].result, LogFiles::Result::Success);
+    EXPECT_EQ(results.done[1].result, LogFiles::Result::Success);
+    EXPECT_EQ(results.done[1].path, second_path);
+}
+
+TEST(LogFilesDownloadManager, ResumesAfterTimeout)
+{
+    FakeLogFiles log_files;
+    auto manager = std::make_shared<LogFilesDownloadManagerImpl>(log_files.download_function());
+
+    const auto path = temp_path("timeout");
+    manager->add(make_entry(1, 10 * BIN_SIZE), path);
+
+    Results results;
+    start(*manager, results);
+    log_files.progress(0.3f);
+    log_files.fail(LogFiles::Result::Timeout);
+
+    // The same entry is downloaded again right away.
+    ASSERT_EQ(log_files.downloads.size(), 2u);
+    EXPECT_EQ(log_files.downloads[1].entry.id, 1u);
+    EXPECT_EQ(log_files.downloads[1].path, path);
+    EXPECT_EQ(results.done_count, 0u);
+
+    log_files.complete();
+    ASSERT_EQ(results.done_count, 1u);
+    EXPECT_EQ(results.done[0].result, LogFiles::Result::Success);
+}
+
+TEST(LogFilesDownloadManager, GivesUpAfterMaxRetriesAndResumesOnStart)
+{
+    FakeLogFiles log_files;
+    auto manager = std::make_shared<LogFilesDownloadManagerImpl>(log_files.download_function());
+    manager->set_max_retries(2);
+
+    const auto first_path = temp_path("retries_first");
+    const auto second_path = temp_path("retries_second");
+    manager->add(make_entry(1, 10 * BIN_SIZE), first_path);
+    manager->add(make_entry(2, 10 * BIN_SIZE), second_path);
+
+    Results results;
+    start(*manager, results);
+    log_files.fail(LogFiles::Result::Timeout);
+    log_files.fail(LogFiles::Result::Timeout);
+    log_files.fail(LogFiles::Result::Timeout);
+
+    // Tried three times in total, then it moves on to the next entry.
+    ASSERT_EQ(log_files.downloads.size(), 4u);
+    EXPECT_EQ(log_files.downloads[2].entry.id, 1u);
+    EXPECT_EQ(log_files.downloads[3].entry.id, 2u);
+
+    log_files.complete();
+    ASSERT_EQ(results.done_count, 1u);
+    EXPECT_EQ(results.done[0].result, LogFiles::Result::Timeout);
+    EXPECT_EQ(results.done[1].result, LogFiles::Result::Success);
+
+    // E.g. after a reconnect, only what failed is downloaded again, with retries again.
+    start(*manager, results);
+    ASSERT_EQ(log_files.downloads.size(), 5u);
+    EXPECT_EQ(log_files.downloads[4].entry.id, 1u);
+
+    log_files.fail(LogFiles::Result::Timeout);
+    ASSERT_EQ(log_files.downloads.size(), 6u);
+    EXPECT_EQ(log_files.downloads[5].entry.id, 1u);
+
+    log_files.complete();
+    ASSERT_EQ(results.done_count, 2u);
+    EXPECT_EQ(results.done[0].result, LogFiles::Result::Success);
+    EXPECT_EQ(results.done[1].result, LogFiles::Result::Success);
+    EXPECT_EQ(log_files.downloads.size(), 6u);
+}
+
+TEST(LogFilesDownloadManager, OtherErrorsAreNotRetried)
+{
+    FakeLogFiles log_files;
+    auto manager = std::make_shared<LogFilesDownloadManagerImpl>(log_files.download_function());
+
+    manager->add(make_entry(1, 10 * BIN_SIZE), temp_path("error"));
+
+    Results results;
+    start(*manager, results);
+    log_files.fail(LogFiles::Result::FileOpenFailed);
+
+    EXPECT_EQ(log_files.downloads.size(), 1u);
+    ASSERT_EQ(results.done_count, 1u);
+    EXPECT_EQ(results.done[0].result, LogFiles::Result::FileOpenFailed);
+}
+
+TEST(LogFilesDownloadManager, SkipsCompleteEntries)
+{
+    FakeLogFiles log_files;
+    auto manager = std::make_shared<LogFilesDownloadManagerImpl>(log_files.download_function());
+
+    const auto complete_path = temp_path("complete");
+    const auto partial_path = temp_path("partial");
+    write_file(complete_path, 10 * BIN_SIZE);
+    // Same size, but still being downloaded.
+    write_file(partial_path, 10 * BIN_SIZE);
+    write_file(partial_path + ".part", 5 * BIN_SIZE);
+
+    manager->add(make_entry(1, 10 * BIN_SIZE), complete_path);
+    manager->add(make_entry(2, 10 * BIN_SIZE), partial_path);
+
+    Results results;
+    start(*manager, results);
+
+    ASSERT_EQ(log_files.downloads.size(), 1u);
+    EXPECT_EQ(log_files.downloads[0].entry.id, 2u);
+
+    fs::remove(partial_path + ".part");
+    log_files.complete();
+    ASSERT_EQ(results.done_count, 1u);
+    EXPECT_EQ(results.done[0].result, LogFiles::Result::Success);
+    EXPECT_EQ(results.done[1].result, LogFiles::Result::Success);
+
+    // The file that was already there does not count for the rate.
+    const auto& progress = results.progress.back();
+    EXPECT_EQ(progress.bytes_done, 20 * BIN_SIZE);
+    EXPECT_GT(progress.bytes_per_second, 0.0);
+}
+
+TEST(LogFilesDownloadManager, ResumedBytesDontCountForRate)
+{
+    FakeLogFiles log_files;
+    auto manager = std::make_shared<LogFilesDownloadManagerImpl>(log_files.download_function());
+
+    const auto path = temp_path("journal");
+    const auto entry = make_entry(1, 4 * BIN_SIZE);
+    ASSERT_TRUE(LogDownloadJournal::save(path + ".part.journal", entry, {{0, 2 * BIN_SIZE}}));
+    manager->add(entry, path);
+
+    Results results;
+    const auto before_start = std::chrono::steady_clock::now();
+    start(*manager, results);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    log_files.progress(0.75f);
+    log_files.complete();
+    const double elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - before_start).count();
+
+    ASSERT_EQ(results.done_count, 1u);
+    ASSERT_EQ(results.progress.size(), 2u);
+
+    // The journaled half counts as done right away.
+    EXPECT_EQ(results.progress[0].bytes_done, 3 * BIN_SIZE);
+    EXPECT_EQ(results.progress[1].bytes_done, 4 * BIN_SIZE);
+
+    // Only the other half was downloaded in this session.
+    const double session_bytes = 2 * BIN_SIZE;
+    EXPECT_GE(results.progress[1].bytes_per_second, session_bytes / elapsed_s);
+    EXPECT_LE(results.progress[1].bytes_per_second, session_bytes / 0.05);
+
+    fs::remove(path + ".part.journal");
+}
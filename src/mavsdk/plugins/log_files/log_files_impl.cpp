@@ -1,4 +1,5 @@
 #include "log_files_impl.h"
+#include "log_download_journal.h"
 #include "mavlink_address.h"
 #include "mavsdk_impl.h"
 
@@ -6,6 +7,7 @@
 #include <cmath>
 #include <ctime>
 #include <filesystem>
+#include <system_error>
 
 namespace mavsdk {
 
@@ -15,44 +17,43 @@ LogData::LogData(
     const LogFiles::Entry& e, const std::string& filepath, LogFiles::DownloadLogFileCallback cb) :
     entry(e),
     file_path(filepath),
+    partial_file_path(filepath + ".part"),
+    journal_path(filepath + ".part.journal"),
+    window(e.size_bytes, WINDOW_CHUNKS * CHUNK_SIZE),
     user_callback(cb)
 {
-    // Reset the table
-    chunk_bin_table = std::vector<bool>(bins_in_chunk(), false);
-    file.open(file_path, std::ios::out | std::ios::binary);
-}
+    // Continue where a previous download of the same log stopped.
+    const auto ranges = fs::exists(partial_file_path) ?
+                            LogDownloadJournal::load(journal_path, entry) :
+                            std::nullopt;
 
-bool LogData::file_is_open()
-{
-    // TODO: any other checks?
-    return !(file.rdstate() & std::ofstream::failbit); // Ensure file is writable
-}
+    if (!file.open(partial_file_path, entry.size_bytes, ranges.has_value())) {
+        return;
+    }
 
-uint32_t LogData::total_chunks() const
-{
-    uint32_t partial_chunk = entry.size_bytes % CHUNK_SIZE;
-    uint32_t add_one_chunk = partial_chunk ? 1 : 0;
-    return entry.size_bytes / CHUNK_SIZE + add_one_chunk;
+    if (ranges) {
+        for (const auto& range : ranges.value()) {
+            window.add_range(range.offset, range.count);
+        }
+        journaled_bytes = window.received_bytes();
+        reported_chunks = window.received_bytes() / CHUNK_SIZE;
+        LogInfo() << "Resuming download of " << file_path << " at " << window.received_bytes()
+                  << "/" << entry.size_bytes << " bytes";
+    }
 }
 
-uint32_t LogData::bins_in_chunk() const
+bool LogData::file_is_open()
 {
-    uint32_t size = current_chunk_size();
-    uint32_t add_one_bin = size % MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN ? 1 : 0;
-    return size / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN + add_one_bin;
+    return file.is_open();
 }
 
-uint32_t LogData::current_chunk_size() const
+void LogData::save_journal()
 {
-    uint32_t chunk_size = CHUNK_SIZE;
-    uint32_t chunk_remainder = entry.size_bytes % CHUNK_SIZE;
-    bool is_last_chunk = (current_chunk == total_chunks() - 1);
-    // Last chunk might be less than CHUNK_SIZE
-    if (is_last_chunk && chunk_remainder) {
-        chunk_size = entry.size_bytes % CHUNK_SIZE;
+    if (!file.flush()) {
+        return;
     }
-
-    return chunk_size;
+    LogDownloadJournal::save(journal_path, entry, window.received_ranges());
+    journaled_bytes = window.received_bytes();
 }
 
 LogFilesImpl::LogFilesImpl(System& system) : PluginImplBase(system)
@@ -96,6 +97,12 @@ void LogFilesImpl::deinit()
     {
         std::lock_guard<std::mutex> lock(_download_data_mutex);
         _system_impl->unregister_timeout_handler(_download_data.timeout_cookie);
+
+        // Keep what we have of an unfinished download to resume later.
+        if (_download_data.file_is_open()) {
+            _download_data.save_journal();
+            _download_data.file.close();
+        }
     }
     _system_impl->unregister_all_mavlink_message_handlers(this);
 }
@@ -310,6 +317,14 @@ void LogFilesImpl::download_log_file_async(
         return;
     }
 
+    std::lock_guard<std::mutex> download_lock(_download_data_mutex);
+
+    // A download that is still going on is stopped, it can be resumed later.
+    if (_download_data.file_is_open()) {
+        _system_impl->unregister_timeout_handler(_download_data.timeout_cookie);
+        _download_data.save_journal();
+    }
+
     _download_data = LogData(found_entry, file_path, callback);
 
     if (!_download_data.file_is_open()) {
@@ -321,11 +336,17 @@ void LogFilesImpl::download_log_file_async(
         return;
     }
 
+    if (_download_data.window.complete()) {
+        // Everything was already there from before.
+        finish_download(LogFiles::Result::Success);
+        return;
+    }
+
     _download_data.timeout_cookie = _system_impl->register_timeout_handler(
         [this]() { LogFilesImpl::data_timeout(); }, _system_impl->timeout_s());
 
-    // Request the first chunk
-    request_log_data(_download_data.entry.id, 0, _download_data.current_chunk_size());
+    // Request the first window
+    request_next_log_data();
 }
 
 void LogFilesImpl::process_log_data(const mavlink_message_t& message)
@@ -359,90 +380,58 @@ void LogFilesImpl::process_log_data(const mavlink_message_t& message)
         return;
     }
 
-    // Calculate current chunk
-    const uint32_t chunk = msg.ofs / CHUNK_SIZE;
-
-    if (chunk != _download_data.current_chunk) {
-        // Quietly ignore packets for out of order chunks
-        // LogErr() << "Ignored packet for out of order chunk actual/expected: " << chunk << "/"
-        //          << _download_data.current_chunk;
+    if (!_download_data.file_is_open()) {
+        // Late data, we are already done.
         return;
     }
 
-    // Calculate current bin within the chunk
-    const uint16_t bin = (msg.ofs - chunk * CHUNK_SIZE) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-
-    if (bin >= _download_data.chunk_bin_table.size()) {
-        LogErr() << "Out of range bin received: bin/size: " << bin << "/"
-                 << _download_data.chunk_bin_table.size();
+    // Data of earlier requests is still welcome, it's never requested again then.
+    const auto received = _download_data.window.add(msg.ofs, msg.count);
+    if (received == LogDownloadWindow::Received::Invalid) {
+        LogErr() << "Ignoring invalid data: offset/count: " << msg.ofs << "/" << +msg.count;
         return;
     }
 
-    if (_download_data.file.tellp() != msg.ofs) {
-        if (!_download_data.file.seekp(msg.ofs)) {
-            LogErr() << "Error while seeking to log file offset";
-            return;
-        }
-    }
-
-    _download_data.file.write((char*)msg.data, msg.count);
+    const auto& window = _download_data.window;
 
-    // Mark bin as received (quietly ignore duplicates)
-    _download_data.chunk_bin_table[bin] = true;
+    if (received == LogDownloadWindow::Received::New) {
+        _download_data.timeouts_without_data = 0;
 
-    // Check if all bins in the chunk have been received
-    const uint32_t bins_in_chunk = _download_data.bins_in_chunk();
-    bool chunk_complete = std::all_of(
-        _download_data.chunk_bin_table.begin(),
-        _download_data.chunk_bin_table.begin() + bins_in_chunk,
-        [](bool received) { return received; });
-
-    if (chunk_complete) {
-        uint32_t chunk_bytes = _download_data.current_chunk_size();
-
-        auto result = LogFiles::Result::Next;
+        if (!_download_data.file.write(msg.ofs, msg.data, msg.count)) {
+            LogErr() << "Error while writing log file";
+            finish_download(LogFiles::Result::FileOpenFailed);
+            return;
+        }
 
-        _download_data.current_chunk++;
-        _download_data.total_bytes_written += chunk_bytes;
-        _download_data.chunk_bin_table = std::vector<bool>(_download_data.bins_in_chunk(), false);
+        if (window.received_bytes() - _download_data.journaled_bytes >= JOURNAL_INTERVAL_BYTES) {
+            _download_data.save_journal();
+        }
+    }
 
-        bool log_complete = _download_data.total_bytes_written == _download_data.entry.size_bytes;
+    if (window.complete()) {
+        finish_download(LogFiles::Result::Success);
+        return;
+    }
 
-        if (log_complete) {
-            result = LogFiles::Result::Success;
-            _download_data.file.close();
-            _system_impl->unregister_timeout_handler(_download_data.timeout_cookie);
+    if (window.is_end_of_request(msg.ofs, msg.count)) {
+        // The server is done with the request, continue with gaps or the next window.
+        request_next_log_data();
+    }
 
-        } else {
-            // Request the next chunk
-            request_log_data(
-                _download_data.entry.id,
-                _download_data.current_chunk * CHUNK_SIZE,
-                _download_data.current_chunk_size());
-        }
+    const uint32_t received_chunks = window.received_bytes() / CHUNK_SIZE;
+    if (received_chunks == _download_data.reported_chunks) {
+        return;
+    }
+    _download_data.reported_chunks = received_chunks;
 
-        LogFiles::ProgressData progress_data;
-        progress_data.progress =
-            (float)_download_data.total_bytes_written / (float)_download_data.entry.size_bytes;
+    LogFiles::ProgressData progress_data;
+    progress_data.progress = (float)window.received_bytes() / (float)window.size_bytes();
 
-        // Update progress
-        const auto cb = _download_data.user_callback;
-        if (cb) {
-            _system_impl->call_user_callback(
-                [cb, progress_data, result]() { cb(result, progress_data); });
-        }
-    } else {
-        // Check for missing bins when we might have all bins for this chunk
-        // This handles: receiving the last expected bin AND receiving retried bins that might
-        // complete the chunk
-        if (bins_in_chunk > 0) {
-            const uint32_t expected_last_bin = bins_in_chunk - 1;
-            // Check if this could be the last bin we need (either the expected last one, or a
-            // retried one)
-            if (bin == expected_last_bin || _download_data.chunk_bin_table[expected_last_bin]) {
-                check_and_request_missing_bins();
-            }
-        }
+    // Update progress
+    const auto cb = _download_data.user_callback;
+    if (cb) {
+        _system_impl->call_user_callback(
+            [cb, progress_data]() { cb(LogFiles::Result::Next, progress_data); });
     }
 }
 
@@ -450,53 +439,79 @@ void LogFilesImpl::data_timeout()
 {
     std::lock_guard<std::mutex> lock(_download_data_mutex);
 
+    if (++_download_data.timeouts_without_data >= MAX_DATA_TIMEOUTS) {
+        LogErr() << "Giving up log download after " << MAX_DATA_TIMEOUTS << " timeouts";
+        // The timeout handler is already removed when it fires.
+        _download_data.timeout_cookie = {};
+        finish_download(LogFiles::Result::Timeout);
+        return;
+    }
+
     LogErr() << "Timeout!";
-    LogErr() << "Requesting missing chunk:\t" << _download_data.current_chunk << "/"
-             << _download_data.total_chunks();
+    LogErr() << "Requesting missing data:\t" << _download_data.window.received_bytes() << "/"
+             << _download_data.entry.size_bytes;
 
-    // Don't reset chunk data - preserve what we've received
-    // Instead, request missing ranges based on bin table
-    check_and_request_missing_bins();
+    // Preserve what we've received and request what is missing.
+    _download_data.save_journal();
+    request_next_log_data();
 
     _download_data.timeout_cookie = _system_impl->register_timeout_handler(
         [this]() { LogFilesImpl::data_timeout(); }, _system_impl->timeout_s());
 }
 
-void LogFilesImpl::check_and_request_missing_bins()
+void LogFilesImpl::finish_download(LogFiles::Result result)
 {
     // Note: This function assumes _download_data_mutex is already locked by caller
 
-    // Find missing ranges and request the first one
-    const uint32_t chunk_start = _download_data.current_chunk * CHUNK_SIZE;
-    const uint32_t bins_in_chunk = _download_data.bins_in_chunk();
-
-    uint32_t range_start = 0;
-    bool in_missing_range = false;
-    bool requested_something = false;
-
-    for (uint32_t bin = 0; bin <= bins_in_chunk; ++bin) {
-        bool is_missing = (bin < bins_in_chunk) ? !_download_data.chunk_bin_table[bin] : false;
-
-        if (is_missing && !in_missing_range) {
-            // Start of a missing range
-            range_start = bin;
-            in_missing_range = true;
-        } else if (!is_missing && in_missing_range) {
-            // End of a missing range, request it (but only request the first one)
-            if (!requested_something) {
-                const uint32_t missing_start =
-                    chunk_start + (range_start * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-                const uint32_t missing_count =
-                    (bin - range_start) * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-
-                LogDebug() << "Requesting missing range from offset " << missing_start << " count "
-                           << missing_count;
-                request_log_data(_download_data.entry.id, missing_start, missing_count);
-                requested_something = true;
-            }
-            in_missing_range = false;
+    _system_impl->unregister_timeout_handler(_download_data.timeout_cookie);
+
+    if (result == LogFiles::Result::Success) {
+        std::error_code ec;
+        if (_download_data.file.close()) {
+            fs::rename(_download_data.partial_file_path, _download_data.file_path, ec);
+        } else {
+            ec = std::make_error_code(std::errc::io_error);
+        }
+
+        if (ec) {
+            LogErr() << "Could not complete log file " << _download_data.file_path << ": "
+                     << ec.message();
+            result = LogFiles::Result::FileOpenFailed;
+        } else {
+            LogDownloadJournal::remove(_download_data.journal_path);
+        }
+    } else {
+        // Keep what we have to resume later, unless writing the file failed.
+        if (result == LogFiles::Result::Timeout) {
+            _download_data.save_journal();
         }
+        _download_data.file.close();
+        request_end();
     }
+
+    LogFiles::ProgressData progress_data;
+    progress_data.progress = (float)_download_data.window.received_bytes() /
+                             (float)_download_data.window.size_bytes();
+
+    const auto cb = _download_data.user_callback;
+    if (cb) {
+        _system_impl->call_user_callback(
+            [cb, progress_data, result]() { cb(result, progress_data); });
+    }
+}
+
+void LogFilesImpl::request_next_log_data()
+{
+    // Note: This function assumes _download_data_mutex is already locked by caller
+
+    const auto request = _download_data.window.next_request();
+    if (!request) {
+        return;
+    }
+
+    LogDebug() << "Requesting log data from offset " << request->offset << " count "
+               << request->count;
+    request_log_data(_download_data.entry.id, request->offset, request->count);
 }
 
 void LogFilesImpl::check_and_request_missing_entries()
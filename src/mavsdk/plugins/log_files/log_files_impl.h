@@ -1,10 +1,11 @@
 #pragma once
 
+#include "log_download_window.h"
+#include "log_file_writer.h"
 #include "mavlink_include.h"
 #include "plugins/log_files/log_files.h"
 #include "plugin_impl_base.h"
 #include "system.h"
-#include <fstream>
 #include <optional>
 
 namespace mavsdk {
@@ -13,6 +14,12 @@ namespace mavsdk {
 // sends too much all at once.
 static constexpr uint32_t TABLE_BINS = 128;
 static constexpr uint32_t CHUNK_SIZE = (TABLE_BINS * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+// Chunks requested at once, this still fits into the default UDP receive buffer.
+static constexpr uint32_t WINDOW_CHUNKS = 4;
+// How often the received ranges are saved to the journal, to resume the download later.
+static constexpr uint32_t JOURNAL_INTERVAL_BYTES = 1024 * 1024;
+// Timeouts without any data until the download is given up, it can be resumed later.
+static constexpr uint32_t MAX_DATA_TIMEOUTS = 20;
 
 struct LogData {
     LogData() = default;
@@ -22,19 +29,22 @@ struct LogData {
         LogFiles::DownloadLogFileCallback cb);
 
     bool file_is_open();
-    uint32_t current_chunk_size() const;
-    uint32_t total_chunks() const;
-    uint32_t bins_in_chunk() const;
+    void save_journal();
 
     LogFiles::Entry entry{};
 
+    // Data goes into the partial file first, it's renamed once complete.
     std::string file_path{};
-    std::ofstream file{};
+    std::string partial_file_path{};
+    std::string journal_path{};
+    LogFileWriter file{};
 
-    uint32_t current_chunk{};
-    std::vector<bool> chunk_bin_table{};
+    LogDownloadWindow window{};
+    uint32_t journaled_bytes{};
+    uint32_t timeouts_without_data{};
 
-    uint32_t total_bytes_written{};
+    // Progress is reported for every chunk worth of data received.
+    uint32_t reported_chunks{};
 
     TimeoutHandler::Cookie timeout_cookie{};
 
@@ -72,7 +82,8 @@ private:
 
     void process_log_data(const mavlink_message_t& message);
     void data_timeout();
-    void check_and_request_missing_bins();
+    void request_next_log_data();
+    void finish_download(LogFiles::Result result);
     void check_and_request_missing_entries();
 
     void request_log_list(uint16_t index_min, uint16_t index_max);
@@ -1,4 +1,5 @@
 #include "mavlink_direct_impl.h"
+#include <algorithm>
 #include <mav/Message.h>
 #include <mav/MessageSet.h>
 #include <variant>
@@ -7,12 +8,9 @@
 #include <limits>
 #include "log.h"
 #include "connection.h"
-#include "callback_list.tpp"
 
 namespace mavsdk {
 
-template class CallbackList<MavlinkDirect::MavlinkMessage>;
-
 MavlinkDirectImpl::MavlinkDirectImpl(System& system) : PluginImplBase(system)
 {
     if (const char* env_p = std::getenv("MAVSDK_MAVLINK_DIRECT_DEBUGGING")) {
@@ -39,34 +37,16 @@ MavlinkDirectImpl::~MavlinkDirectImpl()
     _system_impl->unregister_plugin(this);
 }
 
-void MavlinkDirectImpl::init()
-{
-    // Subscribe to all messages from SystemImpl and distribute to internal CallbackList
-    _system_subscription = _system_impl->register_libmav_message_handler(
-        "", // Empty string means all messages
-        [this](const Mavsdk::MavlinkMessage& message) {
-            // Convert Mavsdk::MavlinkMessage to MavlinkDirect::MavlinkMessage
-            MavlinkDirect::MavlinkMessage mavlink_direct_message;
-            mavlink_direct_message.message_name = message.message_name;
-            mavlink_direct_message.system_id = message.system_id;
-            mavlink_direct_message.component_id = message.component_id;
-            mavlink_direct_message.target_system_id = message.target_system_id;
-            mavlink_direct_message.target_component_id = message.target_component_id;
-            mavlink_direct_message.fields_json = message.fields_json;
-
-            // Call callbacks directly, queueing needs to happen in the user APIs
-            _callbacks(mavlink_direct_message);
-        });
-}
+void MavlinkDirectImpl::init() {}
 
 void MavlinkDirectImpl::deinit()
 {
     // Unsubscribe from SystemImpl - this automatically prevents dangling callbacks
-    if (_system_subscription.valid()) {
-        _system_impl->unregister_libmav_message_handler(_system_subscription);
-        _system_subscription = {}; // Reset handle
+    std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+    for (const auto& subscription : _subscriptions) {
+        _system_impl->unregister_libmav_message_handler(subscription);
     }
-    // Internal CallbackList will be automatically cleaned up when destroyed
+    _subscriptions.clear();
 }
 
 void MavlinkDirectImpl::enable() {}
@@ -76,10 +56,10 @@ void MavlinkDirectImpl::disable() {}
 MavlinkDirect::Result MavlinkDirectImpl::send_message(MavlinkDirect::MavlinkMessage message)
 {
     // Get access to the MessageSet through the system
-    auto& message_set = _system_impl->get_message_set();
+    const auto message_set = _system_impl->get_message_set();
 
     // Create libmav message from the message name
-    auto libmav_message_opt = message_set.create(message.message_name);
+    auto libmav_message_opt = message_set->create(message.message_name);
     if (!libmav_message_opt) {
         LogErr() << "Failed to create message: " << message.message_name;
         return MavlinkDirect::Result::InvalidMessage; // Message type not found
@@ -151,35 +131,51 @@ MavlinkDirect::Result MavlinkDirectImpl::send_message(MavlinkDirect::MavlinkMess
 MavlinkDirect::MessageHandle MavlinkDirectImpl::subscribe_message(
     std::string message_name, const MavlinkDirect::MessageCallback& callback)
 {
-    // Add filtering callback to internal CallbackList
-    auto filtering_callback =
-        [this, message_name, callback](const MavlinkDirect::MavlinkMessage& message) {
-            // Apply message filtering (empty string means all messages)
-            if (!message_name.empty() && message_name != message.message_name) {
-                return;
-            }
-
-            // Queue user callback to user callback thread
-            _system_impl->call_user_callback([callback, message]() { callback(message); });
-        };
+    // SystemImpl routes by message ID, so only the subscribers of this message get called,
+    // and messages without any subscriber are not parsed at all.
+    auto system_handle = _system_impl->register_libmav_message_handler(
+        message_name,
+        [this, callback](const std::shared_ptr<const LibmavMessage>& libmav_message) {
+            // All subscribers share the same message, it is only converted when the user
+            // callback is called.
+            _system_impl->call_user_callback([callback, libmav_message]() {
+                const auto& message = libmav_message->message;
+                MavlinkDirect::MavlinkMessage mavlink_direct_message;
+                mavlink_direct_message.message_name = message.message_name;
+                mavlink_direct_message.system_id = message.system_id;
+                mavlink_direct_message.component_id = message.component_id;
+                mavlink_direct_message.target_system_id = message.target_system_id;
+                mavlink_direct_message.target_component_id = message.target_component_id;
+                mavlink_direct_message.fields_json = message.fields_json;
+                callback(mavlink_direct_message);
+            });
+        });
 
-    // Subscribe to internal CallbackList and return handle directly
-    return _callbacks.subscribe(filtering_callback);
+    std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+    _subscriptions.push_back(system_handle);
+    return _handle_factory.convert_from(system_handle);
 }
 
 void MavlinkDirectImpl::unsubscribe_message(MavlinkDirect::MessageHandle handle)
 {
-    // Unregister from internal CallbackList directly
-    _callbacks.unsubscribe(handle);
+    const auto system_handle = _handle_factory.convert_to<Mavsdk::MavlinkMessage>(handle);
+
+    std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+    auto it = std::find(_subscriptions.begin(), _subscriptions.end(), system_handle);
+    if (it == _subscriptions.end()) {
+        return;
+    }
+    _subscriptions.erase(it);
+    _system_impl->unregister_libmav_message_handler(system_handle);
 }
 
 std::optional<uint32_t> MavlinkDirectImpl::message_name_to_id(const std::string& name) const
 {
     // Get MessageSet to access message definitions
-    auto& message_set = _system_impl->get_message_set();
+    const auto message_set = _system_impl->get_message_set();
 
     // Use MessageSet's message name to ID conversion
-    auto id_opt = message_set.idForMessage(name);
+    auto id_opt = message_set->idForMessage(name);
     if (id_opt.has_value()) {
         return static_cast<uint32_t>(id_opt.value());
     }
@@ -190,10 +186,10 @@ std::optional<uint32_t> MavlinkDirectImpl::message_name_to_id(const std::string&
 std::optional<std::string> MavlinkDirectImpl::message_id_to_name(uint32_t id) const
 {
     // Get MessageSet to access message definitions
-    auto& message_set = _system_impl->get_message_set();
+    const auto message_set = _system_impl->get_message_set();
 
     // Use MessageSet's message ID to name conversion
-    auto message_def = message_set.getMessageDefinition(static_cast<int>(id));
+    auto message_def = message_set->getMessageDefinition(static_cast<int>(id));
     if (message_def) {
         return message_def.get().name();
     }
@@ -3,13 +3,14 @@
 #include "plugins/mavlink_direct/mavlink_direct.h"
 
 #include "plugin_impl_base.h"
-#include "callback_list.h"
+#include "handle_factory.h"
 
 #include <json/json.h>
 #include <mav/Message.h>
 #include <optional>
 #include <map>
 #include <mutex>
+#include <vector>
 
 namespace mavsdk {
 
@@ -36,9 +37,10 @@ public:
     MavlinkDirect::Result load_custom_xml(const std::string& xml_content);
 
 private:
-    // Internal callback management
-    CallbackList<MavlinkDirect::MavlinkMessage> _callbacks{};
-    Handle<Mavsdk::MavlinkMessage> _system_subscription{};
+    // Our handles use the same IDs as the SystemImpl handles.
+    HandleFactory<MavlinkDirect::MavlinkMessage> _handle_factory{};
+    std::vector<Handle<Mavsdk::MavlinkMessage>> _subscriptions{};
+    std::mutex _subscriptions_mutex{};
 
     bool _debugging = false;
 
@@ -0,0 +1,405 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "plugin_base.h"
+#include "handle.h"
+
+namespace mavsdk {
+
+class System;
+class MavlinkDirectBinaryImpl;
+
+/**
+ * @brief The MavlinkDirectBinary class provides typed access to MAVLink message fields.
+ *
+ * This is an alternative to the JSON representation used by MavlinkDirect, for
+ * high rate messages where converting every message to and from JSON is too costly.
+ *
+ * Message types and fields are resolved by name once, using the same message
+ * definitions as MavlinkDirect, including the ones loaded with load_custom_xml().
+ * The resolved Field is then used to read from received messages without copying
+ * the payload, and to write directly into messages to send.
+ */
+class MavlinkDirectBinary : public PluginBase {
+public:
+    /**
+     * @brief Constructor. Creates the plugin for a specific System.
+     *
+     * The plugin is typically created as shown below:
+     *
+     *     ```cpp
+     *     auto mavlink_direct_binary = MavlinkDirectBinary(system);
+     *     ```
+     *
+     * @param system The specific system associated with this plugin.
+     */
+    explicit MavlinkDirectBinary(System& system); // deprecated
+
+    /**
+     * @brief Constructor. Creates the plugin for a specific System.
+     *
+     * The plugin is typically created as shown below:
+     *
+     *     ```cpp
+     *     auto mavlink_direct_binary = MavlinkDirectBinary(system);
+     *     ```
+     *
+     * @param system The specific system associated with this plugin.
+     */
+    explicit MavlinkDirectBinary(std::shared_ptr<System> system); // new
+
+    /**
+     * @brief Destructor (internal use only).
+     */
+    ~MavlinkDirectBinary();
+
+    /**
+     * @brief Possible results returned for requests.
+     */
+    enum class Result {
+        Unknown, /**< @brief Unknown error. */
+        Success, /**< @brief Success. */
+        Error, /**< @brief Error. */
+        InvalidMessage, /**< @brief Message type not found. */
+        InvalidField, /**< @brief Field not found, or of a different type or message. */
+    };
+
+    /**
+     * @brief Stream operator to print information about a `MavlinkDirectBinary::Result`.
+     *
+     * @return A reference to the stream.
+     */
+    friend std::ostream& operator<<(std::ostream& str, MavlinkDirectBinary::Result const& result);
+
+    /**
+     * @brief Type of a field as defined in the message definition.
+     */
+    enum class FieldType {
+        Unknown, /**< @brief Unknown type. */
+        Uint8, /**< @brief uint8_t. */
+        Int8, /**< @brief int8_t. */
+        Uint16, /**< @brief uint16_t. */
+        Int16, /**< @brief int16_t. */
+        Uint32, /**< @brief uint32_t. */
+        Int32, /**< @brief int32_t. */
+        Uint64, /**< @brief uint64_t. */
+        Int64, /**< @brief int64_t. */
+        Float, /**< @brief float. */
+        Double, /**< @brief double. */
+        Char, /**< @brief char, used for strings. */
+    };
+
+    /**
+     * @brief A message type, resolved by name using resolve_message().
+     */
+    struct MessageType {
+        uint32_t id{0}; /**< @brief Message ID. */
+        std::string name{}; /**< @brief Message name. */
+        uint8_t max_payload_length{0}; /**< @brief Payload length including extensions. */
+        uint8_t crc_extra{0}; /**< @brief CRC extra byte of the message definition. */
+    };
+
+    /**
+     * @brief A field of a message type, resolved by name using resolve_field().
+     */
+    struct Field {
+        uint32_t message_id{0}; /**< @brief ID of the message the field belongs to. */
+        uint8_t offset{0}; /**< @brief Offset of the field in the payload. */
+        FieldType type{FieldType::Unknown}; /**< @brief Type of the field. */
+        uint8_t array_length{1}; /**< @brief Number of elements, 1 if it's not an array. */
+    };
+
+    /**
+     * @brief Typed read access to a received message.
+     *
+     * The view points directly into the received payload and is only valid for the
+     * duration of the callback it is passed to.
+     */
+    class MessageView {
+    public:
+        /**
+         * @brief Create a view of a payload (internal use only).
+         */
+        MessageView(
+            uint32_t message_id,
+            uint8_t system_id,
+            uint8_t component_id,
+            const uint8_t* payload,
+            uint8_t payload_length) :
+            _message_id(message_id),
+            _system_id(system_id),
+            _component_id(component_id),
+            _payload(payload),
+            _payload_length(payload_length)
+        {}
+
+        /**
+         * @brief ID of the message.
+         */
+        uint32_t message_id() const { return _message_id; }
+
+        /**
+         * @brief System ID of the sender.
+         */
+        uint8_t system_id() const { return _system_id; }
+
+        /**
+         * @brief Component ID of the sender.
+         */
+        uint8_t component_id() const { return _component_id; }
+
+        /**
+         * @brief Length of the payload as received, trailing zeros are truncated by MAVLink 2.
+         */
+        uint8_t payload_length() const { return _payload_length; }
+
+        /**
+         * @brief Read a field (or one element of an array field).
+         *
+         * The type T has to match the type of the field exactly.
+         *
+         * @param field The field as resolved by resolve_field().
+         * @param index The element of an array field.
+         *
+         * @return The value, or nothing if the field doesn't match this message or T.
+         */
+        template<typename T> std::optional<T> get(const Field& field, unsigned index = 0) const
+        {
+            if (field.message_id != _message_id || !is_type<T>(field.type) ||
+                index >= field.array_length) {
+                return std::nullopt;
+            }
+            T value;
+            std::memcpy(&value, _payload + field.offset + index * sizeof(T), sizeof(T));
+            return value;
+        }
+
+        /**
+         * @brief Read a char array field as string.
+         *
+         * @param field The field as resolved by resolve_field().
+         *
+         * @return The string up to the first null character, or nothing if the field doesn't
+         *         match this message or is not a char field.
+         */
+        std::optional<std::string> get_string(const Field& field) const
+        {
+            if (field.message_id != _message_id || field.type != FieldType::Char) {
+                return std::nullopt;
+            }
+            const auto* begin = reinterpret_cast<const char*>(_payload + field.offset);
+            size_t length = 0;
+            while (length < field.array_length && begin[length] != '\0') {
+                ++length;
+            }
+            return std::string(begin, length);
+        }
+
+    private:
+        uint32_t _message_id;
+        uint8_t _system_id;
+        uint8_t _component_id;
+        // Zero padded up to the maximum payload length.
+        const uint8_t* _payload;
+        uint8_t _payload_length;
+    };
+
+    /**
+     * @brief Typed write access to a message to send.
+     */
+    class MessageBuilder {
+    public:
+        /**
+         * @brief Create an empty message (all fields 0).
+         *
+         * @param message_type The message type as resolved by resolve_message().
+         */
+        explicit MessageBuilder(MessageType message_type) :
+            _message_type(std::move(message_type))
+        {}
+
+        /**
+         * @brief Write a field (or one element of an array field).
+         *
+         * The type T has to match the type of the field exactly.
+         *
+         * @param field The field as resolved by resolve_field().
+         * @param value The value to write.
+         * @param index The element of an array field.
+         *
+         * @return Result::InvalidField if the field doesn't match this message or T.
+         */
+        template<typename T> Result set(const Field& field, T value, unsigned index = 0)
+        {
+            if (field.message_id != _message_type.id || !is_type<T>(field.type) ||
+                index >= field.array_length) {
+                return Result::InvalidField;
+            }
+            std::memcpy(_payload.data() + field.offset + index * sizeof(T), &value, sizeof(T));
+            return Result::Success;
+        }
+
+        /**
+         * @brief Write a char array field from a string.
+         *
+         * The string is null terminated if it is shorter than the field.
+         *
+         * @param field The field as resolved by resolve_field().
+         * @param value The string to write.
+         *
+         * @return Result::InvalidField if the field doesn't match this message, is not a char
+         *         field, or the string is too long.
+         */
+        Result set_string(const Field& field, const std::string& value)
+        {
+            if (field.message_id != _message_type.id || field.type != FieldType::Char ||
+                value.size() > field.array_length) {
+                return Result::InvalidField;
+            }
+            auto* begin = _payload.data() + field.offset;
+            std::memset(begin, 0, field.array_length);
+            std::memcpy(begin, value.data(), value.size());
+            return Result::Success;
+        }
+
+        /**
+         * @brief The message type of this message.
+         */
+        const MessageType& message_type() const { return _message_type; }
+
+        /**
+         * @brief The payload, of length MessageType::max_payload_length.
+         */
+        const uint8_t* payload() const { return _payload.data(); }
+
+    private:
+        MessageType _message_type;
+        std::array<uint8_t, 255> _payload{};
+    };
+
+    /**
+     * @brief Resolve a message type by name.
+     *
+     * @param message_name Name of the message, e.g. "ATTITUDE".
+     *
+     * @return Result::InvalidMessage if the message is not known, and the message type.
+     */
+    std::pair<Result, MessageType> resolve_message(const std::string& message_name) const;
+
+    /**
+     * @brief Resolve a field of a message type by name.
+     *
+     * @param message_type The message type as resolved by resolve_message().
+     * @param field_name Name of the field, e.g. "roll".
+     *
+     * @return Result::InvalidField if the field is not known, and the field.
+     */
+    std::pair<Result, Field>
+    resolve_field(const MessageType& message_type, const std::string& field_name) const;
+
+    /**
+     * @brief Send a message.
+     *
+     * @param message The message to send.
+     *
+     * @return result of the request.
+     */
+    Result send_message(const MessageBuilder& message);
+
+    /**
+     * @brief Callback type for message subscriptions.
+     */
+    using MessageCallback = std::function<void(const MessageView&)>;
+
+    /**
+     * @brief Handle type for subscribe_message.
+     */
+    using MessageHandle = Handle<const MessageView&>;
+
+    /**
+     * @brief Subscribe to a message type.
+     *
+     * The fields of messages received for binary subscriptions only are not converted to JSON.
+     *
+     * @param message_type The message type as resolved by resolve_message().
+     * @param callback Callback to be called for every message received.
+     *
+     * @return Handle to unsubscribe again.
+     */
+    MessageHandle
+    subscribe_message(const MessageType& message_type, const MessageCallback& callback);
+
+    /**
+     * @brief Unsubscribe from subscribe_message.
+     *
+     * @param handle The handle returned from subscribe_message.
+     */
+    void unsubscribe_message(MessageHandle handle);
+
+    /**
+     * @brief Load custom MAVLink message definitions from XML.
+     *
+     * The definitions are shared with MavlinkDirect. Message types and fields have to be
+     * resolved after loading.
+     *
+     * @param xml_content The XML content of the message definitions.
+     *
+     * @return result of the request.
+     */
+    Result load_custom_xml(const std::string& xml_content);
+
+    /**
+     * @brief Copy Constructor (object is not copyable).
+     */
+    MavlinkDirectBinary(const MavlinkDirectBinary&) = delete;
+
+    /**
+     * @brief Equality operator (object is not copyable).
+     */
+    const MavlinkDirectBinary& operator=(const MavlinkDirectBinary&) = delete;
+
+private:
+    template<typename T> static constexpr bool is_type(FieldType type)
+    {
+        if constexpr (std::is_same_v<T, uint8_t>) {
+            return type == FieldType::Uint8;
+        } else if constexpr (std::is_same_v<T, int8_t>) {
+            return type == FieldType::Int8;
+        } else if constexpr (std::is_same_v<T, uint16_t>) {
+            return type == FieldType::Uint16;
+        } else if constexpr (std::is_same_v<T, int16_t>) {
+            return type == FieldType::Int16;
+        } else if constexpr (std::is_same_v<T, uint32_t>) {
+            return type == FieldType::Uint32;
+        } else if constexpr (std::is_same_v<T, int32_t>) {
+            return type == FieldType::Int32;
+        } else if constexpr (std::is_same_v<T, uint64_t>) {
+            return type == FieldType::Uint64;
+        } else if constexpr (std::is_same_v<T, int64_t>) {
+            return type == FieldType::Int64;
+        } else if constexpr (std::is_same_v<T, float>) {
+            return type == FieldType::Float;
+        } else if constexpr (std::is_same_v<T, double>) {
+            return type == FieldType::Double;
+        } else if constexpr (std::is_same_v<T, char>) {
+            return type == FieldType::Char;
+        } else {
+            return false;
+        }
+    }
+
+    /** @private Underlying implementation, set at instantiation */
+    std::unique_ptr<MavlinkDirectBinaryImpl> _impl;
+};
+
+} // namespace mavsdk
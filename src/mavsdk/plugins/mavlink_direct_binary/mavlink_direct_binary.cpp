@@ -0,0 +1,70 @@
+#include "plugins/mavlink_direct_binary/mavlink_direct_binary.h"
+#include "mavlink_direct_binary_impl.h"
+
+namespace mavsdk {
+
+MavlinkDirectBinary::MavlinkDirectBinary(System& system) :
+    PluginBase(),
+    _impl{std::make_unique<MavlinkDirectBinaryImpl>(system)}
+{}
+
+MavlinkDirectBinary::MavlinkDirectBinary(std::shared_ptr<System> system) :
+    PluginBase(),
+    _impl{std::make_unique<MavlinkDirectBinaryImpl>(system)}
+{}
+
+MavlinkDirectBinary::~MavlinkDirectBinary() {}
+
+std::pair<MavlinkDirectBinary::Result, MavlinkDirectBinary::MessageType>
+MavlinkDirectBinary::resolve_message(const std::string& message_name) const
+{
+    return _impl->resolve_message(message_name);
+}
+
+std::pair<MavlinkDirectBinary::Result, MavlinkDirectBinary::Field>
+MavlinkDirectBinary::resolve_field(
+    const MessageType& message_type, const std::string& field_name) const
+{
+    return _impl->resolve_field(message_type, field_name);
+}
+
+MavlinkDirectBinary::Result MavlinkDirectBinary::send_message(const MessageBuilder& message)
+{
+    return _impl->send_message(message);
+}
+
+MavlinkDirectBinary::MessageHandle MavlinkDirectBinary::subscribe_message(
+    const MessageType& message_type, const MessageCallback& callback)
+{
+    return _impl->subscribe_message(message_type, callback);
+}
+
+void MavlinkDirectBinary::unsubscribe_message(MessageHandle handle)
+{
+    _impl->unsubscribe_message(handle);
+}
+
+MavlinkDirectBinary::Result MavlinkDirectBinary::load_custom_xml(const std::string& xml_content)
+{
+    return _impl->load_custom_xml(xml_content);
+}
+
+std::ostream& operator<<(std::ostream& str, MavlinkDirectBinary::Result const& result)
+{
+    switch (result) {
+        default:
+        // FALLTHROUGH
+        case MavlinkDirectBinary::Result::Unknown:
+            return str << "Unknown";
+        case MavlinkDirectBinary::Result::Success:
+            return str << "Success";
+        case MavlinkDirectBinary::Result::Error:
+            return str << "Error";
+        case MavlinkDirectBinary::Result::InvalidMessage:
+            return str << "Invalid Message";
+        case MavlinkDirectBinary::Result::InvalidField:
+            return str << "Invalid Field";
+    }
+}
+
+} // namespace mavsdk
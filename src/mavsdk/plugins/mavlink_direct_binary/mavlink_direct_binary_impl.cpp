@@ -0,0 +1,212 @@
+#include "mavlink_direct_binary_impl.h"
+#include <algorithm>
+#include <cstring>
+#include <mav/MessageSet.h>
+#include "log.h"
+
+namespace mavsdk {
+
+namespace {
+
+MavlinkDirectBinary::FieldType to_field_type(mav::FieldType::BaseType base_type)
+{
+    switch (base_type) {
+        case mav::FieldType::BaseType::UINT8:
+            return MavlinkDirectBinary::FieldType::Uint8;
+        case mav::FieldType::BaseType::INT8:
+            return MavlinkDirectBinary::FieldType::Int8;
+        case mav::FieldType::BaseType::UINT16:
+            return MavlinkDirectBinary::FieldType::Uint16;
+        case mav::FieldType::BaseType::INT16:
+            return MavlinkDirectBinary::FieldType::Int16;
+        case mav::FieldType::BaseType::UINT32:
+            return MavlinkDirectBinary::FieldType::Uint32;
+        case mav::FieldType::BaseType::INT32:
+            return MavlinkDirectBinary::FieldType::Int32;
+        case mav::FieldType::BaseType::UINT64:
+            return MavlinkDirectBinary::FieldType::Uint64;
+        case mav::FieldType::BaseType::INT64:
+            return MavlinkDirectBinary::FieldType::Int64;
+        case mav::FieldType::BaseType::FLOAT:
+            return MavlinkDirectBinary::FieldType::Float;
+        case mav::FieldType::BaseType::DOUBLE:
+            return MavlinkDirectBinary::FieldType::Double;
+        case mav::FieldType::BaseType::CHAR:
+            return MavlinkDirectBinary::FieldType::Char;
+        default:
+            return MavlinkDirectBinary::FieldType::Unknown;
+    }
+}
+
+} // namespace
+
+MavlinkDirectBinaryImpl::MavlinkDirectBinaryImpl(System& system) : PluginImplBase(system)
+{
+    _system_impl->register_plugin(this);
+}
+
+MavlinkDirectBinaryImpl::MavlinkDirectBinaryImpl(std::shared_ptr<System> system) :
+    PluginImplBase(std::move(system))
+{
+    _system_impl->register_plugin(this);
+}
+
+MavlinkDirectBinaryImpl::~MavlinkDirectBinaryImpl()
+{
+    _system_impl->unregister_plugin(this);
+}
+
+void MavlinkDirectBinaryImpl::init() {}
+
+void MavlinkDirectBinaryImpl::deinit()
+{
+    std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+    for (const auto& subscription : _subscriptions) {
+        _system_impl->unregister_libmav_message_handler(subscription);
+    }
+    _subscriptions.clear();
+}
+
+void MavlinkDirectBinaryImpl::enable() {}
+
+void MavlinkDirectBinaryImpl::disable() {}
+
+std::pair<MavlinkDirectBinary::Result, MavlinkDirectBinary::MessageType>
+MavlinkDirectBinaryImpl::resolve_message(const std::string& message_name) const
+{
+    // The message set is replaced when custom XML is loaded, so we resolve everything
+    // we need here once, instead of keeping the definition.
+    const auto message_set = _system_impl->get_message_set();
+
+    const auto message_id = message_set->idForMessage(message_name);
+    if (!message_id) {
+        LogWarn() << "Unknown message: " << message_name;
+        return {MavlinkDirectBinary::Result::InvalidMessage, {}};
+    }
+
+    auto definition = message_set->getMessageDefinition(message_id.value());
+    if (!definition) {
+        return {MavlinkDirectBinary::Result::InvalidMessage, {}};
+    }
+
+    MavlinkDirectBinary::MessageType message_type;
+    message_type.id = static_cast<uint32_t>(message_id.value());
+    message_type.name = definition.get().name();
+    message_type.max_payload_length = static_cast<uint8_t>(definition.get().maxPayloadSize());
+    message_type.crc_extra = static_cast<uint8_t>(definition.get().crcExtra());
+
+    return {MavlinkDirectBinary::Result::Success, message_type};
+}
+
+std::pair<MavlinkDirectBinary::Result, MavlinkDirectBinary::Field>
+MavlinkDirectBinaryImpl::resolve_field(
+    const MavlinkDirectBinary::MessageType& message_type, const std::string& field_name) const
+{
+    const auto message_set = _system_impl->get_message_set();
+
+    auto definition = message_set->getMessageDefinition(static_cast<int>(message_type.id));
+    if (!definition) {
+        return {MavlinkDirectBinary::Result::InvalidMessage, {}};
+    }
+
+    const auto field_opt = definition.get().getField(field_name);
+    if (!field_opt) {
+        LogWarn() << "Field " << field_name << " not found in " << message_type.name;
+        return {MavlinkDirectBinary::Result::InvalidField, {}};
+    }
+
+    const auto& mav_field = field_opt.value();
+
+    MavlinkDirectBinary::Field field;
+    field.message_id = message_type.id;
+    field.offset = static_cast<uint8_t>(mav_field.offset);
+    field.type = to_field_type(mav_field.type.base_type);
+    field.array_length = static_cast<uint8_t>(std::max(mav_field.type.size, 1));
+
+    if (field.type == MavlinkDirectBinary::FieldType::Unknown) {
+        return {MavlinkDirectBinary::Result::InvalidField, {}};
+    }
+
+    return {MavlinkDirectBinary::Result::Success, field};
+}
+
+MavlinkDirectBinary::Result
+MavlinkDirectBinaryImpl::send_message(const MavlinkDirectBinary::MessageBuilder& message)
+{
+    const auto& message_type = message.message_type();
+    if (message_type.max_payload_length == 0) {
+        return MavlinkDirectBinary::Result::InvalidMessage;
+    }
+
+    const bool queued =
+        _system_impl->queue_message([&](MavlinkAddress mavlink_address, uint8_t channel) {
+            mavlink_message_t mavlink_message;
+            mavlink_message.msgid = message_type.id;
+            std::memcpy(
+                mavlink_message.payload64, message.payload(), message_type.max_payload_length);
+
+            // Trailing zeros are truncated by finalize.
+            mavlink_finalize_message_chan(
+                &mavlink_message,
+                mavlink_address.system_id,
+                mavlink_address.component_id,
+                channel,
+                message_type.max_payload_length,
+                message_type.max_payload_length,
+                message_type.crc_extra);
+
+            return mavlink_message;
+        });
+
+    return queued ? MavlinkDirectBinary::Result::Success : MavlinkDirectBinary::Result::Error;
+}
+
+MavlinkDirectBinary::MessageHandle MavlinkDirectBinaryImpl::subscribe_message(
+    const MavlinkDirectBinary::MessageType& message_type,
+    const MavlinkDirectBinary::MessageCallback& callback)
+{
+    // Only the payload is used, so the message is not converted to JSON for us.
+    auto system_handle = _system_impl->register_libmav_payload_handler(
+        message_type.name,
+        [this, callback](const std::shared_ptr<const LibmavMessage>& libmav_message) {
+            // The message is shared with the other subscribers, the view points into it.
+            _system_impl->call_user_callback([callback, libmav_message]() {
+                const MavlinkDirectBinary::MessageView view(
+                    libmav_message->message_id,
+                    static_cast<uint8_t>(libmav_message->message.system_id),
+                    static_cast<uint8_t>(libmav_message->message.component_id),
+                    libmav_message->payload.data(),
+                    libmav_message->payload_length);
+                callback(view);
+            });
+        });
+
+    std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+    _subscriptions.push_back(system_handle);
+    return _handle_factory.convert_from(system_handle);
+}
+
+void MavlinkDirectBinaryImpl::unsubscribe_message(MavlinkDirectBinary::MessageHandle handle)
+{
+    const auto system_handle = _handle_factory.convert_to<Mavsdk::MavlinkMessage>(handle);
+
+    std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+    auto it = std::find(_subscriptions.begin(), _subscriptions.end(), system_handle);
+    if (it == _subscriptions.end()) {
+        return;
+    }
+    _subscriptions.erase(it);
+    _system_impl->unregister_libmav_message_handler(system_handle);
+}
+
+MavlinkDirectBinary::Result MavlinkDirectBinaryImpl::load_custom_xml(const std::string& xml_content)
+{
+    if (!_system_impl->load_custom_xml_to_message_set(xml_content)) {
+        LogErr() << "Failed to load custom XML definitions";
+        return MavlinkDirectBinary::Result::Error;
+    }
+
+    return MavlinkDirectBinary::Result::Success;
+}
+
+} // namespace mavsdk
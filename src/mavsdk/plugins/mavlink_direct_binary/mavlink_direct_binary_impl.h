@@ -0,0 +1,47 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "plugins/mavlink_direct_binary/mavlink_direct_binary.h"
+#include "plugin_impl_base.h"
+#include "handle_factory.h"
+
+namespace mavsdk {
+
+class MavlinkDirectBinaryImpl : public PluginImplBase {
+public:
+    explicit MavlinkDirectBinaryImpl(System& system);
+    explicit MavlinkDirectBinaryImpl(std::shared_ptr<System> system);
+    ~MavlinkDirectBinaryImpl() override;
+
+    void init() override;
+    void deinit() override;
+
+    void enable() override;
+    void disable() override;
+
+    std::pair<MavlinkDirectBinary::Result, MavlinkDirectBinary::MessageType>
+    resolve_message(const std::string& message_name) const;
+
+    std::pair<MavlinkDirectBinary::Result, MavlinkDirectBinary::Field> resolve_field(
+        const MavlinkDirectBinary::MessageType& message_type, const std::string& field_name) const;
+
+    MavlinkDirectBinary::Result send_message(const MavlinkDirectBinary::MessageBuilder& message);
+
+    MavlinkDirectBinary::MessageHandle subscribe_message(
+        const MavlinkDirectBinary::MessageType& message_type,
+        const MavlinkDirectBinary::MessageCallback& callback);
+
+    void unsubscribe_message(MavlinkDirectBinary::MessageHandle handle);
+
+    MavlinkDirectBinary::Result load_custom_xml(const std::string& xml_content);
+
+private:
+    // Our handles use the same IDs as the SystemImpl handles.
+    HandleFactory<const MavlinkDirectBinary::MessageView&> _handle_factory{};
+    std::vector<Handle<Mavsdk::MavlinkMessage>> _subscriptions{};
+    std::mutex _subscriptions_mutex{};
+};
+
+} // namespace mavsdk
@@ -1,7 +1,9 @@
+#include "log.h"
 #include "mavsdk.h"
 #include "plugins/camera/camera.h"
 #include "plugins/camera_server/camera_server.h"
 #include "plugins/ftp_server/ftp_server.h"
+#include <chrono>
 #include <future>
 #include <mutex>
 #include <thread>
@@ -290,3 +292,87 @@ TEST(SystemTest, CameraSettingsAsync)
 
     EXPECT_EQ(fut_found_exp_absolute.wait_for(std::chrono::seconds(1)), std::future_status::ready);
 }
+
+TEST(SystemTest, CameraSettingsTimeToComplete)
+{
+    Mavsdk mavsdk_groundstation{Mavsdk::Configuration{ComponentType::GroundStation}};
+    Mavsdk mavsdk_camera{Mavsdk::Configuration{ComponentType::Camera}};
+
+    ASSERT_EQ(
+        mavsdk_groundstation.add_any_connection("udpin://0.0.0.0:17000"),
+        ConnectionResult::Success);
+    ASSERT_EQ(
+        mavsdk_camera.add_any_connection("udpout://127.0.0.1:17000"), ConnectionResult::Success);
+
+    auto ftp_server = FtpServer{mavsdk_camera.server_component()};
+
+    EXPECT_EQ(ftp_server.set_root_dir("src/mavsdk/plugins/camera/"), FtpServer::Result::Success);
+
+    auto camera_server = CameraServer{mavsdk_camera.server_component()};
+
+    CameraServer::Information information{};
+    information.vendor_name = "UVC";
+    information.model_name = "Logitech C270HD Webcam";
+    information.firmware_version = "4.0.0";
+    information.definition_file_version = 2;
+    information.definition_file_uri = "mavlinkftp://uvc_camera.xml";
+    EXPECT_EQ(camera_server.set_information(information), CameraServer::Result::Success);
+
+    auto param_server = ParamServer{mavsdk_camera.server_component()};
+    EXPECT_EQ(param_server.provide_param_int("CAM_MODE", 0), ParamServer::Result::Success);
+    EXPECT_EQ(param_server.provide_param_int("BRIGHTNESS", 100), ParamServer::Result::Success);
+    EXPECT_EQ(param_server.provide_param_int("CONTRAST", 32), ParamServer::Result::Success);
+    EXPECT_EQ(param_server.provide_param_int("SATURATION", 32), ParamServer::Result::Success);
+    EXPECT_EQ(param_server.provide_param_int("GAIN", 64), ParamServer::Result::Success);
+    EXPECT_EQ(param_server.provide_param_int("SHARPNESS", 24), ParamServer::Result::Success);
+    EXPECT_EQ(param_server.provide_param_int("BACKLIGHT", 0), ParamServer::Result::Success);
+    EXPECT_EQ(param_server.provide_param_int("POWER_MODE", 0), ParamServer::Result::Success);
+    EXPECT_EQ(param_server.provide_param_int("WB_MODE", 0), ParamServer::Result::Success);
+    EXPECT_EQ(param_server.provide_param_int("EXP_MODE", 3), ParamServer::Result::Success);
+    EXPECT_EQ(param_server.provide_param_int("EXP_ABSOLUTE", 166), ParamServer::Result::Success);
+    EXPECT_EQ(param_server.provide_param_int("WB_TEMP", 5000), ParamServer::Result::Success);
+    EXPECT_EQ(param_server.provide_param_int("EXP_PRIORITY", 1), ParamServer::Result::Success);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    auto system = [&]() -> std::shared_ptr<System> {
+        for (unsigned i = 0; i < 30; ++i) {
+            for (auto& candidate : mavsdk_groundstation.systems()) {
+                if (candidate->is_connected() && candidate->has_camera()) {
+                    return candidate;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        return nullptr;
+    }();
+    ASSERT_NE(system, nullptr);
+
+    auto camera = Camera{system};
+
+    // The settings are complete once every param of the definition is known, the one
+    // we check for is not the default.
+    std::pair<Camera::Result, Camera::Setting> brightness;
+    for (unsigned i = 0; i < 500; ++i) {
+        if (camera.camera_list().cameras.size() == 1) {
+            brightness = camera.get_setting(
+                camera.camera_list().cameras[0].component_id, Camera::Setting{"BRIGHTNESS"});
+            const auto current_settings =
+                camera.get_current_settings(camera.camera_list().cameras[0].component_id);
+            if (brightness.first == Camera::Result::Success &&
+                brightness.second.option.option_id == "100" &&
+                current_settings.first == Camera::Result::Success &&
+                current_settings.second.size() == 11) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    const auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    EXPECT_EQ(brightness.first, Camera::Result::Success);
+    EXPECT_EQ(brightness.second.option.option_id, "100");
+
+    LogInfo() << "Camera settings complete after " << duration.count() << " s";
+}
@@ -2,6 +2,7 @@
 #include <fstream>
 #include <vector>
 #include <atomic>
+#include <chrono>
 #include <future>
 #include <thread>
 
@@ -229,4 +230,60 @@ TEST(SystemTest, ComponentInformationConnect)
     ASSERT_TRUE(received_events) << "timeout, metadata not received";
     ASSERT_TRUE(received_parameters) << "timeout, metadata not received";
     ASSERT_TRUE(all_completed) << "timeout, metadata not received";
-}
\ No newline at end of file
+}
+
+TEST(SystemTest, ComponentMetadataTimeToReady)
+{
+    Mavsdk mavsdk_groundstation{Mavsdk::Configuration{ComponentType::GroundStation}};
+    ASSERT_EQ(
+        mavsdk_groundstation.add_any_connection("udpin://0.0.0.0:17000"),
+        ConnectionResult::Success);
+
+    Mavsdk mavsdk_companion{Mavsdk::Configuration{ComponentType::CompanionComputer}};
+    ASSERT_EQ(
+        mavsdk_companion.add_any_connection("udpout://127.0.0.1:17000"), ConnectionResult::Success);
+
+    auto prom = std::promise<std::shared_ptr<System>>();
+    std::once_flag flag;
+    mavsdk_groundstation.subscribe_on_new_system([&]() {
+        std::call_once(flag, [&prom, &mavsdk_groundstation]() {
+            prom.set_value(mavsdk_groundstation.systems().at(0));
+        });
+    });
+    auto fut = prom.get_future();
+    ASSERT_EQ(fut.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    auto system = fut.get();
+
+    auto server = ComponentMetadataServer{mavsdk_companion.server_component()};
+    std::vector<ComponentMetadataServer::Metadata> metadata;
+    metadata.push_back(
+        {ComponentMetadataServer::MetadataType::Parameter, std::string(parameter_json_metadata)});
+    metadata.push_back(
+        {ComponentMetadataServer::MetadataType::Events, std::string(events_json_metadata)});
+    server.set_metadata(metadata);
+
+    auto all_completed_prom = std::promise<void>();
+    auto all_completed_fut = all_completed_prom.get_future();
+    std::once_flag all_completed_flag;
+    std::atomic<int> received_types{0};
+
+    auto client = ComponentMetadata{system};
+    client.subscribe_metadata_available([&](ComponentMetadata::MetadataUpdate data) {
+        if (data.type == ComponentMetadata::MetadataType::AllCompleted) {
+            std::call_once(all_completed_flag, [&]() { all_completed_prom.set_value(); });
+        } else {
+            ++received_types;
+        }
+    });
+
+    // Time from the request until all metadata types are ready to be used.
+    const auto start = std::chrono::steady_clock::now();
+    client.request_component(MAV_COMP_ID_ONBOARD_COMPUTER);
+
+    ASSERT_EQ(all_completed_fut.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    LogInfo() << "Component metadata ready after " << duration.count() << " ms";
+
+    EXPECT_EQ(received_types, 2);
+}
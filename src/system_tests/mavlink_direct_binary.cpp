@@ -0,0 +1,161 @@
+#include "log.h"
+#include "mavsdk.h"
+#include "plugins/mavlink_direct_binary/mavlink_direct_binary.h"
+#include <chrono>
+#include <thread>
+#include <future>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(SystemTest, MavlinkDirectBinaryRoundtrip)
+{
+    Mavsdk mavsdk_groundstation{Mavsdk::Configuration{ComponentType::GroundStation}};
+    Mavsdk mavsdk_autopilot{Mavsdk::Configuration{ComponentType::Autopilot}};
+
+    ASSERT_EQ(
+        mavsdk_groundstation.add_any_connection("udpin://0.0.0.0:17020"),
+        ConnectionResult::Success);
+    ASSERT_EQ(
+        mavsdk_autopilot.add_any_connection("udpout://127.0.0.1:17020"), ConnectionResult::Success);
+
+    auto maybe_system = mavsdk_groundstation.first_autopilot(10.0);
+    ASSERT_TRUE(maybe_system);
+    auto system = maybe_system.value();
+
+    while (mavsdk_autopilot.systems().size() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    auto groundstation_system = mavsdk_autopilot.systems().at(0);
+
+    auto receiver = MavlinkDirectBinary{system};
+    auto sender = MavlinkDirectBinary{groundstation_system};
+
+    // Resolve everything once up front.
+    auto [message_result, attitude] = receiver.resolve_message("ATTITUDE");
+    ASSERT_EQ(message_result, MavlinkDirectBinary::Result::Success);
+    EXPECT_EQ(attitude.id, 30u);
+
+    auto [time_result, time_boot_ms] = receiver.resolve_field(attitude, "time_boot_ms");
+    ASSERT_EQ(time_result, MavlinkDirectBinary::Result::Success);
+    EXPECT_EQ(time_boot_ms.type, MavlinkDirectBinary::FieldType::Uint32);
+    auto [roll_result, roll] = receiver.resolve_field(attitude, "roll");
+    ASSERT_EQ(roll_result, MavlinkDirectBinary::Result::Success);
+    EXPECT_EQ(roll.type, MavlinkDirectBinary::FieldType::Float);
+
+    EXPECT_EQ(
+        receiver.resolve_field(attitude, "does_not_exist").first,
+        MavlinkDirectBinary::Result::InvalidField);
+    EXPECT_EQ(
+        receiver.resolve_message("DOES_NOT_EXIST").first,
+        MavlinkDirectBinary::Result::InvalidMessage);
+
+    auto prom = std::promise<std::pair<uint32_t, float>>();
+    auto fut = prom.get_future();
+
+    auto handle = receiver.subscribe_message(
+        attitude, [&, time_boot_ms = time_boot_ms, roll = roll](const auto& message) {
+            // Wrong types are rejected.
+            EXPECT_FALSE(message.template get<double>(roll));
+            prom.set_value(
+                {message.template get<uint32_t>(time_boot_ms).value_or(0),
+                 message.template get<float>(roll).value_or(0.0f)});
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    MavlinkDirectBinary::MessageBuilder builder{attitude};
+    EXPECT_EQ(builder.set<uint32_t>(time_boot_ms, 12345), MavlinkDirectBinary::Result::Success);
+    EXPECT_EQ(builder.set<float>(roll, 0.5f), MavlinkDirectBinary::Result::Success);
+    EXPECT_EQ(builder.set<int32_t>(roll, 1), MavlinkDirectBinary::Result::InvalidField);
+    EXPECT_EQ(sender.send_message(builder), MavlinkDirectBinary::Result::Success);
+
+    ASSERT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    const auto received = fut.get();
+    EXPECT_EQ(received.first, 12345u);
+    EXPECT_FLOAT_EQ(received.second, 0.5f);
+
+    receiver.unsubscribe_message(handle);
+}
+
+TEST(SystemTest, MavlinkDirectBinaryLoadCustomXml)
+{
+    Mavsdk mavsdk_groundstation{Mavsdk::Configuration{ComponentType::GroundStation}};
+    Mavsdk mavsdk_autopilot{Mavsdk::Configuration{ComponentType::Autopilot}};
+
+    ASSERT_EQ(
+        mavsdk_groundstation.add_any_connection("udpin://0.0.0.0:17021"),
+        ConnectionResult::Success);
+    ASSERT_EQ(
+        mavsdk_autopilot.add_any_connection("udpout://127.0.0.1:17021"), ConnectionResult::Success);
+
+    auto maybe_system = mavsdk_groundstation.first_autopilot(10.0);
+    ASSERT_TRUE(maybe_system);
+    auto system = maybe_system.value();
+
+    while (mavsdk_autopilot.systems().size() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    auto groundstation_system = mavsdk_autopilot.systems().at(0);
+
+    auto receiver = MavlinkDirectBinary{system};
+    auto sender = MavlinkDirectBinary{groundstation_system};
+
+    std::string custom_xml = R"(<?xml version="1.0"?>
+<mavlink>
+    <version>3</version>
+    <dialect>0</dialect>
+    <messages>
+        <message id="421" name="CUSTOM_BINARY_TEST_MESSAGE">
+            <description>A test custom message for MavlinkDirectBinary</description>
+            <field type="uint32_t" name="test_value">Test value field</field>
+            <field type="int16_t[3]" name="values">Array field</field>
+            <field type="char[10]" name="label">String field</field>
+        </message>
+    </messages>
+</mavlink>)";
+
+    EXPECT_EQ(
+        receiver.resolve_message("CUSTOM_BINARY_TEST_MESSAGE").first,
+        MavlinkDirectBinary::Result::InvalidMessage);
+
+    EXPECT_EQ(sender.load_custom_xml(custom_xml), MavlinkDirectBinary::Result::Success);
+    EXPECT_EQ(receiver.load_custom_xml(custom_xml), MavlinkDirectBinary::Result::Success);
+
+    auto [message_result, message_type] = receiver.resolve_message("CUSTOM_BINARY_TEST_MESSAGE");
+    ASSERT_EQ(message_result, MavlinkDirectBinary::Result::Success);
+    auto test_value = receiver.resolve_field(message_type, "test_value").second;
+    auto values = receiver.resolve_field(message_type, "values").second;
+    auto label = receiver.resolve_field(message_type, "label").second;
+    EXPECT_EQ(values.type, MavlinkDirectBinary::FieldType::Int16);
+    EXPECT_EQ(values.array_length, 3);
+    EXPECT_EQ(label.type, MavlinkDirectBinary::FieldType::Char);
+    EXPECT_EQ(label.array_length, 10);
+
+    auto prom = std::promise<void>();
+    auto fut = prom.get_future();
+
+    auto handle = receiver.subscribe_message(message_type, [&](const auto& message) {
+        EXPECT_EQ(message.template get<uint32_t>(test_value), 42u);
+        EXPECT_EQ(message.template get<int16_t>(values, 0), -1);
+        EXPECT_EQ(message.template get<int16_t>(values, 2), 300);
+        EXPECT_FALSE(message.template get<int16_t>(values, 3));
+        EXPECT_EQ(message.get_string(label), "binary");
+        prom.set_value();
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    MavlinkDirectBinary::MessageBuilder builder{message_type};
+    builder.set<uint32_t>(test_value, 42);
+    builder.set<int16_t>(values, -1, 0);
+    builder.set<int16_t>(values, 300, 2);
+    EXPECT_EQ(builder.set_string(label, "binary"), MavlinkDirectBinary::Result::Success);
+    EXPECT_EQ(
+        builder.set_string(label, "much too long"), MavlinkDirectBinary::Result::InvalidField);
+    EXPECT_EQ(sender.send_message(builder), MavlinkDirectBinary::Result::Success);
+
+    ASSERT_EQ(fut.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+
+    receiver.unsubscribe_message(handle);
+}
@@ -0,0 +1,171 @@
+#include "log.h"
+#include "mavsdk.h"
+#include "plugins/param/param.h"
+#include "plugins/param_server/param_server.h"
+#include "plugins/ftp_server/ftp_server.h"
+#include "fs_helpers.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+static constexpr double reduced_timeout_s = 0.1;
+
+static const fs::path temp_dir_provided = "/tmp/mavsdk_systemtest_temp_data/provided";
+
+// @PARAM/param.pck as generated by MavlinkParamPck::encode, with params:
+// ATC_RAT_PIT_P 0.25f, ATC_RAT_RLL_P 0.5f, BATT_MONITOR int8 4, RTL_ALT int32 1500,
+// WPNAV_SPEED int16 1000
+static const std::vector<uint8_t> recorded_param_pck{
+    0x1b, 0x67, 0x05, 0x00, 0x05, 0x00, 0x04, 0xc0, 0x41, 0x54, 0x43, 0x5f, 0x52, 0x41,
+    0x54, 0x5f, 0x50, 0x49, 0x54, 0x5f, 0x50, 0x00, 0x00, 0x80, 0x3e, 0x04, 0x48, 0x52,
+    0x4c, 0x4c, 0x5f, 0x50, 0x00, 0x00, 0x00, 0x3f, 0x01, 0xb0, 0x42, 0x41, 0x54, 0x54,
+    0x5f, 0x4d, 0x4f, 0x4e, 0x49, 0x54, 0x4f, 0x52, 0x04, 0x03, 0x60, 0x52, 0x54, 0x4c,
+    0x5f, 0x41, 0x4c, 0x54, 0xdc, 0x05, 0x00, 0x00, 0x02, 0xa0, 0x57, 0x50, 0x4e, 0x41,
+    0x56, 0x5f, 0x53, 0x50, 0x45, 0x45, 0x44, 0xe8, 0x03,
+};
+
+// The params are only downloaded over FTP from ArduPilot, so our autopilot has to appear as one.
+static void appear_as_ardupilot(Mavsdk& mavsdk_groundstation)
+{
+    mavsdk_groundstation.intercept_incoming_messages_async([](mavlink_message_t& message) {
+        if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT &&
+            message.compid == MAV_COMP_ID_AUTOPILOT1) {
+            mavlink_heartbeat_t heartbeat;
+            mavlink_msg_heartbeat_decode(&message, &heartbeat);
+            heartbeat.autopilot = MAV_AUTOPILOT_ARDUPILOTMEGA;
+            mavlink_msg_heartbeat_encode(message.sysid, message.compid, &message, &heartbeat);
+        }
+        return true;
+    });
+}
+
+static bool write_param_pck(const fs::path& root)
+{
+    if (!reset_directories(root / "@PARAM")) {
+        return false;
+    }
+
+    std::ofstream file(root / "@PARAM" / "param.pck", std::ios::binary);
+    file.write(
+        reinterpret_cast<const char*>(recorded_param_pck.data()),
+        static_cast<std::streamsize>(recorded_param_pck.size()));
+    return file.good();
+}
+
+template<typename T>
+static const T* find_param(const std::vector<T>& params, const std::string& name)
+{
+    auto it = std::find_if(
+        params.begin(), params.end(), [&](const auto& param) { return param.name == name; });
+    return it != params.end() ? &(*it) : nullptr;
+}
+
+TEST(SystemTest, ParamGetAllFtp)
+{
+    ASSERT_TRUE(write_param_pck(temp_dir_provided));
+
+    Mavsdk mavsdk_groundstation{Mavsdk::Configuration{ComponentType::GroundStation}};
+    mavsdk_groundstation.set_timeout_s(reduced_timeout_s);
+    appear_as_ardupilot(mavsdk_groundstation);
+
+    Mavsdk mavsdk_autopilot{Mavsdk::Configuration{ComponentType::Autopilot}};
+    mavsdk_autopilot.set_timeout_s(reduced_timeout_s);
+
+    ASSERT_EQ(
+        mavsdk_groundstation.add_any_connection("udpin://0.0.0.0:17000"),
+        ConnectionResult::Success);
+    ASSERT_EQ(
+        mavsdk_autopilot.add_any_connection("udpout://127.0.0.1:17000"), ConnectionResult::Success);
+
+    // No ParamServer, so the params can only come from the file.
+    auto ftp_server = FtpServer{mavsdk_autopilot.server_component()};
+    ftp_server.set_root_dir(temp_dir_provided.string());
+
+    auto maybe_system = mavsdk_groundstation.first_autopilot(10.0);
+    ASSERT_TRUE(maybe_system);
+    auto system = maybe_system.value();
+
+    ASSERT_TRUE(system->has_autopilot());
+
+    // Give the autopilot version with the FTP capability time to arrive.
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    auto param = Param{system};
+    param.select_component(1, Param::ProtocolVersion::V1);
+    const auto all_params = param.get_all_params();
+
+    EXPECT_EQ(all_params.float_params.size(), 2);
+    EXPECT_EQ(all_params.int_params.size(), 3);
+
+    const auto* pit_p = find_param(all_params.float_params, "ATC_RAT_PIT_P");
+    ASSERT_NE(pit_p, nullptr);
+    EXPECT_EQ(pit_p->value, 0.25f);
+
+    const auto* rll_p = find_param(all_params.float_params, "ATC_RAT_RLL_P");
+    ASSERT_NE(rll_p, nullptr);
+    EXPECT_EQ(rll_p->value, 0.5f);
+
+    const auto* batt_monitor = find_param(all_params.int_params, "BATT_MONITOR");
+    ASSERT_NE(batt_monitor, nullptr);
+    EXPECT_EQ(batt_monitor->value, 4);
+
+    const auto* rtl_alt = find_param(all_params.int_params, "RTL_ALT");
+    ASSERT_NE(rtl_alt, nullptr);
+    EXPECT_EQ(rtl_alt->value, 1500);
+
+    const auto* wpnav_speed = find_param(all_params.int_params, "WPNAV_SPEED");
+    ASSERT_NE(wpnav_speed, nullptr);
+    EXPECT_EQ(wpnav_speed->value, 1000);
+}
+
+TEST(SystemTest, ParamGetAllFtpFallback)
+{
+    // The root dir exists but there is no param.pck in it.
+    ASSERT_TRUE(reset_directories(temp_dir_provided));
+
+    Mavsdk mavsdk_groundstation{Mavsdk::Configuration{ComponentType::GroundStation}};
+    mavsdk_groundstation.set_timeout_s(reduced_timeout_s);
+    appear_as_ardupilot(mavsdk_groundstation);
+
+    Mavsdk mavsdk_autopilot{Mavsdk::Configuration{ComponentType::Autopilot}};
+    mavsdk_autopilot.set_timeout_s(reduced_timeout_s);
+
+    ASSERT_EQ(
+        mavsdk_groundstation.add_any_connection("udpin://0.0.0.0:17000"),
+        ConnectionResult::Success);
+    ASSERT_EQ(
+        mavsdk_autopilot.add_any_connection("udpout://127.0.0.1:17000"), ConnectionResult::Success);
+
+    auto ftp_server = FtpServer{mavsdk_autopilot.server_component()};
+    ftp_server.set_root_dir(temp_dir_provided.string());
+
+    // Only a float param, our param server sends ints bytewise while the client expects them
+    // to be cast like ArduPilot does.
+    auto param_server = ParamServer{mavsdk_autopilot.server_component()};
+    EXPECT_EQ(param_server.provide_param_float("TEST_FLOAT", 42.0f), ParamServer::Result::Success);
+
+    auto maybe_system = mavsdk_groundstation.first_autopilot(10.0);
+    ASSERT_TRUE(maybe_system);
+    auto system = maybe_system.value();
+
+    ASSERT_TRUE(system->has_autopilot());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    // The download fails, so the params are requested using PARAM_REQUEST_LIST instead.
+    auto param = Param{system};
+    param.select_component(1, Param::ProtocolVersion::V1);
+    const auto all_params = param.get_all_params();
+
+    ASSERT_EQ(all_params.float_params.size(), 1);
+    EXPECT_EQ(all_params.float_params[0].name, "TEST_FLOAT");
+    EXPECT_EQ(all_params.float_params[0].value, 42.0f);
+    EXPECT_EQ(all_params.int_params.size(), 0);
+}
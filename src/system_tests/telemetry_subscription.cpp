@@ -4,7 +4,9 @@
 #include "plugins/telemetry_server/telemetry_server.h"
 #include <atomic>
 #include <future>
+#include <mutex>
 #include <thread>
+#include <vector>
 #include <gtest/gtest.h>
 
 using namespace mavsdk;
@@ -76,3 +78,49 @@ TEST(SystemTest, TelemetrySubscription)
 
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
 }
+
+TEST(SystemTest, TelemetrySubscriptionRateLimited)
+{
+    Mavsdk mavsdk_groundstation{Mavsdk::Configuration{ComponentType::GroundStation}};
+    Mavsdk mavsdk_autopilot{Mavsdk::Configuration{ComponentType::Autopilot}};
+
+    ASSERT_EQ(
+        mavsdk_groundstation.add_any_connection("udpin://0.0.0.0:17000"),
+        ConnectionResult::Success);
+    ASSERT_EQ(
+        mavsdk_autopilot.add_any_connection("udpout://127.0.0.1:17000"),
+        ConnectionResult::Success);
+
+    auto telemetry_server = TelemetryServer{mavsdk_autopilot.server_component()};
+
+    auto maybe_system = mavsdk_groundstation.first_autopilot(10.0);
+    ASSERT_TRUE(maybe_system);
+    auto system = maybe_system.value();
+
+    auto telemetry = Telemetry{system};
+
+    std::mutex mutex;
+    std::vector<float> altitudes;
+    telemetry.subscribe_position(with_delivery_policy<Telemetry::PositionCallback>(
+        DeliveryPolicy::rate_limited(2.0), [&](Telemetry::Position position) {
+            std::lock_guard<std::mutex> lock(mutex);
+            altitudes.push_back(position.relative_altitude_m);
+        }));
+
+    // A burst of updates within one interval.
+    constexpr unsigned num_updates = 10;
+    for (unsigned i = 0; i < num_updates; ++i) {
+        TelemetryServer::Position position{47.3977, 8.5456, 500.0f, static_cast<float>(i)};
+        EXPECT_EQ(
+            telemetry_server.publish_position(position, {}, {}), TelemetryServer::Result::Success);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // Once the interval has passed, the last one has to be delivered.
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_FALSE(altitudes.empty());
+    EXPECT_LT(altitudes.size(), num_updates);
+    EXPECT_EQ(altitudes.back(), static_cast<float>(num_updates - 1));
+}